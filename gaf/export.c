@@ -41,27 +41,42 @@
 #include <cairo-pdf.h>
 #include <cairo-ps.h>
 
+struct ExportFormat;
+struct ExportJob;
+struct ExportTask;
+
 static int export_text_rendered_bounds (void *user_data,
                                         OBJECT *object,
                                         int *left, int *top,
                                         int *right, int *bottom);
 static void export_layout_page (PAGE *page, cairo_rectangle_t *extents,
                                 cairo_matrix_t *mtx);
-static void export_draw_page (PAGE *page);
-
-static void export_png (void);
-static void export_postscript (gboolean is_eps);
-static void export_ps  (void);
-static void export_eps (void);
-static void export_pdf (void);
-static void export_svg (void);
+static GList *export_objects_in_rect (PAGE *page, const BOX *rect);
+static void export_dispatch_tiles (struct ExportTask *task, GThreadPool *pool,
+                                   guint *in_flight, guint max_in_flight);
+static void export_draw_page (EdaRenderer *renderer, const GList *contents);
+
+static void export_png (struct ExportTask *task, EdaRenderer *renderer);
+static void export_png_tile (struct ExportTask *task, EdaRenderer *renderer);
+static void export_record (struct ExportTask *task, EdaRenderer *renderer);
+static void export_eps (struct ExportTask *task, EdaRenderer *renderer);
+static void export_svg (struct ExportTask *task, EdaRenderer *renderer);
+static void export_ps_write (struct ExportJob *job);
+static void export_pdf_write (struct ExportJob *job);
+
+static struct ExportFormat *export_find_format (const gchar *format,
+                                                const char *outfile);
+static GPtrArray *export_parse_manifest (const char *filename);
+static void export_run (GPtrArray *jobs, const gchar *original_cwd);
 
 static gdouble export_parse_dist (const gchar *dist);
 static gboolean export_parse_scale (const gchar *scale);
 static gboolean export_parse_layout (const gchar *layout);
 static gboolean export_parse_margins (const gchar *margins);
 static gboolean export_parse_paper (const gchar *paper);
+static gboolean export_parse_region (const gchar *region);
 static gboolean export_parse_size (const gchar *size);
+static gboolean export_parse_tile (const gchar *tile);
 static void export_config (void);
 static void export_usage (void);
 static void export_command_line (int argc, char * const *argv);
@@ -70,6 +85,13 @@ static void export_command_line (int argc, char * const *argv);
 #define DEFAULT_DPI 96
 /* Default margin width in points */
 #define DEFAULT_MARGIN 18
+/* Number of pages, or tiles of tiled outputs, per worker thread
+ * which may be waiting to be drawn before handing out further ones
+ * is held off */
+#define TASKS_PER_THREAD 2
+/* Distance in world units by which an object's cues may stick out of
+ * its bounds; objects this close to a tile are drawn into it, too */
+#define CUE_MARGIN JUNCTION_CUE_SIZE_BUS
 
 enum ExportFormatFlags {
   OUTPUT_MULTIPAGE = 1,
@@ -81,7 +103,53 @@ struct ExportFormat {
   gchar *name; /* UTF-8 */
   gchar *alias; /* UTF-8 */
   gint flags;
-  void (*func)(void);
+  /* Draws a page.  Called from a worker thread. */
+  void (*func)(struct ExportTask *task, EdaRenderer *renderer);
+  /* For multipage formats, writes the output file once all pages
+   * have been drawn.  Called from a worker thread. */
+  void (*write)(struct ExportJob *job);
+};
+
+/* An output file and the input files whose pages go into it. */
+struct ExportJob {
+  struct ExportFormat *exporter;
+  gchar *outfile; /* Filename encoding */
+  GPtrArray *infiles; /* Filename encoding */
+
+  /* Rendering flags, used both for laying out and drawing pages, since
+   * hinting changes the extents of text */
+  guint render_flags;
+
+  /* Recorded pages and their sizes, for multipage formats */
+  cairo_surface_t **pages;
+  cairo_rectangle_t *extents;
+
+  gint remaining; /* Pages not yet drawn; accessed atomically */
+  gint failed; /* Accessed atomically */
+};
+
+/* A tile of a tiled PNG output. */
+struct ExportTile {
+  int level, x, y; /* Position within the pyramid of tiles */
+  int width, height; /* Pixels; smaller than usual at the edges */
+  cairo_matrix_t mtx; /* Transformation from world to tile pixels */
+};
+
+/* A page of a job, or a single tile of a page for tiled outputs, to
+ * be drawn by a worker thread.  The page has already been laid out
+ * on the main thread, and the objects to draw have been looked up,
+ * so worker threads never call into libgeda. */
+struct ExportTask {
+  struct ExportJob *job;
+  guint index; /* Position of the page within the output file */
+  PAGE *page; /* NULL if the page failed to load */
+  /* Number of users of a page shared by the tasks of its tiles; NULL
+   * if the task has the page to itself.  Main thread only. */
+  guint *page_users;
+  cairo_rectangle_t extents;
+  cairo_matrix_t mtx;
+  GList *contents; /* Objects to draw */
+  struct ExportTile tile; /* Only used if the output is tiled */
 };
 
 enum ExportOrientation {
@@ -108,20 +176,39 @@ struct ExportSettings {
 
   gboolean color;
   gchar *font; /* UTF-8 */
+
+  /* Partial output */
+  gboolean use_region;
+  BOX region; /* World coordinates */
+  gint tile[2]; /* Pixels; -1 for untiled output */
+
+  /* Batch processing */
+  const char *manifest; /* Filename encoding */
+  gint threads; /* Number of worker threads; 0 for one per processor */
 };
 
 static struct ExportFormat formats[] =
   {
-    {"Portable Network Graphics (PNG)", "png", OUTPUT_PIXELS, export_png},
-    {"Postscript (PS)", "ps", OUTPUT_POINTS | OUTPUT_MULTIPAGE, export_ps},
-    {"Encapsulated Postscript (EPS)", "eps", OUTPUT_POINTS, export_eps},
-    {"Portable Document Format (PDF)", "pdf", OUTPUT_POINTS | OUTPUT_MULTIPAGE, export_pdf},
-    {"Scalable Vector Graphics (SVG)", "svg", OUTPUT_POINTS, export_svg},
-    {NULL, NULL, 0, NULL},
+    {"Portable Network Graphics (PNG)", "png", OUTPUT_PIXELS, export_png, NULL},
+    {"Postscript (PS)", "ps", OUTPUT_POINTS | OUTPUT_MULTIPAGE, export_record, export_ps_write},
+    {"Encapsulated Postscript (EPS)", "eps", OUTPUT_POINTS, export_eps, NULL},
+    {"Portable Document Format (PDF)", "pdf", OUTPUT_POINTS | OUTPUT_MULTIPAGE, export_record, export_pdf_write},
+    {"Scalable Vector Graphics (SVG)", "svg", OUTPUT_POINTS, export_svg, NULL},
+    {NULL, NULL, 0, NULL, NULL},
   };
 
+/* The renderer used on the main thread for calculating text bounds
+ * while laying out pages.  Worker threads use their own renderers. */
 static EdaRenderer *renderer = NULL;
 static TOPLEVEL *toplevel = NULL;
+static GArray *render_color_map = NULL;
+
+/* Worker threads push finished tasks here, so that the main thread
+ * can free their pages. */
+static GAsyncQueue *done_queue = NULL;
+
+/* Set if any output could not be written; accessed atomically */
+static gint export_failed = 0;
 
 static struct ExportSettings settings = {
   0,
@@ -140,6 +227,13 @@ static struct ExportSettings settings = {
 
   FALSE,
   NULL,
+
+  FALSE,
+  {0, 0, 0, 0},
+  {-1, -1},
+
+  NULL,
+  0,
 };
 
 #define bad_arg_msg _("ERROR: Bad argument '%s' to %s option.\n")
@@ -149,11 +243,7 @@ static void
 cmd_export_impl (void *data, int argc, char **argv)
 {
   int i;
-  GError *err = NULL;
-  gchar *tmp;
-  const gchar *out_suffix;
-  struct ExportFormat *exporter = NULL;
-  GArray *render_color_map = NULL;
+  GPtrArray *jobs;
   gchar *original_cwd = g_get_current_dir ();
 
   gtk_init_check (&argc, &argv);
@@ -175,68 +265,41 @@ cmd_export_impl (void *data, int argc, char **argv)
   /* Parse command-line arguments */
   export_command_line (argc, argv);
 
-  /* If no format was specified, try and guess from output
-   * filename. */
-  if (settings.format == NULL) {
-    out_suffix = strrchr (settings.outfile, '.');
-    if (out_suffix != NULL) {
-      out_suffix++; /* Skip '.' */
-    } else {
-      fprintf (stderr,
-               _("ERROR: Cannot infer output format from filename '%s'.\n"),
-               settings.outfile);
-      exit (1);
-    }
-  }
+  /* Work out what needs to be exported */
+  if (settings.manifest != NULL) {
+    jobs = export_parse_manifest (settings.manifest);
+  } else {
+    struct ExportJob *job = g_new0 (struct ExportJob, 1);
 
-  /* Try and find an exporter function */
-  tmp = g_utf8_strdown ((settings.format == NULL) ? out_suffix : settings.format, -1);
-  for (i = 0; formats[i].name != NULL; i++) {
-    if (strcmp (tmp, formats[i].alias) == 0) {
-      exporter = &formats[i];
-      break;
-    }
-  }
-  if (exporter == NULL) {
-    if (settings.format == NULL) {
-      fprintf (stderr,
-               _("ERROR: Cannot find supported format for filename '%s'.\n"),
-               settings.outfile);
-      exit (1);
-    } else {
-      fprintf (stderr,
-               _("ERROR: Unsupported output format '%s'.\n"),
-               settings.format);
-      fprintf (stderr, see_help_msg);
+    job->exporter = export_find_format (settings.format, settings.outfile);
+    if (job->exporter == NULL) {
+      if (settings.format != NULL) {
+        fprintf (stderr, see_help_msg);
+      }
       exit (1);
     }
-  }
-  g_free (tmp);
+    job->outfile = g_strdup (settings.outfile);
+    job->infiles = g_ptr_array_new_with_free_func (g_free);
+    for (i = 0; i < settings.infilec; i++) {
+      g_ptr_array_add (job->infiles, g_strdup (settings.infilev[i]));
+    }
 
-  /* If more than one schematic/symbol file was specified, check that
-   * exporter supports multipage output. */
-  if ((settings.infilec > 1) && !(exporter->flags & OUTPUT_MULTIPAGE)) {
-    fprintf (stderr,
-             _("ERROR: Selected output format does not support multipage output\n"));
-    exit (1);
+    jobs = g_ptr_array_new ();
+    g_ptr_array_add (jobs, job);
   }
 
-  /* Load schematic files */
-  while (optind < argc) {
-    PAGE *page;
-    tmp = argv[optind++];
-
-    page = s_page_new (toplevel, tmp);
-    if (!f_open (toplevel, page, tmp, &err)) {
+  /* If more than one schematic/symbol file goes into an output file,
+   * check that the exporter supports multipage output. */
+  for (i = 0; i < jobs->len; i++) {
+    struct ExportJob *job = g_ptr_array_index (jobs, i);
+    if ((job->infiles->len > 1) && !(job->exporter->flags & OUTPUT_MULTIPAGE)) {
       fprintf (stderr,
-               _("ERROR: Failed to load '%s': %s\n"), tmp,
-               err->message);
+               _("ERROR: Selected output format does not support multipage output\n"));
       exit (1);
     }
-    if (g_chdir (original_cwd) != 0) {
+    if ((settings.tile[0] > 0) && !(job->exporter->flags & OUTPUT_PIXELS)) {
       fprintf (stderr,
-               _("ERROR: Failed to change directory to '%s': %s\n"),
-               original_cwd, g_strerror (errno));
+               _("ERROR: Selected output format does not support tiled output\n"));
       exit (1);
     }
   }
@@ -282,10 +345,368 @@ cmd_export_impl (void *data, int argc, char **argv)
   eda_renderer_set_color_map (renderer, render_color_map);
 
   /* Render */
-  exporter->func ();
+  export_run (jobs, original_cwd);
 
   scm_dynwind_end ();
-  exit (0);
+  exit (g_atomic_int_get (&export_failed) ? 1 : 0);
+}
+
+/* Looks up an exporter by format name.  If format is NULL, tries to
+ * guess it from the suffix of the output filename instead.  Prints
+ * an error message and returns NULL if no exporter is found. */
+static struct ExportFormat *
+export_find_format (const gchar *format, const char *outfile)
+{
+  int i;
+  gchar *tmp;
+  const gchar *out_suffix = NULL;
+  struct ExportFormat *exporter = NULL;
+
+  /* If no format was specified, try and guess from output
+   * filename. */
+  if (format == NULL) {
+    out_suffix = strrchr (outfile, '.');
+    if (out_suffix != NULL) {
+      out_suffix++; /* Skip '.' */
+    } else {
+      fprintf (stderr,
+               _("ERROR: Cannot infer output format from filename '%s'.\n"),
+               outfile);
+      return NULL;
+    }
+  }
+
+  /* Try and find an exporter function */
+  tmp = g_utf8_strdown ((format == NULL) ? out_suffix : format, -1);
+  for (i = 0; formats[i].name != NULL; i++) {
+    if (strcmp (tmp, formats[i].alias) == 0) {
+      exporter = &formats[i];
+      break;
+    }
+  }
+  g_free (tmp);
+
+  if (exporter == NULL) {
+    if (format == NULL) {
+      fprintf (stderr,
+               _("ERROR: Cannot find supported format for filename '%s'.\n"),
+               outfile);
+    } else {
+      fprintf (stderr,
+               _("ERROR: Unsupported output format '%s'.\n"),
+               format);
+    }
+  }
+  return exporter;
+}
+
+/* Reads a batch manifest.  Each line of the manifest names an input
+ * file, an output format (or `auto' to infer it from the output
+ * filename) and an output file, separated by whitespace; filenames
+ * containing whitespace can be quoted as in the shell.  Empty lines
+ * and lines starting with `#' are ignored.  Lines naming the same
+ * output file are combined into a multipage output, with the pages
+ * in the order in which they are listed.  Returns a list of jobs in
+ * order of their first appearance in the manifest. */
+static GPtrArray *
+export_parse_manifest (const char *filename)
+{
+  GPtrArray *jobs = g_ptr_array_new ();
+  GHashTable *job_table = g_hash_table_new (g_str_hash, g_str_equal);
+  GError *err = NULL;
+  gchar *contents;
+  gchar **lines;
+  int i;
+
+  if (!g_file_get_contents (filename, &contents, NULL, &err)) {
+    fprintf (stderr, _("ERROR: Failed to read manifest '%s': %s\n"),
+             filename, err->message);
+    exit (1);
+  }
+
+  lines = g_strsplit (contents, "\n", -1);
+  g_free (contents);
+
+  for (i = 0; lines[i] != NULL; i++) {
+    struct ExportFormat *exporter;
+    struct ExportJob *job;
+    gchar *line = g_strstrip (lines[i]);
+    gchar **fields;
+    gint n_fields;
+
+    if (line[0] == '\0' || line[0] == '#') continue;
+
+    if (!g_shell_parse_argv (line, &n_fields, &fields, &err)) {
+      fprintf (stderr, _("ERROR: %s:%i: %s\n"),
+               filename, i + 1, err->message);
+      exit (1);
+    }
+    if (n_fields != 3) {
+      fprintf (stderr,
+               _("ERROR: %s:%i: Expected input file, format and output file.\n"),
+               filename, i + 1);
+      exit (1);
+    }
+
+    exporter = export_find_format ((strcmp (fields[1], "auto") == 0)
+                                   ? NULL : fields[1], fields[2]);
+    if (exporter == NULL) {
+      fprintf (stderr, _("ERROR: %s:%i: No usable output format.\n"),
+               filename, i + 1);
+      exit (1);
+    }
+
+    job = g_hash_table_lookup (job_table, fields[2]);
+    if (job == NULL) {
+      job = g_new0 (struct ExportJob, 1);
+      job->exporter = exporter;
+      job->outfile = g_strdup (fields[2]);
+      job->infiles = g_ptr_array_new_with_free_func (g_free);
+      g_hash_table_insert (job_table, job->outfile, job);
+      g_ptr_array_add (jobs, job);
+    } else if (job->exporter != exporter) {
+      fprintf (stderr,
+               _("ERROR: %s:%i: Conflicting output formats for '%s'.\n"),
+               filename, i + 1, fields[2]);
+      exit (1);
+    }
+    g_ptr_array_add (job->infiles, g_strdup (fields[0]));
+
+    g_strfreev (fields);
+  }
+
+  g_strfreev (lines);
+  g_hash_table_destroy (job_table);
+  return jobs;
+}
+
+/* Creates a renderer for use by a worker thread.  Renderers cache
+ * data about the objects they draw, and drop it when the objects are
+ * destroyed, so each page is drawn by a renderer of its own.
+ * Otherwise the main thread could modify a renderer's caches while
+ * deleting a finished page. */
+static EdaRenderer *
+export_renderer_new (struct ExportJob *job)
+{
+  EdaRenderer *r = eda_renderer_new (NULL, NULL);
+
+  if (settings.font != NULL) {
+    g_object_set (r, "font-name", settings.font, NULL);
+  }
+  g_object_set (r, "render-flags", job->render_flags, NULL);
+  eda_renderer_set_color_map (r, render_color_map);
+  return r;
+}
+
+/* Marks a job as failed. */
+static void
+export_job_fail (struct ExportJob *job)
+{
+  g_atomic_int_set (&job->failed, TRUE);
+  g_atomic_int_set (&export_failed, TRUE);
+}
+
+/* Worker thread function.  Draws the task's page and, if it was the
+ * last page of a multipage output, writes the output file.  Finished
+ * tasks are handed back to the main thread. */
+static void
+export_task_run (struct ExportTask *task, gpointer user_data)
+{
+  struct ExportJob *job = task->job;
+
+  if (task->page != NULL && !g_atomic_int_get (&job->failed)) {
+    EdaRenderer *r = export_renderer_new (job);
+    job->exporter->func (task, r);
+    g_object_unref (r);
+  }
+
+  if (g_atomic_int_dec_and_test (&job->remaining)) {
+    if (job->exporter->write != NULL && !g_atomic_int_get (&job->failed)) {
+      job->exporter->write (job);
+    }
+  }
+
+  g_async_queue_push (done_queue, task);
+}
+
+/* Drops a use of a page, and frees the page once it is no longer
+ * used.  Must be called from the main thread. */
+static void
+export_page_release (PAGE *page, guint *users)
+{
+  if (users != NULL && --*users > 0) {
+    return;
+  }
+  s_page_delete (toplevel, page);
+  g_free (users);
+}
+
+/* Frees a finished task and, unless other tasks still use it, its
+ * page.  Must be called from the main thread. */
+static void
+export_task_free (struct ExportTask *task)
+{
+  g_list_free (task->contents);
+  if (task->page != NULL) {
+    export_page_release (task->page, task->page_users);
+  }
+  g_free (task);
+}
+
+/* Frees finished tasks until no more than `limit' are left
+ * in flight.  Must be called from the main thread. */
+static void
+export_wait_tasks (guint *in_flight, guint limit)
+{
+  while (*in_flight > limit) {
+    export_task_free (g_async_queue_pop (done_queue));
+    (*in_flight)--;
+  }
+}
+
+/* Frees a job after all of its tasks have finished. */
+static void
+export_job_free (struct ExportJob *job)
+{
+  guint i;
+
+  if (job->pages != NULL) {
+    for (i = 0; i < job->infiles->len; i++) {
+      if (job->pages[i] != NULL) {
+        cairo_surface_destroy (job->pages[i]);
+      }
+    }
+    g_free (job->pages);
+  }
+  g_free (job->extents);
+  g_ptr_array_free (job->infiles, TRUE);
+  g_free (job->outfile);
+  g_free (job);
+}
+
+/* Exports all jobs.  Pages are loaded and laid out one by one on the
+ * main thread, since neither libgeda nor Guile may be used from
+ * several threads at once.  Drawing the pages and writing the output
+ * files is done by a pool of worker threads, while the main thread
+ * goes on loading further pages. */
+static void
+export_run (GPtrArray *jobs, const gchar *original_cwd)
+{
+  GThreadPool *pool;
+  GError *err = NULL;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint in_flight = 0;
+  guint max_in_flight;
+  guint default_flags;
+  gint threads;
+  guint i, j;
+
+  threads = (settings.threads > 0) ? settings.threads : g_get_num_processors ();
+  max_in_flight = TASKS_PER_THREAD * threads;
+
+  done_queue = g_async_queue_new ();
+  pool = g_thread_pool_new ((GFunc) export_task_run, NULL,
+                            threads, TRUE, &err);
+  if (pool == NULL) {
+    fprintf (stderr, _("ERROR: Failed to create worker threads: %s\n"),
+             err->message);
+    exit (1);
+  }
+
+  /* Create a dummy context to permit calculating extents taking text
+   * into account. */
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
+  cr = cairo_create (surface);
+  cairo_surface_destroy (surface);
+  g_object_set (renderer, "cairo-context", cr, NULL);
+  g_object_get (renderer, "render-flags", &default_flags, NULL);
+
+  for (i = 0; i < jobs->len; i++) {
+    struct ExportJob *job = g_ptr_array_index (jobs, i);
+
+    /* PNG output needs subpixel hinting.  Pages are laid out with the
+     * same flags they are drawn with, or text bounds would differ. */
+    job->render_flags = (job->exporter->flags & OUTPUT_PIXELS)
+      ? EDA_RENDERER_FLAG_HINTING : default_flags;
+    g_object_set (renderer, "render-flags", job->render_flags, NULL);
+
+    job->remaining = job->infiles->len;
+    if (job->exporter->flags & OUTPUT_MULTIPAGE) {
+      job->pages = g_new0 (cairo_surface_t *, job->infiles->len);
+      job->extents = g_new0 (cairo_rectangle_t, job->infiles->len);
+    }
+
+    for (j = 0; j < job->infiles->len; j++) {
+      struct ExportTask *task = g_new0 (struct ExportTask, 1);
+      const gchar *infile = g_ptr_array_index (job->infiles, j);
+
+      /* Don't keep too many pages in memory */
+      export_wait_tasks (&in_flight, max_in_flight - 1);
+
+      task->job = job;
+      task->index = j;
+
+      /* Load and lay out the page, unless the job is hopeless */
+      if (!g_atomic_int_get (&job->failed)) {
+        task->page = s_page_new (toplevel, infile);
+        if (!f_open (toplevel, task->page, infile, &err)) {
+          fprintf (stderr,
+                   _("ERROR: Failed to load '%s': %s\n"), infile,
+                   err->message);
+          g_clear_error (&err);
+          s_page_delete (toplevel, task->page);
+          task->page = NULL;
+          export_job_fail (job);
+        }
+        if (g_chdir (original_cwd) != 0) {
+          fprintf (stderr,
+                   _("ERROR: Failed to change directory to '%s': %s\n"),
+                   original_cwd, g_strerror (errno));
+          exit (1);
+        }
+      }
+
+      if (task->page != NULL) {
+        export_layout_page (task->page, &task->extents, &task->mtx);
+        if (job->extents != NULL) {
+          job->extents[j] = task->extents;
+        }
+
+        /* Tiles are handed out one at a time, each with the
+         * objects near it */
+        if (settings.tile[0] > 0) {
+          export_dispatch_tiles (task, pool, &in_flight, max_in_flight);
+          continue;
+        }
+
+        /* Look up the objects to draw while libgeda may still be
+         * used.  Partial outputs only get the objects near them. */
+        if (settings.use_region) {
+          task->contents = export_objects_in_rect (task->page,
+                                                   &settings.region);
+        } else {
+          task->contents = g_list_copy ((GList *) s_page_objects (task->page));
+        }
+      }
+
+      g_thread_pool_push (pool, task, NULL);
+      in_flight++;
+    }
+  }
+
+  /* Wait for the remaining tasks to finish */
+  export_wait_tasks (&in_flight, 0);
+  g_thread_pool_free (pool, FALSE, TRUE);
+  g_async_queue_unref (done_queue);
+  done_queue = NULL;
+
+  cairo_destroy (cr);
+
+  for (i = 0; i < jobs->len; i++) {
+    export_job_free (g_ptr_array_index (jobs, i));
+  }
+  g_ptr_array_free (jobs, TRUE);
 }
 
 /* Callback function registered with libgeda to allow the libgeda
@@ -309,15 +730,18 @@ export_text_rendered_bounds (void *user_data, OBJECT *object,
   return result;
 }
 
-/* Prints a message and quits with error status if a cairo status
- * value is not "success". */
-static inline void
-export_cairo_check_error (cairo_status_t status)
+/* Prints a message and marks the job as failed if a cairo status
+ * value is not "success".  Returns TRUE on success. */
+static inline gboolean
+export_cairo_check_error (struct ExportJob *job, cairo_status_t status)
 {
   if (status != CAIRO_STATUS_SUCCESS) {
-    fprintf (stderr, _("ERROR: %s.\n"), cairo_status_to_string (status));
-    exit (1);
+    fprintf (stderr, _("ERROR: %s: %s.\n"),
+             job->outfile, cairo_status_to_string (status));
+    export_job_fail (job);
+    return FALSE;
   }
+  return TRUE;
 }
 
 /* Calculates a page layout.  If page is NULL, uses the first page
@@ -325,7 +749,7 @@ export_cairo_check_error (cairo_status_t status)
  * of the page is returned in extents, and the cairo transformation
  * matrix needed to fit the drawing into the page is returned in mtx.
  * Takes into account all of the margin/orientation/paper settings,
- * and the size of the drawing itself. */
+ * and the size of the drawing itself, or of the selected region. */
 static void
 export_layout_page (PAGE *page, cairo_rectangle_t *extents, cairo_matrix_t *mtx)
 {
@@ -359,9 +783,15 @@ export_layout_page (PAGE *page, cairo_rectangle_t *extents, cairo_matrix_t *mtx)
     m[3] = DEFAULT_MARGIN;
   }
 
-  /* Now calculate extents of objects within page */
-  if (!world_get_object_glist_bounds (toplevel, s_page_objects (page),
-                                      &wx_min, &wy_min, &wx_max, &wy_max))
+  /* Now calculate extents of objects within page, unless only a
+   * region of the page is wanted */
+  if (settings.use_region) {
+    wx_min = settings.region.lower_x;
+    wy_min = settings.region.lower_y;
+    wx_max = settings.region.upper_x;
+    wy_max = settings.region.upper_y;
+  } else if (!world_get_object_glist_bounds (toplevel, s_page_objects (page),
+                                             &wx_min, &wy_min, &wx_max, &wy_max))
     wx_min = wy_min = wx_max = wy_max = 0;
   w_width = wx_max - wx_min;
   w_height = wy_max - wy_min;
@@ -437,190 +867,384 @@ export_layout_page (PAGE *page, cairo_rectangle_t *extents, cairo_matrix_t *mtx)
                      (wy_min + w_height) * s + drawable.y + slack[1]);
 }
 
-/* Actually draws a page.  If page is NULL, uses the first open page. */
+/* Returns a newly allocated list of the objects of a page which
+ * might be visible within a rectangle (in world coordinates),
+ * including those whose cues stick into it.  Must be called from the
+ * main thread. */
+static GList *
+export_objects_in_rect (PAGE *page, const BOX *rect)
+{
+  BOX query;
+
+  query.lower_x = rect->lower_x - CUE_MARGIN;
+  query.lower_y = rect->lower_y - CUE_MARGIN;
+  query.upper_x = rect->upper_x + CUE_MARGIN;
+  query.upper_y = rect->upper_y + CUE_MARGIN;
+  return s_page_objects_in_regions (toplevel, page, &query, 1);
+}
+
+/* Returns the number of levels in the pyramid of tiles of a page.
+ * The last level shows the page at full resolution, and each level
+ * before it at half the resolution of the next one, down to level 0
+ * which fits into a single tile. */
+static int
+export_tile_levels (const cairo_rectangle_t *extents)
+{
+  double scale = settings.dpi / 72.0;
+  int n_levels;
+
+  for (n_levels = 1;
+       ceil (ldexp (extents->width * scale, 1 - n_levels)) > settings.tile[0]
+         || ceil (ldexp (extents->height * scale, 1 - n_levels)) > settings.tile[1];
+       n_levels++);
+  return n_levels;
+}
+
+/* Calculates the scale factor from points to pixels of a level of
+ * the pyramid of tiles, and its size in pixels (at least one). */
+static double
+export_tile_level_size (const cairo_rectangle_t *extents, int n_levels,
+                        int level, int *width, int *height)
+{
+  double factor = ldexp (settings.dpi / 72.0, level + 1 - n_levels);
+
+  *width = MAX (1, (int) ceil (extents->width * factor));
+  *height = MAX (1, (int) ceil (extents->height * factor));
+  return factor;
+}
+
+/* Works out the size and transformation matrix of a tile, whose
+ * level and position have been set, and the part of the page it
+ * covers (in world coordinates). */
+static void
+export_layout_tile (const struct ExportTask *task, double factor,
+                    int width, int height,
+                    struct ExportTile *tile, BOX *rect)
+{
+  cairo_matrix_t inverse, m;
+  double ux[2], uy[2];
+
+  /* Tiles at the right and bottom edges are cropped */
+  tile->width = MIN (settings.tile[0], width - tile->x * settings.tile[0]);
+  tile->height = MIN (settings.tile[1], height - tile->y * settings.tile[1]);
+
+  cairo_matrix_init_scale (&m, factor, factor);
+  cairo_matrix_multiply (&tile->mtx, &task->mtx, &m);
+  cairo_matrix_init_translate (&m, - tile->x * settings.tile[0],
+                               - tile->y * settings.tile[1]);
+  cairo_matrix_multiply (&tile->mtx, &tile->mtx, &m);
+
+  inverse = tile->mtx;
+  cairo_matrix_invert (&inverse);
+  ux[0] = 0; uy[0] = 0;
+  ux[1] = tile->width; uy[1] = tile->height;
+  cairo_matrix_transform_point (&inverse, &ux[0], &uy[0]);
+  cairo_matrix_transform_point (&inverse, &ux[1], &uy[1]);
+  rect->lower_x = (int) floor (fmin (ux[0], ux[1]));
+  rect->lower_y = (int) floor (fmin (uy[0], uy[1]));
+  rect->upper_x = (int) ceil (fmax (ux[0], ux[1]));
+  rect->upper_y = (int) ceil (fmax (uy[0], uy[1]));
+}
+
+/* Hands the tiles of a laid out page to the worker threads, one task
+ * per tile.  Each tile is laid out, and the objects to draw into it
+ * looked up, only once there is room for another task in flight, so
+ * memory use doesn't depend on the size of the output.  Takes over
+ * `task', whose page is shared by the tasks of the tiles.  Must be
+ * called from the main thread. */
+static void
+export_dispatch_tiles (struct ExportTask *task, GThreadPool *pool,
+                       guint *in_flight, guint max_in_flight)
+{
+  struct ExportJob *job = task->job;
+  struct ExportTask *tile_task;
+  guint *users;
+  double factor;
+  int n_levels, n_tiles, level, x, y, width, height;
+  BOX rect;
+
+  n_levels = export_tile_levels (&task->extents);
+
+  /* The job is finished once the last tile has been drawn */
+  n_tiles = 0;
+  for (level = 0; level < n_levels; level++) {
+    export_tile_level_size (&task->extents, n_levels, level, &width, &height);
+    n_tiles += ((width + settings.tile[0] - 1) / settings.tile[0])
+      * ((height + settings.tile[1] - 1) / settings.tile[1]);
+  }
+  g_atomic_int_add (&job->remaining, n_tiles - 1);
+
+  /* Keep the page while tiles are still being handed out */
+  users = g_new (guint, 1);
+  *users = 1;
+
+  for (level = 0; level < n_levels; level++) {
+    factor = export_tile_level_size (&task->extents, n_levels, level,
+                                     &width, &height);
+
+    for (y = 0; y * settings.tile[1] < height; y++) {
+      for (x = 0; x * settings.tile[0] < width; x++) {
+        export_wait_tasks (in_flight, max_in_flight - 1);
+
+        tile_task = g_new0 (struct ExportTask, 1);
+        tile_task->job = job;
+        tile_task->index = task->index;
+        tile_task->page = task->page;
+        tile_task->page_users = users;
+        tile_task->extents = task->extents;
+        tile_task->mtx = task->mtx;
+        tile_task->tile.level = level;
+        tile_task->tile.x = x;
+        tile_task->tile.y = y;
+        (*users)++;
+
+        export_layout_tile (task, factor, width, height,
+                            &tile_task->tile, &rect);
+        if (!g_atomic_int_get (&job->failed)) {
+          tile_task->contents = export_objects_in_rect (task->page, &rect);
+        }
+
+        g_thread_pool_push (pool, tile_task, NULL);
+        (*in_flight)++;
+      }
+    }
+  }
+
+  export_page_release (task->page, users);
+  g_free (task);
+}
+
+/* Actually draws a page, or the given objects of it.  If a region
+ * has been selected, anything outside it is clipped away.  Called
+ * from worker threads, so it must not call into libgeda. */
 static void
-export_draw_page (PAGE *page)
+export_draw_page (EdaRenderer *renderer, const GList *contents)
 {
-  const GList *contents;
-  GList *iter;
+  const GList *iter;
   cairo_t *cr;
 
   cr = eda_renderer_get_cairo_context (renderer);
 
-  if (page == NULL) {
-    const GList *pages = geda_list_get_glist (toplevel->pages);
-    g_assert (pages != NULL && pages->data != NULL);
-    page = (PAGE *) pages->data;
-  }
-
   /* Draw background */
   eda_cairo_set_source_color (cr, OUTPUT_BACKGROUND_COLOR,
                               eda_renderer_get_color_map (renderer));
   cairo_paint (cr);
 
+  if (settings.use_region) {
+    cairo_rectangle (cr, settings.region.lower_x, settings.region.lower_y,
+                     settings.region.upper_x - settings.region.lower_x,
+                     settings.region.upper_y - settings.region.lower_y);
+    cairo_clip (cr);
+  }
+
   /* Draw objects & cues */
-  contents = s_page_objects (page);
-  for (iter = (GList *) contents; iter != NULL; iter = g_list_next (iter))
+  for (iter = contents; iter != NULL; iter = g_list_next (iter))
     eda_renderer_draw (renderer, (OBJECT *) iter->data);
-  for (iter = (GList *) contents; iter != NULL; iter = g_list_next (iter))
+  for (iter = contents; iter != NULL; iter = g_list_next (iter))
     eda_renderer_draw_cues (renderer, (OBJECT *) iter->data);
 }
 
 static void
-export_png (void)
+export_png (struct ExportTask *task, EdaRenderer *renderer)
 {
   cairo_surface_t *surface;
   cairo_t *cr;
-  cairo_matrix_t mtx;
-  cairo_rectangle_t extents;
   cairo_status_t status;
   double scale;
 
-  /* Create a dummy context to permit calculating extents taking text
-   * into account. */
-  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
-  cr = cairo_create (surface);
-  cairo_surface_destroy (surface);
-
-  g_object_set (renderer,
-                "cairo-context", cr,
-                "render-flags", EDA_RENDERER_FLAG_HINTING,
-                NULL);
-
-  /* Calculate page layout */
-  export_layout_page (NULL, &extents, &mtx);
-  cairo_destroy (cr);
+  if (settings.tile[0] > 0) {
+    export_png_tile (task, renderer);
+    return;
+  }
 
   /* Create a rendering surface of the correct size.  'extents' is
    * measured in points, so we need to use the DPI setting to
    * transform to pixels. */
   scale = settings.dpi / 72.0;
   surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
-                                        (int) ceil (extents.width * scale),
-                                        (int) ceil (extents.height * scale));
+                                        (int) ceil (task->extents.width * scale),
+                                        (int) ceil (task->extents.height * scale));
 
   /* Create a cairo context and set the transformation matrix. */
   cr = cairo_create (surface);
   cairo_scale (cr, scale, scale);
-  cairo_transform (cr, &mtx);
+  cairo_transform (cr, &task->mtx);
 
-  /* Set up renderer. We need to enable subpixel hinting. */
+  /* Set up renderer. */
   g_object_set (renderer, "cairo-context", cr, NULL);
 
   /* Draw */
-  export_draw_page (NULL);
-  export_cairo_check_error (cairo_surface_status (surface));
+  export_draw_page (renderer, task->contents);
+  if (export_cairo_check_error (task->job, cairo_surface_status (surface))) {
+    /* Save to file */
+    status = cairo_surface_write_to_png (surface, task->job->outfile);
+    export_cairo_check_error (task->job, status);
+  }
 
-  /* Save to file */
-  status = cairo_surface_write_to_png (surface, settings.outfile);
-  export_cairo_check_error (status);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
 }
 
-/* Worker function used by both export_ps and export_eps */
+/* Builds the filename of a tile of a tiled output by inserting the
+ * level, column and row of the tile before the suffix of the output
+ * filename, e.g. `out-2-0-1.png' for `out.png'. */
+static gchar *
+export_tile_filename (const gchar *outfile, int level, int x, int y)
+{
+  const gchar *suffix = strrchr (outfile, '.');
+
+  /* Don't mistake a dot in a directory name for a suffix */
+  if (suffix == NULL || strchr (suffix, G_DIR_SEPARATOR) != NULL) {
+    suffix = outfile + strlen (outfile);
+  }
+  return g_strdup_printf ("%.*s-%i-%i-%i%s", (int) (suffix - outfile),
+                          outfile, level, x, y, suffix);
+}
+
+/* Draws a tile of a tiled PNG output, as laid out by
+ * export_dispatch_tiles().  Only the objects within the tile are
+ * drawn, so the cost of a tile doesn't depend on the size of the
+ * output. */
 static void
-export_postscript (gboolean is_eps)
+export_png_tile (struct ExportTask *task, EdaRenderer *renderer)
 {
+  struct ExportJob *job = task->job;
+  struct ExportTile *tile = &task->tile;
   cairo_surface_t *surface;
-  cairo_rectangle_t extents;
-  cairo_matrix_t mtx;
   cairo_t *cr;
-  GList *iter;
+  cairo_status_t status;
+  gchar *filename;
 
-  /* Create a surface. To begin with, we don't know the size. */
-  surface = cairo_ps_surface_create (settings.outfile, 1, 1);
-  cairo_ps_surface_set_eps (surface, is_eps);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        tile->width, tile->height);
   cr = cairo_create (surface);
+  cairo_set_matrix (cr, &tile->mtx);
+
   g_object_set (renderer, "cairo-context", cr, NULL);
 
-  for (iter = geda_list_get_glist (toplevel->pages);
-       iter != NULL;
-       iter = g_list_next (iter)) {
-    PAGE *page = (PAGE *) iter->data;
+  export_draw_page (renderer, task->contents);
 
-    export_layout_page (page, &extents, &mtx);
-    cairo_ps_surface_set_size (surface, extents.width, extents.height);
-    cairo_set_matrix (cr, &mtx);
-    export_draw_page (page);
+  filename = export_tile_filename (job->outfile, tile->level, tile->x, tile->y);
+  status = cairo_surface_status (surface);
+  if (status == CAIRO_STATUS_SUCCESS) {
+    status = cairo_surface_write_to_png (surface, filename);
+  }
+  if (status != CAIRO_STATUS_SUCCESS) {
+    fprintf (stderr, _("ERROR: %s: %s.\n"),
+             filename, cairo_status_to_string (status));
+    export_job_fail (job);
+  }
+  g_free (filename);
+
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+}
+
+/* Draws a page of a multipage output into a recording surface, to be
+ * written to the output file in the right order once all pages are
+ * done. */
+static void
+export_record (struct ExportTask *task, EdaRenderer *renderer)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA,
+                                            &task->extents);
+  cr = cairo_create (surface);
+  cairo_set_matrix (cr, &task->mtx);
+  g_object_set (renderer, "cairo-context", cr, NULL);
+
+  export_draw_page (renderer, task->contents);
+  export_cairo_check_error (task->job, cairo_surface_status (surface));
+
+  cairo_destroy (cr);
+  task->job->pages[task->index] = surface;
+}
+
+/* Writes the recorded pages of a multipage output to surface, using
+ * set_size to adjust the size of each page. */
+static void
+export_write_pages (struct ExportJob *job, cairo_surface_t *surface,
+                    void (*set_size)(cairo_surface_t *, double, double))
+{
+  cairo_t *cr;
+  guint i;
+
+  cr = cairo_create (surface);
+
+  for (i = 0; i < job->infiles->len; i++) {
+    set_size (surface, job->extents[i].width, job->extents[i].height);
+    cairo_set_source_surface (cr, job->pages[i], 0, 0);
+    cairo_paint (cr);
     cairo_show_page (cr);
   }
 
+  cairo_destroy (cr);
   cairo_surface_finish (surface);
-  export_cairo_check_error (cairo_surface_status (surface));
+  export_cairo_check_error (job, cairo_surface_status (surface));
+  cairo_surface_destroy (surface);
 }
 
 static void
-export_ps (void)
+export_ps_write (struct ExportJob *job)
 {
-  export_postscript (FALSE);
+  /* Create a surface. To begin with, we don't know the size. */
+  export_write_pages (job, cairo_ps_surface_create (job->outfile, 1, 1),
+                      cairo_ps_surface_set_size);
 }
 
 static void
-export_eps (void)
+export_pdf_write (struct ExportJob *job)
 {
-  export_postscript (TRUE);
+  /* Create a surface. To begin with, we don't know the size. */
+  export_write_pages (job, cairo_pdf_surface_create (job->outfile, 1, 1),
+                      cairo_pdf_surface_set_size);
 }
 
 static void
-export_pdf (void)
+export_eps (struct ExportTask *task, EdaRenderer *renderer)
 {
   cairo_surface_t *surface;
-  cairo_rectangle_t extents;
-  cairo_matrix_t mtx;
   cairo_t *cr;
-  GList *iter;
 
-  /* Create a surface. To begin with, we don't know the size. */
-  surface = cairo_pdf_surface_create (settings.outfile, 1, 1);
+  surface = cairo_ps_surface_create (task->job->outfile,
+                                     task->extents.width,
+                                     task->extents.height);
+  cairo_ps_surface_set_eps (surface, TRUE);
   cr = cairo_create (surface);
   g_object_set (renderer, "cairo-context", cr, NULL);
 
-  for (iter = geda_list_get_glist (toplevel->pages);
-       iter != NULL;
-       iter = g_list_next (iter)) {
-    PAGE *page = (PAGE *) iter->data;
-
-    export_layout_page (page, &extents, &mtx);
-    cairo_pdf_surface_set_size (surface, extents.width, extents.height);
-    cairo_set_matrix (cr, &mtx);
-    export_draw_page (page);
-    cairo_show_page (cr);
-  }
+  cairo_set_matrix (cr, &task->mtx);
+  export_draw_page (renderer, task->contents);
 
+  cairo_show_page (cr);
+  cairo_destroy (cr);
   cairo_surface_finish (surface);
-  export_cairo_check_error (cairo_surface_status (surface));
+  export_cairo_check_error (task->job, cairo_surface_status (surface));
+  cairo_surface_destroy (surface);
 }
 
 static void
-export_svg ()
+export_svg (struct ExportTask *task, EdaRenderer *renderer)
 {
   cairo_surface_t *surface;
-  cairo_rectangle_t extents;
-  cairo_matrix_t mtx;
   cairo_t *cr;
 
-  /* Create a surface and run export_layout_page() to figure out
-   * the picture extents and set up the cairo transformation
-   * matrix.  The surface is created only in order to force
-   * eda_renderer_default_get_user_bounds() to behave quietly. */
-  surface = cairo_svg_surface_create (settings.outfile, 0, 0);
-  cr = cairo_create (surface);
-  g_object_set (renderer, "cairo-context", cr, NULL);
-  export_layout_page (NULL, &extents, &mtx);
-  cairo_destroy (cr);
-
-  /* Now create a new surface with the known extents. */
-  surface = cairo_svg_surface_create (settings.outfile,
-                                      extents.width,
-                                      extents.height);
+  surface = cairo_svg_surface_create (task->job->outfile,
+                                      task->extents.width,
+                                      task->extents.height);
   cr = cairo_create (surface);
   g_object_set (renderer, "cairo-context", cr, NULL);
 
-  cairo_set_matrix (cr, &mtx);
-  export_draw_page (NULL);
+  cairo_set_matrix (cr, &task->mtx);
+  export_draw_page (renderer, task->contents);
 
   cairo_show_page (cr);
+  cairo_destroy (cr);
   cairo_surface_finish (surface);
-  export_cairo_check_error (cairo_surface_status (surface));
+  export_cairo_check_error (task->job, cairo_surface_status (surface));
+  cairo_surface_destroy (surface);
 }
 
 /* Parse a distance specification. A distance specification consists
@@ -790,6 +1414,83 @@ export_parse_size (const gchar *size)
   return TRUE;
 }
 
+/* Parse the --region option, which must either be "auto" (i.e. export
+ * the whole drawing) or a list of four world coordinates giving two
+ * opposite corners of the region to export. */
+static gboolean
+export_parse_region (const gchar *region)
+{
+  gint n;
+  gchar **coords;
+  gdouble c[4];
+
+  /* Whole drawing case */
+  if (g_strcmp0 (region, "auto") == 0 || region[0] == 0) {
+    settings.use_region = FALSE;
+    return TRUE;
+  }
+
+  coords = g_strsplit_set (region, ":; ", 4);
+  for (n = 0; coords[n] != NULL; n++) {
+    gchar *end;
+    errno = 0;
+    c[n] = strtod (coords[n], &end);
+    if (errno != 0 || end == coords[n] || *end != 0) {
+      g_strfreev (coords);
+      return FALSE;
+    }
+  }
+  g_strfreev (coords);
+  if (n != 4) return FALSE;
+
+  settings.region.lower_x = lrint (fmin (c[0], c[2]));
+  settings.region.lower_y = lrint (fmin (c[1], c[3]));
+  settings.region.upper_x = lrint (fmax (c[0], c[2]));
+  settings.region.upper_y = lrint (fmax (c[1], c[3]));
+  if (settings.region.lower_x == settings.region.upper_x
+      || settings.region.lower_y == settings.region.upper_y) return FALSE;
+
+  settings.use_region = TRUE;
+  return TRUE;
+}
+
+/* Parse the --tile option, which must either be "none" (i.e. write
+ * one image per output) or the width and height of a tile in
+ * pixels. */
+static gboolean
+export_parse_tile (const gchar *tile)
+{
+  gint n;
+  gchar **dims;
+  gint d[2];
+
+  /* Untiled case */
+  if (g_strcmp0 (tile, "none") == 0 || tile[0] == 0) {
+    settings.tile[0] = settings.tile[1] = -1;
+    return TRUE;
+  }
+
+  /* Accept `WIDTHxHEIGHT' as well as the usual separators */
+  dims = g_strsplit_set (tile, "x:; ", 2);
+  for (n = 0; dims[n] != NULL; n++) {
+    gchar *end;
+    long l;
+    errno = 0;
+    l = strtol (dims[n], &end, 10);
+    if (errno != 0 || end == dims[n] || *end != 0 || l <= 0 || l > G_MAXINT) {
+      g_strfreev (dims);
+      return FALSE;
+    }
+    d[n] = (gint) l;
+  }
+  g_strfreev (dims);
+  if (n != 2) return FALSE;
+
+  settings.tile[0] = d[0];
+  settings.tile[1] = d[1];
+  return TRUE;
+}
+
 /* Parse the --scale option. The value should be a distance
  * corresponding to 100 points in gschem (1 default grid spacing). */
 static gboolean
@@ -880,22 +1581,26 @@ export_config (void)
   }
 }
 
-#define export_short_options "a:cd:f:F:hl:m:o:p:s:k:"
+#define export_short_options "a:b:cd:f:F:hj:l:m:o:p:r:s:k:t:"
 
 static struct option export_long_options[] = {
   {"no-color", 0, NULL, 2},
   {"align", 1, NULL, 'a'},
+  {"batch", 1, NULL, 'b'},
   {"color", 0, NULL, 'c'},
   {"dpi", 1, NULL, 'd'},
   {"format", 1, NULL, 'f'},
   {"font", 1, NULL, 'F'},
   {"help", 0, NULL, 'h'},
+  {"jobs", 1, NULL, 'j'},
   {"layout", 1, NULL, 'l'},
   {"margins", 1, NULL, 'm'},
   {"output", 1, NULL, 'o'},
   {"paper", 1, NULL, 'p'},
+  {"region", 1, NULL, 'r'},
   {"size", 1, NULL, 's'},
   {"scale", 1, NULL, 'k'},
+  {"tile", 1, NULL, 't'},
   {NULL, 0, NULL, 0},
 };
 
@@ -903,9 +1608,12 @@ static void
 export_usage (void)
 {
   printf (_("Usage: gaf export [OPTION ...] -o OUTPUT [--] FILE ...\n"
+"       gaf export [OPTION ...] -b MANIFEST\n"
 "\n"
 "Export gEDA files in various image formats.\n"
 "\n"
+"  -b, --batch=MANIFEST   export the files listed in MANIFEST\n"
+"  -j, --jobs=N           number of pages to draw in parallel\n"
 "  -f, --format=TYPE      output format (normally autodetected)\n"
 "  -o, --output=OUTPUT    output filename\n"
 "  -p, --paper=NAME       select paper size by name\n"
@@ -917,6 +1625,10 @@ export_usage (void)
 "  -a, --align=HALIGN;VALIGN\n"
 "                           set alignment of drawing within page\n"
 "  -d, --dpi=DPI          pixels-per-inch for raster outputs\n"
+"  -r, --region=X1;Y1;X2;Y2\n"
+"                           only export this region of each page\n"
+"  -t, --tile=WIDTH;HEIGHT\n"
+"                           split raster outputs into tiles of this size\n"
 "  -c, --color            enable color output\n"
 "  --no-color             disable color output\n"
 "  -F, --font=NAME        set font family for printing text\n"
@@ -975,6 +1687,10 @@ export_command_line (int argc, char * const *argv)
       g_free (str);
       break;
 
+    case 'b':
+      settings.manifest = optarg;
+      break;
+
     case 'c':
       settings.color = TRUE;
       break;
@@ -1003,6 +1719,15 @@ export_command_line (int argc, char * const *argv)
       export_usage ();
       break;
 
+    case 'j':
+      settings.threads = strtol (optarg, NULL, 10);
+      if (settings.threads <= 0) {
+        fprintf (stderr, bad_arg_msg, optarg, "-j,--jobs");
+        fprintf (stderr, see_help_msg);
+        exit (1);
+      }
+      break;
+
     case 'k':
       str = export_command_line__utf8_check (optarg, "-k,--scale");
       if (!export_parse_scale (str)) {
@@ -1052,6 +1777,16 @@ export_command_line (int argc, char * const *argv)
       g_free (str);
       break;
 
+    case 'r':
+      str = export_command_line__utf8_check (optarg, "-r,--region");
+      if (!export_parse_region (str)) {
+        fprintf (stderr, bad_arg_msg, optarg, "-r,--region");
+        fprintf (stderr, see_help_msg);
+        exit (1);
+      }
+      g_free (str);
+      break;
+
     case 's':
       str = export_command_line__utf8_check (optarg, "-s,--size");
       if (!export_parse_size (str)) {
@@ -1068,6 +1803,16 @@ export_command_line (int argc, char * const *argv)
       }
       break;
 
+    case 't':
+      str = export_command_line__utf8_check (optarg, "-t,--tile");
+      if (!export_parse_tile (str)) {
+        fprintf (stderr, bad_arg_msg, optarg, "-t,--tile");
+        fprintf (stderr, see_help_msg);
+        exit (1);
+      }
+      g_free (str);
+      break;
+
     case '?':
       /* getopt_long already printed an error message */
       fprintf (stderr, see_help_msg);
@@ -1078,6 +1823,17 @@ export_command_line (int argc, char * const *argv)
     }
   }
 
+  /* In batch mode, inputs and outputs are taken from the manifest */
+  if (settings.manifest != NULL) {
+    if (argc > optind || settings.outfile != NULL) {
+      fprintf (stderr,
+               _("ERROR: Input and output files must be given in the manifest in batch mode.\n"));
+      fprintf (stderr, see_help_msg);
+      exit (1);
+    }
+    return;
+  }
+
   /* Check that some schematic files to print were provided */
   if (argc <= optind) {
     fprintf (stderr,
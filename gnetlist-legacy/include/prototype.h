@@ -96,6 +96,15 @@ void s_netlist_name_named_nets (TOPLEVEL *pr_current,
 char *s_netlist_netname_of_netid (TOPLEVEL *pr_current,
 				  NETLIST *netlist_head,
 				  int net_id);
+/* s_netindex.c */
+void s_netindex_free(void);
+void s_netindex_build(void);
+GPtrArray *s_netindex_get_packages(void);
+GPtrArray *s_netindex_get_nets(void);
+GPtrArray *s_netindex_get_instances(const char *uref);
+GPtrArray *s_netindex_get_pins(const char *uref, const char *pin);
+GPtrArray *s_netindex_get_connections(const char *net_name);
+GPtrArray *s_netindex_get_graphical(const char *net_name);
 /* s_rename.c */
 void s_rename_init(void);
 void s_rename_destroy_all(void);
@@ -103,7 +112,6 @@ void s_rename_next_set(void);
 void s_rename_print(void);
 int s_rename_search(char *src, char *dest, int quiet_flag);
 void s_rename_add(char *src, char *dest);
-void s_rename_all_lowlevel(NETLIST *netlist_head, char *src, char *dest);
 void s_rename_all(TOPLEVEL *pr_current, NETLIST *netlist_head);
 SCM g_get_renamed_nets(SCM scm_level);
 /* s_traverse.c */
@@ -48,29 +48,16 @@ SCM g_scm_c_get_uref (OBJECT *object)
 SCM g_get_packages(SCM level)
 {
     SCM list = SCM_EOL;
-    GHashTable *ht;
-
-    NETLIST *nl_current = NULL;
+    GPtrArray *urefs;
+    guint i;
 
     SCM_ASSERT(scm_is_string (level), level, SCM_ARG1, "gnetlist:get-packages");
 
-    /* build a hash table */
-    ht = g_hash_table_new (g_str_hash, g_str_equal);
-    for (nl_current = netlist_head; nl_current != NULL;
-         nl_current = nl_current->next) {
-      if (nl_current->component_uref != NULL) {
-        /* add component_uref in the hash table */
-        /* uniqueness of component_uref is guaranteed by the hashtable */
-
-        if (g_hash_table_lookup (ht, nl_current->component_uref) == NULL) {
-          g_hash_table_insert (ht, nl_current->component_uref,
-                                   nl_current->component_uref);
-          list = scm_cons (scm_from_utf8_string (nl_current->component_uref),
-                           list);
-        }
-      }
+    urefs = s_netindex_get_packages ();
+    for (i = 0; urefs != NULL && i < urefs->len; i++) {
+      list = scm_cons (scm_from_utf8_string (g_ptr_array_index (urefs, i)),
+                       list);
     }
-    g_hash_table_destroy (ht);
 
     return list;
 }
@@ -100,34 +87,28 @@ SCM g_get_pins(SCM scm_uref)
 {
     char *uref;
     SCM list = SCM_EOL;
+    GPtrArray *instances;
     NETLIST *nl_current;
     CPINLIST *pl_current;
+    guint i;
 
     SCM_ASSERT(scm_is_string (scm_uref), scm_uref, SCM_ARG1, "gnetlist:get-pins");
 
     uref = scm_to_utf8_string (scm_uref);
 
-    /* here is where you make it multi page aware */
-    nl_current = netlist_head;
+    /* go through all instances */
+    instances = s_netindex_get_instances (uref);
+    for (i = 0; instances != NULL && i < instances->len; i++) {
+	nl_current = g_ptr_array_index (instances, i);
 
-    /* search for the first instance */
-    /* through the entire list */
-    while (nl_current != NULL) {
-
-	if (nl_current->component_uref) {
-	    if (strcmp(nl_current->component_uref, uref) == 0) {
-
-		pl_current = nl_current->cpins;
-		while (pl_current != NULL) {
-		    if (pl_current->pin_number) {
+	pl_current = nl_current->cpins;
+	while (pl_current != NULL) {
+	    if (pl_current->pin_number) {
               list = scm_cons (scm_from_utf8_string (pl_current->pin_number),
                                list);
-		    }
-		    pl_current = pl_current->next;
-		}
 	    }
+	    pl_current = pl_current->next;
 	}
-	nl_current = nl_current->next;
     }
 
     free (uref);
@@ -182,40 +163,18 @@ SCM g_get_all_unique_nets(SCM scm_level)
 {
 
     SCM list = SCM_EOL;
-    SCM x = SCM_EOL;
-    NETLIST *nl_current;
-    CPINLIST *pl_current;
-    char *net_name;
+    GPtrArray *net_names;
+    guint i;
 
     SCM_ASSERT(scm_is_string (scm_level), scm_level, SCM_ARG1,
 	       "gnetlist:get-all-unique-nets");
 
-    nl_current = netlist_head;
-
-    /* walk through the list of components, and through the list
-     * of individual pins on each, adding net names to the list
-     * being careful to ignore duplicates, and unconnected pins
-     */
-    while (nl_current != NULL) {
-	pl_current = nl_current->cpins;
-	while (pl_current != NULL) {
-	    if (pl_current->net_name) {
-
-		net_name = pl_current->net_name;
-		/* filter off unconnected pins */
-		if (strncmp(net_name, "unconnected_pin", 15) != 0) {
-		    /* add the net name to the list */
-		    /*printf("Got net: `%s'\n",net_name); */
-
-		    x = scm_from_utf8_string (net_name);
-		    if (scm_is_false (scm_member (x, list))) {
-              list = scm_cons (x, list);
-		    }
-		}
-	    }
-	    pl_current = pl_current->next;
-	}
-	nl_current = nl_current->next;
+    /* the index already has the names of all connected nets, without
+     * duplicates, in the order in which they appear in the netlist */
+    net_names = s_netindex_get_nets ();
+    for (i = 0; net_names != NULL && i < net_names->len; i++) {
+	list = scm_cons (scm_from_utf8_string (g_ptr_array_index (net_names, i)),
+                         list);
     }
 
     return list;
@@ -225,18 +184,11 @@ SCM g_get_all_unique_nets(SCM scm_level)
 SCM g_get_all_connections(SCM scm_netname)
 {
 
-    SCM list = SCM_EOL;
-    SCM x = SCM_EOL;
-    SCM is_member = SCM_EOL;
     SCM connlist = SCM_EOL;
     SCM pairlist = SCM_EOL;
-    NETLIST *nl_current;
-    CPINLIST *pl_current;
-    NET *n_current;
+    GPtrArray *connections;
     char *wanted_net_name;
-    char *net_name;
-    char *pin;
-    char *uref;
+    guint i;
 
     SCM_ASSERT(scm_is_string(scm_netname), scm_netname, SCM_ARG1,
 	       "gnetlist:get-all-connections");
@@ -244,67 +196,18 @@ SCM g_get_all_connections(SCM scm_netname)
     wanted_net_name = scm_to_utf8_string (scm_netname);
 
     if (wanted_net_name == NULL) {
-	return list;
+	return connlist;
     }
 
+    /* the index has each (uref pin) pair connected to the net once */
+    connections = s_netindex_get_connections (wanted_net_name);
+    for (i = 0; connections != NULL && i < connections->len; i += 2) {
+	pairlist = scm_list_n (
+	    scm_from_utf8_string (g_ptr_array_index (connections, i)),
+	    scm_from_utf8_string (g_ptr_array_index (connections, i + 1)),
+	    SCM_UNDEFINED);
 
-    nl_current = netlist_head;
-
-    /* walk through the list of components, and through the list
-     * of individual pins on each, adding net names to the list
-     * being careful to ignore duplicates, and unconnected pins
-     */
-    while (nl_current != NULL) {
-	pl_current = nl_current->cpins;
-	while (pl_current != NULL) {
-	    if (pl_current->net_name) {
-
-		net_name = pl_current->net_name;
-		/* filter off unconnected pins */
-		if (strcmp(net_name, wanted_net_name) == 0) {
-		    /* add the net name to the list */
-
-#if DEBUG
-		    printf("found net: `%s'\n", net_name);
-#endif
-
-		    n_current = pl_current->nets;
-		    while (n_current != NULL) {
-
-			if (n_current->connected_to) {
-
-			    pin = (char *) g_malloc(sizeof(char) *
-						  strlen(n_current->
-							 connected_to));
-			    uref =
-				(char *) g_malloc(sizeof(char) *
-						strlen(n_current->
-						       connected_to));
-
-			    sscanf(n_current->connected_to,
-				   "%s %s", uref, pin);
-
-			    pairlist = scm_list_n (scm_from_utf8_string (uref),
-                                       scm_from_utf8_string (pin),
-                                       SCM_UNDEFINED);
-
-			    x = pairlist;
-			    is_member = scm_member(x, connlist);
-
-			    if (scm_is_false (is_member)) {
-				connlist = scm_cons (pairlist, connlist);
-			    }
-
-			    g_free(uref);
-			    g_free(pin);
-			}
-			n_current = n_current->next;
-		    }
-		}
-	    }
-	    pl_current = pl_current->next;
-	}
-	nl_current = nl_current->next;
+	connlist = scm_cons (pairlist, connlist);
     }
 
     free (wanted_net_name);
@@ -318,9 +221,10 @@ SCM g_get_nets(SCM scm_uref, SCM scm_pin)
   SCM outerlist = SCM_EOL;
   SCM pinslist = SCM_EOL;
   SCM pairlist = SCM_EOL;
-  NETLIST *nl_current = NULL;
+  GPtrArray *pins;
   CPINLIST *pl_current = NULL;
   NET *n_current;
+  guint i;
   char *wanted_uref = NULL;
   char *wanted_pin = NULL;
   char *net_name = NULL;
@@ -342,53 +246,41 @@ SCM g_get_nets(SCM scm_uref, SCM scm_pin)
   wanted_pin = scm_to_utf8_string (scm_pin);
   scm_dynwind_free (wanted_pin);
 
-  /* search for the first instance */
-  /* through the entire list */
-  for (nl_current = netlist_head;
-       nl_current != NULL;
-       nl_current = nl_current->next) {
-
-    if (!nl_current->component_uref) continue;
-    if (strcmp (nl_current->component_uref, wanted_uref) != 0) continue;
-
-    for (pl_current = nl_current->cpins;
-         pl_current != NULL;
-         pl_current = pl_current->next) {
-
-      if (!pl_current->pin_number) continue;
-      if (strcmp(pl_current->pin_number, wanted_pin) != 0) continue;
+  /* go through the pins with this number in all instances */
+  pins = s_netindex_get_pins (wanted_uref, wanted_pin);
+  for (i = 0; pins != NULL && i < pins->len; i++) {
+    pl_current = g_ptr_array_index (pins, i);
 
-      if (pl_current->net_name) {
-        net_name = pl_current->net_name;
-      }
+    if (pl_current->net_name) {
+      net_name = pl_current->net_name;
+    }
 
-      for (n_current = pl_current->nets;
-           n_current != NULL;
-           n_current = n_current->next) {
+    for (n_current = pl_current->nets;
+         n_current != NULL;
+         n_current = n_current->next) {
 
-        if (!n_current->connected_to) continue;
+      if (!n_current->connected_to) continue;
 
-        pin = (char *) g_malloc(sizeof(char) *
-                                strlen
-                                (n_current->
+      pin = (char *) g_malloc(sizeof(char) *
+                              strlen
+                              (n_current->
+                               connected_to));
+      uref =
+        (char *) g_malloc(sizeof(char) *
+                          strlen(n_current->
                                  connected_to));
-        uref =
-          (char *) g_malloc(sizeof(char) *
-                            strlen(n_current->
-                                   connected_to));
 
-        sscanf(n_current->connected_to,
-               "%s %s", uref, pin);
+      sscanf(n_current->connected_to,
+             "%s %s", uref, pin);
 
-        pairlist = scm_list_n (scm_from_utf8_string (uref),
-                               scm_from_utf8_string (pin),
-                               SCM_UNDEFINED);
+      pairlist = scm_list_n (scm_from_utf8_string (uref),
+                             scm_from_utf8_string (pin),
+                             SCM_UNDEFINED);
 
-        pinslist = scm_cons (pairlist, pinslist);
+      pinslist = scm_cons (pairlist, pinslist);
 
-        g_free(uref);
-        g_free(pin);
-      }
+      g_free(uref);
+      g_free(pin);
     }
   }
 
@@ -414,8 +306,10 @@ SCM g_get_pins_nets(SCM scm_uref)
 {
     SCM pinslist = SCM_EOL;
     SCM pairlist = SCM_EOL;
+    GPtrArray *instances;
     NETLIST *nl_current = NULL;
     CPINLIST *pl_current = NULL;
+    guint i;
 
     char *wanted_uref = NULL;
     char *net_name = NULL;
@@ -426,32 +320,25 @@ SCM g_get_pins_nets(SCM scm_uref)
 
     wanted_uref = scm_to_utf8_string (scm_uref);
 
-    /* search for the any instances */
-    /* through the entire list */
-    for (nl_current = netlist_head; nl_current != NULL;
-	 nl_current = nl_current->next) {
-
-	/* is there a uref? */
-	if (nl_current->component_uref) {
-	    /* is it the one we want ? */
-	    if (strcmp(nl_current->component_uref, wanted_uref) == 0) {
-
-		for (pl_current = nl_current->cpins; pl_current != NULL;
-		     pl_current = pl_current->next) {
-		    /* is there a valid pin number and a valid name ? */
-		    if (pl_current->pin_number) {
-			if (pl_current->net_name) {
-			    /* yes, add it to the list */
-			    pin = pl_current->pin_number;
-			    net_name = pl_current->net_name;
-
-			    pairlist = scm_cons (scm_from_utf8_string (pin),
-                                                 scm_from_utf8_string (net_name));
-			    pinslist = scm_cons (pairlist, pinslist);
-			}
-
-		    }
+    /* go through all instances */
+    instances = s_netindex_get_instances (wanted_uref);
+    for (i = 0; instances != NULL && i < instances->len; i++) {
+	nl_current = g_ptr_array_index (instances, i);
+
+	for (pl_current = nl_current->cpins; pl_current != NULL;
+	     pl_current = pl_current->next) {
+	    /* is there a valid pin number and a valid name ? */
+	    if (pl_current->pin_number) {
+		if (pl_current->net_name) {
+		    /* yes, add it to the list */
+		    pin = pl_current->pin_number;
+		    net_name = pl_current->net_name;
+
+		    pairlist = scm_cons (scm_from_utf8_string (pin),
+                                         scm_from_utf8_string (net_name));
+		    pinslist = scm_cons (pairlist, pinslist);
 		}
+
 	    }
 	}
     }
@@ -484,9 +371,11 @@ SCM g_get_pins_nets(SCM scm_uref)
 SCM g_get_all_package_attributes(SCM scm_uref, SCM scm_wanted_attrib)
 {
     SCM ret = SCM_EOL;
+    GPtrArray *instances;
     NETLIST *nl_current;
     char *uref;
     char *wanted_attrib;
+    guint i;
 
     SCM_ASSERT(scm_is_string (scm_uref),
 	       scm_uref, SCM_ARG1, "gnetlist:get-all-package-attributes");
@@ -497,24 +386,18 @@ SCM g_get_all_package_attributes(SCM scm_uref, SCM scm_wanted_attrib)
     uref          = scm_to_utf8_string (scm_uref);
     wanted_attrib = scm_to_utf8_string (scm_wanted_attrib);
 
-    /* here is where you make it multi page aware */
-    nl_current = netlist_head;
-
-    /* search for uref instances and through the entire list */
-    while (nl_current != NULL) {
+    /* go through all instances */
+    instances = s_netindex_get_instances (uref);
+    for (i = 0; instances != NULL && i < instances->len; i++) {
+	char *value;
 
-	if (nl_current->component_uref) {
-	    if (strcmp(nl_current->component_uref, uref) == 0) {
-		char *value =
-		    o_attrib_search_object_attribs_by_name (nl_current->object_ptr,
-		                                            wanted_attrib, 0);
+	nl_current = g_ptr_array_index (instances, i);
+	value = o_attrib_search_object_attribs_by_name (nl_current->object_ptr,
+	                                                wanted_attrib, 0);
 
-		ret = scm_cons (value ? scm_from_utf8_string (value) : SCM_BOOL_F, ret);
+	ret = scm_cons (value ? scm_from_utf8_string (value) : SCM_BOOL_F, ret);
 
-		g_free (value);
-	    }
-	}
-	nl_current = nl_current->next;
+	g_free (value);
     }
 
     free (uref);
@@ -529,7 +412,9 @@ SCM g_get_attribute_by_pinseq(SCM scm_uref, SCM scm_pinseq,
                               SCM scm_wanted_attrib)
 {
   SCM scm_return_value;
+  GPtrArray *instances;
   NETLIST *nl_current;
+  guint i;
   char *uref;
   char *pinseq;
   char *wanted_attrib;
@@ -564,33 +449,25 @@ SCM g_get_attribute_by_pinseq(SCM scm_uref, SCM scm_pinseq,
   printf("  wanted_attrib = %s\n", wanted_attrib);
 #endif
 
-  /* here is where you make it multi page aware */
-  nl_current = netlist_head;
+  /* search for the first instance which has the attribute */
+  instances = s_netindex_get_instances (uref);
+  for (i = 0; instances != NULL && i < instances->len; i++) {
+    nl_current = g_ptr_array_index (instances, i);
 
-  /* search for the first instance */
-  /* through the entire list */
-  while (nl_current != NULL) {
+    o_pin_object = o_complex_find_pin_by_attribute (nl_current->object_ptr,
+                                                    "pinseq", pinseq);
 
-    if (nl_current->component_uref) {
-      if (strcmp(nl_current->component_uref, uref) == 0) {
-
-        o_pin_object = o_complex_find_pin_by_attribute (nl_current->object_ptr,
-                                                        "pinseq", pinseq);
-
-        if (o_pin_object) {
-          return_value =
-            o_attrib_search_object_attribs_by_name (o_pin_object,
-                                                    wanted_attrib, 0);
-          if (return_value) {
-            break;
-          }
-        }
-
-        /* Don't break until we search the whole netlist to handle slotted */
-        /* parts.   4.28.2007 -- SDB. */
+    if (o_pin_object) {
+      return_value =
+        o_attrib_search_object_attribs_by_name (o_pin_object,
+                                                wanted_attrib, 0);
+      if (return_value) {
+        break;
       }
     }
-    nl_current = nl_current->next;
+
+    /* Don't break until we search all instances to handle slotted */
+    /* parts.   4.28.2007 -- SDB. */
   }
 
   scm_dynwind_end ();
@@ -615,13 +492,14 @@ SCM g_get_attribute_by_pinnumber(SCM scm_uref, SCM scm_pin, SCM
                                scm_wanted_attrib)
 {
     SCM scm_return_value;
+    GPtrArray *instances;
     NETLIST *nl_current;
     OBJECT *pin_object;
+    guint i;
     char *uref;
     char *pin;
     char *wanted_attrib;
     char *return_value = NULL;
-    int done = FALSE;
 
     SCM_ASSERT(scm_is_string (scm_uref),
 	       scm_uref, SCM_ARG1, "gnetlist:get-attribute-by-pinnumber");
@@ -643,48 +521,41 @@ SCM g_get_attribute_by_pinnumber(SCM scm_uref, SCM scm_pin, SCM
     wanted_attrib = scm_to_utf8_string (scm_wanted_attrib);
     scm_dynwind_free (wanted_attrib);
 
-    /* here is where you make it multi page aware */
-    nl_current = netlist_head;
-
-    /* search for the first instance */
-    /* through the entire list */
-    while (nl_current != NULL && !done) {
-	if (nl_current->component_uref) {
-	    if (strcmp(nl_current->component_uref, uref) == 0) {
+    /* go through all instances */
+    instances = s_netindex_get_instances (uref);
+    for (i = 0; instances != NULL && i < instances->len; i++) {
+	nl_current = g_ptr_array_index (instances, i);
 
-		pin_object =
-		    o_complex_find_pin_by_attribute (nl_current->object_ptr,
-		                                     "pinnumber", pin);
+	pin_object =
+	    o_complex_find_pin_by_attribute (nl_current->object_ptr,
+	                                     "pinnumber", pin);
 
-		if (pin_object) {
+	if (pin_object) {
 
-		    /* only look for the first occurance of wanted_attrib */
-		    return_value =
-		      o_attrib_search_object_attribs_by_name (pin_object,
-		                                              wanted_attrib, 0);
+	    /* only look for the first occurance of wanted_attrib */
+	    return_value =
+	      o_attrib_search_object_attribs_by_name (pin_object,
+	                                              wanted_attrib, 0);
 #if DEBUG
-		    if (return_value) {
-			printf("GOT IT: %s\n", return_value);
-		    }
+	    if (return_value) {
+		printf("GOT IT: %s\n", return_value);
+	    }
 #endif
-		} else if (strcmp("pintype",
-				  wanted_attrib) == 0) {
-		  if (nl_current->cpins) {
-		    CPINLIST *pinobject =
-		      s_cpinlist_search_pin(nl_current->cpins, pin);
-		    if (pinobject) {
-		      return_value="pwr";
+	} else if (strcmp("pintype",
+			  wanted_attrib) == 0) {
+	  if (nl_current->cpins) {
+	    CPINLIST *pinobject =
+	      s_cpinlist_search_pin(nl_current->cpins, pin);
+	    if (pinobject) {
+	      return_value="pwr";
 #if DEBUG
 
-		      printf("Supplied pintype 'pwr' for artificial pin '%s' of '%s'\n",
-			     pin, uref);
+	      printf("Supplied pintype 'pwr' for artificial pin '%s' of '%s'\n",
+		     pin, uref);
 #endif
-		    }
-		  }
-		}
 	    }
+	  }
 	}
-	nl_current = nl_current->next;
     }
 
     scm_dynwind_end ();
@@ -806,12 +677,12 @@ SCM g_graphical_objs_in_net_with_attrib_get_attrib (SCM scm_netname, SCM scm_has
 {
 
     SCM list = SCM_EOL;
+    GPtrArray *graphical;
     NETLIST *nl_current;
-    CPINLIST *pl_current;
+    guint i;
     char *wanted_net_name;
     char *wanted_attrib;
     char *has_attrib;
-    char *net_name;
     char *attrib_value=NULL;
     char *has_attrib_value = NULL;
     char *has_attrib_name = NULL;
@@ -842,45 +713,33 @@ SCM g_graphical_objs_in_net_with_attrib_get_attrib (SCM scm_netname, SCM scm_has
     has_attrib = scm_to_utf8_string (scm_has_attribute);
     scm_dynwind_free (has_attrib);
 
-    nl_current = graphical_netlist_head;
-
-    /* walk through the list of components, and through the list
-     * of individual pins on each, adding net names to the list
-     * being careful to ignore duplicates, and unconnected pins
-     */
-    while (nl_current != NULL) {
-	pl_current = nl_current->cpins;
-	while (pl_current != NULL) {
-	    if (pl_current->net_name) {
-		net_name = pl_current->net_name;
-		if (strcmp(net_name, wanted_net_name) == 0) {
-
-		  if (o_attrib_string_get_name_value (has_attrib, &has_attrib_name,
-					       &has_attrib_value) != 0) {
-		    attrib_value =
-		      o_attrib_search_object_attribs_by_name (nl_current->object_ptr,
-		                                              has_attrib_name, 0);
-
-		    if ( ((has_attrib_value == NULL) && (attrib_value == NULL)) ||
-			 ((has_attrib_value != NULL) && (attrib_value != NULL) &&
-			  (strcmp(attrib_value, has_attrib_value) == 0)) ) {
-		      g_free (attrib_value);
-		      attrib_value =
-		        o_attrib_search_object_attribs_by_name (nl_current->object_ptr,
-		                                                wanted_attrib, 0);
-		      if (attrib_value) {
-			list = scm_cons (scm_from_utf8_string (attrib_value), list);
-		      }
-		      g_free (attrib_value);
-		    }
-		    g_free (has_attrib_name);
-		    g_free (has_attrib_value);
-		  }
-		}
+    /* go through the graphical components connected to the net, once
+     * for each of their pins on it */
+    graphical = s_netindex_get_graphical (wanted_net_name);
+    for (i = 0; graphical != NULL && i < graphical->len; i++) {
+	nl_current = g_ptr_array_index (graphical, i);
+
+	if (o_attrib_string_get_name_value (has_attrib, &has_attrib_name,
+	                                    &has_attrib_value) != 0) {
+	    attrib_value =
+	      o_attrib_search_object_attribs_by_name (nl_current->object_ptr,
+	                                              has_attrib_name, 0);
+
+	    if ( ((has_attrib_value == NULL) && (attrib_value == NULL)) ||
+		 ((has_attrib_value != NULL) && (attrib_value != NULL) &&
+		  (strcmp(attrib_value, has_attrib_value) == 0)) ) {
+	      g_free (attrib_value);
+	      attrib_value =
+	        o_attrib_search_object_attribs_by_name (nl_current->object_ptr,
+	                                                wanted_attrib, 0);
+	      if (attrib_value) {
+		list = scm_cons (scm_from_utf8_string (attrib_value), list);
+	      }
+	      g_free (attrib_value);
 	    }
-	    pl_current = pl_current->next;
+	    g_free (has_attrib_name);
+	    g_free (has_attrib_value);
 	}
-	nl_current = nl_current->next;
     }
 
     scm_dynwind_end ();
@@ -49,6 +49,7 @@ void gnetlist_quit(void)
     s_clib_free();
     s_slib_free();
     s_rename_destroy_all();
+    s_netindex_free();
     /* o_text_freeallfonts(); */
 
     /* Free GSList *backend_params */
@@ -0,0 +1,342 @@
+/* gEDA - GPL Electronic Design Automation
+ * gnetlist - gEDA Netlist
+ * Copyright (C) 1998-2010 Ales Hvezda
+ * Copyright (C) 1998-2020 gEDA Contributors (see ChangeLog for details)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*! \file s_netindex.c
+ *  \brief Lookup tables for the gnetlist Scheme API
+ *
+ *  The gnetlist: primitives in g_netlist.c are called by the backends
+ *  once per package, pin, or net.  Scanning the whole netlist for each
+ *  call makes netlisting large designs quadratic, so the netlist is
+ *  indexed once after it has been built and post-processed, and the
+ *  primitives only look up the entries they need.
+ *
+ *  All lists in the index keep the order in which the entries appear
+ *  in the netlist, so the primitives return their results in the same
+ *  order as a linear scan would.  The index refers to the strings and
+ *  structures of the netlist, which must not change once the index
+ *  has been built.
+ */
+
+#include <config.h>
+
+#include <stdio.h>
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include <libgeda/libgeda.h>
+
+#include "../include/globals.h"
+#include "../include/prototype.h"
+
+/*! All instances and pins of one package */
+typedef struct {
+  GPtrArray *instances;         /* NETLIST * with this refdes */
+  GHashTable *pins;             /* pin number -> GPtrArray of CPINLIST * */
+} PACKAGE_INDEX;
+
+/*! All pins connected to one net */
+typedef struct {
+  GPtrArray *connections;       /* unique (refdes, pin) string pairs */
+  GHashTable *seen;             /* "refdes pin" -> itself */
+  GPtrArray *graphical;         /* NETLIST * of the graphical netlist */
+} NET_INDEX;
+
+static GPtrArray *package_names = NULL;
+static GPtrArray *net_names = NULL;
+static GHashTable *packages = NULL;
+static GHashTable *nets = NULL;
+static GStringChunk *strings = NULL;
+
+static void
+free_ptr_array (GPtrArray *array)
+{
+  g_ptr_array_free (array, TRUE);
+}
+
+static void
+free_package_index (PACKAGE_INDEX *package)
+{
+  g_ptr_array_free (package->instances, TRUE);
+  g_hash_table_destroy (package->pins);
+  g_free (package);
+}
+
+static void
+free_net_index (NET_INDEX *net)
+{
+  g_ptr_array_free (net->connections, TRUE);
+  g_hash_table_destroy (net->seen);
+  g_ptr_array_free (net->graphical, TRUE);
+  g_free (net);
+}
+
+/*! \brief Get the index entry of a net, creating it if necessary */
+static NET_INDEX *
+lookup_net (char *net_name)
+{
+  NET_INDEX *net = g_hash_table_lookup (nets, net_name);
+
+  if (net == NULL) {
+    net = g_new (NET_INDEX, 1);
+    net->connections = g_ptr_array_new ();
+    net->seen = g_hash_table_new (g_str_hash, g_str_equal);
+    net->graphical = g_ptr_array_new ();
+    g_hash_table_insert (nets, net_name, net);
+  }
+
+  return net;
+}
+
+/*! \brief Add the pin a net is connected to to the index of the net
+ *  \par Function Description
+ *  Splits the "refdes pin" string in \a connected_to into its two
+ *  words and adds them to the connections of \a net unless the same
+ *  pair is already there.
+ */
+static void
+add_connection (NET_INDEX *net, const char *connected_to)
+{
+  const char *uref, *uref_end, *pin, *pin_end;
+  char *key;
+
+  for (uref = connected_to; g_ascii_isspace (*uref); uref++);
+  for (uref_end = uref; *uref_end != '\0' && !g_ascii_isspace (*uref_end);
+       uref_end++);
+  for (pin = uref_end; g_ascii_isspace (*pin); pin++);
+  for (pin_end = pin; *pin_end != '\0' && !g_ascii_isspace (*pin_end);
+       pin_end++);
+
+  key = g_strdup_printf ("%.*s %.*s", (int) (uref_end - uref), uref,
+                         (int) (pin_end - pin), pin);
+
+  if (g_hash_table_lookup (net->seen, key) == NULL) {
+    char *entry = g_string_chunk_insert (strings, key);
+
+    g_hash_table_insert (net->seen, entry, entry);
+    g_ptr_array_add (net->connections,
+                     g_string_chunk_insert_len (strings, uref,
+                                                uref_end - uref));
+    g_ptr_array_add (net->connections,
+                     g_string_chunk_insert_len (strings, pin,
+                                                pin_end - pin));
+  }
+
+  g_free (key);
+}
+
+/*! \brief Discard the netlist index
+ *  \par Function Description
+ *  Frees all memory used by the index.  Until s_netindex_build() is
+ *  called again, all lookups return \b NULL.
+ */
+void
+s_netindex_free (void)
+{
+  if (packages != NULL) {
+    g_hash_table_destroy (packages);
+    g_hash_table_destroy (nets);
+    g_ptr_array_free (package_names, TRUE);
+    g_ptr_array_free (net_names, TRUE);
+    g_string_chunk_free (strings);
+    packages = NULL;
+    nets = NULL;
+    package_names = NULL;
+    net_names = NULL;
+    strings = NULL;
+  }
+}
+
+/*! \brief Build the netlist index
+ *  \par Function Description
+ *  Indexes the components, pins, and nets of the netlists starting at
+ *  \a netlist_head and \a graphical_netlist_head.  This must be done
+ *  after the netlist has been post-processed and the graphical
+ *  netlist has been named, and before any of the gnetlist: primitives
+ *  are called.
+ */
+void
+s_netindex_build (void)
+{
+  NETLIST *nl_current;
+  CPINLIST *pl_current;
+  NET *n_current;
+  PACKAGE_INDEX *package;
+  NET_INDEX *net;
+  GPtrArray *pins;
+
+  s_netindex_free ();
+
+  packages = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                    (GDestroyNotify) free_package_index);
+  nets = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                (GDestroyNotify) free_net_index);
+  package_names = g_ptr_array_new ();
+  net_names = g_ptr_array_new ();
+  strings = g_string_chunk_new (4096);
+
+  for (nl_current = netlist_head; nl_current != NULL;
+       nl_current = nl_current->next) {
+
+    if (nl_current->component_uref != NULL) {
+      package = g_hash_table_lookup (packages, nl_current->component_uref);
+
+      if (package == NULL) {
+        package = g_new (PACKAGE_INDEX, 1);
+        package->instances = g_ptr_array_new ();
+        package->pins = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                               (GDestroyNotify) free_ptr_array);
+        g_hash_table_insert (packages, nl_current->component_uref, package);
+        g_ptr_array_add (package_names, nl_current->component_uref);
+      }
+
+      g_ptr_array_add (package->instances, nl_current);
+
+      for (pl_current = nl_current->cpins; pl_current != NULL;
+           pl_current = pl_current->next) {
+        if (pl_current->pin_number == NULL) continue;
+
+        pins = g_hash_table_lookup (package->pins, pl_current->pin_number);
+        if (pins == NULL) {
+          pins = g_ptr_array_new ();
+          g_hash_table_insert (package->pins, pl_current->pin_number, pins);
+        }
+        g_ptr_array_add (pins, pl_current);
+      }
+    }
+
+    for (pl_current = nl_current->cpins; pl_current != NULL;
+         pl_current = pl_current->next) {
+      if (pl_current->net_name == NULL) continue;
+
+      if (g_hash_table_lookup (nets, pl_current->net_name) == NULL
+          && strncmp (pl_current->net_name, "unconnected_pin", 15) != 0) {
+        g_ptr_array_add (net_names, pl_current->net_name);
+      }
+
+      net = lookup_net (pl_current->net_name);
+
+      for (n_current = pl_current->nets; n_current != NULL;
+           n_current = n_current->next) {
+        if (n_current->connected_to != NULL) {
+          add_connection (net, n_current->connected_to);
+        }
+      }
+    }
+  }
+
+  for (nl_current = graphical_netlist_head; nl_current != NULL;
+       nl_current = nl_current->next) {
+    for (pl_current = nl_current->cpins; pl_current != NULL;
+         pl_current = pl_current->next) {
+      if (pl_current->net_name == NULL) continue;
+
+      net = lookup_net (pl_current->net_name);
+      g_ptr_array_add (net->graphical, nl_current);
+    }
+  }
+}
+
+/*! \brief Get the refdes of all packages
+ *  \return An array of the distinct refdes strings in the order of
+ *          their first instance, or \b NULL if there is no index.
+ */
+GPtrArray *
+s_netindex_get_packages (void)
+{
+  return package_names;
+}
+
+/*! \brief Get the names of all connected nets
+ *  \return An array of the distinct net names in the order in which
+ *          they are first found, excluding unconnected pins, or \b NULL
+ *          if there is no index.
+ */
+GPtrArray *
+s_netindex_get_nets (void)
+{
+  return net_names;
+}
+
+/*! \brief Get all instances of a package
+ *  \param uref  The refdes of the package.
+ *  \return An array of the NETLIST entries with this refdes, or \b NULL
+ *          if there are none.
+ */
+GPtrArray *
+s_netindex_get_instances (const char *uref)
+{
+  PACKAGE_INDEX *package;
+
+  if (packages == NULL) return NULL;
+
+  package = g_hash_table_lookup (packages, uref);
+  return package != NULL ? package->instances : NULL;
+}
+
+/*! \brief Get a pin of a package
+ *  \param uref  The refdes of the package.
+ *  \param pin   The pin number.
+ *  \return An array of the CPINLIST entries with this pin number in all
+ *          instances of the package, or \b NULL if there are none.
+ */
+GPtrArray *
+s_netindex_get_pins (const char *uref, const char *pin)
+{
+  PACKAGE_INDEX *package;
+
+  if (packages == NULL) return NULL;
+
+  package = g_hash_table_lookup (packages, uref);
+  return package != NULL ? g_hash_table_lookup (package->pins, pin) : NULL;
+}
+
+/*! \brief Get all pins connected to a net
+ *  \param net_name  The name of the net.
+ *  \return An array of alternating refdes and pin number strings, each
+ *          pair appearing once, or \b NULL if there is no such net.
+ */
+GPtrArray *
+s_netindex_get_connections (const char *net_name)
+{
+  NET_INDEX *net;
+
+  if (nets == NULL) return NULL;
+
+  net = g_hash_table_lookup (nets, net_name);
+  return net != NULL ? net->connections : NULL;
+}
+
+/*! \brief Get the graphical components connected to a net
+ *  \param net_name  The name of the net.
+ *  \return An array of the graphical NETLIST entries, one for each of
+ *          their pins connected to the net, or \b NULL if there is no
+ *          such net.
+ */
+GPtrArray *
+s_netindex_get_graphical (const char *net_name)
+{
+  NET_INDEX *net;
+
+  if (nets == NULL) return NULL;
+
+  net = g_hash_table_lookup (nets, net_name);
+  return net != NULL ? net->graphical : NULL;
+}
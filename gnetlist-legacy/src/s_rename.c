@@ -44,20 +44,33 @@
 #include "../include/prototype.h"
 #include "../include/gettext.h"
 
+/* A rename set is an ordered list of renames which are applied to the
+ * netlist one after the other by s_rename_all().  Renames are looked
+ * up by their source name through the by_src table, which maps each
+ * name to the renames of the set having it as source, in order.
+ *
+ * All names are interned in rename_names, which lives until
+ * s_rename_destroy_all() is called.  Renamed pins point to these
+ * strings as well, since the names they had before may be shared
+ * with other parts of the netlist and can't be freed. */
+
 typedef struct {
-    void * next;
     char * src;
     char * dest;
+    guint index;              /* position in the set */
 } RENAME;
 
-typedef struct {
-    void * next_set;
-    RENAME * first_rename;
-    RENAME * last_rename;
-} SET;
+typedef struct st_set SET;
+
+struct st_set {
+    SET * next_set;
+    GPtrArray * renames;      /* RENAME * in the order they were added */
+    GHashTable * by_src;      /* source name -> GPtrArray of RENAME * */
+};
 
 static SET * first_set = NULL;
 static SET * last_set = NULL;
+static GStringChunk * rename_names = NULL;
 
 void s_rename_init(void)
 {
@@ -70,32 +83,39 @@ void s_rename_init(void)
 
 void s_rename_destroy_all(void)
 {
-    RENAME * temp;
-    void * to_free;
+    SET * to_free;
 
     for (; first_set;)
     {
-        for (temp = first_set->first_rename; temp;)
-        {
-            g_free(temp->src);
-            g_free(temp->dest);
-	    to_free = temp;
-	    temp = temp->next;
-	    g_free(to_free);
-        }
+        g_ptr_array_free(first_set->renames, TRUE);
+        g_hash_table_destroy(first_set->by_src);
 	to_free = first_set;
 	first_set = first_set->next_set;
 	g_free(to_free);
     }
     last_set = NULL;
+
+    if (rename_names)
+    {
+        g_string_chunk_free(rename_names);
+        rename_names = NULL;
+    }
+}
+
+static void s_rename_free_list (GPtrArray *list)
+{
+    g_ptr_array_free(list, TRUE);
 }
 
 void s_rename_next_set(void)
 {
     SET * new_set;
 
-    new_set = g_malloc(sizeof(SET));
-    memset(new_set,0,sizeof(SET));
+    new_set = g_new0(SET, 1);
+    new_set->renames = g_ptr_array_new_with_free_func(g_free);
+    new_set->by_src = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                            (GDestroyNotify) s_rename_free_list);
+
     if (first_set)
     {
         last_set->next_set = new_set;
@@ -111,44 +131,63 @@ void s_rename_print(void)
 {
     SET * temp_set;
     RENAME * temp_rename;
+    guint j;
     int i;
 
     for (i = 0, temp_set = first_set; temp_set; temp_set = temp_set->next_set, i++)
     {
-        for (temp_rename = temp_set->first_rename; temp_rename; temp_rename = temp_rename->next)
+        for (j = 0; j < temp_set->renames->len; j++)
         {
+            temp_rename = g_ptr_array_index(temp_set->renames, j);
             printf("%d) Source: _%s_", i, temp_rename->src);
             printf(" -> Dest: _%s_\n", temp_rename->dest);
         }
     }
 }
 
+/* returns the renames of the current set which have name as source */
+static GPtrArray *s_rename_lookup (const char *name)
+{
+    return g_hash_table_lookup(last_set->by_src, name);
+}
+
 /* if the src is found, return true */
 /* if the dest is found, also return true, but warn user */
 /* If quiet_flag is true than don't print anything */
 int s_rename_search(char *src, char *dest, int quiet_flag)
 {
+    GPtrArray * src_renames;
+    GPtrArray * dest_renames;
     RENAME * temp;
 
     if (last_set)
     {
-        for (temp = last_set->first_rename; temp; temp = temp->next)
+        src_renames = s_rename_lookup(src);
+        dest_renames = s_rename_lookup(dest);
+
+        /* whichever of the two names was used as a source first decides */
+        if (src_renames != NULL)
         {
-            if (strcmp(src, temp->src) == 0)
+            temp = g_ptr_array_index(src_renames, 0);
+
+            if (dest_renames == NULL
+                || temp->index <= ((RENAME *) g_ptr_array_index(dest_renames, 0))->index)
             {
                 return (TRUE);
             }
+        }
+
+        if (dest_renames != NULL)
+	{
+            temp = g_ptr_array_index(dest_renames, 0);
 
-            if (strcmp(dest, temp->src) == 0)
+            if (!quiet_flag)
 	    {
-                if (!quiet_flag)
-	        {
-                    fprintf(stderr, _("WARNING: Trying to rename something twice:\n\t%s and %s\nare both a src and dest name\n"), dest, temp->src);
-                    fprintf(stderr, _("This warning is okay if you have multiple levels of hierarchy!\n"));
-                }
-                return (TRUE);
+                fprintf(stderr, _("WARNING: Trying to rename something twice:\n\t%s and %s\nare both a src and dest name\n"), dest, temp->src);
+                fprintf(stderr, _("This warning is okay if you have multiple levels of hierarchy!\n"));
             }
-	}
+            return (TRUE);
+        }
     }
     return (FALSE);
 }
@@ -156,35 +195,40 @@ int s_rename_search(char *src, char *dest, int quiet_flag)
 static void s_rename_add_lowlevel (const char *src, const char *dest)
 {
     RENAME *new_rename;
+    GPtrArray *list;
 
     g_return_if_fail(last_set != NULL);
 
-    new_rename = g_malloc(sizeof (RENAME));
-
-    g_return_if_fail(new_rename != NULL);
-
-    new_rename->next = NULL;
-    new_rename->src = g_strdup(src);
-    new_rename->dest = g_strdup(dest);
-
-    if (last_set->first_rename == NULL)
+    if (rename_names == NULL)
     {
-        last_set->first_rename = last_set->last_rename = new_rename;
+        rename_names = g_string_chunk_new(4096);
     }
-    else
+
+    new_rename = g_new(RENAME, 1);
+    new_rename->src = g_string_chunk_insert_const(rename_names, src);
+    new_rename->dest = g_string_chunk_insert_const(rename_names, dest);
+    new_rename->index = last_set->renames->len;
+    g_ptr_array_add(last_set->renames, new_rename);
+
+    list = s_rename_lookup(new_rename->src);
+    if (list == NULL)
     {
-        last_set->last_rename->next = new_rename;
-        last_set->last_rename = new_rename;
+        list = g_ptr_array_new();
+        g_hash_table_insert(last_set->by_src, new_rename->src, list);
     }
+    g_ptr_array_add(list, new_rename);
 }
 
 void s_rename_add(char *src, char *dest)
 {
     int flag;
-    RENAME * last;
+    guint count;
+    guint i, j;
+    GPtrArray * src_renames;
+    GPtrArray * dest_renames;
     RENAME * temp;
-    RENAME * new_rename;
-    SET * new_set;
+    RENAME * next_src;
+    RENAME * next_dest;
 
     if (src == NULL || dest == NULL)
     {
@@ -195,42 +239,71 @@ void s_rename_add(char *src, char *dest)
 
     if (flag)
     {
-        /* If found follow the original behaviour, limiting the operation to the current end-of-list */
-	last = last_set->last_rename;
-	for (temp = last_set->first_rename; ; temp = temp->next)
-	{
-        if ((strcmp(dest, temp->src) == 0)
-            && (strcmp(src, temp->dest) != 0))
+        /* If found follow the original behaviour, limiting the operation
+         * to the current end-of-list.  Only renames having either src
+         * or dest as source can match, so merge these two lists in the
+         * order the renames were added. */
+        count = last_set->renames->len;
+        src_renames = s_rename_lookup(src);
+        dest_renames = s_rename_lookup(dest);
+        i = j = 0;
+
+        for (;;)
         {
-            /* we found a -> b, while adding c -> a.
-             * hence we would have c -> a -> b, so add c -> b.
-             * avoid renaming if b is same as c!
-             */
+            next_dest = (dest_renames != NULL && i < dest_renames->len)
+                        ? g_ptr_array_index(dest_renames, i) : NULL;
+            next_src = (src_renames != NULL && j < src_renames->len)
+                       ? g_ptr_array_index(src_renames, j) : NULL;
+
+            if (next_dest != NULL
+                && (next_src == NULL || next_dest->index <= next_src->index))
+            {
+                temp = next_dest;
+                i++;
+                if (next_src == next_dest)
+                {
+                    j++;
+                }
+            }
+            else
+            {
+                temp = next_src;
+                j++;
+            }
+
+            if (temp == NULL || temp->index >= count)
+            {
+                break;
+            }
+
+            if ((strcmp(dest, temp->src) == 0)
+                && (strcmp(src, temp->dest) != 0))
+            {
+                /* we found a -> b, while adding c -> a.
+                 * hence we would have c -> a -> b, so add c -> b.
+                 * avoid renaming if b is same as c!
+                 */
 #if DEBUG
-            printf("Found dest [%s] in src [%s] and that had a dest as: [%s]\n"
-                   "So you want rename [%s] to [%s]\n",
-                   dest, temp->src, temp->dest, src, temp->dest);
+                printf("Found dest [%s] in src [%s] and that had a dest as: [%s]\n"
+                       "So you want rename [%s] to [%s]\n",
+                       dest, temp->src, temp->dest, src, temp->dest);
 #endif
-            s_rename_add_lowlevel(src, temp->dest);
+                s_rename_add_lowlevel(src, temp->dest);
 
-        }
-        else if ((strcmp(src, temp->src) == 0)
-                 && (strcmp(dest, temp->dest) != 0))
-        {
-            /* we found a -> b, while adding a -> c.
-             * hence b <==> c, so add c -> b.
-             * avoid renaming if b is same as c!
-             */
+            }
+            else if ((strcmp(src, temp->src) == 0)
+                     && (strcmp(dest, temp->dest) != 0))
+            {
+                /* we found a -> b, while adding a -> c.
+                 * hence b <==> c, so add c -> b.
+                 * avoid renaming if b is same as c!
+                 */
 #if DEBUG
-            printf("Found src [%s] that had a dest as: [%s]\n"
-                   "Unify nets by renaming [%s] to [%s]\n",
-                   src, temp->dest, dest, temp->dest);
+                printf("Found src [%s] that had a dest as: [%s]\n"
+                       "Unify nets by renaming [%s] to [%s]\n",
+                       src, temp->dest, dest, temp->dest);
 #endif
-            s_rename_add_lowlevel(dest, temp->dest);
-        }
-            if (temp == last)
-            {
-                break;
+                s_rename_add_lowlevel(dest, temp->dest);
             }
         }
     }
@@ -239,70 +312,68 @@ void s_rename_add(char *src, char *dest)
         /* Check for a valid set */
 	if (first_set == NULL)
 	{
-	    new_set = g_malloc(sizeof(SET));
-	        memset(new_set,0,sizeof(SET));
-		first_set = last_set = new_set;
+	    s_rename_next_set();
 	}
-        new_rename = g_malloc(sizeof(RENAME));
-	     new_rename->next = NULL;
-             new_rename->src = g_strdup(src);
-             new_rename->dest = g_strdup(dest);
-	     if (last_set->first_rename == NULL)
-	     {
-	         last_set->first_rename = last_set->last_rename = new_rename;
-	     }
-	     else
-	     {
-	         last_set->last_rename->next = new_rename;
-		 last_set->last_rename = new_rename;
-	     }
-    }
-}
-
-void s_rename_all_lowlevel(NETLIST * netlist_head, char *src, char *dest)
-{
-    NETLIST *nl_current = NULL;
-    CPINLIST *pl_current;
-
-    nl_current = netlist_head;
-
-    while (nl_current != NULL)
-    {
-        if (nl_current->cpins)
-	{
-            pl_current = nl_current->cpins;
-            while (pl_current != NULL)
-	    {
-                if (pl_current->net_name != NULL)
-		{
-                    if (strcmp(pl_current->net_name, src) == 0)
-		    {
-                        pl_current->net_name = g_strdup(dest);
-                    }
-                }
-                pl_current = pl_current->next;
-            }
-        }
-        nl_current = nl_current->next;
+	s_rename_add_lowlevel(src, dest);
     }
 }
 
+/* Applies the renames of the current set to all pins of the netlist.
+ *
+ * Applying the renames one after the other means that a name follows
+ * the chain of renames which starts with the first rename having it
+ * as source, and continues with each later rename whose source is
+ * the name reached so far.  Walking the set backwards, the final name
+ * for each source is therefore known once all later renames have been
+ * seen, so every pin only needs to be looked up once. */
 void s_rename_all(TOPLEVEL * pr_current, NETLIST * netlist_head)
 {
+    GHashTable * final_names;
+    NETLIST * nl_current;
+    CPINLIST * pl_current;
     RENAME * temp;
+    char * dest;
+    guint i;
 
 #if DEBUG
     s_rename_print();
 #endif
 
-    if (last_set)
+    if (last_set == NULL || last_set->renames->len == 0)
+    {
+        return;
+    }
+
+    final_names = g_hash_table_new(g_str_hash, g_str_equal);
+
+    for (i = last_set->renames->len; i-- > 0;)
     {
-        for (temp = last_set->first_rename; temp; temp = temp->next)
+        verbose_print("R");
+        temp = g_ptr_array_index(last_set->renames, i);
+
+        dest = g_hash_table_lookup(final_names, temp->dest);
+        g_hash_table_insert(final_names, temp->src,
+                            dest != NULL ? dest : temp->dest);
+    }
+
+    for (nl_current = netlist_head; nl_current != NULL;
+         nl_current = nl_current->next)
+    {
+        for (pl_current = nl_current->cpins; pl_current != NULL;
+             pl_current = pl_current->next)
         {
-            verbose_print("R");
-            s_rename_all_lowlevel(netlist_head, temp->src, temp->dest);
-	}
+            if (pl_current->net_name != NULL)
+            {
+                dest = g_hash_table_lookup(final_names, pl_current->net_name);
+                if (dest != NULL)
+                {
+                    pl_current->net_name = dest;
+                }
+            }
+        }
     }
+
+    g_hash_table_destroy(final_names);
 }
 
 
@@ -313,13 +384,15 @@ SCM g_get_renamed_nets(SCM scm_level)
     SET * temp_set;
     RENAME * temp_rename;
     char *level;
+    guint i;
 
     level = scm_to_utf8_string (scm_level);
 
     for (temp_set = first_set; temp_set; temp_set = temp_set->next_set)
     {
-        for (temp_rename = temp_set->first_rename; temp_rename; temp_rename = temp_rename->next)
+        for (i = 0; i < temp_set->renames->len; i++)
         {
+            temp_rename = g_ptr_array_index(temp_set->renames, i);
             pairlist = scm_list_n (scm_from_utf8_string (temp_rename->src),
                                    scm_from_utf8_string (temp_rename->dest),
                                    SCM_UNDEFINED);
@@ -39,6 +39,15 @@
  */
 static GHashTable *visit_table = NULL;
 
+/*! The last known entries of #netlist_head and #graphical_netlist_head.
+ *
+ * Components are appended to the netlists while the sheets are being
+ * traversed.  Searching for the end of a list from here instead of
+ * from its head only walks over the entries added since.
+ */
+static NETLIST *netlist_tail = NULL;
+static NETLIST *graphical_netlist_tail = NULL;
+
 /*! Trivial function used when clearing #visit_table. */
 static gboolean
 returns_true (gpointer key, gpointer value, gpointer user_data)
@@ -85,6 +94,9 @@ void s_traverse_init(void)
     graphical_netlist_head = s_netlist_add(NULL);
     graphical_netlist_head->nlid = -1;	/* head node */
 
+    netlist_tail = netlist_head;
+    graphical_netlist_tail = graphical_netlist_head;
+
     if (verbose_mode) {
 	printf
 	    ("\n\n------------------------------------------------------\n");
@@ -137,6 +149,9 @@ void s_traverse_start(TOPLEVEL * pr_current)
   s_netlist_name_named_nets(pr_current, netlist_head,
                             graphical_netlist_head);
 
+  /* The netlist is complete; index it for the Scheme API */
+  s_netindex_build();
+
   if (verbose_mode) {
     printf("\nInternal netlist representation:\n\n");
     s_netlist_print(netlist_head);
@@ -160,8 +175,6 @@ s_traverse_sheet (TOPLEVEL * pr_current, const GList *obj_list, char *hierarchy_
   for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
     OBJECT *o_current = iter->data;
 
-    netlist = s_netlist_return_tail(netlist_head);
-
     if (o_current->type == OBJ_PLACEHOLDER) {
       printf(_("WARNING: Found a placeholder/missing component, are you missing a symbol file? [%s]\n"), o_current->complex_basename);
     }
@@ -175,19 +188,31 @@ s_traverse_sheet (TOPLEVEL * pr_current, const GList *obj_list, char *hierarchy_
 
       verbose_print(" C");
 
+      netlist_tail = s_netlist_return_tail(netlist_tail);
+      netlist = netlist_tail;
+
       /* look for special tag */
       temp = o_attrib_search_object_attribs_by_name (o_current, "graphical", 0);
       if (g_strcmp0 (temp, "1") == 0) {
         /* traverse graphical elements, but adding them to the
 	   graphical netlist */
 
-	netlist = s_netlist_return_tail(graphical_netlist_head);
+	graphical_netlist_tail =
+	  s_netlist_return_tail(graphical_netlist_tail);
+	netlist = graphical_netlist_tail;
 	is_graphical = TRUE;
 
 
       }
       g_free (temp);
       netlist = s_netlist_add(netlist);
+
+      if (is_graphical) {
+	graphical_netlist_tail = netlist;
+      } else {
+	netlist_tail = netlist;
+      }
+
       netlist->nlid = o_current->sid;
 
       scm_uref = g_scm_c_get_uref (o_current);
@@ -66,6 +66,7 @@ vams_get_attribs_list (OBJECT *object)
 SCM
 vams_get_package_attributes(SCM scm_uref)
 {
+  GPtrArray *instances;
   NETLIST *nl_current;
   char *uref;
 
@@ -74,21 +75,14 @@ vams_get_package_attributes(SCM scm_uref)
 
   uref = scm_to_utf8_string (scm_uref);
 
-  /* here is where you make it multi page aware */
-  nl_current = netlist_head;
-
-  /* search for the first instance */
-  /* through the entire list */
-  while(nl_current != NULL) {
+  /* use the first instance */
+  instances = s_netindex_get_instances (uref);
+  free (uref);
 
-    if (nl_current->component_uref &&
-        strcmp(nl_current->component_uref, uref) == 0) {
-      free (uref);
-      return vams_get_attribs_list (nl_current->object_ptr);
-    }
-    nl_current = nl_current->next;
+  if (instances == NULL) {
+    return SCM_EOL;
   }
 
-  free (uref);
-  return SCM_EOL;
+  nl_current = g_ptr_array_index (instances, 0);
+  return vams_get_attribs_list (nl_current->object_ptr);
 }
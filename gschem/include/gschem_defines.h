@@ -64,6 +64,7 @@
 /* used for undo_type */
 #define UNDO_DISK		0
 #define UNDO_MEMORY		1
+#define UNDO_DELTA		2
 
 /* selection types */
 /* used in o_select_object */
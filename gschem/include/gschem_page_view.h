@@ -56,6 +56,12 @@ struct _GschemPageView
   int throttle;
 
   PAGE *page;
+
+  /* cache of rendered page content, see gschem_page_view_redraw */
+  GHashTable *tiles;
+  PAGE *tiles_page;
+  double tiles_scale_x;
+  double tiles_scale_y;
 };
 
 
@@ -84,6 +90,9 @@ gschem_page_view_invalidate_object (GschemPageView *view, OBJECT *object);
 void
 gschem_page_view_invalidate_screen_rect (GschemPageView *view, int left, int top, int right, int bottom);
 
+void
+gschem_page_view_invalidate_world_content (GschemPageView *view, int left, int top, int right, int bottom);
+
 void
 gschem_page_view_invalidate_world_rect (GschemPageView *view, int left, int top, int right, int bottom);
 
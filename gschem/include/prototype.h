@@ -146,6 +146,8 @@ void o_attrib_toggle_visibility(GschemToplevel *w_current, OBJECT *object);
 void o_attrib_toggle_show_name_value(GschemToplevel *w_current, OBJECT *object, int new_show_name_value);
 OBJECT *o_attrib_add_attrib(GschemToplevel *w_current, const char *text_string, int visibility, int show_name_value, OBJECT *object);
 /* o_basic.c */
+void o_redraw_static (GschemToplevel *w_current, cairo_t *cr, PAGE *page, GschemPageGeometry *geometry, GdkRectangle *rectangle);
+void o_redraw_overlay (GschemToplevel *w_current, cairo_t *cr, PAGE *page, GschemPageGeometry *geometry, GdkRectangle *rectangle);
 void o_redraw_rect (GschemToplevel *w_current, GdkDrawable *drawable, PAGE *page, GschemPageGeometry *geometry, GdkRectangle *rectangle);
 int o_invalidate_rubber(GschemToplevel *w_current);
 int o_redraw_cleanstates(GschemToplevel *w_current);
@@ -320,6 +322,7 @@ char *o_undo_find_prev_filename(UNDO *start);
 GList *o_undo_find_prev_object_head(UNDO *start);
 void o_undo_callback(GschemToplevel *w_current, PAGE *page, int type);
 void o_undo_update_actions(GschemToplevel *w_current, PAGE *page);
+void o_undo_notify(GschemToplevel *w_current, OBJECT *object);
 void o_undo_cleanup(void);
 /* parsecmd.c */
 int parse_commandline(int argc, char *argv[]);
@@ -413,6 +416,7 @@ void x_fstylecb_set_index (GtkWidget *widget, int style);
 /* x_grid.c */
 void x_grid_draw_region(GschemToplevel *w_current, cairo_t *cr, int x, int y, int width, int height);
 int x_grid_query_drawn_spacing(GschemToplevel *w_current);
+void x_grid_free (void);
 /* x_grid_size_sb.c */
 GtkWidget *x_grid_size_sb_new (GschemToplevel *w_current);
 /* x_hierarchy.c */
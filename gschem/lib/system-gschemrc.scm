@@ -84,9 +84,12 @@
 ; to disk).  The other mechanism uses only memory.  The disk mechanism is
 ; nice because you get undo-level number of backups of the schematic written
 ; to disk as backups so you should never lose a schematic due to a crash.
+; The delta mechanism also uses memory, but only stores the objects which
+; have been changed by each action, so it stays fast on large schematics.
 ;
 (undo-type "disk")
 ;(undo-type "memory")
+;(undo-type "delta")
 
 ; undo-panzoom string
 ;
@@ -1087,9 +1087,7 @@ DEFINE_ACTION (attributes_detach,
     OBJECT *obj = (OBJECT *) l->data;
 
     if (obj->type == OBJ_TEXT && obj->attached_to != NULL) {
-      obj->attached_to->attribs =
-        g_list_remove (obj->attached_to->attribs, obj);
-      obj->attached_to = NULL;
+      o_attrib_remove (toplevel, &obj->attached_to->attribs, obj);
       o_set_color (toplevel, obj, DETACHED_ATTRIBUTE_COLOR);
       detached_attribs = g_list_prepend (detached_attribs, obj);
     }
@@ -1478,7 +1476,9 @@ DEFINE_ACTION (edit_lock,
       continue;
     }
 
+    o_emit_pre_change_notify (toplevel, object);
     object->selectable = FALSE;
+    o_emit_change_notify (toplevel, object);
 
     /* apply "locked" color to attached attributes */
     for (GList *la = object->attribs; la != NULL; la = la->next) {
@@ -1486,8 +1486,10 @@ DEFINE_ACTION (edit_lock,
       if (attrib->color == LOCK_COLOR)
         continue;
 
+      o_emit_pre_change_notify (toplevel, attrib);
       attrib->locked_color = attrib->color;
       attrib->color = LOCK_COLOR;
+      o_emit_change_notify (toplevel, attrib);
     }
 
     changed = TRUE;
@@ -1545,7 +1547,9 @@ DEFINE_ACTION (edit_unlock,
       continue;
     }
 
+    o_emit_pre_change_notify (toplevel, object);
     object->selectable = TRUE;
+    o_emit_change_notify (toplevel, object);
 
     /* restore color of attached attributes */
     for (GList *la = object->attribs; la != NULL; la = la->next) {
@@ -1553,12 +1557,14 @@ DEFINE_ACTION (edit_unlock,
       if (attrib->color != LOCK_COLOR)
         continue;
 
+      o_emit_pre_change_notify (toplevel, attrib);
       if (attrib->locked_color == -1)
         attrib->color = ATTRIBUTE_COLOR;
       else {
         attrib->color = attrib->locked_color;
         attrib->locked_color = -1;
       }
+      o_emit_change_notify (toplevel, attrib);
     }
 
     changed = TRUE;
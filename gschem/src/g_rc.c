@@ -641,11 +641,12 @@ SCM g_rc_undo_type(SCM mode)
   static const vstbl_entry mode_table[] = {
     {UNDO_DISK  , "disk"   },
     {UNDO_MEMORY, "memory" },
+    {UNDO_DELTA , "delta"  },
   };
 
   RETURN_G_RC_MODE("undo-type",
 		   default_undo_type,
-		   2);
+		   3);
 }
 
 /*! \todo Finish function documentation!!!
@@ -96,6 +96,7 @@ static void gschem_quit(void)
   s_attrib_free();
   x_fam_free ();
   x_stroke_free ();
+  x_grid_free ();
   o_undo_cleanup();
   /* s_stroke_free(); no longer needed */
 
@@ -44,6 +44,9 @@
 
 #define INVALIDATE_MARGIN 1
 
+/* edge length of the tiles in which the page content is cached, in pixels */
+#define TILE_SIZE 256
+
 
 
 enum
@@ -58,6 +61,21 @@ enum
 
 typedef void (*NotifyFunction) (void*,void*);
 
+typedef struct _GschemPageViewTile GschemPageViewTile;
+
+/*! \brief A rendered part of the page content
+ *
+ *  Tile (x, y) covers the pixels from (x * TILE_SIZE, y * TILE_SIZE)
+ *  to ((x + 1) * TILE_SIZE, (y + 1) * TILE_SIZE) of the page at the
+ *  current zoom level, counted from the world origin.
+ */
+struct _GschemPageViewTile
+{
+  gint64 key;
+  cairo_surface_t *surface;
+  gboolean draft;         /* rendered with outlines during a fast pan */
+};
+
 static void
 dispose (GObject *object);
 
@@ -79,6 +97,12 @@ gschem_page_view_update_hadjustment (GschemPageView *view);
 static void
 gschem_page_view_update_vadjustment (GschemPageView *view);
 
+static void
+gschem_page_view_flush_tiles (GschemPageView *view);
+
+static void
+gschem_page_view_invalidate_window (GschemPageView *view);
+
 static void
 hadjustment_value_changed (GtkAdjustment *vadjustment, GschemPageView *view);
 
@@ -94,6 +118,9 @@ set_property (GObject *object, guint param_id, const GValue *value, GParamSpec *
 static void
 set_scroll_adjustments (GschemPageView *view, GtkAdjustment *hadjustment, GtkAdjustment *vadjustment);
 
+static void
+tile_free (GschemPageViewTile *tile);
+
 static void
 vadjustment_value_changed (GtkAdjustment *vadjustment, GschemPageView *view);
 
@@ -162,6 +189,8 @@ dispose (GObject *object)
   g_hash_table_foreach (view->geometry_table, (GHFunc)remove_page_weak_reference, view);
   g_hash_table_remove_all (view->geometry_table);
 
+  gschem_page_view_flush_tiles (view);
+
   /* We aren't bothering about invoking
    *   gschem_page_view_set_page (view, NULL)
    * directly here since the current page itself must use its weak
@@ -200,6 +229,9 @@ event_unrealize(GtkWidget *widget, gpointer unused)
   GschemPageView *view = GSCHEM_PAGE_VIEW(widget);
 
   g_return_if_fail (view != NULL);
+
+  /* the tiles are compatible to the window only */
+  gschem_page_view_flush_tiles (view);
 }
 
 
@@ -215,6 +247,7 @@ finalize (GObject *object)
   g_return_if_fail (view->geometry_table != NULL);
 
   g_hash_table_destroy (view->geometry_table);
+  g_hash_table_destroy (view->tiles);
 
   /* lastly, chain up to the parent finalize */
 
@@ -469,19 +502,37 @@ gschem_page_view_get_vadjustment (GschemPageView *view)
 
 
 /*! \brief Schedule redraw for the entire window
+ *
+ *  Discards all cached page content, so use this function if the
+ *  appearance of the page may have changed as a whole.  If just the
+ *  view has been moved, gschem_page_view_invalidate_window() is
+ *  sufficient.
  *
  *  \param [in,out] view The Gschem page view to redraw
  */
 void
 gschem_page_view_invalidate_all (GschemPageView *view)
 {
-  GdkWindow *window;
-
   /* this function can be called early during initialization */
   if (view == NULL) {
     return;
   }
 
+  gschem_page_view_flush_tiles (view);
+  gschem_page_view_invalidate_window (view);
+}
+
+
+
+/*! \brief Schedule redraw for the entire window without touching the cache
+ *
+ *  \param [in,out] view The Gschem page view to redraw
+ */
+static void
+gschem_page_view_invalidate_window (GschemPageView *view)
+{
+  GdkWindow *window;
+
   window = gtk_widget_get_window (GTK_WIDGET (view));
 
   if (window == NULL) {
@@ -525,11 +576,11 @@ gschem_page_view_invalidate_object (GschemPageView *view, OBJECT *object)
                                               &world_bottom);
 
     if (success) {
-      gschem_page_view_invalidate_world_rect (view,
-                                              world_left,
-                                              world_top,
-                                              world_right,
-                                              world_bottom);
+      gschem_page_view_invalidate_world_content (view,
+                                                 world_left,
+                                                 world_top,
+                                                 world_right,
+                                                 world_bottom);
     }
   }
 }
@@ -575,6 +626,80 @@ gschem_page_view_invalidate_screen_rect (GschemPageView *view, int left, int top
 
 
 
+/*! \brief Tile range predicate for g_hash_table_foreach_remove()
+ *
+ *  \param [in] key   The key of the tile
+ *  \param [in] tile  The tile
+ *  \param [in] range The first and last tile column and row
+ *  \return TRUE if the tile is inside the range
+ */
+static gboolean
+tile_in_range (gpointer key, GschemPageViewTile *tile, int *range)
+{
+  int x = (int) (tile->key >> 32);
+  int y = (int) (gint32) tile->key;
+
+  return x >= range[0] && x <= range[1] && y >= range[2] && y <= range[3];
+}
+
+
+
+/*! \brief Tile range predicate for g_hash_table_foreach_remove()
+ *
+ *  \param [in] key   The key of the tile
+ *  \param [in] tile  The tile
+ *  \param [in] range The first and last tile column and row
+ *  \return TRUE if the tile is outside the range
+ */
+static gboolean
+tile_not_in_range (gpointer key, GschemPageViewTile *tile, int *range)
+{
+  return !tile_in_range (key, tile, range);
+}
+
+
+
+/*! \brief Schedule redraw of the given rectangle after its content changed
+ *
+ *  Unlike gschem_page_view_invalidate_world_rect(), this function
+ *  also discards the cached page content in the given rectangle.  Use
+ *  it when objects have been changed, but not for transient things
+ *  like rubber band outlines which are drawn on top of the cache.
+ *
+ *  \param [in,out] view   The Gschem page view to redraw
+ *  \param [in]     left
+ *  \param [in]     top
+ *  \param [in]     right
+ *  \param [in]     bottom
+ */
+void
+gschem_page_view_invalidate_world_content (GschemPageView *view, int left, int top, int right, int bottom)
+{
+  GschemPageGeometry *geometry;
+  int bloat;
+  int range[4];
+
+  g_return_if_fail (view != NULL);
+
+  geometry = gschem_page_view_get_page_geometry (view);
+
+  if (geometry != NULL && g_hash_table_size (view->tiles) != 0) {
+    bloat = MAX (GRIP_SIZE / 2, gschem_page_view_SCREENabs (view, CUE_BOX_SIZE))
+            + INVALIDATE_MARGIN + 1;
+
+    range[0] = (int) floor ((MIN (left, right) * geometry->to_screen_x_constant - bloat) / TILE_SIZE);
+    range[1] = (int) floor ((MAX (left, right) * geometry->to_screen_x_constant + bloat) / TILE_SIZE);
+    range[2] = (int) floor ((-MAX (top, bottom) * geometry->to_screen_y_constant - bloat) / TILE_SIZE);
+    range[3] = (int) floor ((-MIN (top, bottom) * geometry->to_screen_y_constant + bloat) / TILE_SIZE);
+
+    g_hash_table_foreach_remove (view->tiles, (GHRFunc) tile_in_range, range);
+  }
+
+  gschem_page_view_invalidate_world_rect (view, left, top, right, bottom);
+}
+
+
+
 /*! \brief Schedule redraw of the given rectange
  *
  *  \param [in,out] view   The Gschem page view to redraw
@@ -625,6 +750,14 @@ gschem_page_view_init (GschemPageView *view)
   view->page = NULL;
   view->configured = FALSE;
 
+  view->tiles = g_hash_table_new_full (g_int64_hash,
+                                       g_int64_equal,
+                                       NULL,
+                                       (GDestroyNotify) tile_free);
+  view->tiles_page = NULL;
+  view->tiles_scale_x = 0.0;
+  view->tiles_scale_y = 0.0;
+
   view->doing_pan = FALSE;
   view->pan_x = 0;
   view->pan_y = 0;
@@ -700,7 +833,7 @@ gschem_page_view_pan_general (GschemPageView *view, int w_x, int w_y, double rel
 
   g_signal_emit_by_name (view, "update-grid-info");
   gschem_page_view_update_scroll_adjustments (view);
-  gschem_page_view_invalidate_all (view);
+  gschem_page_view_invalidate_window (view);
 }
 
 
@@ -719,7 +852,7 @@ gschem_page_view_pan (GschemPageView *view, int w_x, int w_y)
   x_event_faked_motion (view, NULL);
 
   gschem_page_view_update_scroll_adjustments (view);
-  gschem_page_view_invalidate_all (view);
+  gschem_page_view_invalidate_window (view);
 }
 
 
@@ -831,7 +964,8 @@ gboolean
 gschem_page_view_pan_end (GschemPageView *view)
 {
   if (view->doing_pan) {
-    gschem_page_view_invalidate_all (view);
+    /* replaces the draft tiles rendered during the pan */
+    gschem_page_view_invalidate_window (view);
     view->doing_pan = FALSE;
     return TRUE;
   } else {
@@ -1006,7 +1140,7 @@ hadjustment_value_changed (GtkAdjustment *hadjustment, GschemPageView *view)
     geometry->viewport_left = new_left;
     geometry->viewport_right = geometry->viewport_right - (current_left - new_left);
 
-    gschem_page_view_invalidate_all (view);
+    gschem_page_view_invalidate_window (view);
   }
 }
 
@@ -1257,7 +1391,7 @@ vadjustment_value_changed (GtkAdjustment *vadjustment, GschemPageView *view)
     geometry->viewport_bottom = new_bottom;
     geometry->viewport_top = geometry->viewport_top - (current_bottom - new_bottom);
 
-    gschem_page_view_invalidate_all (view);
+    gschem_page_view_invalidate_window (view);
   }
 }
 
@@ -1314,7 +1448,7 @@ gschem_page_view_zoom_extents (GschemPageView *view, const GList *objects)
 
   g_signal_emit_by_name (view, "update-grid-info");
   gschem_page_view_update_scroll_adjustments (view);
-  gschem_page_view_invalidate_all (view);
+  gschem_page_view_invalidate_window (view);
 }
 
 /*! \brief utility function to find the first parent that has a ->page
@@ -1392,20 +1526,133 @@ gschem_page_view_zoom_text (GschemPageView *view, OBJECT *object, gboolean zoom_
                                      viewport_center_x + viewport_width / 2,
                                      viewport_center_y + viewport_height / 2);
 
-    gschem_page_view_invalidate_all (view);
+    gschem_page_view_invalidate_window (view);
+  }
+}
+
+
+/*! \brief Free a cached tile
+ *
+ *  \param [in] tile The tile
+ */
+static void
+tile_free (GschemPageViewTile *tile)
+{
+  cairo_surface_destroy (tile->surface);
+  g_free (tile);
+}
+
+
+
+/*! \brief Discard all cached page content
+ *
+ *  \param [in,out] view The Gschem page view
+ */
+static void
+gschem_page_view_flush_tiles (GschemPageView *view)
+{
+  g_return_if_fail (view != NULL);
+
+  g_hash_table_remove_all (view->tiles);
+  view->tiles_page = NULL;
+}
+
+
+
+/*! \brief Get a tile of the page content, rendering it if necessary
+ *
+ *  \param [in] view      The Gschem page view
+ *  \param [in] w_current The Gschem toplevel
+ *  \param [in] page      The page shown in the view
+ *  \param [in] geometry  The page geometry
+ *  \param [in] target    The surface the tile will be drawn to
+ *  \param [in] x         The tile column
+ *  \param [in] y         The tile row
+ *  \param [in] draft     Whether a draft quality tile is sufficient
+ *  \return The cached tile, owned by the view
+ */
+static GschemPageViewTile *
+gschem_page_view_get_tile (GschemPageView *view,
+                           GschemToplevel *w_current,
+                           PAGE *page,
+                           GschemPageGeometry *geometry,
+                           cairo_surface_t *target,
+                           int x,
+                           int y,
+                           gboolean draft)
+{
+  GschemPageViewTile *tile;
+  GdkRectangle rectangle = { 0, 0, TILE_SIZE, TILE_SIZE };
+  cairo_matrix_t matrix;
+  cairo_t *cr;
+  gint64 key = ((gint64) x << 32) | (guint32) y;
+
+  tile = g_hash_table_lookup (view->tiles, &key);
+
+  if (tile != NULL && (!tile->draft || draft)) {
+    return tile;
+  }
+
+  if (tile == NULL) {
+    tile = g_new (GschemPageViewTile, 1);
+    tile->key = key;
+    tile->surface = cairo_surface_create_similar (target,
+                                                  CAIRO_CONTENT_COLOR,
+                                                  TILE_SIZE,
+                                                  TILE_SIZE);
+    g_hash_table_insert (view->tiles, &tile->key, tile);
   }
+
+  tile->draft = draft;
+
+  cr = cairo_create (tile->surface);
+
+  cairo_matrix_init (&matrix,
+                     geometry->to_screen_x_constant,
+                     0,
+                     0,
+                     - geometry->to_screen_y_constant,
+                     - (double) x * TILE_SIZE,
+                     - (double) y * TILE_SIZE);
+  cairo_set_matrix (cr, &matrix);
+
+  o_redraw_static (w_current, cr, page, geometry, &rectangle);
+
+  cairo_destroy (cr);
+
+  return tile;
 }
 
 
+
 /*! \brief Redraw page on the view
+ *  \par Function Description
+ *  The objects which aren't selected or being edited are rendered
+ *  into tiles of TILE_SIZE by TILE_SIZE pixels which are kept until
+ *  the zoom level changes or the objects in them are modified.
+ *  Redrawing the view, e.g. while panning or dragging a rubber band,
+ *  then just copies these tiles to the window and draws the
+ *  selection and the rubber band objects on top of them.
+ *
+ *  To keep the tiles aligned to the pixel grid, the world origin is
+ *  rounded to the nearest pixel when placing them.
  *
  *  \param [in] view      The GschemPageView object which page to redraw
+ *  \param [in] event     The expose event
+ *  \param [in] w_current The Gschem toplevel
  */
 void
 gschem_page_view_redraw (GschemPageView *view, GdkEventExpose *event, GschemToplevel *w_current)
 {
   GschemPageGeometry *geometry;
   PAGE *page;
+  cairo_matrix_t *world_to_screen;
+  cairo_matrix_t matrix;
+  cairo_t *cr;
+  gboolean draft;
+  int origin_x, origin_y;
+  int range[4];
+  int x, y;
 
 #if DEBUG
   printf("EXPOSE\n");
@@ -1419,12 +1666,77 @@ gschem_page_view_redraw (GschemPageView *view, GdkEventExpose *event, GschemTopl
   if (page != NULL) {
     geometry = gschem_page_view_get_page_geometry (view);
 
-    g_return_if_fail (view != NULL);
+    g_return_if_fail (geometry != NULL);
+
+    /* the tiles are only valid for one page and zoom level */
+    if (view->tiles_page != page ||
+        view->tiles_scale_x != geometry->to_screen_x_constant ||
+        view->tiles_scale_y != geometry->to_screen_y_constant) {
+      gschem_page_view_flush_tiles (view);
+      view->tiles_page = page;
+      view->tiles_scale_x = geometry->to_screen_x_constant;
+      view->tiles_scale_y = geometry->to_screen_y_constant;
+    }
+
+    world_to_screen = gschem_page_geometry_get_world_to_screen_matrix (geometry);
+    origin_x = (int) floor (world_to_screen->x0 + 0.5);
+    origin_y = (int) floor (world_to_screen->y0 + 0.5);
+
+    draft = w_current->fast_mousepan && view->doing_pan;
+
+    cr = gdk_cairo_create (gtk_widget_get_window (GTK_WIDGET (view)));
+
+    gdk_cairo_rectangle (cr, &(event->area));
+    cairo_clip (cr);
 
-    o_redraw_rect (w_current,
-                   gtk_widget_get_window (GTK_WIDGET(view)),
-                   page,
-                   geometry,
-                   &(event->area));
+    /* copy the static content from the tiles */
+    range[0] = (int) floor ((double) (event->area.x - origin_x) / TILE_SIZE);
+    range[1] = (int) floor ((double) (event->area.x + event->area.width - 1 - origin_x) / TILE_SIZE);
+    range[2] = (int) floor ((double) (event->area.y - origin_y) / TILE_SIZE);
+    range[3] = (int) floor ((double) (event->area.y + event->area.height - 1 - origin_y) / TILE_SIZE);
+
+    for (y = range[2]; y <= range[3]; y++) {
+      for (x = range[0]; x <= range[1]; x++) {
+        GschemPageViewTile *tile;
+
+        tile = gschem_page_view_get_tile (view, w_current, page, geometry,
+                                          cairo_get_target (cr), x, y, draft);
+
+        cairo_set_source_surface (cr, tile->surface,
+                                  origin_x + x * TILE_SIZE,
+                                  origin_y + y * TILE_SIZE);
+        cairo_rectangle (cr,
+                         origin_x + x * TILE_SIZE,
+                         origin_y + y * TILE_SIZE,
+                         TILE_SIZE,
+                         TILE_SIZE);
+        cairo_fill (cr);
+      }
+    }
+
+    /* draw the selection and rubber band objects on top */
+    cairo_matrix_init (&matrix,
+                       geometry->to_screen_x_constant,
+                       0,
+                       0,
+                       - geometry->to_screen_y_constant,
+                       origin_x,
+                       origin_y);
+    cairo_set_matrix (cr, &matrix);
+
+    o_redraw_overlay (w_current, cr, page, geometry, &(event->area));
+
+    cairo_destroy (cr);
+
+    /* limit the cache to twice the tiles needed to fill the window */
+    range[0] = (int) floor ((double) -origin_x / TILE_SIZE);
+    range[1] = (int) floor ((double) (geometry->screen_width - 1 - origin_x) / TILE_SIZE);
+    range[2] = (int) floor ((double) -origin_y / TILE_SIZE);
+    range[3] = (int) floor ((double) (geometry->screen_height - 1 - origin_y) / TILE_SIZE);
+
+    if (g_hash_table_size (view->tiles) >
+        2 * (range[1] - range[0] + 1) * (range[3] - range[2] + 1)) {
+      g_hash_table_foreach_remove (view->tiles, (GHRFunc) tile_not_in_range, range);
+    }
   }
 }
@@ -27,23 +27,71 @@
 extern COLOR display_colors[MAX_COLORS];
 extern COLOR display_outline_colors[MAX_COLORS];
 
-/*! \todo Lots of Gross code... needs lots of cleanup - mainly
- * readability issues
+/*! \brief Set up the renderer for drawing part of a page
+ *  \par Function Description
+ *  Points the renderer of \a w_current at \a cr and configures it
+ *  according to the settings in \a w_current.
+ *
+ *  \param [in] w_current  The GschemToplevel.
+ *  \param [in] cr         The cairo context to draw to.
+ *  \param [in] geometry   The page geometry.
+ *  \param [in] color_map  The color map for normal rendering.
+ *  \return A new reference to the renderer.
  */
+static EdaRenderer *
+o_redraw_get_renderer (GschemToplevel *w_current,
+                       cairo_t *cr,
+                       GschemPageGeometry *geometry,
+                       GArray *color_map)
+{
+  TOPLEVEL *toplevel = gschem_toplevel_get_toplevel (w_current);
+  EdaRenderer *renderer;
+  int render_flags;
 
-/*! \todo Finish function documentation!!!
- *  \brief
+  render_flags = EDA_RENDERER_FLAG_HINTING | EDA_RENDERER_FLAG_LEVEL_OF_DETAIL;
+  if (toplevel->show_hidden_text)
+    render_flags |= EDA_RENDERER_FLAG_TEXT_HIDDEN;
+  if (w_current->fast_mousepan &&
+      gschem_toplevel_get_current_page_view(w_current)->doing_pan)
+    render_flags |= (EDA_RENDERER_FLAG_TEXT_OUTLINE
+                     | EDA_RENDERER_FLAG_PICTURE_OUTLINE);
+
+  renderer = g_object_ref (w_current->renderer);
+  g_object_set (G_OBJECT (renderer),
+                "cairo-context", cr,
+                "grip-size", ((double) (GRIP_SIZE / 2) * geometry->to_world_x_constant),
+                "render-flags", render_flags,
+                "color-map", color_map,
+                NULL);
+
+  return renderer;
+}
+
+
+/*! \brief Draw the static content of part of a page
  *  \par Function Description
+ *  Paints the background and grid, and draws all objects which are
+ *  neither selected nor hidden for editing, together with their
+ *  cues.  This is the part of the page which doesn't change while
+ *  the user pans the view or drags a rubber band, and which the page
+ *  view keeps in its tile cache.
+ *
+ *  The transformation matrix of \a cr has to be set up to map world
+ *  coordinates to device coordinates already.
  *
+ *  \param [in] w_current  The GschemToplevel.
+ *  \param [in] cr         The cairo context to draw to.
+ *  \param [in] page       The page to draw.
+ *  \param [in] geometry   The page geometry.
+ *  \param [in] rectangle  The region to draw, in device coordinates.
  */
-void o_redraw_rect (GschemToplevel *w_current,
-                    GdkDrawable *drawable,
-                    PAGE *page,
-                    GschemPageGeometry *geometry,
-                    GdkRectangle *rectangle)
+void o_redraw_static (GschemToplevel *w_current,
+                      cairo_t *cr,
+                      PAGE *page,
+                      GschemPageGeometry *geometry,
+                      GdkRectangle *rectangle)
 {
   TOPLEVEL *toplevel = gschem_toplevel_get_toplevel (w_current);
-  gboolean draw_selected;
   int grip_half_size;
   double cue_half_size;
   int bloat;
@@ -52,10 +100,7 @@ void o_redraw_rect (GschemToplevel *w_current,
   GList *iter;
   BOX *world_rect;
   EdaRenderer *renderer;
-  int render_flags;
   GArray *render_color_map = NULL;
-  GArray *render_outline_color_map = NULL;
-  cairo_t *cr;
 
   g_return_if_fail (w_current != NULL);
   g_return_if_fail (toplevel != NULL);
@@ -63,17 +108,9 @@ void o_redraw_rect (GschemToplevel *w_current,
   g_return_if_fail (page != NULL);
   g_return_if_fail (geometry != NULL);
 
-  cr = gdk_cairo_create (drawable);
-
-  gdk_cairo_rectangle (cr, rectangle);
-  cairo_clip (cr);
-
-  cairo_save (cr);
-  cairo_set_matrix (cr, gschem_page_geometry_get_world_to_screen_matrix (geometry));
-
   grip_half_size = GRIP_SIZE / 2;
   cue_half_size = CUE_BOX_SIZE;
-  cairo_user_to_device (cr, &cue_half_size, &dummy);
+  cairo_user_to_device_distance (cr, &cue_half_size, &dummy);
   bloat = MAX (grip_half_size, (int)cue_half_size);
 
 
@@ -99,37 +136,14 @@ void o_redraw_rect (GschemToplevel *w_current,
 
   g_free (world_rect);
 
-  /* Set up renderer based on configuration in w_current */
-  render_flags = EDA_RENDERER_FLAG_HINTING;
-  if (toplevel->show_hidden_text)
-    render_flags |= EDA_RENDERER_FLAG_TEXT_HIDDEN;
-  if (w_current->fast_mousepan &&
-      gschem_toplevel_get_current_page_view(w_current)->doing_pan)
-    render_flags |= (EDA_RENDERER_FLAG_TEXT_OUTLINE
-                     | EDA_RENDERER_FLAG_PICTURE_OUTLINE);
-
   /* This color map is used for "normal" rendering. */
   render_color_map =
     g_array_sized_new (FALSE, FALSE, sizeof(COLOR), MAX_COLORS);
   render_color_map =
     g_array_append_vals (render_color_map, display_colors, MAX_COLORS);
 
-  /* This color map is used for rendering rubberbanding nets and
-     buses, and objects which are in the process of being placed. */
-  render_outline_color_map =
-    g_array_sized_new (FALSE, FALSE, sizeof(COLOR), MAX_COLORS);
-  render_outline_color_map =
-    g_array_append_vals (render_outline_color_map, display_outline_colors,
-                         MAX_COLORS);
-
   /* Set up renderer */
-  renderer = g_object_ref (w_current->renderer);
-  g_object_set (G_OBJECT (renderer),
-                "cairo-context", cr,
-                "grip-size", ((double) grip_half_size * geometry->to_world_x_constant),
-                "render-flags", render_flags,
-                "color-map", render_color_map,
-                NULL);
+  renderer = o_redraw_get_renderer (w_current, cr, geometry, render_color_map);
 
   /* Paint background */
   COLOR *color = x_color_lookup (BACKGROUND_COLOR);
@@ -147,10 +161,6 @@ void o_redraw_rect (GschemToplevel *w_current,
                       rectangle->x, rectangle->y,
                       rectangle->width, rectangle->height);
 
-  /* Determine whether we should draw the selection at all */
-  draw_selected = !(w_current->inside_action &&
-                    (w_current->event_state == MOVEMODE));
-
   /* First pass -- render non-selected objects */
   for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
     OBJECT *o_current = iter->data;
@@ -169,9 +179,67 @@ void o_redraw_rect (GschemToplevel *w_current,
     }
   }
 
-  /* Second pass -- render selected objects, cues & grips. This is
-   * done in a separate pass to non-selected items to make sure that
-   * the selection and grips are never obscured by other objects. */
+  g_list_free (obj_list);
+  g_object_unref (G_OBJECT (renderer));
+  g_array_free (render_color_map, TRUE);
+}
+
+
+/*! \brief Draw the dynamic content of part of a page
+ *  \par Function Description
+ *  Draws the selected objects with their cues and grips, and the
+ *  rubber band objects of the current action, on top of the content
+ *  drawn by o_redraw_static().
+ *
+ *  The transformation matrix of \a cr has to be set up to map world
+ *  coordinates to device coordinates already.
+ *
+ *  \param [in] w_current  The GschemToplevel.
+ *  \param [in] cr         The cairo context to draw to.
+ *  \param [in] page       The page to draw.
+ *  \param [in] geometry   The page geometry.
+ *  \param [in] rectangle  The region to draw, in device coordinates.
+ */
+void o_redraw_overlay (GschemToplevel *w_current,
+                       cairo_t *cr,
+                       PAGE *page,
+                       GschemPageGeometry *geometry,
+                       GdkRectangle *rectangle)
+{
+  gboolean draw_selected;
+  GList *iter;
+  EdaRenderer *renderer;
+  GArray *render_color_map = NULL;
+  GArray *render_outline_color_map = NULL;
+
+  g_return_if_fail (w_current != NULL);
+  g_return_if_fail (page != NULL);
+  g_return_if_fail (geometry != NULL);
+
+  /* This color map is used for "normal" rendering. */
+  render_color_map =
+    g_array_sized_new (FALSE, FALSE, sizeof(COLOR), MAX_COLORS);
+  render_color_map =
+    g_array_append_vals (render_color_map, display_colors, MAX_COLORS);
+
+  /* This color map is used for rendering rubberbanding nets and
+     buses, and objects which are in the process of being placed. */
+  render_outline_color_map =
+    g_array_sized_new (FALSE, FALSE, sizeof(COLOR), MAX_COLORS);
+  render_outline_color_map =
+    g_array_append_vals (render_outline_color_map, display_outline_colors,
+                         MAX_COLORS);
+
+  /* Set up renderer */
+  renderer = o_redraw_get_renderer (w_current, cr, geometry, render_color_map);
+
+  /* Determine whether we should draw the selection at all */
+  draw_selected = !(w_current->inside_action &&
+                    (w_current->event_state == MOVEMODE));
+
+  /* Render selected objects, cues & grips. This is done in a separate
+   * pass to non-selected items to make sure that the selection and
+   * grips are never obscured by other objects. */
   if (draw_selected) {
     g_object_set (G_OBJECT (renderer),
                   "override-color", SELECT_COLOR,
@@ -267,10 +335,46 @@ void o_redraw_rect (GschemToplevel *w_current,
     }
   }
 
-  g_list_free (obj_list);
   g_object_unref (G_OBJECT (renderer));
   g_array_free (render_color_map, TRUE);
   g_array_free (render_outline_color_map, TRUE);
+}
+
+
+/*! \brief Redraw a rectangular region of a page
+ *  \par Function Description
+ *  Draws both the static and the dynamic content of the given region
+ *  of \a page to \a drawable.  The page view draws the static content
+ *  from its tile cache instead; this function is used where there is
+ *  no page view, such as when exporting an image.
+ *
+ *  \param [in] w_current  The GschemToplevel.
+ *  \param [in] drawable   The drawable to draw to.
+ *  \param [in] page       The page to draw.
+ *  \param [in] geometry   The page geometry.
+ *  \param [in] rectangle  The region to draw, in screen coordinates.
+ */
+void o_redraw_rect (GschemToplevel *w_current,
+                    GdkDrawable *drawable,
+                    PAGE *page,
+                    GschemPageGeometry *geometry,
+                    GdkRectangle *rectangle)
+{
+  cairo_t *cr;
+
+  g_return_if_fail (w_current != NULL);
+  g_return_if_fail (page != NULL);
+  g_return_if_fail (geometry != NULL);
+
+  cr = gdk_cairo_create (drawable);
+
+  gdk_cairo_rectangle (cr, rectangle);
+  cairo_clip (cr);
+
+  cairo_set_matrix (cr, gschem_page_geometry_get_world_to_screen_matrix (geometry));
+
+  o_redraw_static (w_current, cr, page, geometry, rectangle);
+  o_redraw_overlay (w_current, cr, page, geometry, rectangle);
 
   cairo_destroy (cr);
 }
@@ -460,11 +564,11 @@ void o_invalidate (GschemToplevel *w_current, OBJECT *object)
 
   if (world_get_single_object_bounds(page->toplevel, object, &left,  &top,
                                                        &right, &bottom)) {
-    gschem_page_view_invalidate_world_rect (page_view,
-                                            left,
-                                            top,
-                                            right,
-                                            bottom);
+    gschem_page_view_invalidate_world_content (page_view,
+                                               left,
+                                               top,
+                                               right,
+                                               bottom);
   }
 }
 
@@ -490,11 +594,11 @@ void o_invalidate_glist (GschemToplevel *w_current, GList *list)
 
   if (world_get_object_glist_bounds (page->toplevel, list, &left,  &top,
                                                      &right, &bottom)) {
-    gschem_page_view_invalidate_world_rect (page_view,
-                                            left,
-                                            top,
-                                            right,
-                                            bottom);
+    gschem_page_view_invalidate_world_content (page_view,
+                                               left,
+                                               top,
+                                               right,
+                                               bottom);
   }
 }
 
@@ -37,7 +37,7 @@ void o_complex_prepare_place(GschemToplevel *w_current, const CLibSymbol *sym)
   TOPLEVEL *toplevel = gschem_toplevel_get_toplevel (w_current);
   GList *temp_list;
   OBJECT *o_current;
-  char *buffer;
+  GBytes *buffer;
   const gchar *sym_name = s_clib_symbol_get_name (sym);
   GError *err = NULL;
 
@@ -58,13 +58,17 @@ void o_complex_prepare_place(GschemToplevel *w_current, const CLibSymbol *sym)
 
     temp_list = NULL;
 
-    buffer = s_clib_symbol_get_data (sym);
-    temp_list = o_read_buffer (toplevel,
-                               temp_list,
-                               buffer, -1,
-                               sym_name,
-                               &err);
-    g_free (buffer);
+    buffer = s_clib_symbol_get_bytes (sym);
+    if (buffer != NULL) {
+      gsize len;
+      temp_list = o_read_buffer (toplevel,
+                                 temp_list,
+                                 (gchar *) g_bytes_get_data (buffer, &len),
+                                 len,
+                                 sym_name,
+                                 &err);
+      g_bytes_unref (buffer);
+    }
 
     if (err) {
       /* If an error occurs here, we can assume that the preview also has failed to load,
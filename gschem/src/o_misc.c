@@ -246,7 +246,7 @@ void o_edit_show_hidden_lowlevel (GschemToplevel *w_current,
 
     if (o_current->type == OBJ_COMPLEX || o_current->type == OBJ_PLACEHOLDER) {
       o_edit_show_hidden_lowlevel(w_current, o_current->complex->prim_objs);
-      o_current->w_bounds_valid_for = NULL;
+      o_bounds_invalidate (toplevel, o_current);
     }
 
     iter = g_list_next (iter);
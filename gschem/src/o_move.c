@@ -181,6 +181,7 @@ void o_move_end(GschemToplevel *w_current)
        s_iter != NULL; s_iter = g_list_next (s_iter)) {
     STRETCH *stretch = s_iter->data;
     stretch->object->dont_redraw = FALSE;
+    o_invalidate (w_current, stretch->object);
   }
 
   s_current = geda_list_get_glist( page->selection_list );
@@ -204,12 +205,14 @@ void o_move_end(GschemToplevel *w_current)
 
         /* this next section of code is from */
         /* o_complex_world_translate_world */
+        o_emit_pre_change_notify (page->toplevel, object);
         object->complex->x = object->complex->x + diff_x;
         object->complex->y = object->complex->y + diff_y;
 
         o_move_end_lowlevel_glist (w_current, object->complex->prim_objs,
                                    diff_x, diff_y);
-        object->w_bounds_valid_for = NULL;
+        o_bounds_invalidate (page->toplevel, object);
+        o_emit_change_notify (page->toplevel, object);
         break;
 
       default:
@@ -268,6 +271,7 @@ void o_move_cancel (GschemToplevel *w_current)
        s_iter != NULL; s_iter = g_list_next (s_iter)) {
     STRETCH *stretch = s_iter->data;
     stretch->object->dont_redraw = FALSE;
+    o_invalidate (w_current, stretch->object);
   }
   g_list_free(page->place_list);
   page->place_list = NULL;
@@ -716,8 +720,11 @@ void o_move_end_rubberband (GschemToplevel *w_current,
       /* remove the object's connections */
       s_conn_remove_object_connections (page->toplevel, object);
 
+      o_emit_pre_change_notify (page->toplevel, object);
       object->line->x[whichone] += w_dx;
       object->line->y[whichone] += w_dy;
+      o_bounds_invalidate (page->toplevel, object);
+      o_emit_change_notify (page->toplevel, object);
 
       if (o_move_zero_length (object)) {
         w_current->stretch_list =
@@ -726,7 +733,6 @@ void o_move_end_rubberband (GschemToplevel *w_current,
         continue;
       }
 
-      object->w_bounds_valid_for = NULL;
       s_conn_update_object (page, object);
       *objects = g_list_append (*objects, object);
     }
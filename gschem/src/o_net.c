@@ -860,8 +860,13 @@ int o_net_add_busrippers(GschemToplevel *w_current, OBJECT *net_obj,
           rippers[ripper_count].angle = 0;
           rippers[ripper_count].mirror = sign == 1 ? 0 : 1;
 
+          o_emit_pre_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
+
           net_obj->line->y[found_conn->whichone] -= ripper_size;
-          net_obj->w_bounds_valid_for = NULL;
+
+          o_bounds_invalidate (gschem_toplevel_get_toplevel (w_current), net_obj);
+
+          o_emit_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
           rippers[ripper_count].x[0] =
             net_obj->line->x[found_conn->whichone];
           rippers[ripper_count].y[0] =
@@ -889,8 +894,13 @@ int o_net_add_busrippers(GschemToplevel *w_current, OBJECT *net_obj,
           rippers[ripper_count].angle = 180;
           rippers[ripper_count].mirror = sign == 1 ? 1 : 0;
 
+          o_emit_pre_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
+
           net_obj->line->y[found_conn->whichone] += ripper_size;
-          net_obj->w_bounds_valid_for = NULL;
+
+          o_bounds_invalidate (gschem_toplevel_get_toplevel (w_current), net_obj);
+
+          o_emit_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
           rippers[ripper_count].x[0] =
             net_obj->line->x[found_conn->whichone];
           rippers[ripper_count].y[0] =
@@ -952,8 +962,13 @@ int o_net_add_busrippers(GschemToplevel *w_current, OBJECT *net_obj,
           rippers[ripper_count].angle = 270;
           rippers[ripper_count].mirror = sign == 1 ? 1 : 0;
 
+          o_emit_pre_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
+
           net_obj->line->x[found_conn->whichone] -= ripper_size;
-          net_obj->w_bounds_valid_for = NULL;
+
+          o_bounds_invalidate (gschem_toplevel_get_toplevel (w_current), net_obj);
+
+          o_emit_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
           rippers[ripper_count].x[0] =
             net_obj->line->x[found_conn->whichone];
           rippers[ripper_count].y[0] =
@@ -980,8 +995,13 @@ int o_net_add_busrippers(GschemToplevel *w_current, OBJECT *net_obj,
           rippers[ripper_count].angle = 90;
           rippers[ripper_count].mirror = sign == 1 ? 0 : 1;
 
+          o_emit_pre_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
+
           net_obj->line->x[found_conn->whichone] += ripper_size;
-          net_obj->w_bounds_valid_for = NULL;
+
+          o_bounds_invalidate (gschem_toplevel_get_toplevel (w_current), net_obj);
+
+          o_emit_change_notify (gschem_toplevel_get_toplevel (w_current), net_obj);
           rippers[ripper_count].x[0] =
             net_obj->line->x[found_conn->whichone];
           rippers[ripper_count].y[0] =
@@ -41,6 +41,25 @@ static char* tmp_path = NULL;
 /* of entries to free */
 #define UNDO_PADDING  5
 
+/*! \brief Record that an object may have changed.
+ *  \par Function Description
+ *  Change notification handler for the delta undo mechanism.  Marks
+ *  the group \a object belongs to, so the next undo level records
+ *  its new state.
+ *
+ *  \param [in] w_current  The GschemToplevel.
+ *  \param [in] object     The OBJECT which is being changed.
+ */
+void
+o_undo_notify (GschemToplevel *w_current, OBJECT *object)
+{
+  if (w_current->undo_type != UNDO_DELTA) {
+    return;
+  }
+
+  s_undo_delta_notify (object);
+}
+
 /*! \todo Finish function documentation!!!
  *  \brief
  *  \par Function Description
@@ -77,6 +96,7 @@ o_undo_savestate (GschemToplevel *w_current, PAGE *page, int flag,
   TOPLEVEL *toplevel = gschem_toplevel_get_toplevel (w_current);
   char *filename = NULL;
   GList *object_list = NULL;
+  GList *changes = NULL;
   int levels;
   UNDO *u_current;
   UNDO *u_current_next;
@@ -129,6 +149,13 @@ o_undo_savestate (GschemToplevel *w_current, PAGE *page, int flag,
     object_list = o_glist_copy_all (toplevel,
                                     s_page_objects (page),
                                     object_list);
+  } else if (w_current->undo_type == UNDO_DELTA && flag == UNDO_ALL) {
+    /* the first undo level saves the whole page instead */
+    if (s_undo_delta_is_tracked (page)) {
+      changes = s_undo_delta_flush (page, NULL);
+    } else {
+      s_undo_delta_track (page);
+    }
   }
 
   /* Clear Anything above current */
@@ -170,6 +197,8 @@ o_undo_savestate (GschemToplevel *w_current, PAGE *page, int flag,
                                 desc);
   }
 
+  page->undo_tos->changes = changes;
+
   page->undo_current =
       page->undo_tos;
 
@@ -191,6 +220,11 @@ o_undo_savestate (GschemToplevel *w_current, PAGE *page, int flag,
 
   o_undo_update_actions (w_current, page);
 
+  /* levels above the current one may just have been discarded */
+  if (w_current->undo_type == UNDO_DELTA) {
+    s_undo_delta_collect (page);
+  }
+
   /* Now go through and see if we need to free/remove some undo levels */
   /* so we stay within the limits */
 
@@ -234,6 +268,9 @@ o_undo_savestate (GschemToplevel *w_current, PAGE *page, int flag,
         u_current->object_list = NULL;
       }
 
+      s_undo_free_changes (u_current->changes);
+      u_current->changes = NULL;
+
       u_current->next = NULL;
       u_current->prev = NULL;
       g_free(u_current);
@@ -375,6 +412,11 @@ o_undo_callback (GschemToplevel *w_current, PAGE *page, int type)
     return;
   }
 
+  /* record changes made since the current undo level was saved */
+  if (w_current->undo_type == UNDO_DELTA) {
+    u_next->changes = s_undo_delta_flush (page, u_next->changes);
+  }
+
   if (u_next->type == UNDO_ALL && u_current->type == UNDO_VIEWPORT_ONLY) {
 #if DEBUG
     printf("Type: %d\n", u_current->type);
@@ -384,7 +426,7 @@ o_undo_callback (GschemToplevel *w_current, PAGE *page, int type)
 
     if (w_current->undo_type == UNDO_DISK) {
       u_current->filename = o_undo_find_prev_filename(u_current);
-    } else {
+    } else if (w_current->undo_type == UNDO_MEMORY) {
       u_current->object_list = o_undo_find_prev_object_head (u_current);
     }
   }
@@ -433,6 +475,16 @@ o_undo_callback (GschemToplevel *w_current, PAGE *page, int type)
     s_page_append_list (toplevel, page,
                         o_glist_copy_all (toplevel, u_current->object_list,
                                           NULL));
+
+  } else if (w_current->undo_type == UNDO_DELTA) {
+
+    /* undo reverts the changes which led to the current level, redo
+     * repeats the changes which lead to the next one */
+    if (type == UNDO_ACTION) {
+      s_undo_delta_apply (toplevel, page, u_next->changes, TRUE);
+    } else {
+      s_undo_delta_apply (toplevel, page, u_current->changes, FALSE);
+    }
   }
 
   page->page_control = u_current->page_control;
@@ -28,6 +28,20 @@
 
 #define DOTS_VARIABLE_MODE_SPACING   30
 
+/* The dots grid is drawn from a tile at least DOTS_PATTERN_MIN_SIZE
+ * and at most DOTS_PATTERN_MAX_SIZE pixels wide.  The tile must span
+ * a whole number of dots and be within DOTS_PATTERN_EPSILON pixels of
+ * an integer width; otherwise, the dots are drawn one by one. */
+#define DOTS_PATTERN_MIN_SIZE        64
+#define DOTS_PATTERN_MAX_SIZE        1024
+#define DOTS_PATTERN_EPSILON         (1.0 / 64)
+
+/* The cached dots grid pattern and what it was rendered for */
+static cairo_pattern_t *dots_pattern = NULL;
+static double dots_pattern_spacing;
+static int dots_pattern_dot_size;
+static COLOR dots_pattern_color;
+
 #define MESH_COARSE_GRID_MULTIPLIER  5
 
 
@@ -82,34 +96,17 @@ static int query_dots_grid_spacing (GschemToplevel *w_current)
   return incr;
 }
 
-/*! \brief Draw an area of the screen with a dotted grid pattern
+/*! \brief Draw dots one by one
  *
  *  \par Function Description
- *  Draws the dotted grid pattern over a given region of the screen.
- *
- *  \param [in] w_current  The GschemToplevel.
- *  \param [in] x          The left screen coordinate for the drawing.
- *  \param [in] y          The top screen coordinate for the drawing.
- *  \param [in] width      The width of the region to draw.
- *  \param [in] height     The height of the region to draw.
+ *  Helper function for draw_dots_grid_region which adds every dot in
+ *  the region to the path separately.  This is only used when the
+ *  dots can't be drawn from a pattern (see get_dots_pattern).
  */
 static void
-draw_dots_grid_region (GschemToplevel *w_current, cairo_t *cr, int x, int y, int width, int height)
+draw_dots (GschemToplevel *w_current, cairo_t *cr, int incr, int dot_size,
+           int x, int y, int width, int height)
 {
-  int incr = query_dots_grid_spacing (w_current);
-
-  if (incr == -1)
-    return;
-
-  int dot_size = min (w_current->dots_grid_dot_size, 5);
-
-  COLOR *color = x_color_lookup (DOTS_GRID_COLOR);
-  cairo_set_source_rgba (cr,
-                         color->r / 255.0,
-                         color->g / 255.0,
-                         color->b / 255.0,
-                         color->a / 255.0);
-
   cairo_matrix_t user_to_device_matrix;
   double x_start = x - 1;
   double y_start = y + height + 1;
@@ -157,6 +154,169 @@ draw_dots_grid_region (GschemToplevel *w_current, cairo_t *cr, int x, int y, int
 }
 
 
+/*! \brief Get a repeating pattern of grid dots
+ *
+ *  \par Function Description
+ *  Returns a surface pattern containing a tile of DOTS_PATTERN_MIN_SIZE
+ *  or more pixels with grid dots at the given screen spacing.  The tile
+ *  is only rendered again when the spacing, dot size or color changes,
+ *  which usually only happens when zooming.
+ *
+ *  Since the screen spacing of the grid is not an integer number of
+ *  pixels, the tile is made as many dots wide as needed for its width
+ *  to be almost exactly an integer.  The pattern is repeated without
+ *  scaling, so each dot keeps its size and no row or column of dots
+ *  gets lost.  If there is no such width up to DOTS_PATTERN_MAX_SIZE
+ *  pixels, NULL is returned.
+ *
+ *  \param [in]  spacing   The on-screen grid spacing in pixels.
+ *  \param [in]  dot_size  The size of a dot.
+ *  \param [in]  color     The color of the dots.
+ *  \returns The pattern, owned by this module, or NULL.
+ */
+static cairo_pattern_t *
+get_dots_pattern (double spacing, int dot_size, COLOR *color)
+{
+  if (dots_pattern != NULL &&
+      dots_pattern_spacing == spacing &&
+      dots_pattern_dot_size == dot_size &&
+      dots_pattern_color.r == color->r &&
+      dots_pattern_color.g == color->g &&
+      dots_pattern_color.b == color->b &&
+      dots_pattern_color.a == color->a)
+    return dots_pattern;
+
+  int count;
+  int size;
+  int i, j, dx, dy;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+
+  for (count = ceil (DOTS_PATTERN_MIN_SIZE / spacing);
+       count * spacing <= DOTS_PATTERN_MAX_SIZE; count++)
+    if (fabs (count * spacing - round (count * spacing)) < DOTS_PATTERN_EPSILON)
+      break;
+
+  if (count * spacing > DOTS_PATTERN_MAX_SIZE)
+    return NULL;
+
+  size = round (count * spacing);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, size, size);
+  cr = cairo_create (surface);
+  cairo_set_source_rgba (cr,
+                         color->r / 255.0,
+                         color->g / 255.0,
+                         color->b / 255.0,
+                         color->a / 255.0);
+
+  for (j = 0; j < count; j++) {
+    for (i = 0; i < count; i++) {
+      double x1 = round (i * spacing);
+      double y1 = round (j * spacing);
+
+      if (dot_size == 1) {
+        cairo_rectangle (cr, x1, y1, 1, 1);
+        continue;
+      }
+
+      /* draw dots on the edge once more on the opposite side,
+       * so they are complete when the tile is repeated */
+      for (dy = -size; dy <= size; dy += size) {
+        for (dx = -size; dx <= size; dx += size) {
+          cairo_move_to (cr, x1 + dx, y1 + dy);
+          cairo_arc (cr, x1 + dx, y1 + dy, dot_size/2, 0, 2*M_PI);
+        }
+      }
+    }
+  }
+
+  cairo_fill (cr);
+  cairo_destroy (cr);
+
+  x_grid_free ();
+
+  dots_pattern = cairo_pattern_create_for_surface (surface);
+  cairo_surface_destroy (surface);
+  cairo_pattern_set_extend (dots_pattern, CAIRO_EXTEND_REPEAT);
+  cairo_pattern_set_filter (dots_pattern, CAIRO_FILTER_NEAREST);
+
+  dots_pattern_spacing = spacing;
+  dots_pattern_dot_size = dot_size;
+  dots_pattern_color = *color;
+
+  return dots_pattern;
+}
+
+
+/*! \brief Draw an area of the screen with a dotted grid pattern
+ *
+ *  \par Function Description
+ *  Draws the dotted grid pattern over a given region of the screen.
+ *
+ *  Where possible, the region is filled with a cached repeating
+ *  pattern, so the cost of drawing the grid doesn't depend on the
+ *  number of dots.
+ *
+ *  \param [in] w_current  The GschemToplevel.
+ *  \param [in] x          The left screen coordinate for the drawing.
+ *  \param [in] y          The top screen coordinate for the drawing.
+ *  \param [in] width      The width of the region to draw.
+ *  \param [in] height     The height of the region to draw.
+ */
+static void
+draw_dots_grid_region (GschemToplevel *w_current, cairo_t *cr, int x, int y, int width, int height)
+{
+  int incr = query_dots_grid_spacing (w_current);
+
+  if (incr == -1)
+    return;
+
+  int dot_size = min (w_current->dots_grid_dot_size, 5);
+
+  COLOR *color = x_color_lookup (DOTS_GRID_COLOR);
+  cairo_set_source_rgba (cr,
+                         color->r / 255.0,
+                         color->g / 255.0,
+                         color->b / 255.0,
+                         color->a / 255.0);
+
+  double spacing = incr;
+  double dummy = 0.0;
+  cairo_user_to_device_distance (cr, &spacing, &dummy);
+  spacing = fabs (spacing);
+
+  cairo_pattern_t *pattern;
+  cairo_matrix_t matrix;
+  double x0 = 0.0;
+  double y0 = 0.0;
+
+  pattern = get_dots_pattern (spacing,
+                              w_current->dots_grid_dot_size == 1 ? 1 : dot_size,
+                              color);
+  if (pattern == NULL) {
+    draw_dots (w_current, cr, incr, dot_size, x, y, width, height);
+    return;
+  }
+
+  /* align the pattern with the grid dot closest to the top left
+   * corner of the screen, so the small difference between the tile
+   * width and the grid spacing doesn't add up across the screen */
+  cairo_device_to_user (cr, &x0, &y0);
+  x0 = round (x0 / incr) * incr;
+  y0 = round (y0 / incr) * incr;
+  cairo_user_to_device (cr, &x0, &y0);
+  cairo_matrix_init_translate (&matrix, -round (x0), -round (y0));
+  cairo_pattern_set_matrix (pattern, &matrix);
+
+  cairo_save (cr);
+  cairo_identity_matrix (cr);
+  cairo_set_source (cr, pattern);
+  cairo_rectangle (cr, x, y, width, height);
+  cairo_fill (cr);
+  cairo_restore (cr);
+}
+
+
 /*! \brief Helper function for draw_mesh_grid_region
  */
 static void draw_mesh (GschemToplevel *w_current,
@@ -468,3 +628,17 @@ int x_grid_query_drawn_spacing (GschemToplevel *w_current)
     case GRID_MODE_MESH: return query_mesh_grid_spacing (w_current);
   }
 }
+
+
+/*! \brief Free the cached dots grid pattern.
+ *
+ *  \par Function Description
+ *  Releases the pattern the dots grid is drawn from.  It is rendered
+ *  again the next time the grid is drawn.
+ */
+void x_grid_free (void)
+{
+  if (dots_pattern != NULL)
+    cairo_pattern_destroy (dots_pattern);
+  dots_pattern = NULL;
+}
@@ -1292,6 +1292,11 @@ GschemToplevel* x_window_new (TOPLEVEL *toplevel)
                        (ChangeNotifyFunc) o_invalidate,
                        (ChangeNotifyFunc) o_invalidate, w_current);
 
+  /* Changed objects have to be recorded by delta undo */
+  o_add_change_notify (gschem_toplevel_get_toplevel (w_current),
+                       (ChangeNotifyFunc) o_undo_notify,
+                       (ChangeNotifyFunc) o_undo_notify, w_current);
+
   x_window_setup (w_current);
 
   return w_current;
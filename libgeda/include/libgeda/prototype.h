@@ -101,6 +101,7 @@ void o_add_change_notify(TOPLEVEL *toplevel, ChangeNotifyFunc pre_change_func, C
 void o_remove_change_notify(TOPLEVEL *toplevel, ChangeNotifyFunc pre_change_func, ChangeNotifyFunc change_func, void *user_data);
 gboolean o_is_visible (OBJECT *object);
 void o_set_visibility (TOPLEVEL *toplevel, OBJECT *object, int visibility);
+void o_bounds_invalidate(TOPLEVEL *toplevel, OBJECT *object);
 
 /* o_box_basic.c */
 OBJECT *o_box_new(TOPLEVEL *toplevel, char type, int color, int x1, int y1, int x2, int y2);
@@ -283,10 +284,15 @@ const gchar *s_clib_source_get_directory (const CLibSource *source);
 const gchar *s_clib_symbol_get_name (const CLibSymbol *symbol);
 gchar *s_clib_symbol_get_filename (const CLibSymbol *symbol);
 const CLibSource *s_clib_symbol_get_source (const CLibSymbol *symbol);
+gint s_clib_symbol_get_pin_count (const CLibSymbol *symbol);
+gchar *s_clib_symbol_get_attribute (const CLibSymbol *symbol, const gchar *name);
 gchar *s_clib_symbol_get_data (const CLibSymbol *symbol);
+GBytes *s_clib_symbol_get_bytes (const CLibSymbol *symbol);
 GList *s_clib_search (const gchar *pattern, const CLibSearchMode mode);
 void s_clib_flush_search_cache ();
 void s_clib_flush_symbol_cache ();
+void s_clib_set_symbol_cache_size (gsize size);
+void s_clib_get_symbol_cache_stats (gulong *hits, gulong *misses, gulong *evictions);
 void s_clib_symbol_invalidate_data (const CLibSymbol *symbol);
 const CLibSymbol *s_clib_get_symbol_by_name (const gchar *name);
 gchar *s_clib_symbol_get_data_by_name (const gchar *name);
@@ -345,6 +351,8 @@ void s_page_append (TOPLEVEL *toplevel, PAGE *page, OBJECT *object);
 void s_page_append_list (TOPLEVEL *toplevel, PAGE *page, GList *obj_list);
 void s_page_remove (TOPLEVEL *toplevel, PAGE *page, OBJECT *object);
 void s_page_replace (TOPLEVEL *toplevel, PAGE *page, OBJECT *object1, OBJECT *object2);
+guint64 s_page_get_order (PAGE *page, OBJECT *object);
+void s_page_insert_list (TOPLEVEL *toplevel, PAGE *page, GList *obj_list, guint64 order);
 void s_page_delete_objects (TOPLEVEL *toplevel, PAGE *page);
 const GList *s_page_objects (PAGE *page);
 GList *s_page_objects_in_region (TOPLEVEL *toplevel, PAGE *page, int min_x, int min_y, int max_x, int max_y);
@@ -386,6 +394,13 @@ void s_undo_remove_rest(TOPLEVEL *toplevel, UNDO *head);
 int s_undo_levels(UNDO *head);
 void s_undo_init(PAGE *p_current);
 void s_undo_free_all(TOPLEVEL *toplevel, PAGE *p_current);
+void s_undo_free_changes(GList *changes);
+void s_undo_delta_track(PAGE *page);
+gboolean s_undo_delta_is_tracked(PAGE *page);
+void s_undo_delta_notify(OBJECT *object);
+GList *s_undo_delta_flush(PAGE *page, GList *changes);
+void s_undo_delta_apply(TOPLEVEL *toplevel, PAGE *page, GList *changes, gboolean undo);
+void s_undo_delta_collect(PAGE *page);
 
 /* u_basic.c */
 char *u_basic_breakup_string(char *string, char delimiter, int count);
@@ -43,12 +43,16 @@ typedef struct st_bezier BEZIER;
 
 typedef struct st_object OBJECT;
 typedef struct st_page PAGE;
+typedef struct st_page_index PAGE_INDEX;
 typedef struct st_toplevel TOPLEVEL;
 typedef struct st_color COLOR;
 typedef struct st_undo UNDO;
+typedef struct st_undo_change UNDO_CHANGE;
 typedef struct st_bounds BOUNDS;
+typedef struct st_slot_table SLOT_TABLE;
 
 typedef struct st_conn CONN;
+typedef struct st_conn_index CONN_INDEX;
 
 /* netlist structures (gnetlist) */
 typedef struct st_netlist NETLIST;
@@ -181,6 +185,8 @@ struct st_text {
 
   char *string;			/* text stuff */
   char *disp_string;
+  GQuark attrib_name;		/* interned attribute name, or 0 if
+                                 * the string isn't a valid attribute */
   int length;
   int size;
   int alignment;	
@@ -198,6 +204,11 @@ struct st_complex {
   GList *prim_objs;			/* Primitive objects */
   /* objects which make up the */
   /* complex */
+
+  GHashTable *attrib_index;		/* inherited attributes by name,
+                                         * built on demand */
+  SLOT_TABLE *slot_table;		/* parsed slotdefs and pins,
+                                         * built on demand */
 };
 
 struct st_circle {
@@ -320,6 +331,16 @@ struct st_transform {
   gdouble m[2][3];    /* m[row][column] */
 };
 
+struct st_undo_change {
+  /* identifies the changed group, owned by the delta undo tracker */
+  void *key;
+
+  /* the object and its attributes in libgeda format before and after
+   * the change, or NULL if the object didn't exist */
+  char *before;
+  char *after;
+};
+
 struct st_undo {
 
   /* one of these is used, depending on if you are doing in-memory */
@@ -327,6 +348,10 @@ struct st_undo {
   char *filename;
   GList *object_list;
 
+  /* UNDO_CHANGE structures for undo levels which only record the
+   * objects changed since the previous level */
+  GList *changes;
+
   /* either UNDO_ALL or UNDO_VIEWPORT_ONLY */
   int type;
 
@@ -358,10 +383,12 @@ struct st_page {
   int pid;
 
   GList *_object_list;
+  PAGE_INDEX *_object_index; /* spatial index of _object_list */
   SELECTION *selection_list; /* new selection mechanism */
   GList *place_list;
   OBJECT *object_lastplace; /* the last found item */
   GList *connectible_list;  /* connectible page objects */
+  CONN_INDEX *conn_index;   /* spatial index of connectible_list */
 
   char *page_filename; 
   gboolean is_untitled;
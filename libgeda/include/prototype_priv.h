@@ -1,5 +1,6 @@
 /* a_basic.c */
 gchar *o_save_objects(const GList *object_list, gboolean save_attribs);
+int o_read_fields (const char *line, char *type, int n_fields, ...);
 
 /* g_rc.c */
 int vstbl_lookup_str(const vstbl_entry *table, int size, const char *str);
@@ -10,6 +11,7 @@ SCM g_rc_component_library_funcs (SCM listfunc, SCM getfunc, SCM name);
 SCM g_rc_source_library(SCM path);
 SCM g_rc_source_library_search(SCM path);
 SCM g_rc_world_size(SCM width, SCM height, SCM border);
+SCM g_rc_symbol_cache_size(SCM size);
 SCM g_rc_reset_component_library(void);
 SCM g_rc_reset_source_library(void);
 SCM g_rc_bitmap_directory(SCM path);
@@ -74,9 +76,11 @@ GList *o_read_attribs(TOPLEVEL *toplevel,
                       unsigned int release_ver,
                       unsigned int fileformat_ver, GError **err);
 OBJECT *o_attrib_find_attrib_by_name(const GList *list, char *name, int count);
+GQuark o_attrib_string_get_name_quark(const gchar *string);
+void o_attrib_invalidate_index(OBJECT *object);
+OBJECT *o_attrib_find_object_attrib_by_name(OBJECT *object, char *name, int counter);
 
 /* o_basic.c */
-void o_bounds_invalidate(TOPLEVEL *toplevel, OBJECT *object);
 double o_shortest_distance_full(TOPLEVEL *toplevel, OBJECT *object, int x, int y, int force_solid);
 void o_emit_pre_change_notify(TOPLEVEL *toplevel, OBJECT *object);
 void o_emit_change_notify(TOPLEVEL *toplevel, OBJECT *object);
@@ -155,8 +159,21 @@ gboolean o_text_get_position(OBJECT *object, gint *x, gint *y);
 void o_selection_select(TOPLEVEL *toplevel, OBJECT *object);
 void o_selection_unselect(TOPLEVEL *toplevel, OBJECT *object);
 
+/* s_basic.c */
+extern int global_sid;
+
 /* s_clib.c */
 void s_clib_init (void);
+CLibPrototype *s_clib_symbol_get_prototype (TOPLEVEL *toplevel, const CLibSymbol *symbol, GError **err);
+void s_clib_prototype_unref (CLibPrototype *prototype);
+
+/* s_clib_index.c */
+gchar *s_clib_index_get_filename (const gchar *directory);
+gboolean s_clib_index_is_candidate (const gchar *name);
+gboolean s_clib_index_read (const gchar *filename, gint64 mtime, GPtrArray *names, GPtrArray *summaries);
+gboolean s_clib_index_write (const gchar *filename, gint64 mtime, GPtrArray *names, GPtrArray *summaries);
+CLibSummary *s_clib_summary_new (const gchar *path, gint64 mtime, gint64 size);
+void s_clib_summary_free (CLibSummary *summary);
 
 /* s_color.c */
 void s_color_init(void);
@@ -169,15 +186,23 @@ OBJECT *s_conn_check_midpoint(OBJECT *o_current, int x, int y);
 void s_conn_print(GList *conn_list);
 void s_conn_add_object(PAGE *page, OBJECT *object);
 void s_conn_remove_object(PAGE *page, OBJECT *object);
+void s_conn_reindex_object(PAGE *page, OBJECT *object);
+void s_conn_free_index(PAGE *page);
 
 /* s_encoding.c */
 gchar* s_encoding_base64_encode (gchar* src, guint srclen, guint* dstlenp, gboolean strict);
 gchar* s_encoding_base64_decode (gchar* src, guint srclen, guint* dstlenp);
 
+/* s_page.c */
+void s_page_index_invalidate(PAGE *page, OBJECT *object);
+
 /* s_path.c */
 int s_path_to_polygon(PATH *path, GArray *points);
 double s_path_shortest_distance (PATH *path, int x, int y, int solid);
 
+/* s_slot.c */
+void s_slot_invalidate(OBJECT *object);
+
 /* s_textbuffer.c */
 TextBuffer *s_textbuffer_new (const gchar *data, const gint size);
 TextBuffer *s_textbuffer_free (TextBuffer *tb);
@@ -21,4 +21,43 @@
 #ifndef STRUCT_PRIV_H
 #define STRUCT_PRIV_H
 
+/*! Summary of a symbol file, as kept in the component library index */
+typedef struct _CLibSummary CLibSummary;
+
+struct _CLibSummary {
+  /*! Modification time of the symbol file */
+  gint64 mtime;
+  /*! Size of the symbol file in bytes */
+  gint64 size;
+  /*! Number of pins, or -1 if the file couldn't be read */
+  gint pin_count;
+  /*! NULL-terminated array of the symbol's floating attributes, as
+   *  "name=value" strings */
+  gchar **attribs;
+};
+
+/*! Slotting information of a complex object, as used by
+ *  s_slot_update_object() */
+struct st_slot_table {
+  /*! Inherited slotdef= attributes, mapping the slot number string
+   *  to a NULL-terminated array of pin numbers */
+  GHashTable *slotdefs;
+  /*! Pins of the complex, mapping the pinseq= value string to the
+   *  pin OBJECT */
+  GHashTable *pins;
+};
+
+/*! Objects parsed from a symbol's data, shared by the symbol data
+ *  cache and the callers of s_clib_symbol_get_prototype() */
+typedef struct _CLibPrototype CLibPrototype;
+
+struct _CLibPrototype {
+  /*! Reference count, see s_clib_prototype_unref() */
+  gint refcount;
+  /*! The parsed objects.  Only their copied_to fields are changed
+   *  (and reset) while they are being copied, so they must only be
+   *  used from the main thread. */
+  GList *objects;
+};
+
 #endif /* !STRUCT_PRIV_H */
@@ -0,0 +1,79 @@
+;; Measure how long it takes to parse schematic files.
+;;
+;; This is not run as part of the test suite.  Run it from the top of
+;; the build tree, e.g.
+;;
+;;   gaf/gaf --no-rcfiles shell -L libgeda/scheme \
+;;     -s libgeda/scheme/benchmarks/page-load.scm gschem/tests/*.sch
+;;
+;; Each file given on the command line is parsed a number of times,
+;; then a synthetic schematic of about 100 MB is generated and parsed
+;; once.  The files are read into memory first, so only the time
+;; spent in the parser is measured.
+
+(use-modules (ice-9 format)
+             (ice-9 rdelim)
+             (geda page))
+
+(define repeat 20)
+(define synthetic-size (* 100 1000 1000))
+
+(define (now)
+  (/ (get-internal-real-time) 1.0 internal-time-units-per-second))
+
+(define (read-file filename)
+  (call-with-input-file filename
+    (lambda (port)
+      (set-port-encoding! port "UTF-8")
+      (read-delimited "" port))))
+
+;; Parses data n times and returns the average time and the number
+;; of top-level objects.
+(define (time-parse name data n)
+  (let loop ((i 0) (total 0.0) (count 0))
+    (if (= i n)
+        (values (/ total n) count)
+        (let* ((start (now))
+               (page (string->page name data))
+               (elapsed (- (now) start))
+               (count (length (page-contents page))))
+          (close-page! page)
+          (loop (1+ i) (+ total elapsed) count)))))
+
+(define (report name size n)
+  (lambda (seconds count)
+    (format #t "~a: ~a bytes, ~a objects, ~,3f ms per load, ~,1f MB/s\n"
+            name size count (* seconds 1000)
+            (/ size seconds 1000000))))
+
+;; A schematic consisting of nets with attached netname attributes,
+;; graphical lines and free text, which exercises most of the parser.
+(define (synthetic-schematic size)
+  (call-with-output-string
+   (lambda (port)
+     (display "v 20111231 2\n" port)
+     (let loop ((i 0) (written 0))
+       (if (< written size)
+           (let* ((x (* 100 (modulo i 1000)))
+                  (y (* 100 (quotient i 1000)))
+                  (block
+                   (format #f "N ~a ~a ~a ~a 4\n{\nT ~a ~a 5 10 1 1 0 0 1\nnetname=net~a\n}\nL ~a ~a ~a ~a 3 0 0 0 -1 -1\nT ~a ~a 9 10 1 0 0 0 2\nsome free text\nline ~a\n"
+                           x y (+ x 100) y
+                           x (+ y 20) i
+                           x (+ y 50) (+ x 100) (+ y 50)
+                           x (+ y 70) i)))
+             (display block port)
+             (loop (1+ i) (+ written (string-length block)))))))))
+
+(for-each
+ (lambda (filename)
+   (let ((data (read-file filename)))
+     (call-with-values
+         (lambda () (time-parse filename data repeat))
+       (report filename (string-length data) repeat))))
+ (cdr (command-line)))
+
+(let ((data (synthetic-schematic synthetic-size)))
+  (call-with-values
+      (lambda () (time-parse "synthetic.sch" data 1))
+    (report "synthetic.sch" (string-length data) 1)))
@@ -0,0 +1,38 @@
+;; Test that the fields of object lines are read correctly, whatever
+;; the signs of the numbers and the whitespace between them.
+
+(use-modules (unit-test)
+             (geda page)
+             (geda object))
+
+(define (parse-first str)
+  (car (page-contents
+        (string->page "/test/page/A"
+                      (string-append "v 20111231 2\n" str)))))
+
+(begin-test 'parse-fields-signs
+  (let ((l (parse-first "L -100 +200 300 -400 3 0 0 0 -1 -1\n")))
+    (assert-equal '(-100 . 200) (line-start l))
+    (assert-equal '(300 . -400) (line-end l))
+    (assert-equal 3 (object-color l))))
+
+(begin-test 'parse-fields-whitespace
+  (let ((l (parse-first "L 0\t0   1000 \t 0 3 0 0 0 -1 -1\n")))
+    (assert-equal '(0 . 0) (line-start l))
+    (assert-equal '(1000 . 0) (line-end l))))
+
+(begin-test 'parse-fields-text
+  (let ((t (parse-first "T 10 -20 5 10 1 1 0 0 1\nfoo bar\n")))
+    (assert-equal '(10 . -20) (text-anchor t))
+    (assert-equal "foo bar" (text-string t))))
+
+(begin-test 'parse-fields-circle
+  (let ((c (parse-first "V 500 -500 250 3 0 0 0 -1 -1 0 -1 -1 -1 -1 -1\n")))
+    (assert-equal '(500 . -500) (circle-center c))
+    (assert-equal 250 (circle-radius c))))
+
+(begin-test 'parse-fields-missing
+  (assert-thrown 'string-format (parse-first "L 0 0 1000\n")))
+
+(begin-test 'parse-fields-garbage
+  (assert-thrown 'string-format (parse-first "L 0 0 x 0 3 0 0 0 -1 -1\n")))
@@ -25,6 +25,7 @@
 #include <version.h>
 
 #include <stdio.h>
+#include <stdarg.h>
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
@@ -241,6 +242,70 @@ int o_save (TOPLEVEL *toplevel, const GList *object_list,
   return 1;
 }
 
+/*! \brief Parse the type and the numeric fields of an object line
+ *  \par Function Description
+ *  Reads the type character at the start of \a line, followed by up
+ *  to \a n_fields whitespace-separated decimal integers, which are
+ *  stored in the int variables passed as further arguments.  This is
+ *  equivalent to
+ *  \code
+ *  sscanf (line, "%c %d %d ...", type, ...);
+ *  \endcode
+ *  but parses the line in a single pass without interpreting a format
+ *  string, which makes it a lot cheaper when loading large files.
+ *  Values which don't fit into an int are clamped.
+ *
+ *  \param [in]  line      The line to parse.
+ *  \param [out] type      The type character.
+ *  \param [in]  n_fields  The number of integers to read.
+ *  \return The number of items read, counting the type character.
+ */
+int o_read_fields (const char *line, char *type, int n_fields, ...)
+{
+  va_list args;
+  const char *p = line;
+  int n;
+
+  if (*p == '\0') {
+    return 0;
+  }
+  *type = *p++;
+
+  va_start (args, n_fields);
+
+  for (n = 0; n < n_fields; n++) {
+    const char *digits;
+    gboolean negative = FALSE;
+    gint64 value = 0;
+
+    while (g_ascii_isspace (*p)) {
+      p++;
+    }
+    if (*p == '-' || *p == '+') {
+      negative = (*p == '-');
+      p++;
+    }
+
+    for (digits = p; g_ascii_isdigit (*p); p++) {
+      if (value <= (gint64) G_MAXINT + 1) {
+        value = value * 10 + (*p - '0');
+      }
+    }
+    if (p == digits) {
+      break;
+    }
+
+    if (negative) {
+      value = -value;
+    }
+    *va_arg (args, int *) = (int) CLAMP (value, G_MININT, G_MAXINT);
+  }
+
+  va_end (args);
+
+  return n + 1;
+}
+
 /*! \brief Read a memory buffer
  *  \par Function Description
  *  This function reads data in libgeda format from a memory buffer.
@@ -276,6 +341,7 @@ GList *o_read_buffer (TOPLEVEL *toplevel, GList *object_list,
   int found_pin = 0;
   OBJECT* last_complex = NULL;
   int itemsread = 0;
+  int version[2] = { 0, 0 };
 
   int embedded_level = 0;
 
@@ -295,7 +361,7 @@ GList *o_read_buffer (TOPLEVEL *toplevel, GList *object_list,
     line = s_textbuffer_next_line(tb);
     if (line == NULL) break;
 
-    sscanf(line, "%c", &objtype);
+    objtype = line[0];
 
     /* Do we need to check the symbol version?  Yes, but only if */
     /* 1) the last object read was a complex and */
@@ -484,7 +550,10 @@ GList *o_read_buffer (TOPLEVEL *toplevel, GList *object_list,
         break;
 
       case(VERSION_CHAR):
-        itemsread = sscanf(line, "v %u %u\n", &release_ver, &fileformat_ver);
+        /* the number of items read, not counting the 'v' */
+        itemsread = o_read_fields (line, &objtype, 2, &version[0], &version[1]) - 1;
+        release_ver = version[0];
+        fileformat_ver = version[1];
 
         if (itemsread == 0) {
           g_set_error (err, EDA_ERROR, EDA_ERROR_PARSE, "Failed to parse version from buffer.");
@@ -552,7 +621,8 @@ GList *o_read_buffer (TOPLEVEL *toplevel, GList *object_list,
 GList *o_read (TOPLEVEL *toplevel, GList *object_list, char *filename,
                GError **err)
 {
-  char *buffer = NULL;
+  GMappedFile *file;
+  char *buffer;
   size_t size;
   GList *result;
 
@@ -560,12 +630,19 @@ GList *o_read (TOPLEVEL *toplevel, GList *object_list, char *filename,
    * for an error isn't NULL. */
   g_return_val_if_fail (err == NULL || *err == NULL, NULL);
 
-  if (!g_file_get_contents(filename, &buffer, &size, err)) {
+  /* Map the file instead of copying it into memory; the parser works
+   * directly on the mapped pages. */
+  file = g_mapped_file_new (filename, FALSE, err);
+  if (file == NULL) {
     return NULL;
-  } 
+  }
+
+  /* An empty file has no contents to map */
+  size = g_mapped_file_get_length (file);
+  buffer = (size == 0) ? (char *) "" : g_mapped_file_get_contents (file);
 
   /* Parse file contents */
   result = o_read_buffer (toplevel, object_list, buffer, size, filename, err);
-  g_free (buffer);
+  g_mapped_file_unref (file);
   return result;
 }
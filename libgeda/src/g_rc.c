@@ -804,6 +804,26 @@ SCM g_rc_world_size(SCM width, SCM height, SCM border)
 }
 #undef FUNC_NAME
 
+/*! \brief Set the size of the symbol data cache.
+ *  \par Function Description
+ *  Sets the amount of memory, in kilobytes, which the component
+ *  library may use to cache symbol data and parsed symbols.
+ *
+ *  \param [in] size  Cache size in kilobytes.
+ *  \return SCM_BOOL_T always.
+ */
+SCM g_rc_symbol_cache_size(SCM size)
+#define FUNC_NAME "symbol-cache-size"
+{
+  SCM_ASSERT (scm_is_integer (size) && scm_is_true (scm_positive_p (size)),
+              size, SCM_ARG1, FUNC_NAME);
+
+  s_clib_set_symbol_cache_size (scm_to_size_t (size) * 1024);
+
+  return SCM_BOOL_T;
+}
+#undef FUNC_NAME
+
 /*! \brief Add a directory to the Guile load path.
  * \par Function Description
  * Prepends \a s_path to the Guile system '%load-path', after
@@ -52,6 +52,7 @@ static struct gsubr_t libgeda_funcs[] = {
   { "source-library-search",    1, 0, 0, g_rc_source_library_search },
   
   { "world-size",               3, 0, 0, g_rc_world_size },
+  { "symbol-cache-size",        1, 0, 0, g_rc_symbol_cache_size },
   
   { "reset-component-library",  0, 0, 0, g_rc_reset_component_library },
   { "reset-source-library",     0, 0, 0, g_rc_reset_source_library },
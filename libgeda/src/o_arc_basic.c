@@ -199,7 +199,7 @@ void o_arc_modify(TOPLEVEL *toplevel, OBJECT *object,
 	}
 
 	/* update the screen coords and the bounding box */
-	object->w_bounds_valid_for = NULL;
+	o_bounds_invalidate (toplevel, object);
 	o_emit_change_notify (toplevel, object);
 }
 
@@ -249,8 +249,8 @@ OBJECT *o_arc_read (TOPLEVEL *toplevel, const char buf[],
    *  restrictive - the oldest - file format are set to common values
    */
   if(release_ver <= VERSION_20000704) {
-    if (sscanf(buf, "%c %d %d %d %d %d %d", &type,
-	       &x1, &y1, &radius, &start_angle, &sweep_angle, &color) != 7) {
+    if (o_read_fields (buf, &type, 6,
+                       &x1, &y1, &radius, &start_angle, &sweep_angle, &color) != 7) {
       g_set_error (err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse arc object"));
       return NULL;
     }
@@ -261,9 +261,9 @@ OBJECT *o_arc_read (TOPLEVEL *toplevel, const char buf[],
     arc_space = -1;
     arc_length= -1;
   } else {
-    if (sscanf(buf, "%c %d %d %d %d %d %d %d %d %d %d %d", &type,
-	       &x1, &y1, &radius, &start_angle, &sweep_angle, &color,
-	       &arc_width, &arc_end, &arc_type, &arc_length, &arc_space) != 12) {
+    if (o_read_fields (buf, &type, 11,
+                       &x1, &y1, &radius, &start_angle, &sweep_angle, &color,
+                       &arc_width, &arc_end, &arc_type, &arc_length, &arc_space) != 12) {
       g_set_error (err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse arc object"));
       return NULL;
     }
@@ -360,7 +360,7 @@ void o_arc_translate_world(OBJECT *object, int dx, int dy)
 
 
   /* Recalculate screen coords from new world coords */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief
@@ -416,7 +416,7 @@ void o_arc_rotate_world(TOPLEVEL *toplevel,
   object->arc->y += world_centery;
 
   /* update the screen coords and the bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   
 }                                   
 
@@ -460,7 +460,7 @@ void o_arc_mirror_world(TOPLEVEL *toplevel,
   object->arc->x += world_centerx;
 
   /* update the screen coords and bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
 	
 }
 
@@ -65,6 +65,9 @@ void o_attrib_add(TOPLEVEL *toplevel, OBJECT *object, OBJECT *item)
   /* Add link from item to attrib listing */
   item->attached_to = object;
   object->attribs = g_list_append (object->attribs, item);
+
+  /* item is no longer floating */
+  o_attrib_invalidate_index (item->parent);
 }
 
 
@@ -123,7 +126,9 @@ void o_attrib_attach (TOPLEVEL *toplevel, OBJECT *attrib, OBJECT *object,
     return;
   }
 
+  o_emit_pre_change_notify (toplevel, attrib);
   o_attrib_add (toplevel, object, attrib);
+  o_emit_change_notify (toplevel, attrib);
 
   if (set_color)
     o_set_color (toplevel, attrib, ATTRIBUTE_COLOR);
@@ -165,7 +170,10 @@ void o_attrib_detach_all(TOPLEVEL *toplevel, OBJECT *object)
        a_iter = g_list_next (a_iter)) {
     a_current = a_iter->data;
 
+    o_emit_pre_change_notify (toplevel, a_current);
     a_current->attached_to = NULL;
+    o_attrib_invalidate_index (a_current->parent);
+    o_emit_change_notify (toplevel, a_current);
     o_set_color (toplevel, a_current, DETACHED_ATTRIBUTE_COLOR);
   }
 
@@ -211,9 +219,14 @@ void o_attrib_remove(TOPLEVEL *toplevel, GList **list, OBJECT *remove)
 {
   g_return_if_fail (remove != NULL);
 
+  o_emit_pre_change_notify (toplevel, remove);
+
   remove->attached_to = NULL;
+  o_attrib_invalidate_index (remove->parent);
 
   *list = g_list_remove (*list, remove);
+
+  o_emit_change_notify (toplevel, remove);
 }
 
 /*! \brief Read attributes from a buffer.
@@ -243,7 +256,7 @@ GList *o_read_attribs (TOPLEVEL *toplevel,
     line = s_textbuffer_next_line (tb);
     if (line == NULL) break;
 
-    sscanf(line, "%c", &objtype);
+    objtype = line[0];
     switch (objtype) {
 
       case(OBJ_LINE):
@@ -413,6 +426,132 @@ o_attrib_get_name_value (OBJECT *attrib, gchar **name_ptr, gchar **value_ptr)
 }
 
 
+/*! \brief Get the interned name of an attribute string.
+ *  \par Function Description
+ *  Splits \a string the same way as o_attrib_string_get_name_value()
+ *  and returns the name as a GQuark.  This is used to cache the name
+ *  of text objects in TEXT::attrib_name whenever their string changes,
+ *  so attribute lookups can compare names without splitting and
+ *  copying the string each time.
+ *
+ *  \param [in] string  String to split into name/value pair.
+ *  \return The quark for the attribute name, or 0 if \a string is
+ *           not a valid attribute.
+ */
+GQuark
+o_attrib_string_get_name_quark (const gchar *string)
+{
+  gchar *name;
+  GQuark quark;
+
+  if (!o_attrib_string_get_name_value (string, &name, NULL))
+    return 0;
+
+  quark = g_quark_from_string (name);
+  g_free (name);
+
+  return quark;
+}
+
+
+/*! \brief Discard the inherited attribute index of a complex OBJECT.
+ *  \par Function Description
+ *  The index is rebuilt from the complex's prim_objs the next time an
+ *  inherited attribute is looked up.  This must be called whenever an
+ *  object is added to or removed from prim_objs, or when a primitive
+ *  text object changes its name or stops or starts being floating.
+ *
+ *  The complex's slot table is derived from the same objects and is
+ *  discarded as well.
+ *
+ *  \param [in] object  The complex OBJECT, or NULL.
+ */
+void
+o_attrib_invalidate_index (OBJECT *object)
+{
+  if (object == NULL || object->complex == NULL)
+    return;
+
+  if (object->complex->attrib_index != NULL) {
+    g_hash_table_destroy (object->complex->attrib_index);
+    object->complex->attrib_index = NULL;
+  }
+
+  s_slot_invalidate (object);
+}
+
+
+/*! \brief Get the inherited attributes of a complex with a given name.
+ *  \par Function Description
+ *  Looks up \a quark in the complex's attribute index, building the
+ *  index first if necessary.  The index maps each attribute name to
+ *  an array of the floating attributes in prim_objs which have that
+ *  name, in list order.
+ *
+ *  \param [in] object  The complex OBJECT whose attributes to search.
+ *  \param [in] quark   The interned attribute name.
+ *  \return A GPtrArray owned by the index, or NULL if there is no
+ *           such attribute.
+ */
+static GPtrArray *
+o_attrib_get_inherited_by_quark (OBJECT *object, GQuark quark)
+{
+  COMPLEX *complex = object->complex;
+  const GList *iter;
+
+  if (complex->attrib_index == NULL) {
+    complex->attrib_index =
+      g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                             NULL, (GDestroyNotify) g_ptr_array_unref);
+
+    for (iter = complex->prim_objs; iter != NULL; iter = g_list_next (iter)) {
+      OBJECT *o_current = iter->data;
+      GPtrArray *attribs;
+
+      if (o_current->type != OBJ_TEXT ||
+          o_current->attached_to != NULL ||
+          o_current->text->attrib_name == 0)
+        continue;
+
+      attribs = g_hash_table_lookup (
+        complex->attrib_index,
+        GUINT_TO_POINTER (o_current->text->attrib_name));
+      if (attribs == NULL) {
+        attribs = g_ptr_array_new ();
+        g_hash_table_insert (complex->attrib_index,
+                             GUINT_TO_POINTER (o_current->text->attrib_name),
+                             attribs);
+      }
+      g_ptr_array_add (attribs, o_current);
+    }
+  }
+
+  return g_hash_table_lookup (complex->attrib_index, GUINT_TO_POINTER (quark));
+}
+
+
+/*! \brief Find the n'th inherited attribute of a complex with a given name.
+ *  \par Function Description
+ *  Counter is the n'th occurance of the attribute, and starts searching
+ *  from zero.
+ *
+ *  \param [in] object  The complex OBJECT whose attributes to search.
+ *  \param [in] quark   The interned attribute name.
+ *  \param [in] count   Which occurance to return.
+ *  \return The attribute OBJECT, or NULL if there is no such attribute.
+ */
+static OBJECT *
+o_attrib_find_inherited_by_quark (OBJECT *object, GQuark quark, int count)
+{
+  GPtrArray *attribs = o_attrib_get_inherited_by_quark (object, quark);
+
+  if (attribs == NULL || count < 0 || (guint) count >= attribs->len)
+    return NULL;
+
+  return g_ptr_array_index (attribs, count);
+}
+
+
 /*! \brief Find all floating attributes in the given object list.
  *  \par Function Description
  *  Find all floating attributes in the given object list.
@@ -437,7 +576,7 @@ GList *o_attrib_find_floating_attribs (const GList *list)
      */
     if (o_current->type == OBJ_TEXT &&
         o_current->attached_to == NULL &&
-        o_attrib_get_name_value (o_current, NULL, NULL)) {
+        o_current->text->attrib_name != 0) {
 
       floating_attributes = g_list_prepend (floating_attributes, o_current);
     }
@@ -463,26 +602,25 @@ OBJECT *o_attrib_find_attrib_by_name (const GList *list, char *name, int count)
 {
   OBJECT *a_current;
   const GList *iter;
-  char *found_name;
+  GQuark quark;
   int internal_counter = 0;
 
+  /* If the name has never been interned, no attribute can have it. */
+  quark = g_quark_try_string (name);
+  if (quark == 0)
+    return NULL;
+
   for (iter = list; iter != NULL; iter = g_list_next (iter)) {
     a_current = iter->data;
 
     g_return_val_if_fail (a_current->type == OBJ_TEXT, NULL);
 
-    if (!o_attrib_get_name_value (a_current, &found_name, NULL))
+    if (a_current->text->attrib_name != quark)
       continue;
 
-    if (strcmp (name, found_name) == 0) {
-      if (internal_counter == count) {
-        g_free (found_name);
-        return a_current;
-      }
-      internal_counter++;
-    }
-
-    g_free (found_name);
+    if (internal_counter == count)
+      return a_current;
+    internal_counter++;
   }
 
   return NULL;
@@ -532,14 +670,32 @@ static char *o_attrib_search_attrib_list_by_name (const GList *list, char *name,
  */
 char *o_attrib_search_floating_attribs_by_name (const GList *list, char *name, int counter)
 {
-  char *result;
-  GList *attributes;
+  OBJECT *o_current;
+  const GList *iter;
+  GQuark quark;
+  char *value = NULL;
+  int internal_counter = 0;
+
+  quark = g_quark_try_string (name);
+  if (quark == 0)
+    return NULL;
+
+  for (iter = list; iter != NULL; iter = g_list_next (iter)) {
+    o_current = iter->data;
+
+    if (o_current->type != OBJ_TEXT ||
+        o_current->attached_to != NULL ||
+        o_current->text->attrib_name != quark)
+      continue;
 
-  attributes = o_attrib_find_floating_attribs (list);
-  result = o_attrib_search_attrib_list_by_name (attributes, name, counter);
-  g_list_free (attributes);
+    if (internal_counter == counter) {
+      o_attrib_get_name_value (o_current, NULL, &value);
+      break;
+    }
+    internal_counter++;
+  }
 
-  return result;
+  return value;
 }
 
 
@@ -581,10 +737,22 @@ char *o_attrib_search_attached_attribs_by_name (OBJECT *object, char *name, int
  */
 char *o_attrib_search_inherited_attribs_by_name (OBJECT *object, char *name, int counter)
 {
+  OBJECT *attrib;
+  GQuark quark;
+  char *value = NULL;
+
   g_return_val_if_fail (object->type == OBJ_COMPLEX ||
                         object->type == OBJ_PLACEHOLDER, NULL);
 
-  return o_attrib_search_floating_attribs_by_name (object->complex->prim_objs, name, counter);
+  quark = g_quark_try_string (name);
+  if (quark == 0)
+    return NULL;
+
+  attrib = o_attrib_find_inherited_by_quark (object, quark, counter);
+  if (attrib != NULL)
+    o_attrib_get_name_value (attrib, NULL, &value);
+
+  return value;
 }
 
 
@@ -605,14 +773,67 @@ char *o_attrib_search_inherited_attribs_by_name (OBJECT *object, char *name, int
  */
 char *o_attrib_search_object_attribs_by_name (OBJECT *object, char *name, int counter)
 {
-  char *result;
-  GList *attributes;
+  OBJECT *attrib;
+  char *value = NULL;
+
+  attrib = o_attrib_find_object_attrib_by_name (object, name, counter);
+
+  if (attrib != NULL)
+    o_attrib_get_name_value (attrib, NULL, &value);
+
+  return value;
+}
+
+
+/*! \brief Find an attribute of an object by name.
+ *  \par Function Description
+ *  Search the attached and inherited attributes of \a object, in
+ *  the same order as o_attrib_return_attribs(), for an attribute
+ *  with the given name.
+ *
+ *  Counter is the n'th occurance of the attribute, and starts searching
+ *  from zero.  Zero is the first occurance of an attribute.
+ *
+ *  \param [in] object   OBJECT who's attributes to search.
+ *  \param [in] name     Character string with attribute name to search for.
+ *  \param [in] counter  Which occurance to return.
+ *  \return The attribute OBJECT, or NULL if there is no such attribute.
+ */
+OBJECT *o_attrib_find_object_attrib_by_name (OBJECT *object, char *name, int counter)
+{
+  OBJECT *a_current;
+  OBJECT *attrib = NULL;
+  GList *a_iter;
+  GQuark quark;
+
+  g_return_val_if_fail (object != NULL, NULL);
+
+  quark = g_quark_try_string (name);
+  if (quark == 0)
+    return NULL;
+
+  /* Directly attached attributes come first... */
+  for (a_iter = object->attribs; a_iter != NULL;
+       a_iter = g_list_next (a_iter)) {
+    a_current = a_iter->data;
+
+    if (a_current->type != OBJ_TEXT ||
+        a_current->text->attrib_name != quark)
+      continue;
+
+    if (counter == 0) {
+      attrib = a_current;
+      break;
+    }
+    counter--;
+  }
 
-  attributes = o_attrib_return_attribs (object);
-  result = o_attrib_search_attrib_list_by_name (attributes, name, counter);
-  g_list_free (attributes);
+  /* ...followed by inherited attributes */
+  if (attrib == NULL && (object->type == OBJ_COMPLEX ||
+                         object->type == OBJ_PLACEHOLDER))
+    attrib = o_attrib_find_inherited_by_quark (object, quark, counter);
 
-  return result;
+  return attrib;
 }
 
 
@@ -648,7 +869,7 @@ GList * o_attrib_return_attribs (OBJECT *object)
       continue;
 
     /* Don't add invalid attributes to the list */
-    if (!o_attrib_get_name_value (a_current, NULL, NULL))
+    if (a_current->text->attrib_name == 0)
       continue;
 
     attribs = g_list_prepend (attribs, a_current);
@@ -138,7 +138,7 @@ void o_set_line_options(TOPLEVEL *toplevel, OBJECT *o_current,
   o_current->line_space  = space;
 
   /* Recalculate the object's bounding box */
-  o_current->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, o_current);
   o_emit_change_notify (toplevel, o_current);
 
 }
@@ -342,6 +342,24 @@ gboolean o_get_position (OBJECT *object, gint *x, gint *y)
 }
 
 
+/*! \brief Get the TOPLEVEL to emit change notifications with.
+ *  \par Function Description
+ *  The transformation functions don't take a TOPLEVEL (or may be
+ *  passed NULL), so use the one of the page the object is on.
+ *  Objects inside a complex object are changed as part of their
+ *  parent and don't emit notifications of their own.
+ *
+ *  \return The page's TOPLEVEL, or NULL if there is nobody to notify.
+ */
+static TOPLEVEL *o_get_page_toplevel (OBJECT *object)
+{
+  if (object->parent != NULL || object->page == NULL) {
+    return NULL;
+  }
+  return object->page->toplevel;
+}
+
+
 /*! \brief Translates an object in world coordinates
  *  \par Function Description
  *  This function translates the object <B>object</B> by
@@ -374,7 +392,11 @@ void o_translate_world (OBJECT *object, gint dx, gint dy)
   }
 
   if (func != NULL) {
+    TOPLEVEL *page_toplevel = o_get_page_toplevel (object);
+
+    o_emit_pre_change_notify (page_toplevel, object);
     (*func) (object, dx, dy);
+    o_emit_change_notify (page_toplevel, object);
   }
 }
 
@@ -413,7 +435,11 @@ void o_rotate_world (TOPLEVEL *toplevel, int world_centerx, int world_centery, i
   }
 
   if (func != NULL) {
+    TOPLEVEL *page_toplevel = o_get_page_toplevel (object);
+
+    o_emit_pre_change_notify (page_toplevel, object);
     (*func) (toplevel, world_centerx, world_centery, angle, object);
+    o_emit_change_notify (page_toplevel, object);
   }
 }
 
@@ -451,7 +477,11 @@ void o_mirror_world (TOPLEVEL *toplevel, int world_centerx, int world_centery, O
   }
 
   if (func != NULL) {
+    TOPLEVEL *page_toplevel = o_get_page_toplevel (object);
+
+    o_emit_pre_change_notify (page_toplevel, object);
     (*func) (toplevel, world_centerx, world_centery, object);
+    o_emit_change_notify (page_toplevel, object);
   }
 }
 
@@ -525,19 +555,32 @@ double o_shortest_distance_full (TOPLEVEL *toplevel, OBJECT *object,
  *  parents as having been invalidated and in need of an update. They
  *  will be recalculated next time the OBJECT's bounds are requested
  *  (e.g. via world_get_single_object_bounds() ).
+ *
+ *  If the object is on a page, the page's spatial index is told to
+ *  re-index it, and it is indexed again under its current coordinates
+ *  for connection lookups.  So functions which change an object's
+ *  bounds must use this function instead of resetting
+ *  w_bounds_valid_for.
+ *
  *  \param [in] toplevel
  *  \param [in] object
- *
- *  \todo Turn this into a macro?
  */
 void o_bounds_invalidate (TOPLEVEL *toplevel, OBJECT *object)
 {
   OBJECT *iter = object;
+  OBJECT *top = object;
 
   while (iter != NULL) {
     iter->w_bounds_valid_for = NULL;
+    top = iter;
     iter = iter->parent;
   }
+
+  /* Let the page know it has to re-index the object */
+  if (top != NULL && top->page != NULL) {
+    s_page_index_invalidate (top->page, top);
+    s_conn_reindex_object (top->page, object);
+  }
 }
 
 
@@ -554,11 +597,15 @@ void o_set_color (TOPLEVEL *toplevel, OBJECT *object, int color)
 {
   g_return_if_fail (object != NULL);
 
+  o_emit_pre_change_notify (toplevel, object);
+
   object->color = color;
 
   if (object->type == OBJ_COMPLEX ||
       object->type == OBJ_PLACEHOLDER)
     o_glist_set_color (toplevel, object->complex->prim_objs, color);
+
+  o_emit_change_notify (toplevel, object);
 }
 
 
@@ -692,6 +739,12 @@ void
 o_emit_pre_change_notify (TOPLEVEL *toplevel, OBJECT *object)
 {
   GList *iter;
+
+  /* objects which don't belong to a TOPLEVEL have nobody to notify */
+  if (toplevel == NULL) {
+    return;
+  }
+
   for (iter = toplevel->change_notify_funcs;
        iter != NULL; iter = g_list_next (iter)) {
 
@@ -718,6 +771,12 @@ void
 o_emit_change_notify (TOPLEVEL *toplevel, OBJECT *object)
 {
   GList *iter;
+
+  /* objects which don't belong to a TOPLEVEL have nobody to notify */
+  if (toplevel == NULL) {
+    return;
+  }
+
   for (iter = toplevel->change_notify_funcs;
        iter != NULL; iter = g_list_next (iter)) {
 
@@ -758,7 +817,9 @@ o_set_visibility (TOPLEVEL *toplevel, OBJECT *object, int visibility)
 {
   g_return_if_fail (object != NULL);
   if (object->visibility != visibility) {
+    o_emit_pre_change_notify (toplevel, object);
     object->visibility = visibility;
     o_bounds_invalidate (toplevel, object);
+    o_emit_change_notify (toplevel, object);
   }
 }
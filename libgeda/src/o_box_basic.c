@@ -153,7 +153,7 @@ o_box_modify_all (TOPLEVEL *toplevel, OBJECT *object,
   object->box->upper_y = (y1 > y2) ? y1 : y2;
 
   /* recalculate the world coords and bounds */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   o_emit_change_notify (toplevel, object);
 }
 
@@ -228,7 +228,7 @@ void o_box_modify(TOPLEVEL *toplevel, OBJECT *object,
 	}
 	
 	/* recalculate the world coords and the boundings */
-	object->w_bounds_valid_for = NULL;
+	o_bounds_invalidate (toplevel, object);
 	o_emit_change_notify (toplevel, object);
   
 }
@@ -275,8 +275,8 @@ OBJECT *o_box_read (TOPLEVEL *toplevel, const char buf[],
    *  to default.
    */
 
-    if (sscanf (buf, "%c %d %d %d %d %d\n",
-		&type, &x1, &y1, &width, &height, &color) != 6) {
+    if (o_read_fields (buf, &type, 5,
+                       &x1, &y1, &width, &height, &color) != 6) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse box object"));
       return NULL;
     }
@@ -301,11 +301,11 @@ OBJECT *o_box_read (TOPLEVEL *toplevel, const char buf[],
      *  characters and numbers in plain ASCII on a single line. The meaning of
      *  each item is described in the file format documentation.
      */
-    if (sscanf (buf, "%c %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
-		&type, &x1, &y1, &width, &height, &color,
-		&box_width, &box_end, &box_type, &box_length,
-		&box_space, &box_filling,
-		&fill_width, &angle1, &pitch1, &angle2, &pitch2) != 17) {
+    if (o_read_fields (buf, &type, 16,
+                       &x1, &y1, &width, &height, &color,
+                       &box_width, &box_end, &box_type, &box_length,
+                       &box_space, &box_filling,
+                       &fill_width, &angle1, &pitch1, &angle2, &pitch2) != 17) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse box object"));
       return NULL;
     }
@@ -443,7 +443,7 @@ void o_box_translate_world(OBJECT *object, int dx, int dy)
   object->box->lower_y = object->box->lower_y + dy;
 
   /* recalc the screen coords and the bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief Rotate BOX OBJECT using WORLD coordinates. 
@@ -513,7 +513,7 @@ void o_box_rotate_world(TOPLEVEL *toplevel,
   object->box->lower_y += world_centery;
   
   /* recalc boundings and world coords */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
 }
 
 /*! \brief Mirror BOX using WORLD coordinates.
@@ -565,7 +565,7 @@ void o_box_mirror_world(TOPLEVEL *toplevel,
   object->box->lower_y += world_centery;
 
   /* recalc boundings and world coords */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   
 }
 
@@ -132,14 +132,14 @@ OBJECT *o_bus_read (TOPLEVEL *toplevel, const char buf[],
   int ripper_dir;
 
   if (release_ver <= VERSION_20020825) {
-    if (sscanf (buf, "%c %d %d %d %d %d\n", &type, &x1, &y1, &x2, &y2, &color) != 6) {
+    if (o_read_fields (buf, &type, 5, &x1, &y1, &x2, &y2, &color) != 6) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse bus object"));
       return NULL;
     }
     ripper_dir = 0;
   } else {
-    if (sscanf (buf, "%c %d %d %d %d %d %d\n", &type, &x1, &y1, &x2, &y2, &color,
-		&ripper_dir) != 7) {
+    if (o_read_fields (buf, &type, 6, &x1, &y1, &x2, &y2, &color,
+                       &ripper_dir) != 7) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse bus object"));
       return NULL;
     }
@@ -212,7 +212,7 @@ void o_bus_translate_world(OBJECT *object, int dx, int dy)
   object->line->y[1] = object->line->y[1] + dy;
 
   /* Update bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief create a copy of a bus object
@@ -359,8 +359,11 @@ void o_bus_modify(TOPLEVEL *toplevel, OBJECT *object,
   g_return_if_fail (whichone >= LINE_END1);
   g_return_if_fail (whichone <= LINE_END2);
 
+  o_emit_pre_change_notify (toplevel, object);
+
   object->line->x[whichone] = x;
   object->line->y[whichone] = y;
 
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
+  o_emit_change_notify (toplevel, object);
 }
@@ -169,7 +169,7 @@ void o_circle_modify(TOPLEVEL *toplevel, OBJECT *object,
   }
 
   /* recalculate the boundings */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   o_emit_change_notify (toplevel, object);
 }
 
@@ -211,7 +211,7 @@ OBJECT *o_circle_read (TOPLEVEL *toplevel, const char buf[],
      * handle the line type and the filling of the box object. They are set
      * to default.
      */
-    if (sscanf(buf, "%c %d %d %d %d\n", &type, &x1, &y1, &radius, &color) != 5) {
+    if (o_read_fields (buf, &type, 4, &x1, &y1, &radius, &color) != 5) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse circle object"));
       return NULL;
     }
@@ -236,11 +236,11 @@ OBJECT *o_circle_read (TOPLEVEL *toplevel, const char buf[],
      * list of characters and numbers in plain ASCII on a single line. The
      * meaning of each item is described in the file format documentation.
      */  
-    if (sscanf(buf, "%c %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
-	       &type, &x1, &y1, &radius, &color,
-	       &circle_width, &circle_end, &circle_type,
-	       &circle_length, &circle_space, &circle_fill,
-	       &fill_width, &angle1, &pitch1, &angle2, &pitch2) != 16) {
+    if (o_read_fields (buf, &type, 15,
+                       &x1, &y1, &radius, &color,
+                       &circle_width, &circle_end, &circle_type,
+                       &circle_length, &circle_space, &circle_fill,
+                       &fill_width, &angle1, &pitch1, &angle2, &pitch2) != 16) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse circle object"));
       return NULL;
     }
@@ -336,7 +336,7 @@ void o_circle_translate_world(OBJECT *object, int dx, int dy)
   object->circle->center_y = object->circle->center_y + dy;
   
   /* recalc the screen coords and the bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
   
 }
 
@@ -392,7 +392,7 @@ void o_circle_rotate_world(TOPLEVEL *toplevel,
   object->circle->center_x += world_centerx;
   object->circle->center_y += world_centery;
 
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   
 }
 
@@ -427,7 +427,7 @@ void o_circle_mirror_world(TOPLEVEL *toplevel,
   object->circle->center_x += world_centerx;
 
   /* recalc boundings and screen coords */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   
 }
 
@@ -37,7 +37,6 @@
 
 #include "libgeda_priv.h"
 
-
 /*! \brief Return the bounds of the given object.
  *  \par Given an object, calculate the bounds coordinates.
  *  \param [in] toplevel The toplevel structure.
@@ -382,6 +381,7 @@ GList *o_complex_get_promotable (TOPLEVEL *toplevel, OBJECT *object, int detach)
       tmp->parent = NULL;
       object->complex->prim_objs =
         g_list_remove (object->complex->prim_objs, tmp);
+      o_attrib_invalidate_index (object);
     }
 
     promoted = g_list_prepend (promoted, tmp);
@@ -430,6 +430,7 @@ GList *o_complex_promote_attribs (TOPLEVEL *toplevel, OBJECT *object)
       object->complex->prim_objs =
         g_list_remove (object->complex->prim_objs, o_removed);
     }
+    o_attrib_invalidate_index (object);
     promoted = promotable;
     /* Invalidate the object's bounds since we may have
      * stolen objects from inside it. */
@@ -478,6 +479,7 @@ static void o_complex_remove_promotable_attribs (TOPLEVEL *toplevel, OBJECT *obj
     }
   }
 
+  o_attrib_invalidate_index (object);
   o_bounds_invalidate (toplevel, object);
   g_list_free (promotable);
 }
@@ -562,9 +564,54 @@ static void create_placeholder(TOPLEVEL * toplevel, OBJECT * new_node, int x, in
     new_node->complex->prim_objs = g_list_reverse(new_node->complex->prim_objs);
 }
 
+/*! \brief Copy the prototype objects of a symbol.
+ *  \par Function Description
+ *  Creates copies of the objects in \a prototype, keeping their order
+ *  and the attachment of attributes to objects within the list.  Each
+ *  copy gets a new sid.
+ *
+ *  \param [in] toplevel   The TOPLEVEL object.
+ *  \param [in] prototype  The objects of a prototype returned by
+ *                         s_clib_symbol_get_prototype().
+ *  \return A newly allocated list of copies.
+ */
+static GList *copy_prototype (TOPLEVEL *toplevel, const GList *prototype)
+{
+  const GList *iter;
+  GList *result = NULL;
+  OBJECT *src_object, *dst_object;
+
+  for (iter = prototype; iter != NULL; iter = g_list_next (iter)) {
+    src_object = iter->data;
+    dst_object = o_object_copy (toplevel, src_object);
+    dst_object->sid = global_sid++;
+    result = g_list_prepend (result, dst_object);
+  }
+
+  /* o_object_copy() has set copied_to for every prototype object */
+  for (iter = prototype; iter != NULL; iter = g_list_next (iter)) {
+    src_object = iter->data;
+    if (src_object->attached_to != NULL)
+      o_attrib_attach (toplevel, src_object->copied_to,
+                       src_object->attached_to->copied_to, FALSE);
+  }
+
+  /* Don't leave pointers to this instance in the cached prototype */
+  for (iter = prototype; iter != NULL; iter = g_list_next (iter)) {
+    src_object = iter->data;
+    src_object->copied_to = NULL;
+  }
+
+  return g_list_reverse (result);
+}
+
 /* Done */
 /*! \brief
  *  \par Function Description
+ *  Creates a new complex object.  If the symbol \a clib can be loaded,
+ *  its objects are copied from the prototype kept by the component
+ *  library, so the symbol data is only parsed once no matter how many
+ *  times the symbol is placed.  Otherwise, a placeholder is created.
  *
  */
 OBJECT *o_complex_new(TOPLEVEL *toplevel,
@@ -576,7 +623,8 @@ OBJECT *o_complex_new(TOPLEVEL *toplevel,
 {
   OBJECT *new_node=NULL;
   GList *iter;
-  gchar *buffer = NULL;
+  CLibPrototype *prototype = NULL;
+  GError *err = NULL;
 
   new_node = s_basic_new_object(type, "complex");
 
@@ -593,39 +641,35 @@ OBJECT *o_complex_new(TOPLEVEL *toplevel,
 
   new_node->complex = (COMPLEX *) g_malloc(sizeof(COMPLEX));
   new_node->complex->prim_objs = NULL;
+  new_node->complex->attrib_index = NULL;
+  new_node->complex->slot_table = NULL;
   new_node->complex->angle = angle;
   new_node->complex->mirror = mirror;
   new_node->complex->x = x;
   new_node->complex->y = y;
 
-  /* get the symbol data */
+  /* get the symbol's prototype objects */
   if (clib != NULL) {
-    buffer = s_clib_symbol_get_data (clib);
+    prototype = s_clib_symbol_get_prototype (toplevel, clib, &err);
   }
 
-  if (clib == NULL || buffer == NULL)
+  if (prototype == NULL) {
+    if (err != NULL)
+      g_error_free (err);
+    /* If reading fails, replace with placeholder object */
     create_placeholder(toplevel, new_node, x, y);
-  else {
-    GError * err = NULL;
-
+  } else {
     /* add connections till translated */
-    new_node->complex->prim_objs = o_read_buffer (toplevel, NULL, buffer, -1, new_node->complex_basename, &err);
-    if (err) {
-      g_error_free(err);
-      /* If reading fails, replace with placeholder object */
-      create_placeholder(toplevel, new_node, x, y);
-    }
-    else {
-      if (mirror) {
-        o_glist_mirror_world (toplevel, 0, 0, new_node->complex->prim_objs);
-      }
-      
-      o_glist_rotate_world (toplevel, 0, 0, angle, new_node->complex->prim_objs);
-      o_glist_translate_world (new_node->complex->prim_objs, x, y);
-    }
+    new_node->complex->prim_objs = copy_prototype (toplevel,
+                                                   prototype->objects);
+    s_clib_prototype_unref (prototype);
 
-    g_free (buffer);
+    if (mirror) {
+      o_glist_mirror_world (toplevel, 0, 0, new_node->complex->prim_objs);
+    }
 
+    o_glist_rotate_world (toplevel, 0, 0, angle, new_node->complex->prim_objs);
+    o_glist_translate_world (new_node->complex->prim_objs, x, y);
   }
 
   /* set the parent field now */
@@ -677,6 +721,8 @@ OBJECT *o_complex_new_embedded(TOPLEVEL *toplevel,
   new_node->selectable = selectable;
 
   new_node->complex->prim_objs = NULL;
+  new_node->complex->attrib_index = NULL;
+  new_node->complex->slot_table = NULL;
 
   /* don't have to translate/rotate/mirror here at all since the */
   /* object is in place */
@@ -704,17 +750,34 @@ OBJECT *o_complex_read (TOPLEVEL *toplevel,
   int x1, y1;
   int angle;
 
-  char *basename = g_malloc (1 + strlen (buf));
+  char *basename;
+  const char *p, *end;
+  int i;
 
   int selectable;
   int mirror;
 
-  if (sscanf(buf, "%c %d %d %d %d %d %s\n",
-	     &type, &x1, &y1, &selectable, &angle, &mirror, basename) != 7) {
+  if (o_read_fields (buf, &type, 5,
+                     &x1, &y1, &selectable, &angle, &mirror) != 6) {
     g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse complex object"));
     return NULL;
   }
 
+  /* the symbol name is the word after the numeric fields */
+  p = buf + 1;
+  for (i = 0; i < 5; i++) {
+    while (g_ascii_isspace (*p)) p++;
+    while (*p != '\0' && !g_ascii_isspace (*p)) p++;
+  }
+  while (g_ascii_isspace (*p)) p++;
+  for (end = p; *end != '\0' && !g_ascii_isspace (*end); end++);
+
+  if (end == p) {
+    g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse complex object"));
+    return NULL;
+  }
+  basename = g_strndup (p, end - p);
+
   switch(angle) {
 
     case(0):
@@ -826,7 +889,7 @@ void o_complex_translate_world(OBJECT *object, int dx, int dy)
 
   o_glist_translate_world (object->complex->prim_objs, dx, dy);
 
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief Create a copy of a COMPLEX object
@@ -986,8 +1049,7 @@ OBJECT *o_complex_find_pin_by_attribute (OBJECT *object, char *name, char *wante
 {
   GList *iter;
   OBJECT *o_current;
-  char *value;
-  int found;
+  OBJECT *attrib;
 
   g_return_val_if_fail (object != NULL, NULL);
   g_return_val_if_fail (object->type == OBJ_COMPLEX ||
@@ -1000,11 +1062,10 @@ OBJECT *o_complex_find_pin_by_attribute (OBJECT *object, char *name, char *wante
     if (o_current->type != OBJ_PIN)
       continue;
 
-    value = o_attrib_search_object_attribs_by_name (o_current, name, 0);
-    found = (value != NULL && strcmp (value, wanted_value) == 0);
-    g_free (value);
-
-    if (found)
+    /* compare the value in place rather than copying it */
+    attrib = o_attrib_find_object_attrib_by_name (o_current, name, 0);
+    if (attrib != NULL &&
+        strcmp (strchr (attrib->text->string, '=') + 1, wanted_value) == 0)
       return o_current;
   }
 
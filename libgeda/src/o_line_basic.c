@@ -172,7 +172,7 @@ void o_line_modify(TOPLEVEL *toplevel, OBJECT *object,
   }
 
   /* recalculate the bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   o_emit_change_notify (toplevel, object);
 }
 
@@ -215,8 +215,8 @@ OBJECT *o_line_read (TOPLEVEL *toplevel, const char buf[],
      * not handle the line type and the filling - here filling is irrelevant.
      * They are set to default.
      */
-    if (sscanf (buf, "%c %d %d %d %d %d\n", &type,
-		&x1, &y1, &x2, &y2, &color) != 6) {
+    if (o_read_fields (buf, &type, 5,
+                       &x1, &y1, &x2, &y2, &color) != 6) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse line object"));
       return NULL;
     }
@@ -232,9 +232,9 @@ OBJECT *o_line_read (TOPLEVEL *toplevel, const char buf[],
      * list of characters and numbers in plain ASCII on a single line.
      * The meaning of each item is described in the file format documentation.
      */
-      if (sscanf (buf, "%c %d %d %d %d %d %d %d %d %d %d\n", &type,
-		  &x1, &y1, &x2, &y2, &color,
-		  &line_width, &line_end, &line_type, &line_length, &line_space) != 11) {
+      if (o_read_fields (buf, &type, 10,
+                         &x1, &y1, &x2, &y2, &color,
+                         &line_width, &line_end, &line_type, &line_length, &line_space) != 11) {
         g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse line object"));
         return NULL;
       }
@@ -331,7 +331,7 @@ void o_line_translate_world(OBJECT *object, int dx, int dy)
   object->line->y[1] = object->line->y[1] + dy;
   
   /* Update bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief Rotate Line OBJECT using WORLD coordinates. 
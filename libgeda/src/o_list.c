@@ -26,9 +26,6 @@
 
 #include "libgeda_priv.h"
 
-/*! global which is used in o_list_copy_all */
-extern int global_sid;
-
 /*! \todo Finish documentation!!!!
  *  \brief
  *  \par Function Description
@@ -128,7 +128,7 @@ OBJECT *o_net_read (TOPLEVEL *toplevel, const char buf[],
   int x2, y2;
   int color;
 
-  if (sscanf (buf, "%c %d %d %d %d %d\n", &type, &x1, &y1, &x2, &y2, &color) != 6) {
+  if (o_read_fields (buf, &type, 5, &x1, &y1, &x2, &y2, &color) != 6) {
         g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse net object"));
     return NULL;
   }
@@ -193,7 +193,7 @@ void o_net_translate_world(OBJECT *object, int dx, int dy)
   object->line->y[1] = object->line->y[1] + dy;
 
   /* Update bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief create a copy of a net object
@@ -486,6 +486,7 @@ static int o_net_consolidate_segments (TOPLEVEL *toplevel, OBJECT *object)
           printf("consolidating %s to %s\n", object->name, other_object->name);
 #endif
 
+          o_emit_pre_change_notify (toplevel, object);
           o_net_consolidate_lowlevel(object, other_object, other_orient);
 
           changed++;
@@ -501,7 +502,8 @@ static int o_net_consolidate_segments (TOPLEVEL *toplevel, OBJECT *object)
           }
 
           s_delete_object (toplevel, other_object);
-          object->w_bounds_valid_for = NULL;
+          o_bounds_invalidate (toplevel, object);
+          o_emit_change_notify (toplevel, object);
           s_conn_update_object (page, object);
           return(-1);
         }
@@ -566,8 +568,11 @@ void o_net_consolidate(TOPLEVEL *toplevel, PAGE *page)
 void o_net_modify(TOPLEVEL *toplevel, OBJECT *object,
 		  int x, int y, int whichone)
 {
+  o_emit_pre_change_notify (toplevel, object);
+
   object->line->x[whichone] = x;
   object->line->y[whichone] = y;
 
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
+  o_emit_change_notify (toplevel, object);
 }
@@ -191,10 +191,10 @@ OBJECT *o_path_read (TOPLEVEL *toplevel,
    * The meaning of each item is described in the file format documentation.
    */
   /* Allocate enough space */
-  if (sscanf (first_line, "%c %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
-	      &type, &color, &line_width, &line_end, &line_type,
-	      &line_length, &line_space, &fill_type, &fill_width, &angle1,
-	      &pitch1, &angle2, &pitch2, &num_lines) != 14) {
+  if (o_read_fields (first_line, &type, 13,
+                     &color, &line_width, &line_end, &line_type,
+                     &line_length, &line_space, &fill_type, &fill_width, &angle1,
+                     &pitch1, &angle2, &pitch2, &num_lines) != 14) {
     g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse path object"));
     return NULL;
   }
@@ -352,7 +352,7 @@ void o_path_modify (TOPLEVEL *toplevel, OBJECT *object,
   }
 
   /* Update bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   o_emit_change_notify (toplevel, object);
 }
 
@@ -397,7 +397,7 @@ void o_path_translate_world (OBJECT *object, int dx, int dy)
   }
 
   /* Update bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 
@@ -450,7 +450,7 @@ void o_path_rotate_world (TOPLEVEL *toplevel,
       break;
     }
   }
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
 }
 
 
@@ -494,7 +494,7 @@ void o_path_mirror_world (TOPLEVEL *toplevel, int world_centerx,
     }
   }
 
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
 }
 
 
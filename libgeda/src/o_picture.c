@@ -64,8 +64,8 @@ OBJECT *o_picture_read (TOPLEVEL *toplevel,
   gchar *file_content = NULL;
   guint file_length = 0;
 
-  num_conv = sscanf(first_line, "%c %d %d %d %d %d %d %d\n",
-                    &type, &x1, &y1, &width, &height, &angle, &mirrored, &embedded);
+  num_conv = o_read_fields (first_line, &type, 7,
+                            &x1, &y1, &width, &height, &angle, &mirrored, &embedded);
 
   if (num_conv != 8) {
     g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse picture definition"));
@@ -499,7 +499,7 @@ void o_picture_modify(TOPLEVEL *toplevel, OBJECT *object,
   }
 
   /* recalculate the screen coords and the boundings */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   o_emit_change_notify (toplevel, object);
 }
 
@@ -530,7 +530,7 @@ o_picture_modify_all (TOPLEVEL *toplevel, OBJECT *object,
   object->picture->upper_y = (y1 > y2) ? y1 : y2;
 
   /* recalculate the world coords and bounds */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
   o_emit_change_notify (toplevel, object);
 }
 
@@ -600,7 +600,7 @@ void o_picture_rotate_world(TOPLEVEL *toplevel,
   object->picture->lower_y += world_centery;
 
   /* recalc boundings and screen coords */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
 
 }
 
@@ -665,7 +665,7 @@ void o_picture_mirror_world(TOPLEVEL *toplevel,
   object->picture->lower_y += world_centery;
 
   /* recalc boundings and screen coords */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
 
 }
 
@@ -691,7 +691,7 @@ void o_picture_translate_world(OBJECT *object, int dx, int dy)
   object->picture->lower_y = object->picture->lower_y + dy;
 
   /* recalc the screen coords and the bounding picture */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief Create a copy of a picture.
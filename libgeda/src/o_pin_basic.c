@@ -136,15 +136,15 @@ OBJECT *o_pin_read (TOPLEVEL *toplevel, const char buf[],
   int whichend;
 
   if (release_ver <= VERSION_20020825) {
-    if (sscanf (buf, "%c %d %d %d %d %d\n", &type, &x1, &y1, &x2, &y2, &color) != 6) {
+    if (o_read_fields (buf, &type, 5, &x1, &y1, &x2, &y2, &color) != 6) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse pin object"));
       return NULL;
     }
     pin_type = PIN_TYPE_NET;
     whichend = -1;
   } else {
-    if (sscanf (buf, "%c %d %d %d %d %d %d %d\n", &type, &x1, &y1, &x2, &y2,
-		&color, &pin_type, &whichend) != 8) {
+    if (o_read_fields (buf, &type, 7, &x1, &y1, &x2, &y2,
+                       &color, &pin_type, &whichend) != 8) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse pin object"));
       return NULL;
     }
@@ -222,7 +222,7 @@ void o_pin_translate_world(OBJECT *object, int dx, int dy)
   object->line->y[1] = object->line->y[1] + dy;
 
   /* Update bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief create a copy of a pin object
@@ -341,10 +341,13 @@ void o_pin_modify(TOPLEVEL *toplevel, OBJECT *object,
   g_return_if_fail (object->whichend >= 0);
   g_return_if_fail (object->whichend < 2);
 
+  o_emit_pre_change_notify (toplevel, object);
+
   object->line->x[whichone] = x;
   object->line->y[whichone] = y;
 
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, object);
+  o_emit_change_notify (toplevel, object);
 }
 
 /*! \brief guess the whichend of pins of object list
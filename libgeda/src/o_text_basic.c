@@ -223,41 +223,28 @@ int o_text_num_lines(const char *string)
 }
 
 
-/*! \brief Creates a text OBJECT and the graphical objects representing it
+/*! \brief Creates a text OBJECT from a string it takes ownership of
  *  \par Function Description
- *  Create an OBJECT of type OBJ_TEXT.
- *
- *  \param [in]  toplevel              The TOPLEVEL object.
- *  \param [in]  color                  The color of the text.
- *  \param [in]  x                      World x coord of text.
- *  \param [in]  y                      World y coord of text.
- *  \param [in]  alignment              How text bounding box aligns on (x, y).
- *  \param [in]  angle                  Angle at which text will appear.
- *  \param [in]  string                 The text (TODO: can be char const *)!
- *  \param [in]  size                   Text size.
- *  \param [in]  visibility             VISIBLE or INVISIBLE.
- *  \param [in]  show_name_value        SHOW_NAME_VALUE or friends.
- *  \return Pointer to text OBJECT.
- *
- *  \note
- *  Caller is responsible for string; this function allocates its own copy.
+ *  Like o_text_new(), but the new object keeps \a string itself
+ *  instead of a copy of it, so the caller must not free or modify it
+ *  afterwards.  Used when reading files to avoid copying every text
+ *  string once more.
  */
-OBJECT *o_text_new(TOPLEVEL *toplevel,
-		   int color, int x, int y, int alignment,
-		   int angle, const char *string, int size, 
-		   int visibility, int show_name_value)
+static OBJECT *o_text_new_take (TOPLEVEL *toplevel,
+                                int color, int x, int y, int alignment,
+                                int angle, char *string, int size,
+                                int visibility, int show_name_value)
 {
   OBJECT *new_node=NULL;
   TEXT *text;
 
-  g_return_val_if_fail (string != NULL, NULL);
-
   new_node = s_basic_new_object(OBJ_TEXT, "text");
 
   text = (TEXT *) g_malloc(sizeof(TEXT));
 
-  text->string = g_strdup (string);
+  text->string = string;
   text->disp_string = NULL; /* We'll fix this up later */
+  text->attrib_name = o_attrib_string_get_name_quark (string);
   text->length = strlen(string);
   text->size = size;
   text->alignment = alignment;
@@ -279,6 +266,37 @@ OBJECT *o_text_new(TOPLEVEL *toplevel,
   return new_node;
 }
 
+/*! \brief Creates a text OBJECT and the graphical objects representing it
+ *  \par Function Description
+ *  Create an OBJECT of type OBJ_TEXT.
+ *
+ *  \param [in]  toplevel              The TOPLEVEL object.
+ *  \param [in]  color                  The color of the text.
+ *  \param [in]  x                      World x coord of text.
+ *  \param [in]  y                      World y coord of text.
+ *  \param [in]  alignment              How text bounding box aligns on (x, y).
+ *  \param [in]  angle                  Angle at which text will appear.
+ *  \param [in]  string                 The text (TODO: can be char const *)!
+ *  \param [in]  size                   Text size.
+ *  \param [in]  visibility             VISIBLE or INVISIBLE.
+ *  \param [in]  show_name_value        SHOW_NAME_VALUE or friends.
+ *  \return Pointer to text OBJECT.
+ *
+ *  \note
+ *  Caller is responsible for string; this function allocates its own copy.
+ */
+OBJECT *o_text_new(TOPLEVEL *toplevel,
+		   int color, int x, int y, int alignment,
+		   int angle, const char *string, int size, 
+		   int visibility, int show_name_value)
+{
+  g_return_val_if_fail (string != NULL, NULL);
+
+  return o_text_new_take (toplevel, color, x, y, alignment, angle,
+                          g_strdup (string), size, visibility,
+                          show_name_value);
+}
+
 /*! \brief read a text object from a char buffer
  *  \par Function Description
  *  This function reads a text object from the textbuffer \a tb and 
@@ -315,30 +333,30 @@ OBJECT *o_text_read (TOPLEVEL *toplevel,
   GString *textstr;
 
   if (fileformat_ver >= 1) {
-    if (sscanf(first_line, "%c %d %d %d %d %d %d %d %d %d\n", &type, &x, &y, 
-	       &color, &size,
-	       &visibility, &show_name_value, 
-	       &angle, &alignment, &num_lines) != 10) {
+    if (o_read_fields (first_line, &type, 9, &x, &y,
+                       &color, &size,
+                       &visibility, &show_name_value,
+                       &angle, &alignment, &num_lines) != 10) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse text object"));
       return NULL;
     }
   } else if (release_ver < VERSION_20000220) {
     /* yes, above less than (not less than and equal) is correct. The format */
     /* change occurred in 20000220 */
-    if (sscanf(first_line, "%c %d %d %d %d %d %d %d\n", &type, &x, &y, 
-	       &color, &size,
-	       &visibility, &show_name_value, 
-	       &angle) != 8) {
+    if (o_read_fields (first_line, &type, 7, &x, &y,
+                       &color, &size,
+                       &visibility, &show_name_value,
+                       &angle) != 8) {
       g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse text object"));
       return NULL;
     }
     alignment = LOWER_LEFT; /* older versions didn't have this */
     num_lines = 1; /* only support a single line */
   } else {
-    if (sscanf(first_line, "%c %d %d %d %d %d %d %d %d\n", &type, &x, &y, 
-	       &color, &size,
-	       &visibility, &show_name_value, 
-           &angle, &alignment) != 9) {
+    if (o_read_fields (first_line, &type, 8, &x, &y,
+                       &color, &size,
+                       &visibility, &show_name_value,
+                       &angle, &alignment) != 9) {
       g_set_error (err, EDA_ERROR, EDA_ERROR_PARSE, _("Failed to parse text object"));
       return NULL;
     }
@@ -395,22 +413,33 @@ OBJECT *o_text_read (TOPLEVEL *toplevel,
 
   g_assert(num_lines && num_lines > 0);
 
-  textstr = g_string_new ("");
-  for (i = 0; i < num_lines; i++) {
-    const gchar *line;
-    
-    line = s_textbuffer_next_line (tb);
+  if (num_lines == 1) {
+    /* most text is a single line, which can simply be copied */
+    const gchar *line = s_textbuffer_next_line (tb);
 
     if (line == NULL) {
-      g_string_free (textstr, TRUE);
-      g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Unexpected end-of-file after %d lines"), i);
+      g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Unexpected end-of-file after %d lines"), 0);
       return NULL;
     }
+    string = g_strdup (line);
+  } else {
+    textstr = g_string_new ("");
+    for (i = 0; i < num_lines; i++) {
+      const gchar *line;
+
+      line = s_textbuffer_next_line (tb);
 
-    textstr = g_string_append (textstr, line);
+      if (line == NULL) {
+        g_string_free (textstr, TRUE);
+        g_set_error(err, EDA_ERROR, EDA_ERROR_PARSE, _("Unexpected end-of-file after %d lines"), i);
+        return NULL;
+      }
+
+      textstr = g_string_append (textstr, line);
+    }
+    /* retrieve the character string from the GString */
+    string = g_string_free (textstr, FALSE);
   }
-  /* retrieve the character string from the GString */
-  string = g_string_free (textstr, FALSE);
 
   string = remove_last_nl(string);	
 
@@ -430,10 +459,10 @@ OBJECT *o_text_read (TOPLEVEL *toplevel,
     }
   }
   
-  new_obj = o_text_new(toplevel, color, x, y,
-                       alignment, angle, string,
-                       size, visibility, show_name_value);
-  g_free(string);
+  /* the new object takes over the string */
+  new_obj = o_text_new_take (toplevel, color, x, y,
+                             alignment, angle, string,
+                             size, visibility, show_name_value);
 
   return new_obj;
 }
@@ -482,7 +511,7 @@ void o_text_recreate(TOPLEVEL *toplevel, OBJECT *o_current)
 {
   o_emit_pre_change_notify (toplevel, o_current);
   update_disp_string (o_current);
-  o_current->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, o_current);
   o_emit_change_notify (toplevel, o_current);
 }
 
@@ -504,7 +533,7 @@ void o_text_translate_world(OBJECT *object, int dx, int dy)
   object->text->y = object->text->y + dy;
 
   /* Update bounding box */
-  object->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (NULL, object);
 }
 
 /*! \brief create a copy of a text object
@@ -717,6 +746,8 @@ double o_text_shortest_distance (TOPLEVEL *toplevel, OBJECT *object,
 void o_text_set_string (TOPLEVEL *toplevel, OBJECT *obj,
                         const gchar *new_string)
 {
+  GQuark old_name;
+
   g_return_if_fail (toplevel != NULL);
   g_return_if_fail (obj != NULL);
   g_return_if_fail (obj->type == OBJ_TEXT);
@@ -726,6 +757,17 @@ void o_text_set_string (TOPLEVEL *toplevel, OBJECT *obj,
   g_free (obj->text->string);
   obj->text->string = g_strdup (new_string);
 
+  old_name = obj->text->attrib_name;
+  obj->text->attrib_name = o_attrib_string_get_name_quark (new_string);
+
+  /* The caches of the enclosing symbol only depend on attribute names,
+   * except for the values of pinseq= and slotdef= */
+  if (obj->text->attrib_name != old_name)
+    o_attrib_invalidate_index (obj->parent);
+  else if (old_name == g_quark_from_static_string ("pinseq") ||
+           old_name == g_quark_from_static_string ("slotdef"))
+    s_slot_invalidate (obj->parent);
+
   o_text_recreate (toplevel, obj);
 }
 
@@ -256,6 +256,8 @@ s_delete_object(TOPLEVEL *toplevel, OBJECT *o_current)
         o_current->complex->prim_objs = NULL;
       }
 
+      o_attrib_invalidate_index (o_current);
+
       g_free(o_current->complex);
       o_current->complex = NULL;
     }
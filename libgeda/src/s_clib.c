@@ -71,6 +71,18 @@
  *  symbol data may be requested directly using
  *  s_clib_symbol_get_data_by_name().
  *
+ *  Symbol data is kept in a cache once it has been fetched from its
+ *  source.  When the cache grows beyond its size limit (see
+ *  s_clib_set_symbol_cache_size(), or the \b symbol-cache-size rc
+ *  keyword), the least recently used symbols are evicted.  Callers
+ *  which only need to read the data can avoid copying it by using
+ *  s_clib_symbol_get_bytes() instead of s_clib_symbol_get_data().
+ *
+ *  Symbol files from directory sources are mapped into memory rather
+ *  than read.  The mapped pages are shared with every other process
+ *  on the host which uses the same library, and can be dropped by the
+ *  kernel under memory pressure, so keeping them cached is cheap.
+ *
  *
  *  \section libcmds Library Commands
  *
@@ -114,6 +126,7 @@
 
 #include <stdio.h>
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #ifdef HAVE_STRING_H
 #include <string.h>
@@ -146,10 +159,8 @@
 /*! Library command mode used to fetch symbol data */
 #define CLIB_DATA_CMD       "get"
 
-/*! Maximum number of symbol cache entries */
-#define CLIB_MAX_SYMBOL_CACHE 128
-/*! When symbol cache gets full, remove down to this level */
-#define CLIB_MIN_SYMBOL_CACHE 96
+/*! Default size of the symbol data cache in bytes */
+#define CLIB_SYMBOL_CACHE_SIZE (4 * 1024 * 1024)
 
 /* Type definitions
  * ================
@@ -166,6 +177,9 @@ enum CLibSourceType {
   CLIB_SCM,
 };
 
+/*! A directory scan running on the #clib_scan_pool */
+typedef struct _ScanJob ScanJob;
+
 /*! Stores data about a particular component source */
 struct _CLibSource {
   /*! Type of source */
@@ -174,9 +188,16 @@ struct _CLibSource {
   gchar *name;
   /*! Available symbols (#CLibSymbol) */
   GList *symbols;
+  /*! Index of \a symbols by name */
+  GHashTable *index;
 
   /*! Path to directory */
   gchar *directory;
+  /*! Modification time of the directory when it was last scanned,
+   *  or 0 if it has to be scanned again */
+  time_t mtime;
+  /*! Scan of the directory which hasn't been collected yet */
+  ScanJob *scan;
 
   /*! Command & arguments for listing symbols */
   gchar *list_cmd;
@@ -195,6 +216,30 @@ struct _CLibSymbol {
   CLibSource *source;
   /*! The name of this symbol */
   gchar *name;
+  /*! Summary of the symbol file (directory sources only), or NULL
+   *  if not known yet */
+  CLibSummary *summary;
+};
+
+struct _ScanJob {
+  /*! Path to directory */
+  gchar *directory;
+  /*! Path to the on-disk index of the directory */
+  gchar *index_file;
+  /*! Modification time of the directory when it was last scanned;
+   *  replaced by the scan result unless \a unchanged is set */
+  time_t mtime;
+
+  /*! Set by the worker thread once the fields below are valid */
+  gboolean done;
+  /*! Whether the directory didn't change since it was last scanned */
+  gboolean unchanged;
+  /*! Names of the symbol files found in the directory */
+  GPtrArray *names;
+  /*! Summaries of the symbol files (#CLibSummary), same order */
+  GPtrArray *summaries;
+  /*! Error message if the directory couldn't be read */
+  gchar *error;
 };
 
 /*! Symbol data cache entry */
@@ -202,10 +247,16 @@ typedef struct _CacheEntry CacheEntry;
 struct _CacheEntry {
   /*! Pointer to symbol */
   CLibSymbol *ptr;
-  /*! Symbol data */
-  gchar *data;
-  /*! Last access */
-  time_t accessed;
+  /*! Symbol data (never changed once fetched; mapped from the symbol
+   *  file for directory sources, so not necessarily NUL-terminated) */
+  GBytes *data;
+  /*! Objects parsed from \a data, copied by o_complex_new(), or
+   *  NULL if the data hasn't been parsed yet */
+  CLibPrototype *prototype;
+  /*! Approximate memory used by this entry, in bytes */
+  gsize size;
+  /*! Link in #clib_symbol_lru */
+  GList link;
 };
 
 /* Static variables
@@ -215,6 +266,13 @@ struct _CacheEntry {
 /*! Holds the list of all known component sources */
 static GList *clib_sources = NULL;
 
+/*! Worker threads which scan directory sources */
+static GThreadPool *clib_scan_pool = NULL;
+/*! Protects the \a done flag of all #ScanJob structures */
+static GMutex clib_scan_mutex;
+/*! Signalled whenever a #ScanJob is done */
+static GCond clib_scan_cond;
+
 /*! Caches results of s_clib_search().  The key of the hashtable is a
  *  string describing the search that was carried out, and the value
  *  is a list of symbol pointers. */
@@ -222,9 +280,23 @@ static GHashTable *clib_search_cache = NULL;
 
 /*! Caches symbol data.  The key of the hashtable is a symbol pointer,
  *  and the value is a #CacheEntry structure containing the data and
- *  the time it was last used. */
+ *  the objects parsed from it. */
 static GHashTable *clib_symbol_cache = NULL;
 
+/*! The entries of #clib_symbol_cache, most recently used first */
+static GQueue clib_symbol_lru = G_QUEUE_INIT;
+
+/*! Total size of all entries in #clib_symbol_cache */
+static gsize clib_symbol_cache_used = 0;
+
+/*! Maximum total size of the entries in #clib_symbol_cache */
+static gsize clib_symbol_cache_size = CLIB_SYMBOL_CACHE_SIZE;
+
+/*! Symbol data cache statistics, see s_clib_get_symbol_cache_stats() */
+static gulong clib_symbol_cache_hits = 0;
+static gulong clib_symbol_cache_misses = 0;
+static gulong clib_symbol_cache_evictions = 0;
+
 /* Local static functions
  * ======================
  */
@@ -233,15 +305,23 @@ static void free_symbol_cache_entry (gpointer data);
 static void free_source (gpointer data, gpointer user_data);
 static gint compare_source_name (gconstpointer a, gconstpointer b);
 static gint compare_symbol_name (gconstpointer a, gconstpointer b);
-static void cache_find_oldest (gpointer key, gpointer value, gpointer user_data);
+static void cache_trim (gsize size, const CacheEntry *keep);
+static CacheEntry *lookup_cache_entry (const CLibSymbol *symbol);
+static CacheEntry *get_cache_entry (const CLibSymbol *symbol);
 static gchar *run_source_command (const gchar *command);
 static CLibSymbol *source_has_symbol (const CLibSource *source, 
 				      const gchar *name);
+static CLibSymbol *source_add_symbol (CLibSource *source, gchar *name);
+static void source_clear_symbols (CLibSource *source);
 static gchar *uniquify_source_name (const gchar *name);
+static void free_old_summary (gpointer key, gpointer value, gpointer user_data);
+static void scan_directory (gpointer data, gpointer user_data);
 static void refresh_directory (CLibSource *source);
+static void finish_directory (CLibSource *source);
+static void finish_all_directories (void);
 static void refresh_command (CLibSource *source);
 static void refresh_scm (CLibSource *source);
-static gchar *get_data_directory (const CLibSymbol *symbol);
+static GBytes *get_data_directory (const CLibSymbol *symbol);
 static gchar *get_data_command (const CLibSymbol *symbol);
 static gchar *get_data_scm (const CLibSymbol *symbol);
 
@@ -296,6 +376,7 @@ static void free_symbol (gpointer data, gpointer user_data)
       g_free (symbol->name);
       symbol->name = NULL;
     }
+    s_clib_summary_free (symbol->summary);
     g_free(symbol);
   }
 }
@@ -308,7 +389,11 @@ static void free_symbol_cache_entry (gpointer data)
 {
   CacheEntry *entry = data;
   g_return_if_fail (entry != NULL);
-  g_free (entry->data);
+  g_queue_unlink (&clib_symbol_lru, &entry->link);
+  clib_symbol_cache_used -= entry->size;
+  if (entry->prototype != NULL)
+    s_clib_prototype_unref (entry->prototype);
+  g_bytes_unref (entry->data);
   g_free (entry);
 }
 
@@ -329,6 +414,10 @@ static void free_source (gpointer data, gpointer user_data)
       g_list_free (source->symbols);
       source->symbols = NULL;
     }
+    if (source->index != NULL) {
+      g_hash_table_destroy (source->index);
+      source->index = NULL;
+    }
     if (source->directory != NULL) {
       g_free (source->directory);
       source->directory = NULL;
@@ -355,6 +444,8 @@ static void free_source (gpointer data, gpointer user_data)
  */
 void s_clib_free ()
 {
+  finish_all_directories ();
+
   if (clib_sources != NULL) {
     g_list_foreach (clib_sources, (GFunc) free_source, NULL);
     g_list_free (clib_sources);
@@ -414,19 +505,24 @@ static gint compare_symbol_name (gconstpointer a, gconstpointer b)
   return strcasecmp(sym1->name, sym2->name);
 }
 
-/*! \brief Iterator callback for finding oldest symbol cache entry
+/*! \brief Remove least recently used symbol cache entries.
  *  \par Function Description
- *  Private function used only in s_clib.c.
+ *  Evicts entries from the tail of the LRU list until another \a size
+ *  bytes fit into the symbol data cache.  The entry \a keep (which
+ *  may be \b NULL) is never evicted.  Private function used only in
+ *  s_clib.c.
  */
-static void cache_find_oldest (gpointer key,
-                               gpointer value,
-                               gpointer user_data)
+static void cache_trim (gsize size, const CacheEntry *keep)
 {
-  CacheEntry *current = value;
-  CacheEntry **oldest = user_data;
+  GList *link = clib_symbol_lru.tail;
 
-  if (current->accessed < (*oldest)->accessed) {
-    *oldest = current;
+  while (link != NULL && clib_symbol_cache_used + size > clib_symbol_cache_size) {
+    CacheEntry *victim = link->data;
+    link = link->prev;
+    if (victim == keep)
+      continue;
+    g_hash_table_remove (clib_symbol_cache, victim->ptr);
+    clib_symbol_cache_evictions++;
   }
 }
 
@@ -509,9 +605,8 @@ GList *s_clib_get_sources (const gboolean sorted)
 
 /*! \brief Find any symbols within a source with a given name.
  *  \par Function Description
- *  Iterates through the symbol list of the given source, checking if
- *  there is already a symbol with the given name.  If there is
- *  such a symbol, it is returned.
+ *  Looks up \a name in the symbol index of the given source.  If
+ *  there is already a symbol with the given name, it is returned.
  *
  *  \param source The source to check.
  *  \param name The symbol name to look for.
@@ -520,19 +615,57 @@ GList *s_clib_get_sources (const gboolean sorted)
 static CLibSymbol *source_has_symbol (const CLibSource *source, 
 				      const gchar *name)
 {
-  GList *symlist;
+  if (source->index == NULL) return NULL;
+  return g_hash_table_lookup (source->index, name);
+}
+
+/*! \brief Add a symbol to a source.
+ *  \par Function Description
+ *  Creates a new symbol record called \a name and adds it to the
+ *  symbol list and index of \a source, taking over \a name.  If the
+ *  source already has a symbol with that name, frees \a name and
+ *  returns \b NULL.
+ *
+ *  The symbol is prepended to the symbol list, so the list has to be
+ *  sorted once all symbols have been added.
+ *
+ *  \param source The source to add the symbol to.
+ *  \param name   The name of the new symbol.
+ *  \return The new symbol, or \b NULL if the name was already taken.
+ */
+static CLibSymbol *source_add_symbol (CLibSource *source, gchar *name)
+{
   CLibSymbol *symbol;
 
-  for (symlist = g_list_first(source->symbols); 
-       symlist != NULL; 
-       symlist = g_list_next(symlist)) {
-    
-    symbol = (CLibSymbol *) symlist->data;
+  if (source->index == NULL)
+    source->index = g_hash_table_new (g_str_hash, g_str_equal);
 
-    if (strcmp (symbol->name, name) == 0) return symbol;
+  if (g_hash_table_contains (source->index, name)) {
+    g_free (name);
+    return NULL;
   }
 
-  return NULL;
+  symbol = g_new0 (CLibSymbol, 1);
+  symbol->source = source;
+  symbol->name = name;
+
+  g_hash_table_insert (source->index, symbol->name, symbol);
+  source->symbols = g_list_prepend (source->symbols, symbol);
+  return symbol;
+}
+
+/*! \brief Remove all symbols from a source.
+ *  \par Function Description
+ *  Frees the symbol list of \a source and clears its index.
+ */
+static void source_clear_symbols (CLibSource *source)
+{
+  if (source->index != NULL)
+    g_hash_table_remove_all (source->index);
+
+  g_list_foreach (source->symbols, (GFunc) free_symbol, NULL);
+  g_list_free (source->symbols);
+  source->symbols = NULL;
 }
 
 /*! \brief Make sure a source name is unique.
@@ -564,85 +697,262 @@ static gchar *uniquify_source_name (const gchar *name)
   return newname;
 }
 
-/*! \brief Rescan a directory for symbols.
+/*! \brief Iterator callback for freeing an unused summary.
  *  \par Function Description
- *  Rescans a directory for symbols.
+ *  Private function used only in s_clib.c.
+ */
+static void free_old_summary (gpointer key, gpointer value, gpointer user_data)
+{
+  s_clib_summary_free (value);
+}
+
+/*! \brief Scan a directory for symbol files.
+ *  \par Function Description
+ *  Worker function of #clib_scan_pool.  Collects the names and
+ *  summaries of all symbol files in the directory of the #ScanJob \a
+ *  data, unless the modification time of the directory shows that it
+ *  hasn't changed since it was last scanned.
+ *
+ *  If the on-disk index of the directory is up to date, the result is
+ *  taken from there without reading the directory.  Otherwise, the
+ *  directory is read and the index is rewritten.  Summaries of files
+ *  which haven't changed are taken over from the old index.
+ *
+ *  Doesn't touch any other libgeda data, so it can run in any thread.
  *
  *  \todo Does this need to do something more sane with subdirectories
  *  than just skipping them silently?
  *
  *  Private function used only in s_clib.c.
  */
-static void refresh_directory (CLibSource *source)
+static void scan_directory (gpointer data, gpointer user_data)
 {
-  CLibSymbol *symbol;
+  ScanJob *job = data;
   GDir *dir;
   const gchar *entry;
-  gchar *low_entry;
   gchar *fullpath;
-  gboolean isfile;
+  GStatBuf st;
+  gboolean have_mtime;
+  time_t start;
+  GPtrArray *old_names, *old_summaries;
+  GHashTable *old_index;
+  CLibSummary *summary;
+  guint i;
   GError *e = NULL;
 
-  g_return_if_fail (source != NULL);
-  g_return_if_fail (source->type == CLIB_DIR);
+  start = time (NULL);
+  have_mtime = (g_stat (job->directory, &st) == 0);
 
-  s_clib_begin_update ();
+  if (have_mtime && job->mtime != 0 && st.st_mtime == job->mtime) {
+    job->unchanged = TRUE;
+    goto done;
+  }
 
-  /* Clear the current symbol list */
-  g_list_foreach (source->symbols, (GFunc) free_symbol, NULL);
-  g_list_free (source->symbols);
-  source->symbols = NULL;  
+  /* A change made within the same second as the scan wouldn't update
+   * the modification time, so only trust it if it is older. */
+  job->mtime = (have_mtime && st.st_mtime < start) ? st.st_mtime : 0;
+
+  job->names = g_ptr_array_new ();
+  job->summaries = g_ptr_array_new ();
+
+  /* Use the on-disk index if it was made for this very directory. */
+  if (job->mtime != 0
+      && s_clib_index_read (job->index_file, job->mtime,
+                            job->names, job->summaries)) {
+    goto done;
+  }
 
   /* Open the directory for reading. */
-  dir = g_dir_open (source->directory, 0, &e);
+  dir = g_dir_open (job->directory, 0, &e);
 
   if (e != NULL) {
-    s_log_message (_("Failed to open directory [%s]: %s\n"),
-		   source->directory, e->message);
+    job->error = g_strdup (e->message);
+    job->mtime = 0;
     g_error_free (e);
-    return;
+    goto done;
   }
 
+  /* Index the summaries of the outdated index by file name. */
+  old_names = g_ptr_array_new_with_free_func (g_free);
+  old_summaries = g_ptr_array_new ();
+  old_index = g_hash_table_new (g_str_hash, g_str_equal);
+  s_clib_index_read (job->index_file, -1, old_names, old_summaries);
+  for (i = 0; i < old_names->len; i++)
+    g_hash_table_insert (old_index, g_ptr_array_index (old_names, i),
+                         g_ptr_array_index (old_summaries, i));
+
   while ((entry = g_dir_read_name (dir)) != NULL) {
-    /* skip ".", ".." & hidden files */
-    if (entry[0] == '.') continue;
+    /* skip hidden files and filenames which don't have the right
+     * suffix. */
+    if (!s_clib_index_is_candidate (entry)) continue;
 
     /* skip subdirectories (for now) */
-    fullpath = g_build_filename (source->directory, entry, NULL);
-    isfile = g_file_test (fullpath, G_FILE_TEST_IS_REGULAR);
-    g_free (fullpath);
-    if (!isfile) continue;
-
-    /* skip filenames that we already know about. */
-    if (source_has_symbol (source, entry) != NULL) continue;
-    
-    /* skip filenames which don't have the right suffix. */
-    low_entry = g_utf8_strdown (entry, -1);
-    if (!g_str_has_suffix (low_entry, SYM_FILENAME_FILTER)) {
-      g_free (low_entry);
+    fullpath = g_build_filename (job->directory, entry, NULL);
+    if (g_stat (fullpath, &st) != 0 || !S_ISREG (st.st_mode)) {
+      g_free (fullpath);
       continue;
     }
-    g_free (low_entry);
 
-    /* Create and add new symbol record */
-    symbol = g_new0 (CLibSymbol, 1);
-    symbol->source = source;
-    symbol->name = g_strdup(entry);
+    summary = g_hash_table_lookup (old_index, entry);
+    if (summary != NULL
+        && summary->mtime == st.st_mtime && summary->size == st.st_size) {
+      g_hash_table_remove (old_index, entry);
+    } else {
+      summary = s_clib_summary_new (fullpath, st.st_mtime, st.st_size);
+    }
+    g_free (fullpath);
 
-    /* Prepend because it's faster and it doesn't matter what order we
-     * add them. */
-    source->symbols = g_list_prepend (source->symbols, symbol);
+    g_ptr_array_add (job->names, g_strdup (entry));
+    g_ptr_array_add (job->summaries, summary);
   }
 
-  entry = NULL;
   g_dir_close (dir);
 
-  /* Now sort the list of symbols by name. */
-  source->symbols = g_list_sort (source->symbols, 
-				 (GCompareFunc) compare_symbol_name);
+  if (job->mtime != 0)
+    s_clib_index_write (job->index_file, job->mtime,
+                        job->names, job->summaries);
+
+  /* Free the summaries which weren't taken over. */
+  g_hash_table_foreach (old_index, (GHFunc) free_old_summary, NULL);
+  g_hash_table_destroy (old_index);
+  g_ptr_array_free (old_summaries, TRUE);
+  g_ptr_array_free (old_names, TRUE);
+
+ done:
+  g_mutex_lock (&clib_scan_mutex);
+  job->done = TRUE;
+  g_cond_broadcast (&clib_scan_cond);
+  g_mutex_unlock (&clib_scan_mutex);
+}
 
-  s_clib_flush_search_cache();
-  s_clib_flush_symbol_cache();
+/*! \brief Rescan a directory for symbols.
+ *  \par Function Description
+ *  Starts rescanning a directory for symbols on the #clib_scan_pool,
+ *  so several directories can be scanned at the same time.  The
+ *  result is collected by finish_directory(), which must be called
+ *  before the symbols of the source are accessed.
+ *
+ *  Private function used only in s_clib.c.
+ */
+static void refresh_directory (CLibSource *source)
+{
+  ScanJob *job;
+
+  g_return_if_fail (source != NULL);
+  g_return_if_fail (source->type == CLIB_DIR);
+
+  if (source->scan != NULL)
+    return;
+
+  job = g_new0 (ScanJob, 1);
+  job->directory = g_strdup (source->directory);
+  job->index_file = s_clib_index_get_filename (source->directory);
+  job->mtime = source->mtime;
+  source->scan = job;
+
+  if (clib_scan_pool == NULL)
+    clib_scan_pool = g_thread_pool_new (scan_directory, NULL,
+                                        g_get_num_processors (),
+                                        FALSE, NULL);
+
+  if (clib_scan_pool == NULL
+      || !g_thread_pool_push (clib_scan_pool, job, NULL)) {
+    scan_directory (job, NULL);
+  }
+}
+
+/*! \brief Collect the result of rescanning a directory.
+ *  \par Function Description
+ *  Waits for the scan started by refresh_directory() to complete and
+ *  replaces the symbols of \a source with the symbol files found.
+ *  Does nothing if no scan is pending.
+ *
+ *  Private function used only in s_clib.c.
+ */
+static void finish_directory (CLibSource *source)
+{
+  ScanJob *job = source->scan;
+  CLibSymbol *symbol;
+  CLibSummary *summary;
+  gchar *name, *low_name;
+  guint i;
+
+  if (job == NULL)
+    return;
+
+  g_mutex_lock (&clib_scan_mutex);
+  while (!job->done)
+    g_cond_wait (&clib_scan_cond, &clib_scan_mutex);
+  g_mutex_unlock (&clib_scan_mutex);
+
+  source->scan = NULL;
+
+  if (!job->unchanged) {
+    s_clib_begin_update ();
+
+    /* Clear the current symbol list */
+    source_clear_symbols (source);
+    source->mtime = job->mtime;
+
+    if (job->error != NULL) {
+      s_log_message (_("Failed to open directory [%s]: %s\n"),
+                     source->directory, job->error);
+    } else {
+      /* Add new symbol records.  Prepend because it's faster and it
+       * doesn't matter what order we add them. */
+      for (i = 0; i < job->names->len; i++) {
+        name = g_ptr_array_index (job->names, i);
+        summary = g_ptr_array_index (job->summaries, i);
+
+        /* skip filenames which don't have the right suffix (the
+         * index also lists symbol files only xorn can read). */
+        low_name = g_utf8_strdown (name, -1);
+        symbol = NULL;
+        if (g_str_has_suffix (low_name, SYM_FILENAME_FILTER))
+          symbol = source_add_symbol (source, name);
+        else
+          g_free (name);
+        g_free (low_name);
+
+        if (symbol != NULL)
+          symbol->summary = summary;
+        else
+          s_clib_summary_free (summary);
+      }
+
+      /* Now sort the list of symbols by name. */
+      source->symbols = g_list_sort (source->symbols,
+                                     (GCompareFunc) compare_symbol_name);
+    }
+
+    s_clib_flush_search_cache();
+    s_clib_flush_symbol_cache();
+  }
+
+  if (job->names != NULL)
+    g_ptr_array_free (job->names, TRUE);
+  if (job->summaries != NULL)
+    g_ptr_array_free (job->summaries, TRUE);
+  g_free (job->error);
+  g_free (job->index_file);
+  g_free (job->directory);
+  g_free (job);
+}
+
+/*! \brief Collect the results of all pending directory scans.
+ *  \par Function Description
+ *  Calls finish_directory() for every source.  Private function used
+ *  only in s_clib.c.
+ */
+static void finish_all_directories (void)
+{
+  GList *sourcelist;
+
+  for (sourcelist = clib_sources;
+       sourcelist != NULL;
+       sourcelist = g_list_next (sourcelist)) {
+    finish_directory ((CLibSource *) sourcelist->data);
+  }
 }
 
 /*! \brief Re-poll a library command for symbols.
@@ -657,7 +967,6 @@ static void refresh_command (CLibSource *source)
   gchar *cmdout;
   TextBuffer *tb;
   const gchar *line;
-  CLibSymbol *symbol;
   gchar *name;
 
   g_return_if_fail (source != NULL);
@@ -666,9 +975,7 @@ static void refresh_command (CLibSource *source)
   s_clib_begin_update ();
 
   /* Clear the current symbol list */
-  g_list_foreach (source->symbols, (GFunc) free_symbol, NULL);
-  g_list_free (source->symbols);
-  source->symbols = NULL;  
+  source_clear_symbols (source);
 
   /* Run the command to get the list of symbols */
   cmdout = run_source_command (source->list_cmd);
@@ -684,19 +991,9 @@ static void refresh_command (CLibSource *source)
 
     name = remove_nl(g_strdup(line));
 
-    /* skip symbols already known about */
-    if (source_has_symbol (source, name) != NULL) {
-      g_free (name);
-      continue;
-    }
-
-    symbol = g_new0 (CLibSymbol, 1);
-    symbol->source = source;
-    symbol->name = name;
-
-    /* Prepend because it's faster and it doesn't matter what order we
-     * add them. */
-    source->symbols = g_list_prepend (source->symbols, symbol);    
+    /* Symbols already known about are skipped.  Prepend because it's
+     * faster and it doesn't matter what order we add them. */
+    source_add_symbol (source, name);
   }
 
   s_textbuffer_free (tb);
@@ -721,7 +1018,6 @@ static void refresh_scm (CLibSource *source)
 {
   SCM symlist;
   SCM symname;
-  CLibSymbol *symbol;
   char *tmp;
 
   g_return_if_fail (source != NULL);
@@ -730,9 +1026,7 @@ static void refresh_scm (CLibSource *source)
   s_clib_begin_update ();
 
   /* Clear the current symbol list */
-  g_list_foreach (source->symbols, (GFunc) free_symbol, NULL);
-  g_list_free (source->symbols);
-  source->symbols = NULL;
+  source_clear_symbols (source);
 
   symlist = scm_call_0 (source->list_fn);
 
@@ -748,18 +1042,14 @@ static void refresh_scm (CLibSource *source)
       s_log_message (_("Non-string symbol name while scanning library [%s]\n"),
 		     source->name);
     } else {
-      symbol = g_new0 (CLibSymbol, 1);
-      symbol->source = source;
-
       /* Need to make sure that the correct free() function is called
        * on strings allocated by Guile. */
       tmp = scm_to_utf8_string (symname);
-      symbol->name = g_strdup(tmp);
-      free (tmp);
 
       /* Prepend because it's faster and it doesn't matter what order we
        * add them. */
-      source->symbols = g_list_prepend (source->symbols, symbol);
+      source_add_symbol (source, g_strdup (tmp));
+      free (tmp);
     }
  
     symlist = SCM_CDR (symlist);
@@ -778,6 +1068,11 @@ static void refresh_scm (CLibSource *source)
  *  Resets the list of symbols available from each source, and
  *  repopulates it from scratch.  Useful e.g. for checking for new
  *  symbols.
+ *
+ *  Directory sources are scanned in parallel, and skipped if the
+ *  modification time of the directory hasn't changed since the last
+ *  scan.  The symbol data cache is flushed in any case so changes to
+ *  the symbol files themselves are picked up.
  */
 void s_clib_refresh ()
 {
@@ -792,6 +1087,7 @@ void s_clib_refresh ()
     switch (source->type)
       {
       case CLIB_DIR:
+	/* Collected by finish_all_directories() below */
 	refresh_directory(source);
 	break;
       case CLIB_CMD:
@@ -807,6 +1103,9 @@ void s_clib_refresh ()
       }
   }
 
+  finish_all_directories ();
+  s_clib_flush_symbol_cache ();
+
   s_clib_end_update ();
 }
 
@@ -872,6 +1171,8 @@ const CLibSource *s_clib_add_directory (const gchar *directory,
   source->directory = g_strdup (directory);
   source->name = realname;
 
+  /* The directory is scanned in the background; the symbols are
+   * collected when they are first needed. */
   refresh_directory (source);
 
   /* Sources added later get scanned earlier */
@@ -1003,6 +1304,7 @@ const gchar *s_clib_source_get_name (const CLibSource *source)
 GList *s_clib_source_get_symbols (const CLibSource *source)
 {
   if (source == NULL) return NULL;
+  finish_directory ((CLibSource *) source);
   return g_list_copy(source->symbols);
 }
 
@@ -1068,20 +1370,107 @@ const CLibSource *s_clib_symbol_get_source (const CLibSymbol *symbol)
   return symbol->source;
 }
 
+/*! \brief Get the summary of a symbol file.
+ *  \par Function Description
+ *  Returns the summary of the file \a symbol was found in, as read
+ *  from the library index.  If the file has changed since, or no
+ *  summary is known yet, the file is summarised again.  Returns \b
+ *  NULL for symbols which don't come from a directory source or whose
+ *  file is gone.  Private function used only in s_clib.c.
+ */
+static CLibSummary *get_symbol_summary (const CLibSymbol *symbol)
+{
+  CLibSymbol *sym = (CLibSymbol *) symbol;
+  GStatBuf st;
+  gchar *filename;
+
+  if (symbol->source->type != CLIB_DIR) return NULL;
+
+  filename = s_clib_symbol_get_filename (symbol);
+  if (g_stat (filename, &st) != 0) {
+    g_free (filename);
+    return NULL;
+  }
+
+  if (sym->summary == NULL
+      || sym->summary->mtime != st.st_mtime
+      || sym->summary->size != st.st_size) {
+    s_clib_summary_free (sym->summary);
+    sym->summary = s_clib_summary_new (filename, st.st_mtime, st.st_size);
+  }
+
+  g_free (filename);
+  return sym->summary;
+}
+
+/*! \brief Get the number of pins of a symbol.
+ *  \par Function Description
+ *  Returns the number of pins of \a symbol without loading it.  This
+ *  is taken from the library index, so it is only available for
+ *  symbols from directory sources.
+ *
+ *  \param symbol Symbol to be examined.
+ *  \return Number of pins, or -1 if not known.
+ */
+gint s_clib_symbol_get_pin_count (const CLibSymbol *symbol)
+{
+  CLibSummary *summary;
+
+  g_return_val_if_fail ((symbol != NULL), -1);
+
+  summary = get_symbol_summary (symbol);
+  return summary != NULL ? summary->pin_count : -1;
+}
+
+/*! \brief Get a floating attribute of a symbol.
+ *  \par Function Description
+ *  Returns the value of the first floating attribute called \a name
+ *  in \a symbol without loading it.  This is taken from the library
+ *  index, so it is only available for symbols from directory sources.
+ *  The return value should be freed when no longer needed.
+ *
+ *  \param symbol Symbol to be examined.
+ *  \param name   Name of the attribute.
+ *  \return Value of the attribute, or \b NULL if not found.
+ */
+gchar *s_clib_symbol_get_attribute (const CLibSymbol *symbol,
+                                    const gchar *name)
+{
+  CLibSummary *summary;
+  gsize len;
+  gchar **attrib;
+
+  g_return_val_if_fail ((symbol != NULL), NULL);
+  g_return_val_if_fail ((name != NULL), NULL);
+
+  summary = get_symbol_summary (symbol);
+  if (summary == NULL) return NULL;
+
+  len = strlen (name);
+  for (attrib = summary->attribs; *attrib != NULL; attrib++) {
+    if (strncmp (*attrib, name, len) == 0 && (*attrib)[len] == '=')
+      return g_strdup (*attrib + len + 1);
+  }
+
+  return NULL;
+}
+
 /*! \brief Get symbol data from a directory source.
  *  \par Function Description
- *  Get symbol data from a directory data source.  The return value
- *  should be free()'d when no longer needed.
+ *  Get symbol data from a directory data source.  The symbol file is
+ *  mapped into memory, and stays mapped until the returned buffer is
+ *  released with g_bytes_unref().  The data is not NUL-terminated.
  *
  *  Private function used only in s_clib.c.
  *
  *  \param symbol Symbol to get data for.
- *  \return Allocated buffer containing symbol data.
+ *  \return Buffer containing symbol data.
  */
-static gchar *get_data_directory (const CLibSymbol *symbol)
+static GBytes *get_data_directory (const CLibSymbol *symbol)
 {
   gchar *filename = NULL;
-  gchar *data = NULL;
+  GMappedFile *file;
+  GBytes *data = NULL;
   GError *e = NULL;
 
   g_return_val_if_fail ((symbol != NULL), NULL);
@@ -1090,14 +1479,21 @@ static gchar *get_data_directory (const CLibSymbol *symbol)
   filename = g_build_filename(symbol->source->directory, 
 			      symbol->name, NULL);
 
-  g_file_get_contents (filename, &data, NULL, &e);
+  file = g_mapped_file_new (filename, FALSE, &e);
 
   if (e != NULL) {
     s_log_message (_("Failed to load symbol from file [%s]: %s\n"),
 		   filename, e->message);
     g_error_free (e);
+  } else if (g_mapped_file_get_length (file) == 0) {
+    /* An empty file has no contents to map */
+    data = g_bytes_new_static ("", 0);
+  } else {
+    data = g_mapped_file_get_bytes (file);
   }
 
+  if (file != NULL)
+    g_mapped_file_unref (file);
   g_free (filename);
   return data;
 }
@@ -1167,36 +1563,60 @@ static gchar *get_data_scm (const CLibSymbol *symbol)
   return result;
 }
 
-/*! \brief Get symbol data.
+/*! \brief Look up the cache entry for a symbol.
  *  \par Function Description
- *  Get the unparsed gEDA-format data corresponding to a symbol from
- *  the symbol's data source.  The return value should be free()'d
- *  when no longer needed.
+ *  Returns the entry for \a symbol if it is in the symbol data cache
+ *  and moves it to the front of the LRU list.  Unlike
+ *  get_cache_entry(), this doesn't fetch missing data and doesn't
+ *  count towards the cache statistics.  Private function used only
+ *  in s_clib.c.
+ *
+ *  \param symbol Symbol to look up.
+ *  \return The cache entry, owned by the cache, or \b NULL.
+ */
+static CacheEntry *lookup_cache_entry (const CLibSymbol *symbol)
+{
+  /* Trickery to bypass effects of const */
+  CacheEntry *cached = g_hash_table_lookup (clib_symbol_cache,
+                                            (gpointer) symbol);
+
+  if (cached != NULL) {
+    g_queue_unlink (&clib_symbol_lru, &cached->link);
+    g_queue_push_head_link (&clib_symbol_lru, &cached->link);
+  }
+  return cached;
+}
+
+/*! \brief Get the cache entry for a symbol.
+ *  \par Function Description
+ *  Looks up \a symbol in the symbol data cache.  If it isn't there
+ *  yet, fetches the symbol data from the symbol's source and adds a
+ *  new entry, removing the least recently used entries first if the
+ *  cache is full.  Private function used only in s_clib.c.
  *
  *  On failure, returns \b NULL (the error will be logged).
  *
- *  \param symbol Symbol to get data for.
- *  \return Allocated buffer containing symbol data.
+ *  \param symbol Symbol to get the cache entry for.
+ *  \return The cache entry, owned by the cache.
  */
-gchar *s_clib_symbol_get_data (const CLibSymbol *symbol)
+static CacheEntry *get_cache_entry (const CLibSymbol *symbol)
 {
   CacheEntry *cached;
-  gchar *data;
+  gchar *str = NULL;
+  GBytes *data;
+  gsize len;
   gpointer symptr;
-  gint n;
-
-  g_return_val_if_fail ((symbol != NULL), NULL);
-  g_return_val_if_fail ((symbol->source != NULL), NULL);
 
   /* Trickery to bypass effects of const */
   symptr = (gpointer) symbol;
 
   /* First, try the cache. */
-  cached = g_hash_table_lookup (clib_symbol_cache, symptr);
+  cached = lookup_cache_entry (symbol);
   if (cached != NULL) {
-    cached->accessed = time(NULL);
-    return g_strdup(cached->data);
+    clib_symbol_cache_hits++;
+    return cached;
   }
+  clib_symbol_cache_misses++;
 
   /* If the symbol wasn't found in the cache, get it directly. */
   switch (symbol->source->type)
@@ -1205,10 +1625,12 @@ gchar *s_clib_symbol_get_data (const CLibSymbol *symbol)
       data = get_data_directory (symbol);
       break;
     case CLIB_CMD:
-      data = get_data_command (symbol);
+      str = get_data_command (symbol);
+      data = (str != NULL) ? g_bytes_new_take (str, strlen (str)) : NULL;
       break;
     case CLIB_SCM:
-      data = get_data_scm (symbol);
+      str = get_data_scm (symbol);
+      data = (str != NULL) ? g_bytes_new_take (str, strlen (str)) : NULL;
       break;
     default:
       g_critical("s_clib_symbol_get_data: source %p has bad source type %i\n",
@@ -1217,26 +1639,189 @@ gchar *s_clib_symbol_get_data (const CLibSymbol *symbol)
     }
 
   if (data == NULL) return NULL;
+  len = g_bytes_get_size (data);
+
+  /* Clean out the cache if it's too full.  This is done before adding
+   * the new entry so the new entry is never the one thrown out. */
+  cache_trim (sizeof (CacheEntry) + len, NULL);
 
   /* Cache the symbol data */
-  cached = g_new (CacheEntry, 1);
+  cached = g_new0 (CacheEntry, 1);
   cached->ptr = (CLibSymbol *) symptr;
-  cached->data = g_strdup (data);
-  cached->accessed = time (NULL);
+  cached->data = data;
+  cached->prototype = NULL;
+  cached->size = sizeof (CacheEntry) + len;
+  cached->link.data = cached;
+  g_queue_push_head_link (&clib_symbol_lru, &cached->link);
+  clib_symbol_cache_used += cached->size;
   g_hash_table_insert (clib_symbol_cache, symptr, cached);
 
-  /* Clean out the cache if it's too full */
-  n = g_hash_table_size (clib_symbol_cache);
-  if (n > CLIB_MAX_SYMBOL_CACHE) {
-    for ( ; n > CLIB_MIN_SYMBOL_CACHE; n--) {
-      g_hash_table_foreach (clib_symbol_cache,
-                            (GHFunc) cache_find_oldest,
-                            &cached);
-      g_hash_table_remove (clib_symbol_cache, cached->ptr);
-    }
+  return cached;
+}
+
+/*! \brief Get symbol data.
+ *  \par Function Description
+ *  Get the unparsed gEDA-format data corresponding to a symbol from
+ *  the symbol's data source.  The return value should be free()'d
+ *  when no longer needed.
+ *
+ *  On failure, returns \b NULL (the error will be logged).
+ *
+ *  \param symbol Symbol to get data for.
+ *  \return Allocated buffer containing symbol data.
+ */
+gchar *s_clib_symbol_get_data (const CLibSymbol *symbol)
+{
+  CacheEntry *cached;
+  const gchar *data;
+  gsize len;
+
+  g_return_val_if_fail ((symbol != NULL), NULL);
+  g_return_val_if_fail ((symbol->source != NULL), NULL);
+
+  cached = get_cache_entry (symbol);
+  if (cached == NULL) return NULL;
+
+  data = g_bytes_get_data (cached->data, &len);
+  return g_strndup (data, len);
+}
+
+/*! \brief Get symbol data without copying it.
+ *  \par Function Description
+ *  Like s_clib_symbol_get_data(), but returns a new reference to the
+ *  buffer held by the symbol data cache instead of a copy.  The
+ *  buffer is never changed and stays valid after it has been evicted
+ *  from the cache.  Its data is \b not NUL-terminated, as it may be
+ *  mapped directly from the symbol file.  Release the reference with
+ *  g_bytes_unref() when no longer needed.
+ *
+ *  On failure, returns \b NULL (the error will be logged).
+ *
+ *  \param symbol Symbol to get data for.
+ *  \return Reference to the symbol data.
+ */
+GBytes *s_clib_symbol_get_bytes (const CLibSymbol *symbol)
+{
+  CacheEntry *cached;
+
+  g_return_val_if_fail ((symbol != NULL), NULL);
+  g_return_val_if_fail ((symbol->source != NULL), NULL);
+
+  cached = get_cache_entry (symbol);
+  if (cached == NULL) return NULL;
+
+  return g_bytes_ref (cached->data);
+}
+
+/*! \brief Get the parsed objects of a symbol.
+ *  \par Function Description
+ *  Returns the objects described by the symbol's data.  The data is
+ *  only parsed the first time the prototype of a symbol is requested;
+ *  later calls return the same prototype until the symbol data cache
+ *  is flushed or the symbol is invalidated.  This lets o_complex_new()
+ *  instantiate a symbol by copying its prototype instead of parsing
+ *  the symbol data once per instance.
+ *
+ *  The caller gets a new reference to the prototype, which keeps it
+ *  valid even if it is evicted from the cache in the meantime.
+ *  Release it with s_clib_prototype_unref() when done.  The objects
+ *  of a prototype are shared and must not be modified or attached to
+ *  a page.  Copying them sets their copied_to fields, so they must
+ *  only be used from the main thread.
+ *
+ *  If the symbol data can't be found or parsed, returns \b NULL and
+ *  sets \a err.
+ *
+ *  \param toplevel  The TOPLEVEL object.
+ *  \param symbol    Symbol to get the prototype for.
+ *  \param err       Location to return error information.
+ *  \return A new reference to the symbol's prototype.
+ */
+CLibPrototype *
+s_clib_symbol_get_prototype (TOPLEVEL *toplevel, const CLibSymbol *symbol,
+                             GError **err)
+{
+  CacheEntry *cached;
+  CLibPrototype *prototype;
+  GList *objects;
+  GBytes *data;
+  gsize len;
+  GError *tmp_err = NULL;
+
+  g_return_val_if_fail ((symbol != NULL), NULL);
+  g_return_val_if_fail ((symbol->source != NULL), NULL);
+
+  cached = get_cache_entry (symbol);
+  if (cached == NULL) {
+    g_set_error (err, EDA_ERROR, EDA_ERROR_NOLIB,
+                 _("Failed to load symbol data [%s]"), symbol->name);
+    return NULL;
+  }
+  if (cached->prototype != NULL) {
+    cached->prototype->refcount++;
+    return cached->prototype;
   }
 
-  return data;
+  /* The symbol may contain components itself, so loading it can
+   * push this entry out of the cache.  Hold a reference to the data
+   * while parsing it and look the entry up again afterwards. */
+  data = g_bytes_ref (cached->data);
+  objects = o_read_buffer (toplevel, NULL,
+                           (gchar *) g_bytes_get_data (data, &len), len,
+                           symbol->name, &tmp_err);
+  g_bytes_unref (data);
+
+  if (tmp_err != NULL) {
+    g_propagate_error (err, tmp_err);
+    return NULL;
+  }
+
+  /* If the entry has been pushed out, the caller gets a prototype
+   * which isn't cached. */
+  cached = lookup_cache_entry (symbol);
+  if (cached != NULL && cached->prototype != NULL) {
+    s_delete_object_glist (toplevel, objects);
+    cached->prototype->refcount++;
+    return cached->prototype;
+  }
+
+  prototype = g_new (CLibPrototype, 1);
+  prototype->refcount = 1;
+  prototype->objects = objects;
+
+  if (cached != NULL) {
+    gsize size = g_list_length (objects) * sizeof (OBJECT);
+    cached->prototype = prototype;
+    cached->size += size;
+    clib_symbol_cache_used += size;
+    prototype->refcount++;
+    cache_trim (0, cached);
+  }
+
+  return prototype;
+}
+
+/*! \brief Release a reference to a symbol prototype.
+ *  \par Function Description
+ *  Drops a reference returned by s_clib_symbol_get_prototype().  The
+ *  prototype and its objects are freed once they are neither in the
+ *  symbol data cache nor used by anyone else.
+ *
+ *  \param prototype  The prototype to release.
+ */
+void
+s_clib_prototype_unref (CLibPrototype *prototype)
+{
+  g_return_if_fail (prototype != NULL);
+  g_return_if_fail (prototype->refcount > 0);
+
+  if (--prototype->refcount > 0)
+    return;
+
+  /* prototype objects are never attached to a page or connected to
+   * anything, so no toplevel is needed to delete them */
+  s_delete_object_glist (NULL, prototype->objects);
+  g_free (prototype);
 }
 
 /*! \brief Find all symbols matching a pattern.  
@@ -1289,6 +1874,9 @@ GList *s_clib_search (const gchar *pattern, const CLibSearchMode mode)
     }
   key = g_strdup_printf("%c%s", keytype, pattern);
 
+  /* Pending directory scans may still change the results */
+  finish_all_directories ();
+
   /* Check to see if the query is already in the cache */
   result = (GList *) g_hash_table_lookup (clib_search_cache, key);
   if (result != NULL) {
@@ -1306,25 +1894,24 @@ GList *s_clib_search (const gchar *pattern, const CLibSearchMode mode)
 
     source = (CLibSource *) sourcelist->data;
 
+    /* Exact matches can be looked up in the source's index. */
+    if (mode == CLIB_EXACT) {
+      symbol = source_has_symbol (source, pattern);
+      if (symbol != NULL) {
+        result = g_list_prepend (result, symbol);
+      }
+      continue;
+    }
+
     for (symlist = source->symbols;
 	 symlist != NULL;
 	 symlist = g_list_next(symlist)) {
     
       symbol = (CLibSymbol *) symlist->data;
 
-      switch (mode)
-	{
-	case CLIB_EXACT:
-	  if (strcmp (pattern, symbol->name) == 0) {
-	    result = g_list_prepend (result, symbol);
-	  }
-	  break;
-	case CLIB_GLOB:
-	  if (g_pattern_match_string (globpattern, symbol->name)) {
-	    result = g_list_prepend (result, symbol);
-	  }
-	  break;
-	}
+      if (g_pattern_match_string (globpattern, symbol->name)) {
+        result = g_list_prepend (result, symbol);
+      }
     }
   }
 
@@ -1357,15 +1944,52 @@ void s_clib_flush_search_cache ()
 
 /*! \brief Flush the symbol data cache.
  *  \par Function Description
- *  Clears the hashtable which caches the results of s_clib_symbol_get_data().
- *  You shouldn't ever need to call this, as all functions which
- *  invalidate the cache are supposed to make sure it's flushed.
+ *  Clears the hashtable which caches the results of s_clib_symbol_get_data()
+ *  and s_clib_symbol_get_prototype().  You shouldn't ever need to call
+ *  this, as all functions which invalidate the cache are supposed to
+ *  make sure it's flushed.
  */
 void s_clib_flush_symbol_cache ()
 {
   g_hash_table_remove_all (clib_symbol_cache);  /* Introduced in glib 2.12 */
 }
 
+/*! \brief Set the size of the symbol data cache.
+ *  \par Function Description
+ *  Sets the number of bytes which the symbol data cache may use for
+ *  symbol data and parsed symbols before the least recently used
+ *  symbols are evicted.  If the cache currently holds more than
+ *  that, it is trimmed immediately.
+ *
+ *  \param size Maximum size of the symbol data cache in bytes.
+ */
+void s_clib_set_symbol_cache_size (gsize size)
+{
+  clib_symbol_cache_size = size;
+  if (clib_symbol_cache != NULL)
+    cache_trim (0, NULL);
+}
+
+/*! \brief Get statistics about the symbol data cache.
+ *  \par Function Description
+ *  Returns the number of lookups which were satisfied by the symbol
+ *  data cache, the number which had to fetch the symbol data from
+ *  its source, and the number of entries which were evicted to make
+ *  room for others, counted since the library was initialised.  Any
+ *  of the pointers may be \b NULL.
+ *
+ *  \param hits       Location to return the number of cache hits.
+ *  \param misses     Location to return the number of cache misses.
+ *  \param evictions  Location to return the number of evictions.
+ */
+void s_clib_get_symbol_cache_stats (gulong *hits, gulong *misses,
+                                    gulong *evictions)
+{
+  if (hits != NULL) *hits = clib_symbol_cache_hits;
+  if (misses != NULL) *misses = clib_symbol_cache_misses;
+  if (evictions != NULL) *evictions = clib_symbol_cache_evictions;
+}
+
 /*! \brief Invalidate all cached data about a symbol.
  * \par Function Description
  * Removes all cached symbol data for \a symbol.
@@ -1563,6 +2187,9 @@ void s_clib_begin_update ()
 
 void s_clib_end_update ()
 {
+  /* Pending directory scans tell whether anything changed */
+  finish_all_directories ();
+
   if (!s_clib_updating)
     return;
   s_clib_updating = FALSE;
@@ -0,0 +1,521 @@
+/* gEDA - GPL Electronic Design Automation
+ * libgeda - gEDA's library
+ * Copyright (C) 1998-2010 Ales Hvezda
+ * Copyright (C) 1998-2020 gEDA Contributors (see ChangeLog for details)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*! \file s_clib_index.c
+ *  \brief On-disk index of component library directories.
+ *
+ *  Scanning a large component library directory means reading the
+ *  directory and stat()ing every symbol file in it, which every
+ *  program using the library would otherwise have to do on startup.
+ *  Instead, the result of a scan is saved to an index file in the
+ *  user's cache directory, together with a short summary of each
+ *  symbol (its pin count and floating attributes).  As long as the
+ *  modification time of the directory matches the one recorded in
+ *  the index, the index is used instead of scanning the directory.
+ *
+ *  The index of a directory is stored as
+ *  <tt>$XDG_CACHE_HOME/gEDA/clib/<i>sha1</i>.idx</tt>, where
+ *  <i>sha1</i> is the hex SHA-1 digest of the directory path as given
+ *  to s_clib_add_directory().  The format is shared with the xorn
+ *  gaf.clib module, so any change here must be made there as well.
+ *  All integers are little-endian:
+ *
+ *  - header: the magic string "GAFCLIB\n", the format version (uint32,
+ *    currently 1), the number of records (uint32), and the
+ *    modification time of the directory (int64);
+ *  - one record per symbol file: the length of the rest of the
+ *    record (uint32), the modification time (int64) and size (int64)
+ *    of the file, its pin count (int32), the number of attributes
+ *    (uint32), the file name, and the attributes as "name=value"
+ *    strings, each string terminated by a NUL byte.
+ *
+ *  Files ending in ".sym.xml" are listed as well since the xorn
+ *  library can read them; libgeda skips them when loading the index.
+ *  Their summaries are empty.
+ *
+ *  All functions in this file can be called from any thread.
+ */
+
+#include <config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#include "libgeda_priv.h"
+
+/*! Magic string at the start of an index file */
+#define INDEX_MAGIC "GAFCLIB\n"
+/*! Version of the index file format */
+#define INDEX_VERSION 1
+/*! Size of the index file header */
+#define INDEX_HEADER_SIZE (8 + 4 + 4 + 8)
+/*! Size of the fixed part of a record, after the length field */
+#define INDEX_RECORD_SIZE (8 + 8 + 4 + 4)
+
+/*! Suffix of libgeda symbol files */
+#define SYM_SUFFIX ".sym"
+/*! Suffix of symbol files in the XML format read by xorn */
+#define SYM_XML_SUFFIX ".sym.xml"
+
+/*! \brief Get the index file name for a library directory.
+ *  \par Function Description
+ *  Returns the path of the file which holds the index of \a
+ *  directory.  The file and its parent directories need not exist.
+ *
+ *  \param directory The path of the library directory.
+ *  \return A newly allocated path.
+ */
+gchar *
+s_clib_index_get_filename (const gchar *directory)
+{
+  gchar *digest, *basename, *filename;
+
+  digest = g_compute_checksum_for_string (G_CHECKSUM_SHA1, directory, -1);
+  basename = g_strconcat (digest, ".idx", NULL);
+  filename = g_build_filename (g_get_user_cache_dir (), "gEDA", "clib",
+                               basename, NULL);
+  g_free (basename);
+  g_free (digest);
+  return filename;
+}
+
+/*! \brief Check whether a file belongs into the index.
+ *  \par Function Description
+ *  Returns \b TRUE if \a name (a file name without directory) looks
+ *  like a symbol file to libgeda or xorn.  Hidden files never do.
+ *  Doesn't check whether the file is a regular file.
+ */
+gboolean
+s_clib_index_is_candidate (const gchar *name)
+{
+  gchar *low_name;
+  gboolean result;
+
+  if (name[0] == '.')
+    return FALSE;
+
+  low_name = g_utf8_strdown (name, -1);
+  result = g_str_has_suffix (low_name, SYM_SUFFIX)
+        || g_str_has_suffix (low_name, SYM_XML_SUFFIX);
+  g_free (low_name);
+  return result;
+}
+
+/*! \brief Check whether a symbol file line is a simple attribute.
+ *  \par Function Description
+ *  Returns \b TRUE if \a line has the form "name=value" with neither
+ *  part empty and no spaces in the name.
+ */
+static gboolean
+is_attribute (const gchar *line)
+{
+  const gchar *eq = strchr (line, '=');
+
+  return eq != NULL && eq != line && eq[1] != '\0'
+    && memchr (line, ' ', eq - line) == NULL;
+}
+
+/*! \brief Count the whitespace-separated fields of a line.
+ *  \par Function Description
+ *  Returns the number of fields in \a line and stores the value of
+ *  the field with index \a n (counting from 0) in \a value if it
+ *  exists.
+ */
+static int
+get_field (const gchar *line, int n, int *value)
+{
+  gchar **fields = g_strsplit_set (line, " \t", -1);
+  int count = 0;
+  int i;
+
+  for (i = 0; fields[i] != NULL; i++) {
+    if (fields[i][0] == '\0')
+      continue;
+    if (count == n)
+      *value = atoi (fields[i]);
+    count++;
+  }
+
+  g_strfreev (fields);
+  return count;
+}
+
+/*! \brief Summarise a symbol file.
+ *  \par Function Description
+ *  Reads the symbol file \a path and returns its pin count and
+ *  floating attributes.  This only skims the file format; the file
+ *  isn't parsed into objects, so it is much cheaper than loading the
+ *  symbol and doesn't need a TOPLEVEL.  If the file can't be read, or
+ *  isn't a libgeda symbol file, the summary has a pin count of -1 and
+ *  no attributes.
+ *
+ *  \param path   The path of the symbol file.
+ *  \param mtime  The modification time of the file.
+ *  \param size   The size of the file in bytes.
+ *  \return A newly allocated summary.
+ */
+CLibSummary *
+s_clib_summary_new (const gchar *path, gint64 mtime, gint64 size)
+{
+  CLibSummary *summary;
+  GPtrArray *attribs;
+  gchar *data = NULL;
+  gchar **lines;
+  gchar *low_path;
+  int depth = 0;
+  int text_lines = 0, path_lines = 0;
+  gboolean text_is_attrib = FALSE;
+  gboolean picture_filename = FALSE, picture_data = FALSE;
+  int embedded = 0;
+  int i, n;
+
+  summary = g_new0 (CLibSummary, 1);
+  summary->mtime = mtime;
+  summary->size = size;
+  summary->pin_count = -1;
+  summary->attribs = g_new0 (gchar *, 1);
+
+  low_path = g_utf8_strdown (path, -1);
+  if (!g_str_has_suffix (low_path, SYM_SUFFIX)
+      || !g_file_get_contents (path, &data, NULL, NULL)) {
+    g_free (low_path);
+    return summary;
+  }
+  g_free (low_path);
+
+  attribs = g_ptr_array_new ();
+  summary->pin_count = 0;
+  lines = g_strsplit (data, "\n", -1);
+  g_free (data);
+
+  for (i = 0; lines[i] != NULL; i++) {
+    gchar *line = lines[i];
+    gsize len = strlen (line);
+
+    if (len > 0 && line[len - 1] == '\r')
+      line[len - 1] = '\0';
+
+    if (text_lines > 0) {
+      if (text_is_attrib && is_attribute (line))
+        g_ptr_array_add (attribs, g_strdup (line));
+      text_lines--;
+      continue;
+    }
+    if (path_lines > 0) {
+      path_lines--;
+      continue;
+    }
+    if (picture_filename) {
+      picture_filename = FALSE;
+      picture_data = (embedded == 1);
+      continue;
+    }
+    if (picture_data) {
+      if (strcmp (line, ".") == 0)
+        picture_data = FALSE;
+      continue;
+    }
+
+    switch (line[0]) {
+    case '{':
+    case '[':
+      depth++;
+      break;
+    case '}':
+    case ']':
+      depth--;
+      break;
+    case OBJ_PIN:
+      if (depth == 0)
+        summary->pin_count++;
+      break;
+    case OBJ_TEXT:
+      /* Files older than 20000220 have no line count. */
+      n = 1;
+      if (get_field (line, 9, &n) < 10)
+        n = 1;
+      text_lines = MAX (n, 0);
+      text_is_attrib = (depth == 0 && n == 1);
+      break;
+    case OBJ_PATH:
+      n = 0;
+      get_field (line, 13, &n);
+      path_lines = MAX (n, 0);
+      break;
+    case OBJ_PICTURE:
+      embedded = 0;
+      get_field (line, 7, &embedded);
+      picture_filename = TRUE;
+      break;
+    default:
+      break;
+    }
+  }
+
+  g_strfreev (lines);
+
+  g_free (summary->attribs);
+  g_ptr_array_add (attribs, NULL);
+  summary->attribs = (gchar **) g_ptr_array_free (attribs, FALSE);
+  return summary;
+}
+
+/*! \brief Free a symbol summary.
+ *  \par Function Description
+ *  Frees \a summary and all its attribute strings.
+ */
+void
+s_clib_summary_free (CLibSummary *summary)
+{
+  if (summary == NULL)
+    return;
+  g_strfreev (summary->attribs);
+  g_free (summary);
+}
+
+static guint32
+get_u32 (const gchar *p)
+{
+  guint32 value;
+  memcpy (&value, p, sizeof value);
+  return GUINT32_FROM_LE (value);
+}
+
+static gint64
+get_i64 (const gchar *p)
+{
+  gint64 value;
+  memcpy (&value, p, sizeof value);
+  return GINT64_FROM_LE (value);
+}
+
+static void
+put_u32 (GByteArray *buf, guint32 value)
+{
+  value = GUINT32_TO_LE (value);
+  g_byte_array_append (buf, (const guint8 *) &value, sizeof value);
+}
+
+static void
+put_i64 (GByteArray *buf, gint64 value)
+{
+  value = GINT64_TO_LE (value);
+  g_byte_array_append (buf, (const guint8 *) &value, sizeof value);
+}
+
+static void
+put_string (GByteArray *buf, const gchar *s)
+{
+  g_byte_array_append (buf, (const guint8 *) s, strlen (s) + 1);
+}
+
+/*! \brief Get the next NUL-terminated string of a record.
+ *  \par Function Description
+ *  Returns the string at \a *p and advances \a *p past it, or returns
+ *  \b NULL if there is no terminating NUL byte before \a end.
+ */
+static const gchar *
+get_string (const gchar **p, const gchar *end)
+{
+  const gchar *s = *p;
+  const gchar *nul = memchr (s, '\0', end - s);
+
+  if (nul == NULL)
+    return NULL;
+  *p = nul + 1;
+  return s;
+}
+
+/*! \brief Read the index of a library directory.
+ *  \par Function Description
+ *  Maps the index file \a filename into memory and appends the names
+ *  of the symbol files it lists to \a names and their summaries to \a
+ *  summaries, if these aren't \b NULL.  The index is only used if it
+ *  was written for a directory with the modification time \a mtime;
+ *  pass -1 to accept any index.
+ *
+ *  \param filename   The path of the index file.
+ *  \param mtime      The modification time of the directory, or -1.
+ *  \param names      Array to append newly allocated names to.
+ *  \param summaries  Array to append newly allocated #CLibSummary
+ *                    structures to.
+ *  \return \b TRUE if the index was read, \b FALSE if it is missing,
+ *          out of date or corrupt (in which case nothing is appended).
+ */
+gboolean
+s_clib_index_read (const gchar *filename, gint64 mtime,
+                   GPtrArray *names, GPtrArray *summaries)
+{
+  GMappedFile *file;
+  const gchar *data, *p, *end;
+  gsize length;
+  guint32 count, i, j;
+  guint old_names = names != NULL ? names->len : 0;
+  guint old_summaries = summaries != NULL ? summaries->len : 0;
+  gboolean ok = FALSE;
+
+  file = g_mapped_file_new (filename, FALSE, NULL);
+  if (file == NULL)
+    return FALSE;
+
+  data = g_mapped_file_get_contents (file);
+  length = g_mapped_file_get_length (file);
+  end = data + length;
+
+  if (length < INDEX_HEADER_SIZE
+      || memcmp (data, INDEX_MAGIC, 8) != 0
+      || get_u32 (data + 8) != INDEX_VERSION
+      || (mtime != -1 && get_i64 (data + 16) != mtime))
+    goto out;
+
+  count = get_u32 (data + 12);
+  p = data + INDEX_HEADER_SIZE;
+
+  for (i = 0; i < count; i++) {
+    const gchar *record_end;
+    const gchar *name;
+    CLibSummary *summary;
+    guint32 n_attribs;
+
+    if (end - p < 4 + INDEX_RECORD_SIZE)
+      goto out;
+    record_end = p + 4 + get_u32 (p);
+    if (record_end > end || record_end < p + 4 + INDEX_RECORD_SIZE)
+      goto out;
+    p += 4;
+
+    summary = g_new0 (CLibSummary, 1);
+    summary->mtime = get_i64 (p);
+    summary->size = get_i64 (p + 8);
+    summary->pin_count = (gint32) get_u32 (p + 16);
+    n_attribs = get_u32 (p + 20);
+    p += INDEX_RECORD_SIZE;
+
+    name = get_string (&p, record_end);
+    if (name == NULL || n_attribs > (guint32) (record_end - p)) {
+      s_clib_summary_free (summary);
+      goto out;
+    }
+
+    summary->attribs = g_new0 (gchar *, n_attribs + 1);
+    for (j = 0; j < n_attribs; j++) {
+      const gchar *attrib = get_string (&p, record_end);
+      if (attrib == NULL) {
+        s_clib_summary_free (summary);
+        goto out;
+      }
+      summary->attribs[j] = g_strdup (attrib);
+    }
+    p = record_end;
+
+    if (names != NULL)
+      g_ptr_array_add (names, g_strdup (name));
+    if (summaries != NULL)
+      g_ptr_array_add (summaries, summary);
+    else
+      s_clib_summary_free (summary);
+  }
+
+  ok = TRUE;
+
+ out:
+  if (!ok) {
+    /* Drop any records read from a corrupt index. */
+    if (names != NULL) {
+      for (i = old_names; i < names->len; i++)
+        g_free (g_ptr_array_index (names, i));
+      g_ptr_array_set_size (names, old_names);
+    }
+    if (summaries != NULL) {
+      for (i = old_summaries; i < summaries->len; i++)
+        s_clib_summary_free (g_ptr_array_index (summaries, i));
+      g_ptr_array_set_size (summaries, old_summaries);
+    }
+  }
+  g_mapped_file_unref (file);
+  return ok;
+}
+
+/*! \brief Write the index of a library directory.
+ *  \par Function Description
+ *  Saves the symbol file names in \a names and the corresponding
+ *  summaries in \a summaries to the index file \a filename, creating
+ *  its parent directories if necessary.  The file is replaced
+ *  atomically, so concurrent readers see either the old or the new
+ *  index.
+ *
+ *  \param filename   The path of the index file.
+ *  \param mtime      The modification time of the directory.
+ *  \param names      Array of symbol file names.
+ *  \param summaries  Array of #CLibSummary structures.
+ *  \return \b TRUE on success, \b FALSE if the index couldn't be
+ *          written.
+ */
+gboolean
+s_clib_index_write (const gchar *filename, gint64 mtime,
+                    GPtrArray *names, GPtrArray *summaries)
+{
+  GByteArray *buf;
+  gchar *dirname;
+  gboolean result;
+  guint i, j;
+
+  g_return_val_if_fail (names->len == summaries->len, FALSE);
+
+  dirname = g_path_get_dirname (filename);
+  if (g_mkdir_with_parents (dirname, 0755) != 0) {
+    g_free (dirname);
+    return FALSE;
+  }
+  g_free (dirname);
+
+  buf = g_byte_array_new ();
+  g_byte_array_append (buf, (const guint8 *) INDEX_MAGIC, 8);
+  put_u32 (buf, INDEX_VERSION);
+  put_u32 (buf, names->len);
+  put_i64 (buf, mtime);
+
+  for (i = 0; i < names->len; i++) {
+    CLibSummary *summary = g_ptr_array_index (summaries, i);
+    guint start, n_attribs = g_strv_length (summary->attribs);
+    guint32 record_length;
+
+    start = buf->len;
+    put_u32 (buf, 0);  /* filled in below */
+    put_i64 (buf, summary->mtime);
+    put_i64 (buf, summary->size);
+    put_u32 (buf, (guint32) summary->pin_count);
+    put_u32 (buf, n_attribs);
+    put_string (buf, g_ptr_array_index (names, i));
+    for (j = 0; j < n_attribs; j++)
+      put_string (buf, summary->attribs[j]);
+
+    record_length = GUINT32_TO_LE (buf->len - start - 4);
+    memcpy (buf->data + start, &record_length, sizeof record_length);
+  }
+
+  result = g_file_set_contents (filename, (const gchar *) buf->data,
+                                buf->len, NULL);
+  g_byte_array_free (buf, TRUE);
+  return result;
+}
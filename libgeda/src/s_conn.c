@@ -42,8 +42,301 @@
  *  
  *  \image html s_conn_overview.png
  *  \image latex s_conn_overview.pdf "Connection overview" width=14cm
+ *
+ *  To find the objects an OBJECT may be connected to without looking
+ *  at every connectible object of the page, each page keeps a
+ *  #CONN_INDEX.  It maps each point to the objects which have a
+ *  connectible end there, and each row and column to the horizontal
+ *  and vertical nets and buses on it and to the objects which have a
+ *  connectible end on it.
  */
 
+/*! Objects indexed under a single key of a #CONN_INDEX table */
+typedef struct _ConnBucket ConnBucket;
+struct _ConnBucket {
+  /*! Point, row or column this bucket is stored under */
+  gint64 key;
+  /*! Set of the objects stored under this key */
+  GHashTable *objects;
+};
+
+/*! Connectible object of a page, as it is currently indexed */
+typedef struct _ConnEntry ConnEntry;
+struct _ConnEntry {
+  /*! The object */
+  OBJECT *object;
+  /*! Link of the object in page->connectible_list */
+  GList *link;
+  /*! Sequence number; entries added later are further down the list */
+  guint64 seq;
+  /*! Coordinates of the object's ends when it was indexed */
+  int x[2], y[2];
+};
+
+/*! Spatial index of the connectible objects of a page */
+struct st_conn_index {
+  /*! #ConnEntry for each object in page->connectible_list */
+  GHashTable *objects;
+  /*! Last link of page->connectible_list */
+  GList *tail;
+  /*! Sequence number of the next entry */
+  guint64 next_seq;
+  /*! Objects by point of a connectible end */
+  GHashTable *endpoints;
+  /*! Objects by row of a connectible end */
+  GHashTable *endpoint_rows;
+  /*! Objects by column of a connectible end */
+  GHashTable *endpoint_columns;
+  /*! Horizontal nets and buses by row */
+  GHashTable *horizontal;
+  /*! Vertical nets and buses by column */
+  GHashTable *vertical;
+};
+
+typedef void (*BucketFunc) (GHashTable *table, gint64 key, OBJECT *object);
+
+/*! \brief Return the key of a point in a #CONN_INDEX table. */
+static gint64 point_key (int x, int y)
+{
+  return (gint64) (((guint64) (guint32) x << 32) | (guint32) y);
+}
+
+/*! \brief Check if an end of a net, bus or pin can be connected to.
+ *  \par Function Description
+ *  Pins can only be connected at the end given by their whichend
+ *  field, nets and buses at both ends.
+ */
+static int end_is_connectible (OBJECT *object, int end)
+{
+  return object->type != OBJ_PIN || object->whichend == end;
+}
+
+static void free_bucket (gpointer data)
+{
+  ConnBucket *bucket = data;
+  g_hash_table_destroy (bucket->objects);
+  g_free (bucket);
+}
+
+static GHashTable *bucket_table_new (void)
+{
+  return g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                NULL, free_bucket);
+}
+
+static GHashTable *bucket_lookup (GHashTable *table, gint64 key)
+{
+  ConnBucket *bucket = g_hash_table_lookup (table, &key);
+  return bucket != NULL ? bucket->objects : NULL;
+}
+
+static void bucket_add (GHashTable *table, gint64 key, OBJECT *object)
+{
+  ConnBucket *bucket = g_hash_table_lookup (table, &key);
+
+  if (bucket == NULL) {
+    bucket = g_new (ConnBucket, 1);
+    bucket->key = key;
+    bucket->objects = g_hash_table_new (g_direct_hash, g_direct_equal);
+    g_hash_table_insert (table, &bucket->key, bucket);
+  }
+
+  g_hash_table_add (bucket->objects, object);
+}
+
+static void bucket_remove (GHashTable *table, gint64 key, OBJECT *object)
+{
+  ConnBucket *bucket = g_hash_table_lookup (table, &key);
+
+  g_return_if_fail (bucket != NULL);
+
+  g_hash_table_remove (bucket->objects, object);
+  if (g_hash_table_size (bucket->objects) == 0) {
+    g_hash_table_remove (table, &key);
+  }
+}
+
+/*! \brief Add an entry to or remove it from the index tables.
+ *  \par Function Description
+ *  Calls \a func for every table and key the object described by
+ *  \a entry is stored under.  Using the same function for adding and
+ *  removing keeps both operations symmetric.
+ *
+ *  \param index  The page's connection index
+ *  \param entry  The entry to add or remove
+ *  \param func   Either bucket_add() or bucket_remove()
+ */
+static void index_foreach_bucket (CONN_INDEX *index, ConnEntry *entry,
+                                  BucketFunc func)
+{
+  OBJECT *object = entry->object;
+  int *x = entry->x, *y = entry->y;
+  int j;
+
+  for (j = 0; j < 2; j++) {
+    if (!end_is_connectible (object, j))
+      continue;
+
+    /* Store each point, row and column only once per object */
+    if (j == 1 && end_is_connectible (object, 0)) {
+      if (x[0] != x[1] || y[0] != y[1])
+        func (index->endpoints, point_key (x[1], y[1]), object);
+      if (y[0] != y[1])
+        func (index->endpoint_rows, y[1], object);
+      if (x[0] != x[1])
+        func (index->endpoint_columns, x[1], object);
+      continue;
+    }
+
+    func (index->endpoints, point_key (x[j], y[j]), object);
+    func (index->endpoint_rows, y[j], object);
+    func (index->endpoint_columns, x[j], object);
+  }
+
+  /* Pins are not allowed midpoint connections onto them. */
+  if (object->type == OBJ_PIN)
+    return;
+
+  if (y[0] == y[1] && x[0] != x[1])
+    func (index->horizontal, y[0], object);
+  if (x[0] == x[1] && y[0] != y[1])
+    func (index->vertical, x[0], object);
+}
+
+/*! \brief Candidates found by find_candidates() so far */
+typedef struct _Candidates Candidates;
+struct _Candidates {
+  /*! The object to find candidates for */
+  OBJECT *object;
+  /*! The index entries of the objects found */
+  GPtrArray *entries;
+  /*! Set of the objects found */
+  GHashTable *seen;
+};
+
+/*! \brief Add an object to the candidates unless it is already there. */
+static void add_candidate (CONN_INDEX *index, Candidates *candidates,
+                           OBJECT *other_object)
+{
+  if (other_object == candidates->object ||
+      !g_hash_table_add (candidates->seen, other_object))
+    return;
+  g_ptr_array_add (candidates->entries,
+                   g_hash_table_lookup (index->objects, other_object));
+}
+
+/*! \brief Compare two index entries by their position in the list. */
+static gint compare_entries (gconstpointer a, gconstpointer b)
+{
+  const ConnEntry *entry_a = *(ConnEntry * const *) a;
+  const ConnEntry *entry_b = *(ConnEntry * const *) b;
+
+  if (entry_a->seq != entry_b->seq)
+    return entry_a->seq < entry_b->seq ? -1 : 1;
+  return 0;
+}
+
+/*! \brief Find the objects a line object may be connected to.
+ *  \par Function Description
+ *  Uses the page's connection index to find all objects which have a
+ *  connectible end at a connectible end of \a object, which are hit
+ *  in the middle by a connectible end of \a object, or which hit \a
+ *  object in the middle with one of their connectible ends.  The
+ *  objects are only candidates; whether they may actually be
+ *  connected to \a object depends on their type and parent.
+ *
+ *  The candidates are returned in the order of the page's list of
+ *  connectible objects, so connections are made in the same order as
+ *  if the whole list had been searched.
+ *
+ *  \param page    The PAGE structure
+ *  \param object  The net, bus or pin to find candidates for
+ *  \return A GList of OBJECTs which must be freed with g_list_free().
+ */
+static GList *find_candidates (PAGE *page, OBJECT *object)
+{
+  CONN_INDEX *index = page->conn_index;
+  Candidates candidates;
+  GHashTable *bucket;
+  GHashTableIter iter;
+  gpointer key;
+  OBJECT *other_object;
+  GList *result = NULL;
+  int i, j, k;
+
+  if (index == NULL)
+    return NULL;
+
+  candidates.object = object;
+  candidates.entries = g_ptr_array_new ();
+  candidates.seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (j = 0; j < 2; j++) {
+    int x = object->line->x[j], y = object->line->y[j];
+
+    if (!end_is_connectible (object, j))
+      continue;
+
+    bucket = bucket_lookup (index->endpoints, point_key (x, y));
+    if (bucket != NULL) {
+      g_hash_table_iter_init (&iter, bucket);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        add_candidate (index, &candidates, key);
+    }
+
+    bucket = bucket_lookup (index->vertical, x);
+    if (bucket != NULL) {
+      g_hash_table_iter_init (&iter, bucket);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        if (s_conn_check_midpoint (key, x, y))
+          add_candidate (index, &candidates, key);
+    }
+
+    bucket = bucket_lookup (index->horizontal, y);
+    if (bucket != NULL) {
+      g_hash_table_iter_init (&iter, bucket);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        if (s_conn_check_midpoint (key, x, y))
+          add_candidate (index, &candidates, key);
+    }
+  }
+
+  /* Look for objects ending somewhere in the middle of this one
+   * (pins are not allowed midpoint connections onto them) */
+  bucket = NULL;
+  if (object->type == OBJ_PIN)
+    ;
+  else if (object->line->y[0] == object->line->y[1])
+    bucket = bucket_lookup (index->endpoint_rows, object->line->y[0]);
+  else if (object->line->x[0] == object->line->x[1])
+    bucket = bucket_lookup (index->endpoint_columns, object->line->x[0]);
+
+  if (bucket != NULL) {
+    g_hash_table_iter_init (&iter, bucket);
+    while (g_hash_table_iter_next (&iter, &key, NULL)) {
+      other_object = key;
+      for (k = 0; k < 2; k++) {
+        if (end_is_connectible (other_object, k) &&
+            s_conn_check_midpoint (object, other_object->line->x[k],
+                                           other_object->line->y[k])) {
+          add_candidate (index, &candidates, other_object);
+          break;
+        }
+      }
+    }
+  }
+
+  g_ptr_array_sort (candidates.entries, compare_entries);
+  for (i = (int) candidates.entries->len - 1; i >= 0; i--) {
+    ConnEntry *entry = g_ptr_array_index (candidates.entries, i);
+    result = g_list_prepend (result, entry->object);
+  }
+
+  g_ptr_array_free (candidates.entries, TRUE);
+  g_hash_table_destroy (candidates.seen);
+  return result;
+}
+
 
 /*! \brief create a new connection object
  *  \par Function Description
@@ -329,13 +622,14 @@ static void add_connection (OBJECT *object, OBJECT *other_object,
  *  This function searches for all geometrical connections of the OBJECT
  *  <b>object</b> to all other connectable objects. It adds connections
  *  to the object and from all other
- *  objects to this one.
+ *  objects to this one.  The object must already have been added to
+ *  the page's connection index by s_conn_add_object().
  *  \param page   The PAGE structure
  *  \param object OBJECT to add into the connection system
  */
 static void s_conn_update_line_object (PAGE* page, OBJECT *object)
 {
-  GList *object_list;
+  GList *candidates, *object_list;
   OBJECT *other_object;
   OBJECT *found;
   int j, k;
@@ -347,8 +641,9 @@ static void s_conn_update_line_object (PAGE* page, OBJECT *object)
 
   complex = o_get_parent (toplevel, object);
 
-  /* loop over all connectible objects */
-  for (object_list = page->connectible_list;
+  /* loop over all connectible objects which are close enough */
+  candidates = find_candidates (page, object);
+  for (object_list = candidates;
        object_list != NULL;
        object_list = g_list_next (object_list)) {
     other_object = object_list->data;
@@ -471,6 +766,7 @@ static void s_conn_update_line_object (PAGE* page, OBJECT *object)
       }
     }
   }
+  g_list_free (candidates);
 
 #if DEBUG
   s_conn_print(object->conn_list);
@@ -644,13 +940,34 @@ GList *s_conn_return_others(GList *input_list, OBJECT *object)
   return return_list;
 }
 
+/*! \brief store the current coordinates of an object in the index */
+static void index_entry (CONN_INDEX *index, ConnEntry *entry)
+{
+  OBJECT *object = entry->object;
+
+  entry->x[0] = object->line->x[0];
+  entry->y[0] = object->line->y[0];
+  entry->x[1] = object->line->x[1];
+  entry->y[1] = object->line->y[1];
+  index_foreach_bucket (index, entry, bucket_add);
+}
+
 /*! \brief add a line object to the list of connectible objects
  *  \par Function Description
+ *  Adds the object to the page's list of connectible objects and to
+ *  its connection index.  If the object is already there, it is
+ *  indexed again under its current coordinates, as they may have
+ *  changed since it was added.
+ *
  *  \param page   The PAGE structure
  *  \param object The line OBJECT to add
  */
 static void s_conn_add_line_object (PAGE *page, OBJECT *object)
 {
+  CONN_INDEX *index;
+  ConnEntry *entry;
+  GList *link;
+
   g_return_if_fail (object != NULL);
   g_return_if_fail (object->line != NULL);
 
@@ -662,9 +979,83 @@ static void s_conn_add_line_object (PAGE *page, OBJECT *object)
     return;
   }
 
-  if (!g_list_find (page->connectible_list, object)) {
-    page->connectible_list = g_list_append (page->connectible_list, object);
+  if (page->conn_index == NULL) {
+    index = g_new (CONN_INDEX, 1);
+    index->objects = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                            NULL, g_free);
+    index->tail = NULL;
+    index->next_seq = 0;
+    index->endpoints = bucket_table_new ();
+    index->endpoint_rows = bucket_table_new ();
+    index->endpoint_columns = bucket_table_new ();
+    index->horizontal = bucket_table_new ();
+    index->vertical = bucket_table_new ();
+    page->conn_index = index;
+  }
+  index = page->conn_index;
+
+  entry = g_hash_table_lookup (index->objects, object);
+  if (entry != NULL) {
+    index_foreach_bucket (index, entry, bucket_remove);
+  } else {
+    /* append to page->connectible_list in constant time */
+    link = g_list_alloc ();
+    link->data = object;
+    link->prev = index->tail;
+    link->next = NULL;
+    if (index->tail != NULL) {
+      index->tail->next = link;
+    } else {
+      page->connectible_list = link;
+    }
+    index->tail = link;
+
+    entry = g_new (ConnEntry, 1);
+    entry->object = object;
+    entry->link = link;
+    entry->seq = index->next_seq++;
+    g_hash_table_insert (index->objects, object, entry);
   }
+
+  index_entry (index, entry);
+}
+
+/*! \brief index an object again under its current coordinates
+ *  \par Function Description
+ *  Must be called whenever the ends of a connectible object change,
+ *  otherwise connections to its new position won't be found.  Does
+ *  nothing if the object isn't in the page's connection index.  The
+ *  object's connections aren't changed; use s_conn_update_object()
+ *  for that.
+ *
+ *  Called by o_bounds_invalidate() for all objects on a page.
+ *
+ *  \param page   The PAGE structure
+ *  \param object The OBJECT whose coordinates may have changed
+ */
+void s_conn_reindex_object (PAGE *page, OBJECT *object)
+{
+  CONN_INDEX *index = page->conn_index;
+  ConnEntry *entry;
+
+  if (index == NULL) {
+    return;
+  }
+
+  entry = g_hash_table_lookup (index->objects, object);
+  if (entry == NULL) {
+    return;
+  }
+
+  if (entry->x[0] == object->line->x[0] &&
+      entry->y[0] == object->line->y[0] &&
+      entry->x[1] == object->line->x[1] &&
+      entry->y[1] == object->line->y[1]) {
+    return;
+  }
+
+  index_foreach_bucket (index, entry, bucket_remove);
+  index_entry (index, entry);
 }
 
 /*! \brief add an object to the list of connectible objects
@@ -702,6 +1093,8 @@ void s_conn_add_object (PAGE *page, OBJECT *object)
  */
 void s_conn_remove_object(PAGE* page, OBJECT *object)
 {
+  CONN_INDEX *index;
+  ConnEntry *entry;
   GList *iter;
 
   if (page == NULL) {
@@ -717,5 +1110,47 @@ void s_conn_remove_object(PAGE* page, OBJECT *object)
     }
   }
 
-  page->connectible_list = g_list_remove (page->connectible_list, object);
+  index = page->conn_index;
+  if (index == NULL) {
+    return;
+  }
+
+  entry = g_hash_table_lookup (index->objects, object);
+  if (entry == NULL) {
+    return;
+  }
+
+  index_foreach_bucket (index, entry, bucket_remove);
+
+  if (index->tail == entry->link) {
+    index->tail = entry->link->prev;
+  }
+  page->connectible_list = g_list_delete_link (page->connectible_list,
+                                               entry->link);
+  g_hash_table_remove (index->objects, object);
+}
+
+/*! \brief free the connection index of a page
+ *  \par Function Description
+ *  Frees the index built by s_conn_add_object().  The page's list of
+ *  connectible objects is not touched and has to be freed separately.
+ *
+ *  \param page  The PAGE structure
+ */
+void s_conn_free_index (PAGE *page)
+{
+  CONN_INDEX *index = page->conn_index;
+
+  if (index == NULL) {
+    return;
+  }
+
+  g_hash_table_destroy (index->objects);
+  g_hash_table_destroy (index->endpoints);
+  g_hash_table_destroy (index->endpoint_rows);
+  g_hash_table_destroy (index->endpoint_columns);
+  g_hash_table_destroy (index->horizontal);
+  g_hash_table_destroy (index->vertical);
+  g_free (index);
+  page->conn_index = NULL;
 }
@@ -55,6 +55,265 @@
 
 static gint global_pid = 0;
 
+/*! Width and height of a cell of the spatial index, in world units */
+#define INDEX_CELL_SIZE 2048
+/*! Objects covering more cells than this are kept in a separate list */
+#define INDEX_MAX_CELLS 64
+/*! Distance between the stacking orders of objects appended to a page,
+ *  leaving room for objects inserted between them */
+#define INDEX_ORDER_STEP 0x10000
+
+/*! Entry of an object in the spatial index of a page */
+typedef struct _IndexEntry IndexEntry;
+struct _IndexEntry {
+  /*! The object */
+  OBJECT *object;
+  /*! Position of the object in the stacking order of the page */
+  guint64 order;
+  /*! Link in the queue of objects which need to be re-indexed */
+  GList *dirty_link;
+  /*! Whether the object is stored in the cells or the large list */
+  gboolean placed;
+  /*! Cells covered by the object when it was indexed */
+  int cell_left, cell_top, cell_right, cell_bottom;
+  /*! Last query which has looked at this entry */
+  guint64 stamp;
+};
+
+/*! Objects stored in a single cell of the spatial index */
+typedef struct _IndexCell IndexCell;
+struct _IndexCell {
+  /*! Key of the cell */
+  gint64 key;
+  /*! #IndexEntry structures of the objects overlapping the cell */
+  GList *entries;
+};
+
+/*! Spatial index of the objects of a page
+ *
+ *  The world is divided into a grid of square cells, and each object
+ *  is stored in all cells its bounds overlap.  Objects which are too
+ *  large are kept in a separate list and looked at by every query.
+ *  Objects are re-indexed lazily: adding an object or invalidating
+ *  its bounds only queues it, and the queue is processed by the next
+ *  query. */
+struct st_page_index {
+  /*! #IndexEntry for each object on the page */
+  GHashTable *entries;
+  /*! #IndexCell by cell key */
+  GHashTable *cells;
+  /*! Entries covering more than #INDEX_MAX_CELLS cells */
+  GList *large;
+  /*! Entries which need to be re-indexed */
+  GQueue dirty;
+  /*! TOPLEVEL the indexed bounds have been calculated for */
+  TOPLEVEL *toplevel;
+  /*! Value of toplevel->show_hidden_text when the bounds were calculated */
+  int show_hidden_text;
+  /*! Stacking order of the next object added to the page */
+  guint64 next_order;
+  /*! Number of the current query */
+  guint64 stamp;
+};
+
+static int cell_of (int coord)
+{
+  if (coord >= 0) {
+    return coord / INDEX_CELL_SIZE;
+  }
+  return -(int) ((INDEX_CELL_SIZE - 1 - (gint64) coord) / INDEX_CELL_SIZE);
+}
+
+static gint64 cell_key (int cx, int cy)
+{
+  return (gint64) (((guint64) (guint32) cx << 32) | (guint32) cy);
+}
+
+static void free_index_cell (gpointer data)
+{
+  IndexCell *cell = data;
+  g_list_free (cell->entries);
+  g_free (cell);
+}
+
+static PAGE_INDEX *page_index_new (void)
+{
+  PAGE_INDEX *index = g_new0 (PAGE_INDEX, 1);
+
+  index->entries = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                          NULL, g_free);
+  index->cells = g_hash_table_new_full (g_int64_hash, g_int64_equal,
+                                        NULL, free_index_cell);
+  g_queue_init (&index->dirty);
+  return index;
+}
+
+static void page_index_free (PAGE_INDEX *index)
+{
+  g_hash_table_destroy (index->entries);
+  g_hash_table_destroy (index->cells);
+  g_list_free (index->large);
+  g_queue_clear (&index->dirty);
+  g_free (index);
+}
+
+/*! \brief Queue an index entry for re-indexing. */
+static void page_index_mark_dirty (PAGE_INDEX *index, IndexEntry *entry)
+{
+  if (entry->dirty_link == NULL) {
+    g_queue_push_tail (&index->dirty, entry);
+    entry->dirty_link = index->dirty.tail;
+  }
+}
+
+/*! \brief Remove an index entry from the cells it is stored in. */
+static void page_index_unplace (PAGE_INDEX *index, IndexEntry *entry)
+{
+  int cx, cy;
+
+  if (!entry->placed) {
+    return;
+  }
+  entry->placed = FALSE;
+
+  if (entry->cell_left > entry->cell_right) {
+    index->large = g_list_remove (index->large, entry);
+    return;
+  }
+
+  for (cx = entry->cell_left; cx <= entry->cell_right; cx++) {
+    for (cy = entry->cell_top; cy <= entry->cell_bottom; cy++) {
+      gint64 key = cell_key (cx, cy);
+      IndexCell *cell = g_hash_table_lookup (index->cells, &key);
+
+      g_return_if_fail (cell != NULL);
+      cell->entries = g_list_remove (cell->entries, entry);
+      if (cell->entries == NULL) {
+        g_hash_table_remove (index->cells, &key);
+      }
+    }
+  }
+}
+
+/*! \brief Store an index entry in the cells its object's bounds overlap.
+ *  \par Function Description
+ *  Objects which don't have bounds (e.g. hidden text) aren't stored
+ *  anywhere.  Any change which gives them bounds invalidates them and
+ *  causes them to be re-indexed.
+ */
+static void page_index_place (TOPLEVEL *toplevel, PAGE_INDEX *index,
+                              IndexEntry *entry)
+{
+  int left, top, right, bottom;
+  int cx, cy;
+
+  if (!world_get_single_object_bounds (toplevel, entry->object,
+                                       &left, &top, &right, &bottom)) {
+    return;
+  }
+  entry->placed = TRUE;
+
+  entry->cell_left = cell_of (left);
+  entry->cell_top = cell_of (top);
+  entry->cell_right = cell_of (right);
+  entry->cell_bottom = cell_of (bottom);
+
+  if ((gint64) (entry->cell_right - entry->cell_left + 1) *
+      (gint64) (entry->cell_bottom - entry->cell_top + 1) > INDEX_MAX_CELLS) {
+    /* mark the entry as being in the large list */
+    entry->cell_left = 1;
+    entry->cell_right = 0;
+    index->large = g_list_prepend (index->large, entry);
+    return;
+  }
+
+  for (cx = entry->cell_left; cx <= entry->cell_right; cx++) {
+    for (cy = entry->cell_top; cy <= entry->cell_bottom; cy++) {
+      gint64 key = cell_key (cx, cy);
+      IndexCell *cell = g_hash_table_lookup (index->cells, &key);
+
+      if (cell == NULL) {
+        cell = g_new (IndexCell, 1);
+        cell->key = key;
+        cell->entries = NULL;
+        g_hash_table_insert (index->cells, &cell->key, cell);
+      }
+      cell->entries = g_list_prepend (cell->entries, entry);
+    }
+  }
+}
+
+/*! \brief Bring the spatial index of a page up to date.
+ *  \par Function Description
+ *  Re-indexes all objects whose bounds have been invalidated since
+ *  the last query.  If the bounds have been calculated for a different
+ *  TOPLEVEL or with a different setting for showing hidden text, all
+ *  objects are re-indexed.
+ */
+static void page_index_update (TOPLEVEL *toplevel, PAGE_INDEX *index)
+{
+  IndexEntry *entry;
+
+  if (index->toplevel != toplevel ||
+      index->show_hidden_text != toplevel->show_hidden_text) {
+    GHashTableIter iter;
+
+    g_hash_table_iter_init (&iter, index->entries);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &entry)) {
+      page_index_mark_dirty (index, entry);
+    }
+    index->toplevel = toplevel;
+    index->show_hidden_text = toplevel->show_hidden_text;
+  }
+
+  while ((entry = g_queue_pop_head (&index->dirty)) != NULL) {
+    entry->dirty_link = NULL;
+    page_index_unplace (index, entry);
+    page_index_place (toplevel, index, entry);
+  }
+}
+
+static void page_index_add (PAGE_INDEX *index, OBJECT *object)
+{
+  IndexEntry *entry = g_new0 (IndexEntry, 1);
+
+  entry->object = object;
+  entry->order = index->next_order;
+  index->next_order += INDEX_ORDER_STEP;
+  g_hash_table_insert (index->entries, object, entry);
+  page_index_mark_dirty (index, entry);
+}
+
+static void page_index_remove (PAGE_INDEX *index, OBJECT *object)
+{
+  IndexEntry *entry = g_hash_table_lookup (index->entries, object);
+
+  g_return_if_fail (entry != NULL);
+
+  page_index_unplace (index, entry);
+  if (entry->dirty_link != NULL) {
+    g_queue_delete_link (&index->dirty, entry->dirty_link);
+  }
+  g_hash_table_remove (index->entries, object);
+}
+
+/*! \brief Notify the spatial index of a page that an object's bounds changed
+ *  \par Function Description
+ *  Called by o_bounds_invalidate() for objects which are on a page.
+ *  The object is re-indexed the next time the page is queried.
+ *
+ *  \param [in] page    The PAGE the object is on.
+ *  \param [in] object  The OBJECT whose bounds have been invalidated.
+ */
+void s_page_index_invalidate (PAGE *page, OBJECT *object)
+{
+  IndexEntry *entry = g_hash_table_lookup (page->_object_index->entries,
+                                           object);
+  if (entry != NULL) {
+    page_index_mark_dirty (page->_object_index, entry);
+  }
+}
+
 /* Called just before removing an OBJECT from a PAGE
  * or after appending an OBJECT to a PAGE. */
 static void
@@ -68,6 +327,8 @@ object_added (TOPLEVEL *toplevel, PAGE *page, OBJECT *object)
 #endif
   object->page = page;
 
+  page_index_add (page->_object_index, object);
+
   /* Update object connection tracking */
   s_conn_update_object (page, object);
 
@@ -91,6 +352,8 @@ pre_object_removed (TOPLEVEL *toplevel, PAGE *page, OBJECT *object)
 #endif
   object->page = NULL;
 
+  page_index_remove (page->_object_index, object);
+
   /* Clear page's object_lastplace pointer if set */
   if (page->object_lastplace == object) {
     page->object_lastplace = NULL;
@@ -149,9 +412,11 @@ PAGE *s_page_new (TOPLEVEL *toplevel, const gchar *filename)
 
   /* Init connectible objects array */
   page->connectible_list = NULL;
+  page->conn_index = NULL;
 
   /* Init the object list */
   page->_object_list = NULL;
+  page->_object_index = page_index_new ();
 
   /* new selection mechanism */
   page->selection_list = o_selection_new();
@@ -237,6 +502,8 @@ void s_page_delete (TOPLEVEL *toplevel, PAGE *page)
 
   /* then delete objects of page */
   s_page_delete_objects (toplevel, page);
+  page_index_free (page->_object_index);
+  page->_object_index = NULL;
 
   /* Free the objects in the place list. */
   s_delete_object_glist (toplevel, page->place_list);
@@ -252,6 +519,7 @@ void s_page_delete (TOPLEVEL *toplevel, PAGE *page)
 
   g_list_free (page->connectible_list);
   page->connectible_list = NULL;
+  s_conn_free_index (page);
 
   /* free current page undo structs */
   s_undo_free_all (toplevel, page); 
@@ -694,6 +962,8 @@ s_page_replace (TOPLEVEL *toplevel, PAGE *page,
                 OBJECT *object1, OBJECT *object2)
 {
   GList *iter = g_list_find (page->_object_list, object1);
+  IndexEntry *entry;
+  guint64 order;
 
   /* If object1 not found, append object2 */
   if (iter == NULL) {
@@ -701,9 +971,73 @@ s_page_replace (TOPLEVEL *toplevel, PAGE *page,
     return;
   }
 
+  entry = g_hash_table_lookup (page->_object_index->entries, object1);
+  order = entry->order;
+
   pre_object_removed (toplevel, page, object1);
   iter->data = object2;
   object_added (toplevel, page, object2);
+
+  /* keep the stacking order of the index in sync with the list */
+  entry = g_hash_table_lookup (page->_object_index->entries, object2);
+  entry->order = order;
+}
+
+/*! \brief Get the position of an OBJECT in the stacking order of a PAGE
+ *
+ *  \par Function Description
+ *  The position of an object doesn't change while it is on the page,
+ *  so it can be used to put the object back in the same place with
+ *  s_page_insert_list() after it has been removed.
+ *
+ *  \param [in] page    The PAGE the object is on.
+ *  \param [in] object  The OBJECT whose position to return.
+ *  \return The position of \a object.
+ */
+guint64 s_page_get_order (PAGE *page, OBJECT *object)
+{
+  IndexEntry *entry = g_hash_table_lookup (page->_object_index->entries,
+                                           object);
+
+  g_return_val_if_fail (entry != NULL, 0);
+  return entry->order;
+}
+
+/*! \brief Insert a GList of OBJECTs at a position in the PAGE
+ *
+ *  \par Function Description
+ *  Links the passed OBJECT GList into the PAGE's object_list in front
+ *  of the first object whose position in the stacking order is after
+ *  \a order, as returned by s_page_get_order().  The first object
+ *  takes position \a order and the others the positions following it.
+ *
+ *  \param [in] toplevel  The TOPLEVEL object.
+ *  \param [in] page      The PAGE the objects are being added to.
+ *  \param [in] obj_list  The OBJECT list being added to the page.
+ *  \param [in] order     The position of the first object.
+ */
+void s_page_insert_list (TOPLEVEL *toplevel, PAGE *page, GList *obj_list,
+                         guint64 order)
+{
+  GList *next, *iter;
+  IndexEntry *entry;
+
+  for (next = page->_object_list; next != NULL; next = g_list_next (next)) {
+    entry = g_hash_table_lookup (page->_object_index->entries, next->data);
+    if (entry->order > order) {
+      break;
+    }
+  }
+
+  for (iter = obj_list; iter != NULL; iter = g_list_next (iter)) {
+    page->_object_list = g_list_insert_before (page->_object_list, next,
+                                               iter->data);
+    object_added (toplevel, page, iter->data);
+
+    entry = g_hash_table_lookup (page->_object_index->entries, iter->data);
+    entry->order = order++;
+  }
+  g_list_free (obj_list);
 }
 
 /*! \brief Remove and free all OBJECTs from the PAGE
@@ -770,12 +1104,67 @@ GList *s_page_objects_in_region (TOPLEVEL *toplevel, PAGE *page,
   return s_page_objects_in_regions (toplevel, page, &rect, 1);
 }
 
+/*! \brief Check if an object is inside or intersects one of some regions. */
+static int object_in_regions (TOPLEVEL *toplevel, OBJECT *object,
+                              BOX *rects, int n_rects)
+{
+  int left, top, right, bottom;
+  int i;
+
+  if (!world_get_single_object_bounds (toplevel, object,
+                                       &left, &top, &right, &bottom)) {
+    return FALSE;
+  }
+
+  for (i = 0; i < n_rects; i++) {
+    if (right  >= rects[i].lower_x &&
+        left   <= rects[i].upper_x &&
+        top    <= rects[i].upper_y &&
+        bottom >= rects[i].lower_y) {
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/*! \brief Add an index entry to the query result if it is in the regions. */
+static void collect_entry (TOPLEVEL *toplevel, PAGE_INDEX *index,
+                           IndexEntry *entry, BOX *rects, int n_rects,
+                           GPtrArray *found)
+{
+  if (entry->stamp == index->stamp) {
+    return;
+  }
+  entry->stamp = index->stamp;
+
+  if (object_in_regions (toplevel, entry->object, rects, n_rects)) {
+    g_ptr_array_add (found, entry);
+  }
+}
+
+static gint compare_entry_order (gconstpointer a, gconstpointer b)
+{
+  const IndexEntry *entry_a = *(IndexEntry * const *) a;
+  const IndexEntry *entry_b = *(IndexEntry * const *) b;
+
+  if (entry_a->order < entry_b->order) {
+    return -1;
+  }
+  return entry_a->order > entry_b->order;
+}
+
 /*! \brief Find the objects in a given region
  *
  *  \par Function Description
  *  Finds the objects which are inside, or intersect
  *  the passed box shaped region.
  *
+ *  The page's spatial index is used to look only at objects close
+ *  to the regions, so the cost depends on the size of the regions
+ *  and the number of objects found rather than on the size of the
+ *  page.  The objects are returned in stacking order.
+ *
  *  \param [in] toplevel  The TOPLEVEL object.
  *  \param [in] page      The PAGE to find objects on.
  *  \param [in] rects     The BOX regions to check.
@@ -785,30 +1174,67 @@ GList *s_page_objects_in_region (TOPLEVEL *toplevel, PAGE *page,
 GList *s_page_objects_in_regions (TOPLEVEL *toplevel, PAGE *page,
                                   BOX *rects, int n_rects)
 {
+  PAGE_INDEX *index = page->_object_index;
+  GPtrArray *found;
   GList *iter;
   GList *list = NULL;
-  int i;
+  gint64 n_cells = 0, max_cells;
+  int i, cx, cy;
+
+  page_index_update (toplevel, index);
+
+  /* If the regions cover more cells than there are objects, it is
+   * cheaper to look at every object. */
+  max_cells = g_hash_table_size (index->entries);
+  for (i = 0; i < n_rects && n_cells <= max_cells; i++) {
+    gint64 w = (gint64) cell_of (rects[i].upper_x) - cell_of (rects[i].lower_x) + 1;
+    gint64 h = (gint64) cell_of (rects[i].upper_y) - cell_of (rects[i].lower_y) + 1;
+
+    if (w <= 0 || h <= 0 || w > max_cells || h > max_cells) {
+      n_cells = max_cells + 1;
+    } else {
+      n_cells += w * h;
+    }
+  }
+
+  if (n_cells > max_cells) {
+    for (iter = page->_object_list; iter != NULL; iter = g_list_next (iter)) {
+      if (object_in_regions (toplevel, iter->data, rects, n_rects)) {
+        list = g_list_prepend (list, iter->data);
+      }
+    }
+    return g_list_reverse (list);
+  }
+
+  found = g_ptr_array_new ();
+  index->stamp++;
+
+  for (iter = index->large; iter != NULL; iter = g_list_next (iter)) {
+    collect_entry (toplevel, index, iter->data, rects, n_rects, found);
+  }
 
-  for (iter = page->_object_list; iter != NULL; iter = g_list_next (iter)) {
-    OBJECT *object = iter->data;
-    int left, top, right, bottom;
-    int visible;
-
-    visible = world_get_single_object_bounds (toplevel, object,
-                                              &left, &top, &right, &bottom);
-    if (visible) {
-      for (i = 0; i < n_rects; i++) {
-        if (right  >= rects[i].lower_x &&
-            left   <= rects[i].upper_x &&
-            top    <= rects[i].upper_y &&
-            bottom >= rects[i].lower_y) {
-          list = g_list_prepend (list, object);
-          break;
+  for (i = 0; i < n_rects; i++) {
+    for (cx = cell_of (rects[i].lower_x); cx <= cell_of (rects[i].upper_x); cx++) {
+      for (cy = cell_of (rects[i].lower_y); cy <= cell_of (rects[i].upper_y); cy++) {
+        gint64 key = cell_key (cx, cy);
+        IndexCell *cell = g_hash_table_lookup (index->cells, &key);
+
+        if (cell == NULL) {
+          continue;
+        }
+        for (iter = cell->entries; iter != NULL; iter = g_list_next (iter)) {
+          collect_entry (toplevel, index, iter->data, rects, n_rects, found);
         }
       }
     }
   }
 
-  list = g_list_reverse (list);
+  g_ptr_array_sort (found, compare_entry_order);
+  for (i = found->len; i > 0; i--) {
+    IndexEntry *entry = g_ptr_array_index (found, i - 1);
+    list = g_list_prepend (list, entry->object);
+  }
+  g_ptr_array_free (found, TRUE);
+
   return list;
 }
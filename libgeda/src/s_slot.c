@@ -51,13 +51,10 @@
  */
 char *s_slot_search_slot (OBJECT *object, OBJECT **return_found)
 {
-  GList *attributes;
   OBJECT *attrib;
   char *value = NULL;
 
-  attributes = o_attrib_return_attribs (object);
-  attrib = o_attrib_find_attrib_by_name (attributes, "slot", 0);
-  g_list_free (attributes);
+  attrib = o_attrib_find_object_attrib_by_name (object, "slot", 0);
 
   if (attrib != NULL)
     o_attrib_get_name_value (attrib, NULL, &value);
@@ -69,37 +66,165 @@ char *s_slot_search_slot (OBJECT *object, OBJECT **return_found)
 }
 
 
+/*! \brief Discard the slot table of a complex OBJECT.
+ *  \par Function Description
+ *  The slot table is rebuilt from the complex's prim_objs the next
+ *  time s_slot_update_object() is called.  It has to be discarded
+ *  whenever the pins or slotdef= attributes inside the complex change;
+ *  this is done by o_attrib_invalidate_index().
+ *
+ *  \param [in] object  The complex OBJECT, or NULL.
+ */
+void s_slot_invalidate (OBJECT *object)
+{
+  SLOT_TABLE *table;
+
+  if (object == NULL || object->complex == NULL ||
+      object->complex->slot_table == NULL)
+    return;
+
+  table = object->complex->slot_table;
+  g_hash_table_destroy (table->slotdefs);
+  g_hash_table_destroy (table->pins);
+  g_free (table);
+
+  object->complex->slot_table = NULL;
+}
+
+
+/*! \brief Split a slotdef= value into its slot number and pin numbers.
+ *  \par Function Description
+ *  Parses a string of the form "#:#,#,#..." and adds it to \a slotdefs
+ *  unless there already is an entry for the same slot number.
+ *
+ *  \param [in] slotdefs  The slotdef table of a SLOT_TABLE.
+ *  \param [in] value     The value of the slotdef= attribute.
+ */
+static void s_slot_add_slotdef (GHashTable *slotdefs, const char *value)
+{
+  const char *colon;
+  char *slot;
+
+  colon = strchr (value, ':');
+  if (colon == NULL)
+    return;
+
+  slot = g_strndup (value, colon - value);
+  if (g_hash_table_contains (slotdefs, slot)) {
+    g_free (slot);
+    return;
+  }
+
+  g_hash_table_insert (slotdefs, slot,
+                       g_strsplit_set (colon + 1, DELIMITERS, -1));
+}
+
+
+/*! \brief Get the slot table of a complex OBJECT.
+ *  \par Function Description
+ *  Returns the parsed slotdef= attributes and the pinseq= to pin map
+ *  of a complex, building them with a single pass over its prim_objs
+ *  if necessary.
+ *
+ *  Only inherited slotdef= attributes are kept in the table; attached
+ *  ones are searched by s_slot_update_object() directly so changing
+ *  attributes of the instance doesn't require rebuilding it.
+ *
+ *  \param [in] object  The complex OBJECT.
+ *  \return The slot table, owned by \a object.
+ */
+static SLOT_TABLE *s_slot_get_table (OBJECT *object)
+{
+  SLOT_TABLE *table;
+  OBJECT *o_current;
+  OBJECT *pinseq;
+  GList *iter;
+  char *value;
+
+  if (object->complex->slot_table != NULL)
+    return object->complex->slot_table;
+
+  table = g_new (SLOT_TABLE, 1);
+  table->slotdefs = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           g_free,
+                                           (GDestroyNotify) g_strfreev);
+  table->pins = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free, NULL);
+
+  for (iter = object->complex->prim_objs; iter != NULL;
+       iter = g_list_next (iter)) {
+    o_current = iter->data;
+
+    if (o_current->type == OBJ_PIN) {
+      pinseq = o_attrib_find_attrib_by_name (o_current->attribs, "pinseq", 0);
+      if (pinseq == NULL ||
+          !o_attrib_get_name_value (pinseq, NULL, &value))
+        continue;
+
+      /* first pin with a given pinseq= wins */
+      if (g_hash_table_contains (table->pins, value))
+        g_free (value);
+      else
+        g_hash_table_insert (table->pins, value, o_current);
+
+    } else if (o_current->type == OBJ_TEXT &&
+               o_current->attached_to == NULL &&
+               o_current->text->attrib_name ==
+                 g_quark_from_static_string ("slotdef")) {
+      if (o_attrib_get_name_value (o_current, NULL, &value)) {
+        s_slot_add_slotdef (table->slotdefs, value);
+        g_free (value);
+      }
+    }
+  }
+
+  object->complex->slot_table = table;
+  return table;
+}
+
+
 /*! \brief Search for slotdef attribute.
  *  \par Function Description
- *  Search for slotdef attribute.
+ *  Search for the pin numbers of a given slot.  Attached slotdef=
+ *  attributes take precedence over the ones inside the symbol.
  *
- *  \param [in] object      The OBJECT list to search.
+ *  \param [in] object      The complex OBJECT to search.
+ *  \param [in] table       The slot table of \a object.
  *  \param [in] slotnumber  The slot number to search for.
- *  \return Character string with attribute value, NULL otherwise.
+ *  \param [out] pins       The return location for the pin numbers.
+ *  \return TRUE if a slotdef was found, FALSE otherwise.
  *
  *  \warning
- *  Caller must g_free returned character string.
+ *  Caller must g_strfreev the returned pin numbers.
  */
-static char *s_slot_search_slotdef (OBJECT *object, int slotnumber)
+static gboolean s_slot_search_slotdef (OBJECT *object, SLOT_TABLE *table,
+                                       int slotnumber, char ***pins)
 {
+  char slot[16];
+  char *value;
+  char **found;
   int counter = 0;
-  char *slotdef;
-  char *search_for;
-
-  search_for = g_strdup_printf ("%d:", slotnumber);
+  size_t length;
 
-  while (1) {
-    slotdef = o_attrib_search_object_attribs_by_name (object, "slotdef",
-                                                      counter++);
-    if (slotdef == NULL ||
-        strncmp (slotdef, search_for, strlen (search_for)) == 0)
-      break;
+  g_snprintf (slot, sizeof slot, "%d", slotnumber);
+  length = strlen (slot);
 
-    g_free (slotdef);
+  while ((value = o_attrib_search_attached_attribs_by_name (
+            object, "slotdef", counter++)) != NULL) {
+    if (strncmp (value, slot, length) == 0 && value[length] == ':') {
+      *pins = g_strsplit_set (value + length + 1, DELIMITERS, -1);
+      g_free (value);
+      return TRUE;
+    }
+    g_free (value);
   }
 
-  g_free (search_for);
-  return slotdef;
+  found = g_hash_table_lookup (table->slotdefs, slot);
+  if (found == NULL)
+    return FALSE;
+
+  *pins = g_strdupv (found);
+  return TRUE;
 }
 
 
@@ -114,22 +239,28 @@ static char *s_slot_search_slotdef (OBJECT *object, int slotnumber)
  *  parts, but on slotted parts, this is what sets the
  *  pinnumber= attribute on slots 2, 3, 4....
  *
+ *  The slotdef= attributes and pins of the symbol are looked up in a
+ *  table which is built on the first call, so changing the slot of
+ *  an instance only takes time proportional to its number of pins.
+ *
  *  \param [in]     toplevel  The TOPLEVEL object.
  *  \param [in,out] object     The OBJECT to update.
  */
 void s_slot_update_object (TOPLEVEL *toplevel, OBJECT *object)
 {
+  SLOT_TABLE *table;
   OBJECT *o_pin_object;
   OBJECT *o_pinnum_attrib;
-  GList *attributes;
   char *string;
-  char *slotdef;
-  char *pinseq;
+  char **pins;
+  char pinseq[16];
   int slot;
   int slot_string;
   int pin_counter;    /* Internal pin counter private to this fcn. */
-  char* current_pin;  /* text from slotdef= to be made into pinnumber= */
-  char* cptr;         /* char pointer pointing to pinnumbers in slotdef=#:#,#,# string */
+  int i;
+
+  g_return_if_fail (object->type == OBJ_COMPLEX ||
+                    object->type == OBJ_PLACEHOLDER);
 
   /* For this particular graphic object (component instantiation) */
   /* get the slot number as a string */
@@ -149,57 +280,41 @@ void s_slot_update_object (TOPLEVEL *toplevel, OBJECT *object)
     g_free (string);
   }
 
-  /* OK, now that we have the slot number, use it to get the */
-  /* corresponding slotdef=#:#,#,# string.  */
-  slotdef = s_slot_search_slotdef (object, slot);
+  table = s_slot_get_table (object);
 
-  if (slotdef == NULL) {
+  /* OK, now that we have the slot number, use it to get the */
+  /* corresponding pin numbers from the slotdef=#:#,#,# string.  */
+  if (!s_slot_search_slotdef (object, table, slot, &pins)) {
     if (slot_string) /* only an error if there's a slot string */
       s_log_message (_("Did not find slotdef=#:#,#,#... attribute\n"));
     return;
   }
 
-  if (!strstr (slotdef, ":")) {
-    /* Didn't find proper slotdef=#:... put warning into log */
-    s_log_message (_("Improper slotdef syntax: missing \":\".\n"));
-    g_free (slotdef);
-    return;
-  }
-
-  /* skip over slotdef number */
-  /* slotdef is in the form #:#,#,# */
-  /* this code skips first #: */
-  cptr = slotdef;
-  while (*cptr != '\0' && *cptr != ':') {
-    cptr++;
-  }
-  cptr++; /* skip colon */
-
-  if (*cptr == '\0') {
+  if (pins[0] == NULL) {
     s_log_message (_("Did not find proper slotdef=#:#,#,#... attribute\n"));
-    g_free (slotdef);
+    g_strfreev (pins);
     return;
   }
 
   /* loop on all pins found in slotdef= attribute */
   pin_counter = 1;  /* internal pin_counter */
-  /* get current pinnumber= from slotdef= attrib */
-  current_pin = strtok (cptr, DELIMITERS);
-  while (current_pin != NULL) {
+  for (i = 0; pins[i] != NULL; i++) {
+    /* g_strsplit_set leaves empty strings between adjacent delimiters */
+    if (*pins[i] == '\0')
+      continue;
+
     /* get pin on this component with pinseq == pin_counter */
-    pinseq = g_strdup_printf ("%d", pin_counter);
-    o_pin_object = o_complex_find_pin_by_attribute (object, "pinseq", pinseq);
-    g_free (pinseq);
+    g_snprintf (pinseq, sizeof pinseq, "%d", pin_counter);
+    o_pin_object = g_hash_table_lookup (table->pins, pinseq);
 
     if (o_pin_object != NULL) {
       /* Now rename pinnumber= attrib on this part with value found */
       /* in slotdef attribute  */
-      attributes = o_attrib_return_attribs (o_pin_object);
-      o_pinnum_attrib = o_attrib_find_attrib_by_name (attributes, "pinnumber", 0);
-      g_list_free (attributes);
+      o_pinnum_attrib =
+        o_attrib_find_attrib_by_name (o_pin_object->attribs, "pinnumber", 0);
 
       if (o_pinnum_attrib != NULL) {
-        gchar *buf = g_strdup_printf ("pinnumber=%s", current_pin);
+        gchar *buf = g_strdup_printf ("pinnumber=%s", pins[i]);
         o_text_set_string (toplevel, o_pinnum_attrib, buf);
         g_free (buf);
       }
@@ -208,9 +323,7 @@ void s_slot_update_object (TOPLEVEL *toplevel, OBJECT *object)
     } else {
       s_log_message (_("component missing pinseq= attribute\n"));
     }
-
-    current_pin = strtok (NULL, DELIMITERS);
   }
 
-  g_free (slotdef);
+  g_strfreev (pins);
 }
@@ -123,54 +123,53 @@ TextBuffer *s_textbuffer_free (TextBuffer *tb)
 const gchar *
 s_textbuffer_next (TextBuffer *tb, const gssize count)
 {
-  gboolean eol = FALSE;
-  gchar c;
-  gsize len;
+  const gchar *src, *p, *buf_end;
+  gsize len = 0;
+  gsize n;
 
   g_return_val_if_fail (tb != NULL, NULL);
 
   if (tb->offset >= tb->size) return NULL;
 
-  const gchar *src = tb->buffer + tb->offset;
-  gchar *dest = tb->line;
-  const gchar *buf_end = tb->buffer + tb->size;
+  src = tb->buffer + tb->offset;
+  buf_end = tb->buffer + tb->size;
 
-  while (1) {
-    if (src >= buf_end) break;
-    if (count >= 0 && dest - tb->line >= count) break;
-    if (count < 0 && eol) break;
+  while (src < buf_end && (count < 0 || len < (gsize) count)) {
 
-    /* Expand line buffer, if necessary, leaving space for a null */
-    len = dest - tb->line + 2;
-    if (len >= tb->linesize) {
-      tb->linesize += TEXT_BUFFER_LINE_SIZE;
-      tb->line = g_realloc(tb->line, tb->linesize);
-    }
+    /* Copy everything up to the next newline in one go */
+    for (p = src; p < buf_end && *p != '\n' && *p != '\r'; p++);
+    n = p - src;
+    if (count >= 0 && n > (gsize) count - len) n = count - len;
 
-    eol = FALSE;
-    c = *src;
-    if (c == '\n') {
-      *dest = '\n';
-      eol = TRUE;
-    } else if (c == '\r') {
-      *dest = '\n';
-      eol = TRUE;
-      /* Peek ahead to absorb a '\n' */
-      src++;
-      if (src >= buf_end || *src != '\n') src--;
-    } else {
-      *dest = c;
+    /* Expand line buffer, if necessary, leaving space for a newline
+     * and a null */
+    if (len + n + 2 > tb->linesize) {
+      while (len + n + 2 > tb->linesize) tb->linesize *= 2;
+      tb->line = g_realloc (tb->line, tb->linesize);
     }
 
+    memcpy (tb->line + len, src, n);
+    len += n;
+    src += n;
+
+    if (src != p || p >= buf_end || (count >= 0 && len >= (gsize) count))
+      break;
+
+    /* Collapse the newline into a single '\n', absorbing the '\n'
+     * of a "\r\n" pair */
+    tb->line[len++] = '\n';
+    if (*src == '\r' && src + 1 < buf_end && src[1] == '\n') src++;
     src++;
-    dest++;
+
+    if (count < 0) break;
   }
 
-  *dest = 0;
+  tb->line[len] = 0;
   tb->offset = src - tb->buffer;
 
   return tb->line;
 }
+
 /*! \brief Fetch the next line from a text buffer
  *
  *  \par Function description
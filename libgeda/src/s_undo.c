@@ -81,6 +81,7 @@ UNDO *s_undo_new_head(void)
   u_new->type = -1;
   u_new->filename = NULL;
   u_new->object_list = NULL;
+  u_new->changes = NULL;
   u_new->x = u_new->y = 0;
   u_new->scale = 0;
 
@@ -125,6 +126,7 @@ UNDO *s_undo_add (UNDO *head, int type, char *filename, GList *object_list,
   u_new->filename = g_strdup (filename);
 	
   u_new->object_list = object_list;
+  u_new->changes = NULL;
 
   u_new->type = type;
 
@@ -205,6 +207,9 @@ void s_undo_destroy_all(TOPLEVEL *toplevel, UNDO *head)
       u_current->object_list = NULL;
     }
 
+    s_undo_free_changes (u_current->changes);
+    u_current->changes = NULL;
+
     g_free(u_current);
     u_current = u_prev;
   }
@@ -245,6 +250,9 @@ void s_undo_remove(TOPLEVEL *toplevel, UNDO *head, UNDO *u_tos)
         u_current->object_list = NULL;
       }
 
+      s_undo_free_changes (u_current->changes);
+      u_current->changes = NULL;
+
       g_free(u_current);
       return;
     }
@@ -277,6 +285,9 @@ void s_undo_remove_rest(TOPLEVEL *toplevel, UNDO *head)
       u_current->object_list = NULL;
     }
 
+    s_undo_free_changes (u_current->changes);
+    u_current->changes = NULL;
+
     g_free(u_current);
     u_current = u_next;
   }
@@ -294,7 +305,8 @@ int s_undo_levels(UNDO *head)
 	
   u_current = head;
   while (u_current != NULL) {
-    if (u_current->filename || u_current->object_list) {
+    if (u_current->filename || u_current->object_list ||
+        u_current->changes) {
       count++;	
     } 	
 		
@@ -327,3 +339,499 @@ void s_undo_free_all(TOPLEVEL *toplevel, PAGE *p_current)
   p_current->undo_tos = NULL;
   p_current->undo_current = NULL;
 }
+
+/*! \brief Free a list of UNDO_CHANGE structures
+ *  \par Function Description
+ *  Frees the recorded object states and the list itself.  The keys
+ *  belong to the page's delta undo tracker and are left alone.
+ *
+ *  \param [in] changes  The GList of UNDO_CHANGE structures to free.
+ */
+void s_undo_free_changes (GList *changes)
+{
+  GList *iter;
+
+  for (iter = changes; iter != NULL; iter = g_list_next (iter)) {
+    UNDO_CHANGE *change = (UNDO_CHANGE *) iter->data;
+    g_free (change->before);
+    g_free (change->after);
+    g_free (change);
+  }
+  g_list_free (changes);
+}
+
+/* number of keys which may be created before unused keys of a delta */
+/* undo tracker are freed, in addition to those in use at the last time */
+#define UNDO_KEYS_SLACK  64
+
+/* State of the delta undo mechanism for a page.
+ *
+ * Objects are recorded in groups: an object which isn't attached to
+ * anything, together with its attributes, saved in libgeda format.
+ * The tracker keeps the saved state of every group as of the last
+ * undo level, and s_undo_delta_notify() tells it which groups
+ * may have changed since.  Each group is identified by an UndoKey
+ * which follows the group's head object when undo or redo recreates
+ * it, and remembers the group's position on the page, so a deleted
+ * group is recreated in the same place. */
+typedef struct _UndoKey UndoKey;
+typedef struct _UndoTracker UndoTracker;
+
+struct _UndoKey {
+  /* head object of the group, or NULL if there is none */
+  OBJECT *object;
+  /* position of the head object in the page's stacking order when
+   * the group was last saved */
+  guint64 order;
+};
+
+struct _UndoTracker {
+  PAGE *page;
+  /* set of all keys which have been created and not yet freed */
+  GHashTable *keys;
+  /* number of keys left after unused keys were last freed */
+  guint live_keys;
+  /* UndoKey by head object */
+  GHashTable *objects;
+  /* saved group by UndoKey */
+  GHashTable *saved;
+  /* keys of the groups which may have changed */
+  GHashTable *dirty;
+  /* set while the tracker changes the page itself */
+  gboolean busy;
+};
+
+/* UndoTracker by PAGE */
+static GHashTable *trackers = NULL;
+
+static void key_object_destroyed (void *object, void *user_data)
+{
+  UndoTracker *tracker = user_data;
+  UndoKey *key = g_hash_table_lookup (tracker->objects, object);
+
+  if (key != NULL) {
+    g_hash_table_remove (tracker->objects, object);
+    key->object = NULL;
+  }
+}
+
+static void set_key_object (UndoTracker *tracker, UndoKey *key, OBJECT *object)
+{
+  if (key->object != NULL) {
+    s_object_weak_unref (key->object, key_object_destroyed, tracker);
+    g_hash_table_remove (tracker->objects, key->object);
+  }
+
+  key->object = object;
+
+  if (object != NULL) {
+    s_object_weak_ref (object, key_object_destroyed, tracker);
+    g_hash_table_insert (tracker->objects, object, key);
+  }
+}
+
+static UndoKey *get_key (UndoTracker *tracker, OBJECT *object)
+{
+  UndoKey *key = g_hash_table_lookup (tracker->objects, object);
+
+  if (key == NULL) {
+    key = g_new0 (UndoKey, 1);
+    g_hash_table_add (tracker->keys, key);
+    set_key_object (tracker, key, object);
+  }
+  return key;
+}
+
+static gboolean is_group_head (PAGE *page, OBJECT *object)
+{
+  return object != NULL && object->page == page &&
+         object->parent == NULL && object->attached_to == NULL;
+}
+
+static gchar *save_group (OBJECT *object)
+{
+  GList *list = g_list_prepend (NULL, object);
+  gchar *buffer = o_save_buffer (list);
+
+  g_list_free (list);
+  return buffer;
+}
+
+static void free_tracker (UndoTracker *tracker)
+{
+  GHashTableIter iter;
+  gpointer object;
+
+  /* objects which have been removed from the page may still be around */
+  g_hash_table_iter_init (&iter, tracker->objects);
+  while (g_hash_table_iter_next (&iter, &object, NULL)) {
+    s_object_weak_unref (object, key_object_destroyed, tracker);
+  }
+
+  g_hash_table_destroy (tracker->objects);
+  g_hash_table_destroy (tracker->saved);
+  g_hash_table_destroy (tracker->dirty);
+  g_hash_table_destroy (tracker->keys);
+  g_free (tracker);
+}
+
+static void page_destroyed (void *page, void *user_data)
+{
+  g_hash_table_remove (trackers, page);
+  free_tracker (user_data);
+}
+
+/*! \brief Get the delta undo tracker of a page.
+ *  \par Function Description
+ *  If \a create is TRUE and the page doesn't have a tracker yet,
+ *  creates one and saves the current state of all objects on the page.
+ */
+static UndoTracker *get_tracker (PAGE *page, gboolean create)
+{
+  UndoTracker *tracker;
+  const GList *iter;
+
+  if (trackers == NULL) {
+    if (!create) {
+      return NULL;
+    }
+    trackers = g_hash_table_new (g_direct_hash, g_direct_equal);
+  }
+
+  tracker = g_hash_table_lookup (trackers, page);
+  if (tracker != NULL || !create) {
+    return tracker;
+  }
+
+  tracker = g_new0 (UndoTracker, 1);
+  tracker->page = page;
+  tracker->keys = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                         g_free, NULL);
+  tracker->objects = g_hash_table_new (g_direct_hash, g_direct_equal);
+  tracker->saved = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+                                          NULL, g_free);
+  tracker->dirty = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (iter = s_page_objects (page); iter != NULL; iter = g_list_next (iter)) {
+    OBJECT *object = iter->data;
+    if (object->attached_to == NULL) {
+      UndoKey *key = get_key (tracker, object);
+      key->order = s_page_get_order (page, object);
+      g_hash_table_insert (tracker->saved, key, save_group (object));
+    }
+  }
+
+  g_hash_table_insert (trackers, page, tracker);
+  s_page_weak_ref (page, page_destroyed, tracker);
+  return tracker;
+}
+
+/*! \brief Free the keys which are no longer used.
+ *  \par Function Description
+ *  A key stays in use as long as its head object exists, the group
+ *  has a saved or pending state, or an undo level of the page refers
+ *  to it.  Keys of groups which were deleted and whose undo levels
+ *  have been trimmed or discarded are freed.
+ *
+ *  To keep the cost amortized, nothing is done unless enough keys
+ *  have been created since the last time.
+ */
+static void collect_keys (UndoTracker *tracker)
+{
+  GHashTable *used;
+  GHashTableIter iter;
+  gpointer key;
+  UNDO *u_current;
+  GList *c_iter;
+
+  if (g_hash_table_size (tracker->keys) <
+      2 * tracker->live_keys + UNDO_KEYS_SLACK) {
+    return;
+  }
+
+  used = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+  for (u_current = tracker->page->undo_bottom; u_current != NULL;
+       u_current = u_current->next) {
+    for (c_iter = u_current->changes; c_iter != NULL;
+         c_iter = g_list_next (c_iter)) {
+      g_hash_table_add (used, ((UNDO_CHANGE *) c_iter->data)->key);
+    }
+  }
+
+  g_hash_table_iter_init (&iter, tracker->keys);
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    if (((UndoKey *) key)->object == NULL &&
+        !g_hash_table_contains (tracker->saved, key) &&
+        !g_hash_table_contains (tracker->dirty, key) &&
+        !g_hash_table_contains (used, key)) {
+      g_hash_table_iter_remove (&iter);
+    }
+  }
+
+  g_hash_table_destroy (used);
+  tracker->live_keys = g_hash_table_size (tracker->keys);
+}
+
+/*! \brief Add a change to a list of changes.
+ *  \par Function Description
+ *  If the list already has a change for the same group, the two are
+ *  merged.  Copies \a before and \a after.
+ */
+static GList *record_change (GList *changes, UndoKey *key,
+                             const gchar *before, const gchar *after)
+{
+  UNDO_CHANGE *change;
+  GList *iter;
+
+  for (iter = changes; iter != NULL; iter = g_list_next (iter)) {
+    change = iter->data;
+    if (change->key != key) {
+      continue;
+    }
+
+    g_free (change->after);
+    change->after = g_strdup (after);
+
+    if (g_strcmp0 (change->before, change->after) == 0) {
+      g_free (change->before);
+      g_free (change->after);
+      g_free (change);
+      changes = g_list_delete_link (changes, iter);
+    }
+    return changes;
+  }
+
+  change = g_new (UNDO_CHANGE, 1);
+  change->key = key;
+  change->before = g_strdup (before);
+  change->after = g_strdup (after);
+  return g_list_prepend (changes, change);
+}
+
+/*! \brief Record the groups which have changed since the last undo level.
+ *  \par Function Description
+ *  Saves the groups which have been reported by change notifications,
+ *  appends those which are different from the saved state to \a
+ *  changes and updates the saved state.
+ *
+ *  \return The new list of changes.
+ */
+static GList *flush_changes (UndoTracker *tracker, GList *changes)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  g_hash_table_iter_init (&iter, tracker->dirty);
+  while (g_hash_table_iter_next (&iter, &key, NULL)) {
+    OBJECT *object = ((UndoKey *) key)->object;
+    gchar *before = g_hash_table_lookup (tracker->saved, key);
+    gchar *after = NULL;
+
+    if (is_group_head (tracker->page, object)) {
+      after = save_group (object);
+      ((UndoKey *) key)->order = s_page_get_order (tracker->page, object);
+    }
+
+    if (g_strcmp0 (before, after) == 0) {
+      g_free (after);
+      continue;
+    }
+
+    changes = record_change (changes, key, before, after);
+
+    if (after != NULL) {
+      g_hash_table_insert (tracker->saved, key, after);
+    } else {
+      g_hash_table_remove (tracker->saved, key);
+    }
+  }
+
+  g_hash_table_remove_all (tracker->dirty);
+  return changes;
+}
+
+/*! \brief Revert or repeat the changes of an undo level.
+ *  \par Function Description
+ *  Replaces the current objects of each changed group with the
+ *  recorded state before (\a undo is TRUE) or after the change.
+ *  Recreated groups take the place of the objects they replace, or
+ *  of the group when it was last saved if it has been deleted since.
+ */
+static void apply_changes (TOPLEVEL *toplevel, UndoTracker *tracker,
+                           GList *changes, gboolean undo)
+{
+  PAGE *page = tracker->page;
+  GList *dead = NULL;
+  GList *iter, *a_iter;
+
+  tracker->busy = TRUE;
+
+  for (iter = changes; iter != NULL; iter = g_list_next (iter)) {
+    UNDO_CHANGE *change = iter->data;
+    UndoKey *key = change->key;
+    gchar *target = undo ? change->before : change->after;
+    OBJECT *head = is_group_head (page, key->object) ? key->object : NULL;
+    GList *new_objects = NULL;
+    GError *err = NULL;
+
+    if (target != NULL) {
+      new_objects = o_read_buffer (toplevel, NULL, target, -1,
+                                   page->page_filename, &err);
+      if (err != NULL) {
+        g_warning (_("Failed to restore objects: %s\n"), err->message);
+        g_clear_error (&err);
+      }
+    }
+
+    if (head != NULL) {
+      key->order = s_page_get_order (page, head);
+
+      for (a_iter = head->attribs; a_iter != NULL;
+           a_iter = g_list_next (a_iter)) {
+        s_page_remove (toplevel, page, a_iter->data);
+        dead = g_list_prepend (dead, a_iter->data);
+      }
+      s_page_remove (toplevel, page, head);
+      dead = g_list_prepend (dead, head);
+    }
+
+    set_key_object (tracker, key,
+                    new_objects != NULL ? new_objects->data : NULL);
+    s_page_insert_list (toplevel, page, new_objects, key->order);
+
+    if (target != NULL) {
+      g_hash_table_insert (tracker->saved, key, g_strdup (target));
+    } else {
+      g_hash_table_remove (tracker->saved, key);
+    }
+  }
+
+  s_delete_object_glist (toplevel, dead);
+
+  g_hash_table_remove_all (tracker->dirty);
+  tracker->busy = FALSE;
+}
+
+/*! \brief Start recording the changes to a page.
+ *  \par Function Description
+ *  Saves the current state of all objects on \a page, so later undo
+ *  levels only need to record what has changed.  The saved state is
+ *  freed along with the page.  Does nothing if the page's changes
+ *  are already being recorded.
+ *
+ *  \param [in] page  The PAGE whose changes to record.
+ */
+void s_undo_delta_track (PAGE *page)
+{
+  g_return_if_fail (page != NULL);
+
+  get_tracker (page, TRUE);
+}
+
+/*! \brief Check whether the changes to a page are being recorded.
+ *
+ *  \param [in] page  The PAGE to check.
+ *  \return TRUE if s_undo_delta_track() has been called for \a page.
+ */
+gboolean s_undo_delta_is_tracked (PAGE *page)
+{
+  return page != NULL && get_tracker (page, FALSE) != NULL;
+}
+
+/*! \brief Record that an object may have changed.
+ *  \par Function Description
+ *  Marks the group \a object belongs to, so the next call to
+ *  s_undo_delta_flush() records its new state.  Meant to be called
+ *  from change notification handlers both before and after changes,
+ *  so an object which moves from one group to another marks both.
+ *  Objects on pages whose changes aren't recorded are ignored.
+ *
+ *  \param [in] object  The OBJECT which is being changed.
+ */
+void s_undo_delta_notify (OBJECT *object)
+{
+  UndoTracker *tracker;
+  UndoKey *key;
+  OBJECT *head = object;
+
+  g_return_if_fail (object != NULL);
+
+  while (head->parent != NULL) {
+    head = head->parent;
+  }
+  if (head->attached_to != NULL) {
+    head = head->attached_to;
+  }
+  if (head->page == NULL) {
+    return;
+  }
+
+  tracker = get_tracker (head->page, FALSE);
+  if (tracker == NULL || tracker->busy) {
+    return;
+  }
+
+  key = get_key (tracker, head);
+  g_hash_table_insert (tracker->dirty, key, key);
+}
+
+/*! \brief Record the changes to a page since the last undo level.
+ *  \par Function Description
+ *  Adds an UNDO_CHANGE to \a changes for every group which has been
+ *  marked by s_undo_delta_notify() and is different from its saved
+ *  state.  Changes to a group which is already in \a changes are
+ *  merged with the existing entry.
+ *
+ *  \param [in] page     The PAGE whose changes to record.
+ *  \param [in] changes  The GList of UNDO_CHANGE structures to add to.
+ *  \return The new list of changes, which is \a changes if the
+ *          page's changes aren't being recorded.
+ */
+GList *s_undo_delta_flush (PAGE *page, GList *changes)
+{
+  UndoTracker *tracker = get_tracker (page, FALSE);
+
+  if (tracker == NULL) {
+    return changes;
+  }
+  return flush_changes (tracker, changes);
+}
+
+/*! \brief Revert or repeat the changes of an undo level.
+ *  \par Function Description
+ *  Replaces the objects of each group in \a changes with the state
+ *  recorded before (\a undo is TRUE) or after the change.  Does
+ *  nothing if the page's changes aren't being recorded.
+ *
+ *  \param [in] toplevel  The TOPLEVEL structure.
+ *  \param [in] page      The PAGE to change.
+ *  \param [in] changes   The GList of UNDO_CHANGE structures to apply.
+ *  \param [in] undo      TRUE to revert the changes, FALSE to repeat them.
+ */
+void s_undo_delta_apply (TOPLEVEL *toplevel, PAGE *page,
+                         GList *changes, gboolean undo)
+{
+  UndoTracker *tracker = get_tracker (page, FALSE);
+
+  if (tracker != NULL) {
+    apply_changes (toplevel, tracker, changes, undo);
+  }
+}
+
+/*! \brief Free the recorded state which is no longer needed.
+ *  \par Function Description
+ *  Should be called after undo levels of \a page have been freed.
+ *  Forgets about groups which have been deleted and aren't referred
+ *  to by any of the page's remaining undo levels.
+ *
+ *  \param [in] page  The PAGE whose undo levels have changed.
+ */
+void s_undo_delta_collect (PAGE *page)
+{
+  UndoTracker *tracker = get_tracker (page, FALSE);
+
+  if (tracker != NULL) {
+    collect_keys (tracker);
+  }
+}
@@ -160,7 +160,7 @@ SCM_DEFINE (set_complex_x, "%set-complex!", 6, 0, 0,
   obj->complex->mirror = scm_is_true (mirror_s);
   obj->selectable = scm_is_false (locked_s);
 
-  obj->w_bounds_valid_for = NULL; /* We need to do this explicitly... */
+  o_bounds_invalidate (toplevel, obj); /* We need to do this explicitly... */
 
   o_emit_change_notify (toplevel, obj);
 
@@ -278,8 +278,9 @@ SCM_DEFINE (complex_append_x, "%complex-append!", 2, 0, 0,
   parent->complex->prim_objs =
     g_list_append (parent->complex->prim_objs, child);
   child->parent = parent;
+  o_attrib_invalidate_index (parent);
 
-  parent->w_bounds_valid_for = NULL;
+  o_bounds_invalidate (toplevel, parent);
 
   PAGE* parent_page = o_get_page (toplevel, parent);
   /* We may need to update connections */
@@ -358,6 +359,7 @@ SCM_DEFINE (complex_remove_x, "%complex-remove!", 2, 0, 0,
   parent->complex->prim_objs =
     g_list_remove_all (parent->complex->prim_objs, child);
   child->parent = NULL;
+  o_attrib_invalidate_index (parent);
 
   /* We may need to update connections */
   s_conn_remove_object (child_page, child);
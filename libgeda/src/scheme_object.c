@@ -278,7 +278,7 @@ SCM_DEFINE (object_bounds, "%object-bounds", 0, 0, 1,
 
     for (list = obj_list; list != NULL; list = g_list_next(list)) {
       OBJECT *o_current = (OBJECT *) list->data;
-      o_current->w_bounds_valid_for = NULL;
+      o_bounds_invalidate (toplevel, o_current);
     }
 
     success = world_get_object_glist_bounds (toplevel, obj_list,
@@ -288,7 +288,7 @@ SCM_DEFINE (object_bounds, "%object-bounds", 0, 0, 1,
 
     for (list = obj_list; list != NULL; list = g_list_next(list)) {
       OBJECT *o_current = (OBJECT *) list->data;
-      o_current->w_bounds_valid_for = NULL;
+      o_bounds_invalidate (toplevel, o_current);
     }
   }
 
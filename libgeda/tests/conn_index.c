@@ -0,0 +1,285 @@
+/* gEDA - GPL Electronic Design Automation
+ * libgeda - gEDA's library
+ * Copyright (C) 1998-2020 gEDA Contributors (see ChangeLog for details)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Randomized check of the connection index: objects are added, moved,
+ * transformed from Scheme, reloaded and removed, and after each step,
+ * nets drawn to random positions must get the same connections as on
+ * a page which is loaded from scratch with the same contents. */
+
+#include <config.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgeda/libgeda.h>
+#include <libgeda/libgedaguile.h>
+
+#define STEPS 2000
+#define PROBES 10
+#define GRID 100
+#define SIZE 8
+
+static TOPLEVEL *toplevel;
+static PAGE *page;
+static GRand *rnd;
+
+static int coord (void)
+{
+  return g_rand_int_range (rnd, 0, SIZE + 1) * GRID;
+}
+
+static OBJECT *random_object (void)
+{
+  const GList *objects = s_page_objects (page);
+  guint length = g_list_length ((GList *) objects);
+
+  if (length == 0)
+    return NULL;
+  return g_list_nth_data ((GList *) objects,
+                          g_rand_int_range (rnd, 0, length));
+}
+
+static GList *read_objects (const gchar *buffer)
+{
+  GError *err = NULL;
+  GList *objects = o_read_buffer (toplevel, NULL, (gchar *) buffer, -1,
+                                  "conn_index.sch", &err);
+  assert (err == NULL);
+  return objects;
+}
+
+static void add_line (void)
+{
+  int x0 = coord (), y0 = coord (), x1 = x0, y1 = y0;
+  OBJECT *object;
+
+  switch (g_rand_int_range (rnd, 0, 3)) {
+    case 0: x1 = coord (); break;
+    case 1: y1 = coord (); break;
+    default: x1 = coord (); y1 = coord (); break;
+  }
+  if (x0 == x1 && y0 == y1)
+    x1 += GRID;
+
+  switch (g_rand_int_range (rnd, 0, 4)) {
+    case 0:
+      object = o_bus_new (toplevel, BUS_COLOR, x0, y0, x1, y1, 0);
+      break;
+    case 1:
+      object = o_pin_new (toplevel, PIN_COLOR, x0, y0, x1, y1,
+                          PIN_TYPE_NET, g_rand_int_range (rnd, 0, 2));
+      break;
+    default:
+      object = o_net_new (toplevel, OBJ_NET, NET_COLOR, x0, y0, x1, y1);
+      break;
+  }
+  s_page_append (toplevel, page, object);
+}
+
+static void add_component (void)
+{
+  gchar *buffer = g_strdup_printf (
+    "v 20200319 2\n"
+    "C %d %d 1 0 0 EMBEDDEDconn_index.sym\n"
+    "[\n"
+    "P 0 0 %d 0 1 0 0\n"
+    "P 0 0 0 %d 1 0 0\n"
+    "P %d 0 %d %d 1 0 1\n"
+    "]\n", coord (), coord (), GRID, GRID, GRID, GRID, GRID);
+
+  s_page_append_list (toplevel, page, read_objects (buffer));
+  g_free (buffer);
+}
+
+static void call_scheme (const char *name, SCM arg0, SCM arg1, OBJECT *object)
+{
+  SCM proc = scm_c_public_ref ("geda object", name);
+
+  scm_dynwind_begin (0);
+  edascm_dynwind_toplevel (toplevel);
+  if (arg1 == SCM_UNDEFINED)
+    scm_call_2 (proc, arg0, edascm_from_object (object));
+  else
+    scm_call_3 (proc, arg0, arg1, edascm_from_object (object));
+  scm_dynwind_end ();
+}
+
+static void transform (void)
+{
+  OBJECT *object = random_object ();
+  int x = coord (), y = coord ();
+
+  if (object == NULL)
+    return;
+
+  switch (g_rand_int_range (rnd, 0, 5)) {
+    case 0:
+      /* translate without updating any connections */
+      o_translate_world (object, x - SIZE * GRID / 2, y - SIZE * GRID / 2);
+      break;
+    case 1:
+      call_scheme ("translate-objects!",
+                   scm_cons (scm_from_int (x - SIZE * GRID / 2),
+                             scm_from_int (y - SIZE * GRID / 2)),
+                   SCM_UNDEFINED, object);
+      break;
+    case 2:
+      call_scheme ("rotate-objects!",
+                   scm_cons (scm_from_int (x), scm_from_int (y)),
+                   scm_from_int (90 * g_rand_int_range (rnd, 1, 4)), object);
+      break;
+    case 3:
+      call_scheme ("mirror-objects!", scm_from_int (x), SCM_UNDEFINED,
+                   object);
+      break;
+    default:
+      if (object->type != OBJ_COMPLEX)
+        return;
+      scm_dynwind_begin (0);
+      edascm_dynwind_toplevel (toplevel);
+      scm_call_5 (scm_c_public_ref ("geda object", "set-component!"),
+                  edascm_from_object (object),
+                  scm_cons (scm_from_int (x), scm_from_int (y)),
+                  scm_from_int (0), SCM_BOOL_F, SCM_BOOL_F);
+      scm_dynwind_end ();
+      break;
+  }
+}
+
+static void remove_object (void)
+{
+  OBJECT *object = random_object ();
+
+  if (object == NULL)
+    return;
+  s_page_remove (toplevel, page, object);
+  s_delete_object (toplevel, object);
+}
+
+static void reload (void)
+{
+  gchar *buffer = o_save_buffer (s_page_objects (page));
+
+  s_page_delete_objects (toplevel, page);
+  s_page_append_list (toplevel, page, read_objects (buffer));
+  g_free (buffer);
+}
+
+/* Describe the connections of an object independently of the
+ * addresses of the objects involved. */
+static gchar *describe_connections (OBJECT *object)
+{
+  GPtrArray *lines = g_ptr_array_new_with_free_func (g_free);
+  GList *iter;
+  gchar *result;
+
+  for (iter = object->conn_list; iter != NULL; iter = g_list_next (iter)) {
+    CONN *conn = iter->data;
+    GList *other = g_list_prepend (NULL, conn->other_object);
+    gchar *saved = o_save_buffer (other);
+
+    g_ptr_array_add (lines, g_strdup_printf ("%d %d %d %d %d %s",
+                                             conn->type, conn->x, conn->y,
+                                             conn->whichone,
+                                             conn->other_whichone, saved));
+    g_free (saved);
+    g_list_free (other);
+  }
+
+  g_ptr_array_sort (lines, (GCompareFunc) g_strcmp0);
+  g_ptr_array_add (lines, NULL);
+  result = g_strjoinv ("\n", (gchar **) lines->pdata);
+  g_ptr_array_free (lines, TRUE);
+  return result;
+}
+
+static void check (void)
+{
+  gchar *buffer = o_save_buffer (s_page_objects (page));
+  PAGE *fresh = s_page_new (toplevel, "fresh.sch");
+  int i;
+
+  s_page_append_list (toplevel, fresh, read_objects (buffer));
+  g_free (buffer);
+
+  for (i = 0; i < PROBES; i++) {
+    int x0 = coord (), y0 = coord ();
+    int x1 = g_rand_boolean (rnd) ? x0 : coord ();
+    int y1 = x1 == x0 ? coord () : y0;
+    OBJECT *probe, *fresh_probe;
+    gchar *expected, *actual;
+
+    if (x0 == x1 && y0 == y1)
+      continue;
+
+    probe = o_net_new (toplevel, OBJ_NET, NET_COLOR, x0, y0, x1, y1);
+    fresh_probe = o_net_new (toplevel, OBJ_NET, NET_COLOR, x0, y0, x1, y1);
+    s_page_append (toplevel, page, probe);
+    s_page_append (toplevel, fresh, fresh_probe);
+
+    actual = describe_connections (probe);
+    expected = describe_connections (fresh_probe);
+    assert (strcmp (actual, expected) == 0);
+    g_free (actual);
+    g_free (expected);
+
+    s_page_remove (toplevel, page, probe);
+    s_delete_object (toplevel, probe);
+    s_page_remove (toplevel, fresh, fresh_probe);
+    s_delete_object (toplevel, fresh_probe);
+  }
+
+  s_page_delete (toplevel, fresh);
+  s_toplevel_set_page_current (toplevel, page);
+}
+
+int main (int argc, char *argv[])
+{
+  int i;
+
+  scm_init_guile ();
+  libgeda_init ();
+
+  toplevel = s_toplevel_new ();
+  page = s_page_new (toplevel, "conn_index.sch");
+  s_toplevel_set_page_current (toplevel, page);
+  rnd = g_rand_new_with_seed (1);
+
+  for (i = 0; i < STEPS; i++) {
+    guint32 op = g_rand_int_range (rnd, 0, 20);
+
+    if (op < 6)
+      add_line ();
+    else if (op < 8)
+      add_component ();
+    else if (op < 15)
+      transform ();
+    else if (op < 19)
+      remove_object ();
+    else
+      reload ();
+
+    check ();
+  }
+
+  g_rand_free (rnd);
+  s_toplevel_delete (toplevel);
+  return 0;
+}
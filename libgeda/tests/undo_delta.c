@@ -0,0 +1,137 @@
+/* gEDA - GPL Electronic Design Automation
+ * libgeda - gEDA's library
+ * Copyright (C) 1998-2020 gEDA Contributors (see ChangeLog for details)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* Round trip through the delta undo mechanism: record three undo
+ * levels, then undo and redo them and compare the page contents. */
+
+#include <config.h>
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgeda/libgeda.h>
+
+static int notify (void *user_data, OBJECT *object)
+{
+  s_undo_delta_notify (object);
+  return 0;
+}
+
+static void assert_page (PAGE *page, const gchar *expected)
+{
+  gchar *buffer = o_save_buffer (s_page_objects (page));
+  assert (strcmp (buffer, expected) == 0);
+  g_free (buffer);
+}
+
+int main (int argc, char *argv[])
+{
+  TOPLEVEL *toplevel;
+  PAGE *page;
+  OBJECT *net, *attrib, *line, *line2;
+  gchar *state0, *state1, *state2, *state3;
+  GList *changes1, *changes2, *changes3;
+  int i;
+
+  scm_init_guile ();
+  libgeda_init ();
+
+  toplevel = s_toplevel_new ();
+  o_add_change_notify (toplevel, notify, notify, NULL);
+  page = s_page_new (toplevel, "undo_delta.sch");
+
+  net = o_net_new (toplevel, OBJ_NET, NET_COLOR, 0, 0, 1000, 0);
+  attrib = o_text_new (toplevel, ATTRIBUTE_COLOR, 0, 100, LOWER_LEFT, 0,
+                       "netname=A", 10, VISIBLE, SHOW_NAME_VALUE);
+  line = o_line_new (toplevel, GRAPHIC_COLOR, 0, 500, 500, 500);
+  line2 = o_line_new (toplevel, GRAPHIC_COLOR, 0, 1000, 500, 1000);
+  s_page_append (toplevel, page, net);
+  s_page_append (toplevel, page, attrib);
+  s_page_append (toplevel, page, line);
+  s_page_append (toplevel, page, line2);
+  o_attrib_attach (toplevel, attrib, net, FALSE);
+
+  s_undo_delta_track (page);
+  assert (s_undo_delta_is_tracked (page));
+  state0 = o_save_buffer (s_page_objects (page));
+
+  /* nothing has changed yet */
+  assert (s_undo_delta_flush (page, NULL) == NULL);
+
+  /* first level: change the net and its attribute, move the line */
+  o_rotate_world (toplevel, 0, 0, 90, net);
+  o_text_set_string (toplevel, attrib, "netname=B");
+  o_translate_world (line, 100, 200);
+  changes1 = s_undo_delta_flush (page, NULL);
+  assert (g_list_length (changes1) == 2);
+  state1 = o_save_buffer (s_page_objects (page));
+
+  /* second level: delete the line */
+  s_page_remove (toplevel, page, line);
+  s_delete_object (toplevel, line);
+  changes2 = s_undo_delta_flush (page, NULL);
+  assert (g_list_length (changes2) == 1);
+  state2 = o_save_buffer (s_page_objects (page));
+
+  /* go back and forth twice, so the second round works on the
+   * objects recreated by the first one */
+  for (i = 0; i < 2; i++) {
+    s_undo_delta_apply (toplevel, page, changes2, TRUE);
+    assert_page (page, state1);
+    s_undo_delta_apply (toplevel, page, changes1, TRUE);
+    assert_page (page, state0);
+
+    s_undo_delta_apply (toplevel, page, changes1, FALSE);
+    assert_page (page, state1);
+    s_undo_delta_apply (toplevel, page, changes2, FALSE);
+    assert_page (page, state2);
+  }
+
+  /* third level: delete the net, which has been recreated above and
+   * isn't the last object on the page */
+  net = s_page_objects (page)->data;
+  assert (net->type == OBJ_NET && net->attribs != NULL);
+  s_delete_object (toplevel, net->attribs->data);
+  s_delete_object (toplevel, net);
+  changes3 = s_undo_delta_flush (page, NULL);
+  assert (g_list_length (changes3) == 1);
+  state3 = o_save_buffer (s_page_objects (page));
+
+  /* undoing the deletion puts the net back in its old place */
+  for (i = 0; i < 2; i++) {
+    s_undo_delta_apply (toplevel, page, changes3, TRUE);
+    assert_page (page, state2);
+    s_undo_delta_apply (toplevel, page, changes3, FALSE);
+    assert_page (page, state3);
+  }
+
+  /* applying changes doesn't count as a change */
+  assert (s_undo_delta_flush (page, NULL) == NULL);
+
+  s_undo_free_changes (changes1);
+  s_undo_free_changes (changes2);
+  s_undo_free_changes (changes3);
+  g_free (state0);
+  g_free (state1);
+  g_free (state2);
+  g_free (state3);
+  s_toplevel_delete (toplevel);
+  return 0;
+}
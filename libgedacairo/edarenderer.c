@@ -20,6 +20,7 @@
 #include <config.h>
 
 #include <math.h>
+#include <string.h>
 #include <glib.h>
 #include <glib-object.h>
 #include <gdk/gdk.h>
@@ -51,6 +52,7 @@ enum {
   FLAG_TEXT_HIDDEN = EDA_RENDERER_FLAG_TEXT_HIDDEN,
   FLAG_TEXT_OUTLINE = EDA_RENDERER_FLAG_TEXT_OUTLINE,
   FLAG_TEXT_ORIGIN = EDA_RENDERER_FLAG_TEXT_ORIGIN,
+  FLAG_LEVEL_OF_DETAIL = EDA_RENDERER_FLAG_LEVEL_OF_DETAIL,
 
   GRIP_SQUARE,
   GRIP_CIRCLE,
@@ -73,6 +75,57 @@ struct _EdaRendererPrivate
 
   /* Cache of font metrics for different font sizes. */
   GHashTable *metrics_cache;
+
+  /* Cache of shaped text layouts, indexed by text object. */
+  GHashTable *text_cache;
+
+  /* Cache of hatch and mesh fill lines, indexed by object. */
+  GHashTable *hatch_cache;
+};
+
+/* A shaped text layout, together with the values it was prepared
+ * from.  An entry is only reused while these still match the text
+ * object, and is dropped as soon as the object is destroyed. */
+typedef struct _EdaRendererText EdaRendererText;
+
+struct _EdaRendererText
+{
+  EdaRenderer *renderer;
+  OBJECT *object;
+
+  gchar *disp_string;
+  int size;
+  unsigned int hinting;
+
+  PangoLayout *layout;
+  int descent;
+  PangoRectangle inked_rect;
+  PangoRectangle logical_rect;
+  gboolean has_overbars;
+};
+
+/* The fill lines of a hatched or meshed box, circle or path, together
+ * with the fill options and geometry they were computed from. */
+typedef struct _EdaRendererHatch EdaRendererHatch;
+
+struct _EdaRendererHatch
+{
+  EdaRenderer *renderer;
+  OBJECT *object;
+
+  OBJECT_FILLING fill_type;
+  int fill_angle1, fill_pitch1;
+  int fill_angle2, fill_pitch2;
+  union {
+    BOX box;
+    CIRCLE circle;
+  } shape;
+  PATH_SECTION *sections;
+  int num_sections;
+
+  GArray *lines;
+  /* The lines as a single path, for drawing without hinting. */
+  cairo_path_t path;
 };
 
 static inline gboolean
@@ -101,6 +154,14 @@ EDA_RENDERER_STROKE_WIDTH (EdaRenderer *r, double width) {
 #define TEXT_MARKER_SIZE 10
 #define TEXT_MARKER_COLOR LOCK_COLOR
 
+/* Level of detail thresholds, in device units (i.e., pixels on
+ * screen).  Objects smaller than LOD_CULL_SIZE aren't drawn at all;
+ * text with a font size below LOD_TEXT_SIZE is drawn as its bounding
+ * box, and complexes smaller than LOD_COMPLEX_SIZE as their bounds. */
+#define LOD_CULL_SIZE 1
+#define LOD_TEXT_SIZE 4
+#define LOD_COMPLEX_SIZE 8
+
 static GObject *eda_renderer_constructor (GType type,
                                           guint n_construct_properties,
                                           GObjectConstructParam *construct_params);
@@ -115,7 +176,10 @@ static void eda_renderer_update_contexts (EdaRenderer *renderer, cairo_t *new_cr
 
 static void eda_renderer_set_color (EdaRenderer *renderer, int color);
 static int eda_renderer_is_drawable (EdaRenderer *renderer, OBJECT *object);
+static double eda_renderer_get_device_size (EdaRenderer *renderer, OBJECT *object);
 static int eda_renderer_draw_hatch (EdaRenderer *renderer, OBJECT *object);
+static void eda_renderer_hatch_free (EdaRendererHatch *hatch);
+static void eda_renderer_hatch_weak_notify (void *dead_ptr, void *user_data);
 
 static void eda_renderer_default_draw (EdaRenderer *renderer, OBJECT *object);
 static void eda_renderer_draw_list (EdaRenderer *renderer, GList *objects);
@@ -130,9 +194,14 @@ static void eda_renderer_draw_path (EdaRenderer *renderer, OBJECT *object);
 static void eda_renderer_draw_text (EdaRenderer *renderer, OBJECT *object);
 static int eda_renderer_get_font_descent (EdaRenderer *renderer,
                                           PangoFontDescription *desc);
-static int eda_renderer_prepare_text (EdaRenderer *renderer, OBJECT *object);
-static void eda_renderer_calc_text_position (EdaRenderer *renderer, OBJECT *object,
-                                             int descent, double *x, double *y);
+static EdaRendererText *eda_renderer_prepare_text (EdaRenderer *renderer,
+                                                   OBJECT *object);
+static void eda_renderer_text_free (EdaRendererText *text);
+static void eda_renderer_text_weak_notify (void *dead_ptr, void *user_data);
+static void eda_renderer_calc_text_position (EdaRenderer *renderer,
+                                             EdaRendererText *text,
+                                             OBJECT *object,
+                                             double *x, double *y);
 static void eda_renderer_draw_picture (EdaRenderer *renderer, OBJECT *object);
 static void eda_renderer_draw_complex (EdaRenderer *renderer, OBJECT *object);
 
@@ -169,6 +238,7 @@ eda_renderer_flags_get_type ()
     {FLAG_TEXT_HIDDEN, "text-hidden", _("Hidden text")},
     {FLAG_TEXT_OUTLINE, "text-outline", _("Text outlines")},
     {FLAG_TEXT_ORIGIN, "text-origin", _("Text origins")},
+    {FLAG_LEVEL_OF_DETAIL, "level-of-detail", _("Level of detail")},
     {0, 0, 0},
   };
   static GType flags_type = 0;
@@ -258,6 +328,16 @@ eda_renderer_init (EdaRenderer *renderer)
   renderer->priv->metrics_cache =
     g_hash_table_new_full (g_int_hash, g_int_equal, g_free,
                            (GDestroyNotify) pango_font_metrics_unref);
+
+  /* Shaping text is even more expensive, so cache the layouts too. */
+  renderer->priv->text_cache =
+    g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                           (GDestroyNotify) eda_renderer_text_free);
+
+  /* Same for hatch lines, which are redrawn on every pan. */
+  renderer->priv->hatch_cache =
+    g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                           (GDestroyNotify) eda_renderer_hatch_free);
 }
 
 static GObject *
@@ -279,6 +359,9 @@ eda_renderer_dispose (GObject *object)
 {
   EdaRenderer *renderer = (EdaRenderer *) object;
 
+  g_hash_table_remove_all (renderer->priv->text_cache);
+  g_hash_table_remove_all (renderer->priv->hatch_cache);
+
   if (renderer->priv->pc != NULL) {
     g_object_unref (renderer->priv->pc);
     renderer->priv->pc = NULL;
@@ -306,6 +389,12 @@ eda_renderer_finalize (GObject *object)
   g_hash_table_destroy (renderer->priv->metrics_cache);
   renderer->priv->metrics_cache = NULL;
 
+  g_hash_table_destroy (renderer->priv->text_cache);
+  renderer->priv->text_cache = NULL;
+
+  g_hash_table_destroy (renderer->priv->hatch_cache);
+  renderer->priv->hatch_cache = NULL;
+
   cairo_destroy (renderer->priv->cr);
   renderer->priv->cr = NULL;
 
@@ -337,8 +426,9 @@ eda_renderer_set_property (GObject *object, guint property_id,
     if (renderer->priv->font_name != NULL)
       g_free (renderer->priv->font_name);
     renderer->priv->font_name = g_value_dup_string (value);
-    /* Clear font metrics cache */
+    /* Clear font metrics and text layout caches */
     g_hash_table_remove_all (renderer->priv->metrics_cache);
+    g_hash_table_remove_all (renderer->priv->text_cache);
     break;
   case PROP_COLOR_MAP:
     renderer->priv->color_map = g_value_get_pointer (value);
@@ -403,23 +493,25 @@ eda_renderer_update_contexts (EdaRenderer *renderer, cairo_t *new_cr,
       renderer->priv->pr = NULL;
     }
 
+    renderer->priv->cr = cairo_reference (new_cr);
+
     /* If the PangoContext was created from the previous Cairo
-     * context, it needs destroying too. */
-    if (renderer->priv->pc_from_cr) {
-      if (renderer->priv->pc != NULL) {
-        g_object_unref (renderer->priv->pc);
-        renderer->priv->pc = NULL;
-      }
-      if (renderer->priv->pl != NULL) {
-        g_object_unref (renderer->priv->pl);
-        renderer->priv->pl = NULL;
-      }
+     * context, it is kept so that the cached text layouts stay
+     * valid.  Just bring it up to date with the new context;
+     * eda_renderer_prepare_text() does the same for every layout
+     * anyway. */
+    if (renderer->priv->pc_from_cr && renderer->priv->pc != NULL) {
+      cairo_save (renderer->priv->cr);
+      cairo_identity_matrix (renderer->priv->cr);
+      pango_cairo_update_context (renderer->priv->cr, renderer->priv->pc);
+      cairo_restore (renderer->priv->cr);
     }
-
-    renderer->priv->cr = cairo_reference (new_cr);
   }
 
   if (new_pc != NULL) {
+    /* Cached layouts belong to the old PangoContext. */
+    g_hash_table_remove_all (renderer->priv->text_cache);
+
     if (renderer->priv->pc != NULL) {
       g_object_unref (G_OBJECT (renderer->priv->pc));
       renderer->priv->pc = NULL;
@@ -486,6 +578,12 @@ eda_renderer_default_draw (EdaRenderer *renderer, OBJECT *object)
 
   if (!eda_renderer_is_drawable (renderer, object)) return;
 
+  /* Don't bother drawing anything that wouldn't cover a pixel */
+  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_LEVEL_OF_DETAIL)) {
+    double size = eda_renderer_get_device_size (renderer, object);
+    if (size >= 0 && size < LOD_CULL_SIZE) return;
+  }
+
   switch (object->type) {
   case OBJ_LINE:        draw_func = eda_renderer_draw_line; break;
   case OBJ_NET:         draw_func = eda_renderer_draw_net; break;
@@ -547,14 +645,94 @@ eda_renderer_is_drawable (EdaRenderer *renderer, OBJECT *object)
   return eda_renderer_is_drawable_color (renderer, color, TRUE);
 }
 
-static int
-eda_renderer_draw_hatch (EdaRenderer *renderer, OBJECT *object)
+/* Returns the larger extent of the object's cached bounds in device
+ * units, or -1 if the bounds haven't been calculated. */
+static double
+eda_renderer_get_device_size (EdaRenderer *renderer, OBJECT *object)
+{
+  double width, height;
+
+  if (object->w_bounds_valid_for == NULL) return -1;
+
+  width = object->w_right - object->w_left;
+  height = object->w_bottom - object->w_top;
+  cairo_user_to_device_distance (renderer->priv->cr, &width, &height);
+
+  return fmax (fabs (width), fabs (height));
+}
+
+static void
+eda_renderer_hatch_free (EdaRendererHatch *hatch)
+{
+  if (hatch->renderer != NULL)
+    s_object_weak_unref (hatch->object, eda_renderer_hatch_weak_notify,
+                         hatch->renderer);
+  g_free (hatch->sections);
+  g_array_free (hatch->lines, TRUE);
+  g_free (hatch->path.data);
+  g_free (hatch);
+}
+
+static void
+eda_renderer_hatch_weak_notify (void *dead_ptr, void *user_data)
+{
+  EdaRenderer *renderer = EDA_RENDERER (user_data);
+  EdaRendererHatch *hatch;
+
+  hatch = g_hash_table_lookup (renderer->priv->hatch_cache, dead_ptr);
+  if (hatch == NULL)
+    return;
+
+  g_hash_table_steal (renderer->priv->hatch_cache, dead_ptr);
+  hatch->renderer = NULL;
+  eda_renderer_hatch_free (hatch);
+}
+
+/* Check whether the cached fill lines of an object were computed for
+ * its current fill options and geometry. */
+static gboolean
+eda_renderer_hatch_is_valid (EdaRendererHatch *hatch, OBJECT *object)
+{
+  if (hatch->fill_type != object->fill_type
+      || hatch->fill_angle1 != object->fill_angle1
+      || hatch->fill_pitch1 != object->fill_pitch1)
+    return FALSE;
+
+  if (object->fill_type == FILLING_MESH
+      && (hatch->fill_angle2 != object->fill_angle2
+          || hatch->fill_pitch2 != object->fill_pitch2))
+    return FALSE;
+
+  switch (object->type) {
+  case OBJ_BOX:
+    return memcmp (&hatch->shape.box, object->box, sizeof (BOX)) == 0;
+  case OBJ_CIRCLE:
+    return memcmp (&hatch->shape.circle, object->circle, sizeof (CIRCLE)) == 0;
+  case OBJ_PATH:
+    return (hatch->num_sections == object->path->num_sections
+            && memcmp (hatch->sections, object->path->sections,
+                       object->path->num_sections * sizeof (PATH_SECTION)) == 0);
+  default:
+    return FALSE;
+  }
+}
+
+/* Look up the fill lines of a hatched or meshed object, running the
+ * hatching algorithm again if the object's fill options or geometry
+ * have changed since they were last computed. */
+static EdaRendererHatch *
+eda_renderer_lookup_hatch (EdaRenderer *renderer, OBJECT *object)
 {
   void (*hatch_func)(void *, gint, gint, GArray *);
   void *hatch_data;
-  GArray *fill_lines;
+  EdaRendererHatch *hatch;
+  cairo_path_data_t *data;
   int i;
 
+  hatch = g_hash_table_lookup (renderer->priv->hatch_cache, object);
+  if (hatch != NULL && eda_renderer_hatch_is_valid (hatch, object))
+    return hatch;
+
   /* Horrible horrible hacks! */
   switch (object->type) {
   case OBJ_BOX:
@@ -569,6 +747,94 @@ eda_renderer_draw_hatch (EdaRenderer *renderer, OBJECT *object)
     hatch_func = (void *) m_hatch_path;
     hatch_data = (void (*)(void *, gint, gint, GArray *)) object->path;
     break;
+  default:
+    g_return_val_if_reached (NULL);
+  }
+
+  if (hatch == NULL) {
+    hatch = g_new0 (EdaRendererHatch, 1);
+    hatch->renderer = renderer;
+    hatch->object = object;
+    hatch->lines = g_array_new (FALSE, FALSE, sizeof (LINE));
+    s_object_weak_ref (object, eda_renderer_hatch_weak_notify, renderer);
+    g_hash_table_insert (renderer->priv->hatch_cache, object, hatch);
+  } else {
+    g_free (hatch->sections);
+    hatch->sections = NULL;
+    g_array_set_size (hatch->lines, 0);
+    g_free (hatch->path.data);
+  }
+
+  hatch->fill_type = object->fill_type;
+  hatch->fill_angle1 = object->fill_angle1;
+  hatch->fill_pitch1 = object->fill_pitch1;
+  hatch->fill_angle2 = object->fill_angle2;
+  hatch->fill_pitch2 = object->fill_pitch2;
+
+  switch (object->type) {
+  case OBJ_BOX:
+    hatch->shape.box = *object->box;
+    break;
+  case OBJ_CIRCLE:
+    hatch->shape.circle = *object->circle;
+    break;
+  case OBJ_PATH:
+    hatch->num_sections = object->path->num_sections;
+    hatch->sections =
+      g_memdup (object->path->sections,
+                object->path->num_sections * sizeof (PATH_SECTION));
+    break;
+  default:
+    break;
+  }
+
+  switch (object->fill_type) {
+  case FILLING_MESH:
+    hatch_func (hatch_data, object->fill_angle2, object->fill_pitch2,
+                hatch->lines);
+    /* Intentionally fall through */
+  case FILLING_HATCH:
+    hatch_func (hatch_data, object->fill_angle1, object->fill_pitch1,
+                hatch->lines);
+    break;
+  default:
+    break;
+  }
+
+  /* Each line is a move-to and a line-to, each of which takes a
+   * header and a point element. */
+  hatch->path.status = CAIRO_STATUS_SUCCESS;
+  hatch->path.num_data = hatch->lines->len * 4;
+  hatch->path.data = data = g_new (cairo_path_data_t, hatch->path.num_data);
+
+  for (i = 0; i < hatch->lines->len; i++) {
+    LINE *line = &g_array_index (hatch->lines, LINE, i);
+
+    data[0].header.type = CAIRO_PATH_MOVE_TO;
+    data[0].header.length = 2;
+    data[1].point.x = line->x[0];
+    data[1].point.y = line->y[0];
+    data[2].header.type = CAIRO_PATH_LINE_TO;
+    data[2].header.length = 2;
+    data[3].point.x = line->x[1];
+    data[3].point.y = line->y[1];
+    data += 4;
+  }
+
+  return hatch;
+}
+
+static int
+eda_renderer_draw_hatch (EdaRenderer *renderer, OBJECT *object)
+{
+  EdaRendererHatch *hatch;
+  int i;
+
+  switch (object->type) {
+  case OBJ_BOX:
+  case OBJ_CIRCLE:
+  case OBJ_PATH:
+    break;
   default:
     g_return_val_if_reached (FALSE);
   }
@@ -587,37 +853,52 @@ eda_renderer_draw_hatch (EdaRenderer *renderer, OBJECT *object)
   }
 
   /* Handle mesh and hatch fill types */
-  fill_lines = g_array_new (FALSE, FALSE, sizeof (LINE));
-  switch (object->fill_type) {
-  case FILLING_MESH:
-    hatch_func (hatch_data, object->fill_angle2, object->fill_pitch2, fill_lines);
-    /* Intentionally fall through */
-  case FILLING_HATCH:
-    hatch_func (hatch_data, object->fill_angle1, object->fill_pitch1, fill_lines);
-    break;
-  default:
-    break;
-  }
+  hatch = eda_renderer_lookup_hatch (renderer, object);
+  if (hatch == NULL || hatch->lines->len == 0)
+    return FALSE;
 
-  /* Draw fill pattern */
-  for (i = 0; i < fill_lines->len; i++) {
-    LINE *line = &g_array_index (fill_lines, LINE, i);
-    eda_cairo_line (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
-                    END_NONE, object->fill_width,
-                    line->x[0], line->y[0], line->x[1], line->y[1]);
+  /* Draw fill pattern.  Without hinting, the lines don't depend on
+   * the transformation and can be added as a single path. */
+  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_HINTING)) {
+    for (i = 0; i < hatch->lines->len; i++) {
+      LINE *line = &g_array_index (hatch->lines, LINE, i);
+      eda_cairo_line (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
+                      END_NONE, object->fill_width,
+                      line->x[0], line->y[0], line->x[1], line->y[1]);
+    }
+  } else {
+    cairo_append_path (renderer->priv->cr, &hatch->path);
   }
   eda_cairo_stroke (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
                     TYPE_SOLID, END_NONE,
                     EDA_RENDERER_STROKE_WIDTH (renderer, object->fill_width),
                     -1, -1);
 
-  g_array_free (fill_lines, TRUE);
   return FALSE;
 }
 
 static void
 eda_renderer_draw_complex (EdaRenderer *renderer, OBJECT *object)
 {
+  /* If the symbol is too small to make out any details, just draw
+   * its bounds. */
+  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_LEVEL_OF_DETAIL)) {
+    double size = eda_renderer_get_device_size (renderer, object);
+    if (size >= 0 && size < LOD_COMPLEX_SIZE) {
+      if (!eda_renderer_is_drawable_color (renderer, GRAPHIC_COLOR, TRUE))
+        return;
+      eda_renderer_set_color (renderer, GRAPHIC_COLOR);
+      eda_cairo_box (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
+                     0, object->w_left, object->w_bottom,
+                     object->w_right, object->w_top);
+      eda_cairo_stroke (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
+                        TYPE_SOLID, END_SQUARE,
+                        EDA_RENDERER_STROKE_WIDTH (renderer, 0),
+                        -1, -1);
+      return;
+    }
+  }
+
   /* Recurse */
   eda_renderer_draw_list (renderer, object->complex->prim_objs);
 }
@@ -771,8 +1052,10 @@ eda_renderer_draw_path (EdaRenderer *renderer, OBJECT *object)
 static void
 eda_renderer_draw_text (EdaRenderer *renderer, OBJECT *object)
 {
+  EdaRendererText *text;
   double x, y;
   double dummy = 0, small_dist = TEXT_MARKER_SIZE;
+  gboolean outline;
 
   /* First check if this is hidden text. */
   if (object->visibility == INVISIBLE
@@ -784,8 +1067,20 @@ eda_renderer_draw_text (EdaRenderer *renderer, OBJECT *object)
   if (object->text->disp_string == NULL)
     return;
 
+  outline = EDA_RENDERER_CHECK_FLAG (renderer, FLAG_TEXT_OUTLINE);
+
+  /* Shaping text which is too small to be read is a waste of time,
+   * so treat it as if text outline mode was selected. */
+  if (!outline && EDA_RENDERER_CHECK_FLAG (renderer, FLAG_LEVEL_OF_DETAIL)
+      && object->w_bounds_valid_for != NULL) {
+    double font_size = o_text_get_font_size_in_points (object) * 1000 / 72;
+    cairo_user_to_device_distance (renderer->priv->cr, &dummy, &font_size);
+    outline = fabs (font_size) < LOD_TEXT_SIZE;
+    dummy = 0;
+  }
+
   /* If text outline mode is selected, draw an outline */
-  if (EDA_RENDERER_CHECK_FLAG (renderer, FLAG_TEXT_OUTLINE)) {
+  if (outline) {
     eda_cairo_box (renderer->priv->cr, EDA_RENDERER_CAIRO_FLAGS (renderer),
                    0, object->w_left, object->w_bottom,
                    object->w_right, object->w_top);
@@ -798,9 +1093,9 @@ eda_renderer_draw_text (EdaRenderer *renderer, OBJECT *object)
 
   /* Otherwise, actually draw the text */
   cairo_save (renderer->priv->cr);
-  if (eda_renderer_prepare_text (renderer, object)) {
-    eda_pango_renderer_show_layout (renderer->priv->pr, renderer->priv->pl,
-                                    0, 0);
+  text = eda_renderer_prepare_text (renderer, object);
+  if (text != NULL) {
+    eda_pango_renderer_show_layout (renderer->priv->pr, text->layout, 0, 0);
     cairo_restore (renderer->priv->cr);
   } else {
     cairo_restore (renderer->priv->cr);
@@ -868,15 +1163,105 @@ eda_renderer_get_font_descent (EdaRenderer *renderer,
   return pango_font_metrics_get_descent (metrics);
 }
 
-static int
-eda_renderer_prepare_text (EdaRenderer *renderer, OBJECT *object)
+static void
+eda_renderer_text_free (EdaRendererText *text)
 {
-  double points_size, dx, dy;
-  int size, descent;
+  if (text->renderer != NULL)
+    s_object_weak_unref (text->object, eda_renderer_text_weak_notify,
+                         text->renderer);
+  g_object_unref (text->layout);
+  g_free (text->disp_string);
+  g_free (text);
+}
+
+static void
+eda_renderer_text_weak_notify (void *dead_ptr, void *user_data)
+{
+  EdaRenderer *renderer = EDA_RENDERER (user_data);
+  EdaRendererText *text;
+
+  text = g_hash_table_lookup (renderer->priv->text_cache, dead_ptr);
+  if (text == NULL)
+    return;
+
+  /* The object's weak references are already being torn down, so
+   * don't try to remove ours. */
+  g_hash_table_steal (renderer->priv->text_cache, dead_ptr);
+  text->renderer = NULL;
+  eda_renderer_text_free (text);
+}
+
+/* Look up the cached layout for a text object, shaping it again if
+ * the object's text or size, or the renderer's hinting setting, has
+ * changed since it was last prepared. */
+static EdaRendererText *
+eda_renderer_lookup_text (EdaRenderer *renderer, OBJECT *object, int size)
+{
+  EdaRendererText *text;
+  unsigned int hinting = EDA_RENDERER_CHECK_FLAG (renderer, FLAG_HINTING);
   char *draw_string;
-  cairo_font_options_t *options;
   PangoFontDescription *desc;
   PangoAttrList *attrs;
+  PangoAttrIterator *attr_iterator;
+
+  text = g_hash_table_lookup (renderer->priv->text_cache, object);
+  if (text != NULL
+      && text->size == size
+      && text->hinting == hinting
+      && strcmp (text->disp_string, object->text->disp_string) == 0) {
+    return text;
+  }
+
+  /* Extract text to display and Pango text attributes. */
+  if (!eda_pango_parse_overbars (object->text->disp_string, -1,
+                                 &attrs, &draw_string)) {
+    g_hash_table_remove (renderer->priv->text_cache, object);
+    return NULL;
+  }
+
+  if (text == NULL) {
+    text = g_new0 (EdaRendererText, 1);
+    text->renderer = renderer;
+    text->object = object;
+    text->layout = pango_layout_new (renderer->priv->pc);
+    s_object_weak_ref (object, eda_renderer_text_weak_notify, renderer);
+    g_hash_table_insert (renderer->priv->text_cache, object, text);
+  } else {
+    g_free (text->disp_string);
+  }
+  text->disp_string = g_strdup (object->text->disp_string);
+  text->size = size;
+  text->hinting = hinting;
+
+  /* Set font name and size, and obtain descent metric */
+  desc = pango_font_description_from_string (renderer->priv->font_name);
+  pango_font_description_set_size (desc, size);
+  pango_layout_set_font_description (text->layout, desc);
+  text->descent = eda_renderer_get_font_descent (renderer, desc);
+  pango_font_description_free (desc);
+
+  /* Set up layout. */
+  pango_layout_set_text (text->layout, draw_string, -1);
+  pango_layout_set_attributes (text->layout, attrs);
+  g_free (draw_string);
+
+  attr_iterator = pango_attr_list_get_iterator (attrs);
+  text->has_overbars = pango_attr_iterator_next (attr_iterator);
+  pango_attr_iterator_destroy (attr_iterator);
+  pango_attr_list_unref (attrs);
+
+  pango_layout_get_extents (text->layout,
+                            &text->inked_rect, &text->logical_rect);
+  return text;
+}
+
+static EdaRendererText *
+eda_renderer_prepare_text (EdaRenderer *renderer, OBJECT *object)
+{
+  double points_size, dx, dy;
+  int size;
+  cairo_font_options_t *options;
+  EdaRendererText *text;
 
   points_size = o_text_get_font_size_in_points (object); /* FIXME */
   size = lrint (points_size * PANGO_SCALE);
@@ -894,26 +1279,13 @@ eda_renderer_prepare_text (EdaRenderer *renderer, OBJECT *object)
 
   pango_cairo_context_set_resolution (renderer->priv->pc, 1000);
 
-  /* Set font name and size, and obtain descent metric */
-  desc = pango_font_description_from_string (renderer->priv->font_name);
-  pango_font_description_set_size (desc, size);
-  pango_layout_set_font_description (renderer->priv->pl, desc);
-  descent = eda_renderer_get_font_descent (renderer, desc);
-  pango_font_description_free (desc);
-
-  /* Extract text to display and Pango text attributes, and then set
-   * up layout. */
-  if (!eda_pango_parse_overbars (object->text->disp_string, -1,
-                                 &attrs, &draw_string)) {
-    return FALSE;
-  }
-  pango_layout_set_text (renderer->priv->pl, draw_string, -1);
-  pango_layout_set_attributes (renderer->priv->pl, attrs);
-  g_free (draw_string);
-  pango_attr_list_unref (attrs);
+  /* Get the shaped layout, from the cache if possible. */
+  text = eda_renderer_lookup_text (renderer, object, size);
+  if (text == NULL)
+    return NULL;
 
   /* Calculate text position. */
-  eda_renderer_calc_text_position (renderer, object, descent, &dx, &dy);
+  eda_renderer_calc_text_position (renderer, text, object, &dx, &dy);
 
   cairo_translate (renderer->priv->cr, object->text->x, object->text->y);
 
@@ -938,25 +1310,24 @@ eda_renderer_prepare_text (EdaRenderer *renderer, OBJECT *object)
 
   cairo_save (renderer->priv->cr);
   cairo_identity_matrix (renderer->priv->cr);
-  pango_cairo_update_layout (renderer->priv->cr, renderer->priv->pl);
+  pango_cairo_update_layout (renderer->priv->cr, text->layout);
   cairo_restore (renderer->priv->cr);
-  return TRUE;
+  return text;
 }
 
 /* Calculate position to draw text relative to text origin marker, in
  * world coordinates. */
 static void
-eda_renderer_calc_text_position (EdaRenderer *renderer, OBJECT *object,
-                                 int descent, double *x, double *y)
+eda_renderer_calc_text_position (EdaRenderer *renderer, EdaRendererText *text,
+                                 OBJECT *object, double *x, double *y)
 {
-  PangoRectangle inked_rect, logical_rect;
+  PangoRectangle inked_rect = text->inked_rect;
+  PangoRectangle logical_rect = text->logical_rect;
+  int descent = text->descent;
   double temp;
   double y_lower, y_middle, y_upper;
   double x_left, x_middle, x_right;
 
-  pango_layout_get_extents (renderer->priv->pl,
-                            &inked_rect, &logical_rect);
-
   x_left = 0;
   x_middle = -logical_rect.width / 2.0;
   x_right = -logical_rect.width;
@@ -1514,10 +1885,8 @@ eda_renderer_get_text_user_bounds (EdaRenderer *renderer, OBJECT *object,
                                    double *left, double *top,
                                    double *right, double *bottom)
 {
+  EdaRendererText *text;
   PangoRectangle inked_rect, logical_rect;
-  PangoAttrList *attr_list;
-  PangoAttrIterator *attr_iterator;
-  gboolean has_overbars;
 
   /* First check if this is hidden text. */
   if (object->visibility == INVISIBLE
@@ -1532,22 +1901,23 @@ eda_renderer_get_text_user_bounds (EdaRenderer *renderer, OBJECT *object,
   cairo_save (renderer->priv->cr);
 
   /* Set up the text and check it worked. */
-  if (!eda_renderer_prepare_text (renderer, object))
+  text = eda_renderer_prepare_text (renderer, object);
+  if (text == NULL) {
+    cairo_restore (renderer->priv->cr);
     return FALSE;
+  }
 
   /* Figure out the bounds, send them back.  Note that Pango thinks in
    * device coordinates, but we need world coordinates. */
-  pango_layout_get_pixel_extents (renderer->priv->pl,
-                                  &inked_rect, &logical_rect);
+  inked_rect = text->inked_rect;
+  logical_rect = text->logical_rect;
+  pango_extents_to_pixels (&inked_rect, NULL);
+  pango_extents_to_pixels (&logical_rect, NULL);
 
   /* The logic for factoring overbar/strikethrough into the text
    * extents is hard-coded into Pango, so we need to simulate this
    * as good as we can here. */
-  attr_list = pango_layout_get_attributes (renderer->priv->pl);
-  attr_iterator = pango_attr_list_get_iterator (attr_list);
-  has_overbars = pango_attr_iterator_next (attr_iterator);
-  pango_attr_iterator_destroy (attr_iterator);
-  if (has_overbars) {
+  if (text->has_overbars) {
     /* Since we can't access the values which we'd need for getting
      * the height exactly right and since the overbar goes up *almost*
      * to zero, just pretend it does go up to zero. */
@@ -70,6 +70,8 @@ enum _EdaRendererFlags
   EDA_RENDERER_FLAG_TEXT_OUTLINE = 1 << 3,
   /* Should text origin markers be drawn? */
   EDA_RENDERER_FLAG_TEXT_ORIGIN = 1 << 4,
+  /* Should details too small to be seen be simplified or skipped? */
+  EDA_RENDERER_FLAG_LEVEL_OF_DETAIL = 1 << 5,
 };
 
 GType eda_renderer_get_type (void) G_GNUC_CONST;
@@ -67,6 +67,7 @@ typedef enum {
 typedef struct xorn_revision *xorn_revision_t;
 typedef struct xorn_object *xorn_object_t;
 typedef struct xorn_selection *xorn_selection_t;
+typedef struct xorn_connectivity *xorn_connectivity_t;
 
 /* revision functions */
 
@@ -106,6 +107,11 @@ int xorn_get_removed_objects(
 int xorn_get_modified_objects(
 	xorn_revision_t from_rev, xorn_revision_t to_rev,
 	xorn_object_t **objects_return, size_t *count_return);
+int xorn_get_changes(
+	xorn_revision_t from_rev, xorn_revision_t to_rev,
+	xorn_object_t **added_return, size_t *added_count_return,
+	xorn_object_t **removed_return, size_t *removed_count_return,
+	xorn_object_t **modified_return, size_t *modified_count_return);
 
 /* selection functions */
 
@@ -369,6 +375,40 @@ DOUBLE2D_ATTRIBUTE(xornsch, size)
 
 #undef DECLARE_ATTRIBUTE_FUNCTIONS
 
+/* connectivity functions */
+
+typedef enum {
+	xorn_conntype_endpoint,
+	xorn_conntype_midpoint,
+} xorn_conntype_t;
+
+struct xorn_connection {
+	struct xorn_double2d pos;
+	xorn_conntype_t type;
+	int whichend0;
+	size_t group1;
+	xorn_object_t ob1;
+	int whichend1;
+};
+
+xorn_connectivity_t xorn_new_connectivity(void);
+void xorn_free_connectivity(xorn_connectivity_t conn);
+
+int xorn_connectivity_goto(xorn_connectivity_t conn, xorn_revision_t rev,
+			   xorn_error_t *err);
+int xorn_connectivity_add_segment(xorn_connectivity_t conn,
+				  size_t group, xorn_object_t ob,
+				  const struct xornsch_net *data,
+				  xorn_error_t *err);
+int xorn_connectivity_remove_segment(xorn_connectivity_t conn,
+				     size_t group, xorn_object_t ob,
+				     xorn_error_t *err);
+int xorn_connectivity_update(xorn_connectivity_t conn, xorn_error_t *err);
+
+int xorn_get_connections(
+	xorn_connectivity_t conn, size_t group, xorn_object_t ob,
+	struct xorn_connection **connections_return, size_t *count_return);
+
 #ifdef __cplusplus
 }
 #endif
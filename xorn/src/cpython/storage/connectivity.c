@@ -0,0 +1,300 @@
+/* Copyright (C) 2013-2020 Roland Lutz
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+#include "data.h"
+#include "module.h"
+
+
+static PyObject *Connectivity_new(PyTypeObject *type,
+				  PyObject *args, PyObject *kwds)
+{
+	static char *kwlist[] = { NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(
+		    args, kwds, ":Connectivity", kwlist))
+		return NULL;
+
+	Connectivity *self = (Connectivity *)type->tp_alloc(type, 0);
+	if (self == NULL)
+		return NULL;
+
+	self->conn = xorn_new_connectivity();
+	if (self->conn == NULL) {
+		Py_DECREF(self);
+		return PyErr_NoMemory();
+	}
+	return (PyObject *)self;
+}
+
+static void Connectivity_dealloc(Connectivity *self)
+{
+	xorn_free_connectivity(self->conn);
+	self->ob_type->tp_free((PyObject *)self);
+}
+
+static PyObject *Connectivity_goto(
+	Connectivity *self, PyObject *args, PyObject *kwds)
+{
+	PyObject *rev_arg = NULL;
+	static char *kwlist[] = { "rev", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(
+		    args, kwds, "O!:Connectivity.goto", kwlist,
+		    &RevisionType, &rev_arg))
+		return NULL;
+
+	xorn_error_t err;
+	if (xorn_connectivity_goto(self->conn, ((Revision *)rev_arg)->rev,
+				   &err) == -1) {
+		if (err == xorn_error_out_of_memory)
+			return PyErr_NoMemory();
+		PyErr_SetString(PyExc_ValueError,
+				"revision must not be transient");
+		return NULL;
+	}
+
+	Py_INCREF(Py_None);
+	return Py_None;
+}
+
+static PyObject *Connectivity_add_segment(
+	Connectivity *self, PyObject *args, PyObject *kwds)
+{
+	Py_ssize_t group;
+	PyObject *ob_arg = NULL, *data_arg = NULL;
+	static char *kwlist[] = { "group", "ob", "data", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(
+		    args, kwds, "nO!O!:Connectivity.add_segment", kwlist,
+		    &group, &ObjectType, &ob_arg, &NetType, &data_arg))
+		return NULL;
+
+	if (group <= 0) {
+		PyErr_SetString(PyExc_ValueError,
+				"group must be a positive number");
+		return NULL;
+	}
+
+	xorn_error_t err;
+	if (xorn_connectivity_add_segment(
+		    self->conn, group, ((Object *)ob_arg)->ob,
+		    &((Net *)data_arg)->data, &err) == -1) {
+		if (err == xorn_error_out_of_memory)
+			return PyErr_NoMemory();
+		PyErr_SetString(PyExc_ValueError, "segment already exists");
+		return NULL;
+	}
+
+	Py_INCREF(Py_None);
+	return Py_None;
+}
+
+static PyObject *Connectivity_remove_segment(
+	Connectivity *self, PyObject *args, PyObject *kwds)
+{
+	Py_ssize_t group;
+	PyObject *ob_arg = NULL;
+	static char *kwlist[] = { "group", "ob", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(
+		    args, kwds, "nO!:Connectivity.remove_segment", kwlist,
+		    &group, &ObjectType, &ob_arg))
+		return NULL;
+
+	if (group < 0 || xorn_connectivity_remove_segment(
+		    self->conn, group, ((Object *)ob_arg)->ob, NULL) == -1) {
+		PyErr_SetString(PyExc_KeyError, "segment doesn't exist");
+		return NULL;
+	}
+
+	Py_INCREF(Py_None);
+	return Py_None;
+}
+
+static PyObject *Connectivity_update(Connectivity *self)
+{
+	if (xorn_connectivity_update(self->conn, NULL) == -1)
+		return PyErr_NoMemory();
+
+	Py_INCREF(Py_None);
+	return Py_None;
+}
+
+static PyObject *Connectivity_get_connections(
+	Connectivity *self, PyObject *args, PyObject *kwds)
+{
+	Py_ssize_t group;
+	PyObject *ob_arg = NULL;
+	static char *kwlist[] = { "group", "ob", NULL };
+	struct xorn_connection *connections;
+	size_t count;
+	PyObject *list;
+	size_t i;
+
+	if (!PyArg_ParseTupleAndKeywords(
+		    args, kwds, "nO!:Connectivity.get_connections", kwlist,
+		    &group, &ObjectType, &ob_arg))
+		return NULL;
+
+	if (group < 0 || xorn_get_connections(
+		    self->conn, group, ((Object *)ob_arg)->ob,
+		    &connections, &count) == -1) {
+		PyErr_SetString(PyExc_KeyError, "segment doesn't exist");
+		return NULL;
+	}
+
+	list = PyList_New(count);
+	if (list == NULL) {
+		free(connections);
+		return NULL;
+	}
+
+	for (i = 0; i < count; i++) {
+		PyObject *ob_item = build_object(connections[i].ob1);
+		if (ob_item == NULL) {
+			Py_DECREF(list);
+			free(connections);
+			return NULL;
+		}
+		PyObject *item = Py_BuildValue(
+			"ddiinNi", connections[i].pos.x, connections[i].pos.y,
+			(int) connections[i].type, connections[i].whichend0,
+			(Py_ssize_t) connections[i].group1, ob_item,
+			connections[i].whichend1);
+		if (item == NULL) {
+			Py_DECREF(list);
+			free(connections);
+			return NULL;
+		}
+		PyList_SET_ITEM(list, i, item);
+	}
+
+	free(connections);
+	return list;
+}
+
+static PyMethodDef Connectivity_methods[] = {
+	{ "goto", (PyCFunction)Connectivity_goto, METH_KEYWORDS,
+	  PyDoc_STR("conn.goto(rev) -- "
+		    "update the net segments of group 0 to a revision\n\n"
+		    "Only callable with a revision which isn't transient.\n") },
+	{ "add_segment", (PyCFunction)Connectivity_add_segment,
+	  METH_KEYWORDS,
+	  PyDoc_STR("conn.add_segment(group, ob, data) -- "
+		    "add a net segment which isn't part of the revision\n\n"
+		    "The coordinates in data must be absolute.\n") },
+	{ "remove_segment", (PyCFunction)Connectivity_remove_segment,
+	  METH_KEYWORDS,
+	  PyDoc_STR("conn.remove_segment(group, ob) -- "
+		    "remove a net segment and all its connections") },
+	{ "update", (PyCFunction)Connectivity_update, METH_NOARGS,
+	  PyDoc_STR("conn.update() -- "
+		    "find the connections of the segments added since the "
+		    "last update") },
+	{ "get_connections", (PyCFunction)Connectivity_get_connections,
+	  METH_KEYWORDS,
+	  PyDoc_STR("conn.get_connections(group, ob) -> [(x, y, type, "
+		    "whichend0, group1, ob1, whichend1)] -- "
+		    "the connections of a net segment") },
+
+	{ NULL, NULL, 0, NULL }  /* Sentinel */
+};
+
+PyTypeObject ConnectivityType = {
+	PyObject_HEAD_INIT(NULL)
+	0,                         /*ob_size*/
+
+	/* For printing, in format "<module>.<name>" */
+	"xorn.storage.Connectivity",	/* const char *tp_name */
+
+	/* For allocation */
+	sizeof(Connectivity),		/* Py_ssize_t tp_basicsize */
+	0,				/* Py_ssize_t tp_itemsize */
+
+	/* Methods to implement standard operations */
+	(destructor)Connectivity_dealloc, /* destructor tp_dealloc */
+	NULL,				/* printfunc tp_print */
+	NULL,				/* getattrfunc tp_getattr */
+	NULL,				/* setattrfunc tp_setattr */
+	NULL,				/* cmpfunc tp_compare */
+	NULL,				/* reprfunc tp_repr */
+
+	/* Method suites for standard classes */
+	NULL,				/* PyNumberMethods *tp_as_number */
+	NULL,				/* PySequenceMethods *tp_as_sequence */
+	NULL,				/* PyMappingMethods *tp_as_mapping */
+
+	/* More standard operations (here for binary compatibility) */
+	NULL,				/* hashfunc tp_hash */
+	NULL,				/* ternaryfunc tp_call */
+	NULL,				/* reprfunc tp_str */
+	NULL,				/* getattrofunc tp_getattro */
+	NULL,				/* setattrofunc tp_setattro */
+
+	/* Functions to access object as input/output buffer */
+	NULL,				/* PyBufferProcs *tp_as_buffer */
+
+	/* Flags to define presence of optional/expanded features */
+	Py_TPFLAGS_DEFAULT,		/* long tp_flags */
+
+	/* Documentation string */
+	PyDoc_STR("The geometrical connections between net segments.\n\n"
+		  "Connectivity() -> new connectivity object\n\n"),
+					/* const char *tp_doc */
+
+	/* Assigned meaning in release 2.0 */
+	/* call function for all accessible objects */
+	NULL,				/* traverseproc tp_traverse */
+
+	/* delete references to contained objects */
+	NULL,				/* inquiry tp_clear */
+
+	/* Assigned meaning in release 2.1 */
+	/* rich comparisons */
+	NULL,				/* richcmpfunc tp_richcompare */
+
+	/* weak reference enabler */
+	0,				/* Py_ssize_t tp_weaklistoffset */
+
+	/* Added in release 2.2 */
+	/* Iterators */
+	NULL,				/* getiterfunc tp_iter */
+	NULL,				/* iternextfunc tp_iternext */
+
+	/* Attribute descriptor and subclassing stuff */
+	Connectivity_methods,		/* struct PyMethodDef *tp_methods */
+	NULL,				/* struct PyMemberDef *tp_members */
+	NULL,				/* struct PyGetSetDef *tp_getset */
+	NULL,				/* struct _typeobject *tp_base */
+	NULL,				/* PyObject *tp_dict */
+	NULL,				/* descrgetfunc tp_descr_get */
+	NULL,				/* descrsetfunc tp_descr_set */
+	0,				/* Py_ssize_t tp_dictoffset */
+	NULL,				/* initproc tp_init */
+	NULL,				/* allocfunc tp_alloc */
+	Connectivity_new,		/* newfunc tp_new */
+	NULL,		/* freefunc tp_free--Low-level free-memory routine */
+	NULL,		/* inquiry tp_is_gc--For PyObject_IS_GC */
+	NULL,				/* PyObject *tp_bases */
+	NULL,		/* PyObject *tp_mro--method resolution order */
+	NULL,				/* PyObject *tp_cache */
+	NULL,				/* PyObject *tp_subclasses */
+	NULL,				/* PyObject *tp_weaklist */
+	NULL,				/* destructor tp_del */
+
+	/* Type attribute cache version tag. Added in version 2.6 */
+	0,				/* unsigned int tp_version_tag */
+};
@@ -170,6 +170,54 @@ static PyObject *get_modified_objects(
 	return to_python_list(objects, count);
 }
 
+static PyObject *get_changes(
+	PyObject *self, PyObject *args, PyObject *kwds)
+{
+	PyObject *from_arg = NULL, *to_arg = NULL;
+	static char *kwlist[] = { "from", "to", NULL };
+
+	if (!PyArg_ParseTupleAndKeywords(
+		    args, kwds, "O!O!:get_changes", kwlist,
+		    &RevisionType, &from_arg, &RevisionType, &to_arg))
+		return NULL;
+
+	xorn_object_t *added, *removed, *modified;
+	size_t added_count, removed_count, modified_count;
+
+	if (xorn_get_changes(((Revision *)from_arg)->rev,
+			     ((Revision *)to_arg)->rev,
+			     &added, &added_count,
+			     &removed, &removed_count,
+			     &modified, &modified_count) == -1)
+		return PyErr_NoMemory();
+
+	PyObject *added_list = to_python_list(added, added_count);
+	if (added_list == NULL) {
+		free(removed);
+		free(modified);
+		return NULL;
+	}
+	PyObject *removed_list = to_python_list(removed, removed_count);
+	if (removed_list == NULL) {
+		Py_DECREF(added_list);
+		free(modified);
+		return NULL;
+	}
+	PyObject *modified_list = to_python_list(modified, modified_count);
+	if (modified_list == NULL) {
+		Py_DECREF(removed_list);
+		Py_DECREF(added_list);
+		return NULL;
+	}
+
+	PyObject *result = PyTuple_Pack(
+		3, added_list, removed_list, modified_list);
+	Py_DECREF(modified_list);
+	Py_DECREF(removed_list);
+	Py_DECREF(added_list);
+	return result;
+}
+
 /****************************************************************************/
 
 static PyObject *select_none(
@@ -403,6 +451,10 @@ static PyMethodDef methods[] = {
 	  PyDoc_STR("get_modified_objects(from, to) -> [Object] -- "
 		    "a list of objects which exist in two revisions but have "
 		    "different type or data") },
+	{ "get_changes", (PyCFunction)get_changes, METH_KEYWORDS,
+	  PyDoc_STR("get_changes(from, to) -> ([Object], [Object], [Object]) "
+		    "-- lists of objects which have been added, removed, and "
+		    "modified between two revisions") },
 
 	{ "select_none", (PyCFunction)select_none, METH_NOARGS,
 	  PyDoc_STR("select_none() -> Selection -- "
@@ -466,6 +518,7 @@ PyMODINIT_FUNC initstorage(void)
 	if (PyType_Ready(&RevisionType) == -1)	return;
 	if (PyType_Ready(&ObjectType) == -1)	return;
 	if (PyType_Ready(&SelectionType) == -1)	return;
+	if (PyType_Ready(&ConnectivityType) == -1)	return;
 
 	if (PyType_Ready(&ArcType) == -1)	return;
 	if (PyType_Ready(&BoxType) == -1)	return;
@@ -485,6 +538,7 @@ PyMODINIT_FUNC initstorage(void)
 	if (add_type(m, "Revision", &RevisionType) == -1)	return;
 	if (add_type(m, "Object", &ObjectType) == -1)		return;
 	if (add_type(m, "Selection", &SelectionType) == -1)	return;
+	if (add_type(m, "Connectivity", &ConnectivityType) == -1) return;
 
 	if (add_type(m, "Arc", &ArcType) == -1)			return;
 	if (add_type(m, "Box", &BoxType) == -1)			return;
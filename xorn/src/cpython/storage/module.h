@@ -23,6 +23,7 @@
 extern PyTypeObject RevisionType;
 extern PyTypeObject ObjectType;
 extern PyTypeObject SelectionType;
+extern PyTypeObject ConnectivityType;
 
 PyObject *build_object(xorn_object_t ob);
 PyObject *build_selection(xorn_selection_t sel);
@@ -42,4 +43,9 @@ typedef struct {
 	xorn_selection_t sel;
 } Selection;
 
+typedef struct {
+	PyObject_HEAD
+	xorn_connectivity_t conn;
+} Connectivity;
+
 #endif
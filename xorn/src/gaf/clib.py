@@ -49,7 +49,8 @@
 # get_symbol.  If the source of a symbol isn't known, the symbol data
 # may be requested using the convenience function \ref lookup_symbol.
 
-import collections, fnmatch, os, shlex, stat, subprocess, sys
+import collections, fnmatch, hashlib, os, shlex, stat, struct, subprocess
+import sys
 from gettext import gettext as _
 import gaf.read
 import gaf.ref
@@ -105,6 +106,69 @@ class DuplicateError(Exception):
     pass
 
 
+## Summary of a symbol file as stored in a library index.
+#
+# \a pin_count is the number of pins of the symbol (or \c -1 if the
+# file couldn't be read), and \a attribs is a list of the symbol's
+# floating attributes as \c "name=value" strings.
+
+Summary = collections.namedtuple(
+    'Summary', ['mtime', 'size', 'pin_count', 'attribs'])
+
+## Return the path of the index file of a library directory.
+#
+# libgeda keeps an index of each directory source in the user's cache
+# directory (see libgeda/src/s_clib_index.c for the format).
+
+def index_filename(directory):
+    cache_dir = os.environ.get('XDG_CACHE_HOME')
+    if not cache_dir:
+        cache_dir = os.path.join(os.path.expanduser('~'), '.cache')
+    return os.path.join(cache_dir, 'gEDA', 'clib',
+                        hashlib.sha1(directory).hexdigest() + '.idx')
+
+## Read the index of a library directory.
+#
+# Returns a list of pairs <tt>(name, summary)</tt> for the symbol files
+# in \a directory, or \c None if there is no index for the directory
+# or if the directory has been modified since the index was written.
+
+def read_index(directory):
+    try:
+        with open(index_filename(directory), 'rb') as f:
+            data = f.read()
+        mtime = int(os.stat(directory).st_mtime)
+    except (IOError, OSError):
+        return None
+
+    try:
+        magic, version, count, index_mtime = \
+            struct.unpack_from('<8sIIq', data, 0)
+        if magic != 'GAFCLIB\n' or version != 1 \
+               or index_mtime == 0 or index_mtime != mtime:
+            return None
+
+        result = []
+        pos = struct.calcsize('<8sIIq')
+        for i in xrange(count):
+            length, = struct.unpack_from('<I', data, pos)
+            record = data[pos + 4:pos + 4 + length]
+            if len(record) != length:
+                return None
+            pos += 4 + length
+
+            file_mtime, file_size, pin_count, n_attribs = \
+                struct.unpack_from('<qqiI', record, 0)
+            strings = record[struct.calcsize('<qqiI'):].split('\0')
+            if len(strings) < n_attribs + 2:
+                return None
+            result.append((strings[0], Summary(
+                file_mtime, file_size, pin_count,
+                strings[1:n_attribs + 1])))
+        return result
+    except struct.error:
+        return None
+
 ## Source object representing a directory of symbol files.
 #
 # This class allows a directory which contains one or more symbol
@@ -124,6 +188,13 @@ class DirectorySource:
 
     def list(self):
         if not self.recursive:
+            # use the library index written by libgeda if it is up
+            # to date (it only lists regular files)
+            index = read_index(self.directory)
+            if index is not None:
+                return (name for name, summary in index
+                        if sym_filename_filter(name))
+
             # skip subdirectories and anything else that isn't a
             # regular file (this is what libgeda does)
             entries = (entry for entry in os.listdir(self.directory)
@@ -135,12 +135,28 @@ class ComponentPin:
         if blueprint.number is not None:
             component.cpins_by_number[blueprint.number] = self
 
-class LocalNet:
+class LocalNet(object):
     def __init__(self, sheet, blueprint):
         self.sheet = sheet
         self.blueprint = blueprint
         self.cpins = []
-        self.net = None
+        self._net = None
 
         sheet.local_nets.append(self)
         sheet.local_nets_by_blueprint[blueprint] = self
+
+    ## The net this local net belongs to.
+    #
+    # Nets which have been merged into another net keep pointing to
+    # it, so look up the net which currently represents them.
+
+    @property
+    def net(self):
+        if self._net is None:
+            return None
+        self._net = self._net.find()
+        return self._net
+
+    @net.setter
+    def net(self, net):
+        self._net = net
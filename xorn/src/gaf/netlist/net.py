@@ -23,11 +23,19 @@
 import sys
 from gettext import gettext as _
 
-class Net:
+class Net(object):
     def __init__(self, netlist):
         self.netlist = netlist
         self.local_nets = []
         self.names = { False: [], True: [] }
+        self.name_sets = { False: set(), True: set() }
+
+        ## Net this net has been merged into, or \c None.
+        #
+        # The nets form a disjoint-set forest; use \ref find to get
+        # the net which currently represents this one.
+        self.parent = None
+
         self.namespace = None
         self.unmangled_name = None
         self.name = None  # set by netlist ctor
@@ -66,29 +74,54 @@ class Net:
                 pass
         return l
 
+    ## Return the net which currently represents this net.
+    #
+    # Follows the \ref parent links up to the net which hasn't been
+    # merged into another one and points all nets on the way directly
+    # to it, so later lookups take constant time.
+
+    def find(self):
+        root = self
+        while root.parent is not None:
+            root = root.parent
+        net = self
+        while net.parent is not None and net.parent is not root:
+            net.parent, net = root, net.parent
+        return root
+
+    def add_name(self, name, from_netattrib):
+        if name not in self.name_sets[from_netattrib]:
+            self.names[from_netattrib].append(name)
+            self.name_sets[from_netattrib].add(name)
+
+    ## Merge this net into \a other.
+    #
+    # The local nets of this net aren't touched; they find their new
+    # net via \ref find.  This net stays in \c netlist.nets until the
+    # caller removes all merged nets (those with a \ref parent) at
+    # once.
+
     def merge_into(self, other):
         if not isinstance(other, Net):
             raise ValueError
         if other.netlist != self.netlist:
             raise ValueError
-        if other == self:
+        if other == self or self.parent is not None \
+                         or other.parent is not None:
             raise ValueError
 
-        for local_net in self.local_nets:
-            assert local_net.net == self
-            local_net.net = other
+        self.parent = other
 
         other.local_nets += self.local_nets
         for from_netattrib in [False, True]:
             for name in self.names[from_netattrib]:
-                if name not in other.names[from_netattrib]:
-                    other.names[from_netattrib].append(name)
+                other.add_name(name, from_netattrib)
 
         del self.local_nets[:]
         del self.names[False][:]
         del self.names[True][:]
-
-        self.netlist.nets.remove(self)
+        self.name_sets[False].clear()
+        self.name_sets[True].clear()
 
     def error(self, msg):
         sys.stderr.write(_("net `%s': error: %s\n") % (self.name, msg))
@@ -101,6 +134,7 @@ def postproc_instances(netlist, flat_namespace, prefer_netname_attribute,
                                 default_net_name, default_bus_name):
     netlist.nets = []
     net_dict = {}
+    net_order = {}
 
     # Naming nets
     for sheet in netlist.sheets:
@@ -124,11 +158,11 @@ def postproc_instances(netlist, flat_namespace, prefer_netname_attribute,
                     net = net_dict[net_name]
                 except KeyError:
                     net = Net(netlist)
+                    net_order[net] = len(netlist.nets)
                     netlist.nets.append(net)
                     net_dict[net_name] = net
 
-                if net_name not in net.names[from_netattrib]:
-                    net.names[from_netattrib].append(net_name)
+                net.add_name(net_name, from_netattrib)
 
                 if local_net.net == net:
                     continue
@@ -137,17 +171,18 @@ def postproc_instances(netlist, flat_namespace, prefer_netname_attribute,
                     local_net.net = net
                     net.local_nets.append(local_net)
                 else:
-                    a = netlist.nets.index(local_net.net)
-                    b = netlist.nets.index(net)
-                    dst = netlist.nets[min(a, b)]
-                    src = netlist.nets[max(a, b)]
+                    # keep the net which has been created first
+                    dst, src = sorted([local_net.net, net],
+                                      key = net_order.__getitem__)
 
                     for name in set(src.names[False] + src.names[True]):
                         assert net_dict[name] == src
                         net_dict[name] = dst
 
                     src.merge_into(dst)
-                    assert local_net in dst.local_nets
+                    assert local_net.net == dst
+
+    netlist.nets = [net for net in netlist.nets if net.parent is None]
 
     # prioritize net names
     prio = not prefer_netname_attribute
@@ -302,14 +302,19 @@ class Netlist:
                 net.unmangled_name, net.namespace)
 
         # assign component pins
+        sheets_and_net_blueprints = set()
         for component in self.components:
             for cpin in component.cpins:
-                if (component.sheet, cpin.blueprint.net) \
-                       not in cpin.local_net.net.sheets_and_net_blueprints:
-                    cpin.local_net.net.sheets_and_net_blueprints.append(
+                net = cpin.local_net.net
+                if (net, component.sheet, cpin.blueprint.net) \
+                       not in sheets_and_net_blueprints:
+                    sheets_and_net_blueprints.add(
+                        (net, component.sheet, cpin.blueprint.net))
+                    net.sheets_and_net_blueprints.append(
                         (component.sheet, cpin.blueprint.net))
 
         for net in self.nets:
+            component_pins = set()
             for sheet, net_blueprint in net.sheets_and_net_blueprints:
                 for cpin_blueprint in net_blueprint.pins:
                     if cpin_blueprint.ob is not None:
@@ -319,7 +324,8 @@ class Netlist:
                         .components_by_blueprint[cpin_blueprint.component] \
                         .cpins_by_blueprint[cpin_blueprint]
 
-                    assert cpin not in net.component_pins
+                    assert cpin not in component_pins
+                    component_pins.add(cpin)
                     net.component_pins.append(cpin)
 
         # Resolve hierarchy
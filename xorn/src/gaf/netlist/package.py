@@ -322,6 +322,7 @@ def postproc_instances(netlist, flat_namespace):
         # of individual pins on each, adding net names to the list
         # being careful to ignore duplicates, and unconnected pins
         net.connections = []
+        connections = set()
 
         # add the net name to the list
         for cpin in net.component_pins:
@@ -333,5 +334,6 @@ def postproc_instances(netlist, flat_namespace):
                 namespace = cpin.component.sheet.namespace
             ppin = pkg_dict[namespace, cpin.component.blueprint.refdes] \
                      .pins_by_number[cpin.blueprint.number]
-            if ppin not in net.connections:
+            if ppin not in connections:
                 net.connections.append(ppin)
+                connections.add(ppin)
@@ -61,9 +61,14 @@ def postproc_blueprints(netlist):
 # they have been replaced with the actual subschematics.
 #
 # remove all composite components and ports
+#
+# Removing items from the lists of components and pins one at a time
+# would take time proportional to the size of the design for each of
+# them, so they are collected and filtered out once at the end.
 
 def postproc_instances(netlist):
     remove_components = set()
+    remove_cpins = set()
 
     for component in netlist.components:
         if not component.blueprint.composite_sources:
@@ -82,8 +87,7 @@ def postproc_instances(netlist):
         processed_labels = set()
         for cpin in component.cpins:
             dest_net = cpin.local_net.net
-            cpin.local_net.cpins.remove(cpin)
-            dest_net.component_pins.remove(cpin)
+            remove_cpins.add(cpin)
 
             label = cpin.blueprint.get_attribute('pinlabel', None)
             if label is None:
@@ -140,19 +144,26 @@ def postproc_instances(netlist):
 
                 # remove port component
                 remove_components.add(port)
-                port.sheet.components.remove(port)
                 del port.sheet.components_by_blueprint[port.blueprint]
-
-                port.cpins[0].local_net.cpins.remove(port.cpins[0])
-                dest_net.component_pins.remove(port.cpins[0])
+                remove_cpins.add(port.cpins[0])
 
         # After all pins have been connected, remove the component.
         remove_components.add(component)
-        component.sheet.components.remove(component)
         del component.sheet.components_by_blueprint[component.blueprint]
 
     netlist.components = [component for component in netlist.components
                           if component not in remove_components]
+    netlist.nets = [net for net in netlist.nets if net.parent is None]
+
+    for sheet in netlist.sheets:
+        sheet.components[:] = [component for component in sheet.components
+                               if component not in remove_components]
+        for local_net in sheet.local_nets:
+            local_net.cpins[:] = [cpin for cpin in local_net.cpins
+                                  if cpin not in remove_cpins]
+    for net in netlist.nets:
+        net.component_pins[:] = [cpin for cpin in net.component_pins
+                                 if cpin not in remove_cpins]
 
     for component in netlist.components:
         if component.blueprint.has_portname_attrib:
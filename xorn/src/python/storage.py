@@ -322,6 +322,89 @@ class Object:
 class Selection:
     pass
 
+## The geometrical connections between net segments.
+#
+# Keeps track of the net objects in a revision and of additional
+# segments supplied by the caller (e.g., the nets and pins inside
+# symbols), and of where the ends of these segments touch each other.
+# Moving to another revision only examines the objects which have
+# changed.
+#
+# Each segment is identified by a group and an object.  Group \c 0
+# contains the net objects of the revision; segments in the same
+# other group are considered to be inside the same symbol.
+
+class Connectivity:
+    ## Create an empty connectivity object.
+    #
+    # \throw MemoryError if there is not enough memory
+
+    def __init__(self):
+        pass
+
+    ## Update the net segments of group \c 0 to a revision.
+    #
+    # Removes the net objects which have been changed or deleted
+    # since the last call and adds those which have been changed or
+    # added.  Their connections aren't searched for until \ref update
+    # is called.
+    #
+    # \throw ValueError  if \a rev is transient
+    # \throw MemoryError if there is not enough memory
+    #
+    # \return \c None
+
+    def goto(self, rev):
+        pass
+
+    ## Add a net segment which isn't part of the revision.
+    #
+    # \a data must be an instance of Net with absolute coordinates.
+    # Only pins can connect to segments in other groups.
+    #
+    # \throw ValueError  if \a group isn't positive or there already
+    #                    is a segment for \a ob in \a group
+    # \throw MemoryError if there is not enough memory
+    #
+    # \return \c None
+
+    def add_segment(self, group, ob, data):
+        pass
+
+    ## Remove a net segment and all its connections.
+    #
+    # \throw KeyError if there is no such segment
+    #
+    # \return \c None
+
+    def remove_segment(self, group, ob):
+        pass
+
+    ## Find the connections of the segments added since the last
+    ## update.
+    #
+    # \throw MemoryError if there is not enough memory
+    #
+    # \return \c None
+
+    def update(self):
+        pass
+
+    ## Return the connections of a net segment.
+    #
+    # \return a list of tuples <tt>(x, y, type, whichend0, group1,
+    #         ob1, whichend1)</tt> in the order in which they were
+    #         found, where \c type is \c 0 for a connection between
+    #         two ends and \c 1 for a connection to the middle of
+    #         segment 1, and \c whichend0 and \c whichend1 are the
+    #         indexes of the connected ends or \c -1
+    #
+    # \throw KeyError    if there is no such segment
+    # \throw MemoryError if there is not enough memory
+
+    def get_connections(self, group, ob):
+        pass
+
 ## Return a list of objects in a revision which are attached to a
 ## certain object.
 #
@@ -377,6 +460,21 @@ def get_removed_objects(from, to):
 def get_modified_objects(from, to):
     pass
 
+## Return the objects which have been added, removed, or modified
+## between two revisions.
+#
+# Returns a tuple <tt>(added, removed, modified)</tt> of lists which
+# are the same as the results of \ref get_added_objects, \ref
+# get_removed_objects, and \ref get_modified_objects, respectively.
+# Parts of the revisions which are shared because one revision has
+# been copied from the other are skipped, so this is much faster than
+# calling the three functions if only a few objects have changed.
+#
+# \throw MemoryError if there is not enough memory
+
+def get_changes(from, to):
+    pass
+
 ## Return an empty selection.
 #
 # \throw MemoryError if there is not enough memory
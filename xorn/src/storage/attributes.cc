@@ -452,8 +452,7 @@ template<typename Attr> static void get_attr(
     typename Attr::basic_type result;
     clear(result);
 
-    std::map<xorn_object_t, obstate *>::const_iterator i
-	= rev->obstates.begin();
+    obstate_map::const_iterator i = rev->obstates.begin();
     std::set<xorn_object_t>::const_iterator j = sel->begin();
 
     while (i != rev->obstates.end() && j != sel->end())
@@ -519,21 +518,10 @@ template<typename Attr> static int set_attr(
 	return -1;
     }
 
-    std::map<xorn_object_t, obstate *> new_obstates;
-    try {
-	new_obstates = rev->obstates;
-    } catch (std::bad_alloc const &) {
-	if (err != NULL)
-	    *err = xorn_error_out_of_memory;
-	return -1;
-    }
-    for (std::map<xorn_object_t, obstate *>::const_iterator i
-	     = new_obstates.begin(); i != new_obstates.end(); ++i)
-	i->second->inc_refcnt();
+    obstate_map new_obstates = rev->obstates;
 
     try {
-	std::map<xorn_object_t, obstate *>::const_iterator i
-	    = rev->obstates.begin();
+	obstate_map::const_iterator i = rev->obstates.begin();
 	std::set<xorn_object_t>::const_iterator j = sel->begin();
 
 	while (i != rev->obstates.end() && j != sel->end())
@@ -578,14 +566,12 @@ template<typename Attr> static int set_attr(
 		try {
 		    obstate *tmp = new obstate(type, data);
 		    try {
-			obstate *&p = new_obstates[ob];
-			if (p != NULL)
-			    p->dec_refcnt();
-			p = tmp;
+			new_obstates.set(ob, tmp);
 		    } catch (std::bad_alloc const &) {
 			tmp->dec_refcnt();
 			throw;
 		    }
+		    tmp->dec_refcnt();
 		} catch (std::bad_alloc const &) {
 		    free(data);
 		    throw;
@@ -593,20 +579,11 @@ template<typename Attr> static int set_attr(
 		free(data);
 	    }
     } catch (std::bad_alloc const &) {
-	for (std::map<xorn_object_t, obstate *>::const_iterator
-		 i = new_obstates.begin();
-	     i != new_obstates.end(); ++i)
-	    i->second->dec_refcnt();
 	if (err != NULL)
 	    *err = xorn_error_out_of_memory;
 	return -1;
     }
 
-    for (std::map<xorn_object_t, obstate *>::const_iterator
-	     i = rev->obstates.begin();
-	 i != rev->obstates.end(); ++i)
-	i->second->dec_refcnt();
-
     rev->obstates = new_obstates;
     return 0;
 }
@@ -622,8 +599,7 @@ template<typename Attr> static xorn_selection_t select_by_attr(
     }
 
     try {
-	for (std::map<xorn_object_t, obstate *>::const_iterator
-		 i = rev->obstates.begin();
+	for (obstate_map::const_iterator i = rev->obstates.begin();
 	     i != rev->obstates.end(); ++i) {
 	    typename Attr::basic_type v;
 	    clear(v);
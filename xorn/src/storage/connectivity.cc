@@ -0,0 +1,617 @@
+/* Copyright (C) 2013-2020 Roland Lutz
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+#include "internal.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+/* A connectivity object keeps track of the geometrical connections
+   between net segments.  Each segment is identified by a group and
+   an object: group 0 contains the net objects of the revision passed
+   to xorn_connectivity_goto, other groups are used by the caller for
+   net objects inside symbols.
+
+   Segments are indexed by their endpoints and, if they are
+   horizontal or vertical, by the line they are on.  All index lists
+   keep the order in which the segments were added, so connections
+   are found in a predictable order.  */
+
+namespace {
+
+struct segment {
+	size_t group;
+	xorn_object_t ob;
+	double x[2], y[2];
+	bool is_bus;
+	bool is_pin;
+	bool pending;
+	std::vector<xorn_connection> connections;
+};
+
+typedef std::pair<size_t, xorn_object_t> segment_key;
+typedef std::vector<segment *> segment_list;
+
+}
+
+struct xorn_connectivity {
+	~xorn_connectivity();
+
+	/* object states of the revision last passed to goto */
+	obstate_map obstates;
+
+	std::map<segment_key, segment *> segments;
+	std::map<std::pair<double, double>, segment_list> by_endpoint;
+	std::map<double, segment_list> by_endpoint_x;
+	std::map<double, segment_list> by_endpoint_y;
+	std::map<double, segment_list> horizontal;
+	std::map<double, segment_list> vertical;
+
+	/* segments added since the last update */
+	segment_list pending;
+};
+
+xorn_connectivity::~xorn_connectivity()
+{
+	for (std::map<segment_key, segment *>::const_iterator i =
+		     segments.begin(); i != segments.end(); ++i)
+		delete i->second;
+}
+
+template<typename K> static void add_to_index(
+	std::map<K, segment_list> &m, K const &key, segment *s)
+{
+	segment_list &l = m[key];
+	/* both ends of a segment may be on the same key */
+	if (l.empty() || l.back() != s)
+		l.push_back(s);
+}
+
+template<typename K> static void remove_from_index(
+	std::map<K, segment_list> &m, K const &key, segment *s)
+{
+	typename std::map<K, segment_list>::iterator i = m.find(key);
+	if (i == m.end())
+		return;
+	i->second.erase(std::remove(i->second.begin(), i->second.end(), s),
+			i->second.end());
+	if (i->second.empty())
+		m.erase(i);
+}
+
+static void index_segment(xorn_connectivity_t conn, segment *s)
+{
+	add_to_index(conn->by_endpoint,
+		std::make_pair(s->x[0], s->y[0]), s);
+	add_to_index(conn->by_endpoint_x, s->x[0], s);
+	add_to_index(conn->by_endpoint_y, s->y[0], s);
+	if (s->is_pin)
+		return;
+	add_to_index(conn->by_endpoint,
+		std::make_pair(s->x[1], s->y[1]), s);
+	add_to_index(conn->by_endpoint_x, s->x[1], s);
+	add_to_index(conn->by_endpoint_y, s->y[1], s);
+	if (s->x[0] == s->x[1])
+		add_to_index(conn->vertical, s->x[0], s);
+	if (s->y[0] == s->y[1])
+		add_to_index(conn->horizontal, s->y[0], s);
+}
+
+static void unindex_segment(xorn_connectivity_t conn, segment *s)
+{
+	remove_from_index(conn->by_endpoint,
+		std::make_pair(s->x[0], s->y[0]), s);
+	remove_from_index(conn->by_endpoint_x, s->x[0], s);
+	remove_from_index(conn->by_endpoint_y, s->y[0], s);
+	if (s->is_pin)
+		return;
+	remove_from_index(conn->by_endpoint,
+		std::make_pair(s->x[1], s->y[1]), s);
+	remove_from_index(conn->by_endpoint_x, s->x[1], s);
+	remove_from_index(conn->by_endpoint_y, s->y[1], s);
+	if (s->x[0] == s->x[1])
+		remove_from_index(conn->vertical, s->x[0], s);
+	if (s->y[0] == s->y[1])
+		remove_from_index(conn->horizontal, s->y[0], s);
+}
+
+static bool same_connection(xorn_connection const &a,
+			    xorn_connection const &b)
+{
+	return a.pos.x == b.pos.x && a.pos.y == b.pos.y &&
+	       a.type == b.type && a.whichend0 == b.whichend0 &&
+	       a.group1 == b.group1 && a.ob1 == b.ob1 &&
+	       a.whichend1 == b.whichend1;
+}
+
+static void add_connection(segment *s, xorn_connection const &c)
+{
+	for (std::vector<xorn_connection>::const_iterator i =
+		     s->connections.begin(); i != s->connections.end(); ++i)
+		if (same_connection(*i, c))
+			return;
+	s->connections.push_back(c);
+}
+
+static void remove_connection(segment *s, xorn_connection const &c)
+{
+	for (std::vector<xorn_connection>::iterator i =
+		     s->connections.begin(); i != s->connections.end(); ++i)
+		if (same_connection(*i, c)) {
+			s->connections.erase(i);
+			return;
+		}
+}
+
+/* Record a connection between s0 and s1 in both segments.  */
+
+static void connect(segment *s0, int w0, segment *s1, int w1,
+		    double x, double y, xorn_conntype_t type)
+{
+	xorn_connection c;
+	c.pos.x = x;
+	c.pos.y = y;
+	c.type = type;
+
+	c.whichend0 = w0;
+	c.group1 = s1->group;
+	c.ob1 = s1->ob;
+	c.whichend1 = w1;
+	add_connection(s0, c);
+
+	c.whichend0 = w1;
+	c.group1 = s0->group;
+	c.ob1 = s0->ob;
+	c.whichend1 = w0;
+	add_connection(s1, c);
+}
+
+/* A segment inside a symbol can only be connected to another segment
+   if they are both inside the same symbol or if it is a pin.  */
+
+static bool can_connect(segment const *s0, segment const *s1)
+{
+	if (s0->group != 0 && s1->group != 0)
+		return (s0->group == s1->group || s0->is_pin) && s1->is_pin;
+	if (s0->group != 0)
+		return s0->is_pin;
+	if (s1->group != 0)
+		return s1->is_pin;
+	return true;
+}
+
+/* Return whether (x, y) is on an orthogonal segment but isn't one of
+   its endpoints.  */
+
+static bool check_midpoint(segment const *s, double x, double y)
+{
+	return (s->x[0] == x && s->x[1] == x &&
+		y > std::min(s->y[0], s->y[1]) &&
+		y < std::max(s->y[0], s->y[1])) ||
+	       (s->y[0] == y && s->y[1] == y &&
+		x > std::min(s->x[0], s->x[1]) &&
+		x < std::max(s->x[0], s->x[1]));
+}
+
+template<typename K> static segment_list const *lookup(
+	std::map<K, segment_list> const &m, K const &key)
+{
+	typename std::map<K, segment_list>::const_iterator i = m.find(key);
+	return i == m.end() ? NULL : &i->second;
+}
+
+/* Connect the ends of s0 to coinciding ends of s1.  Pins only
+   connect at their first end.  */
+
+static void connect_ends(segment *s0, segment *s1)
+{
+	int ends0 = s0->is_pin ? 1 : 2;
+	int ends1 = s1->is_pin ? 1 : 2;
+
+	if (s0->is_bus != s1->is_bus)
+		return;
+
+	for (int w1 = 0; w1 < ends1; w1++)
+		for (int w0 = 0; w0 < ends0; w0++)
+			if (s0->x[w0] == s1->x[w1] && s0->y[w0] == s1->y[w1])
+				connect(s0, w0, s1, w1, s0->x[w0], s0->y[w0],
+					xorn_conntype_endpoint);
+}
+
+/* Connect the ends of s0 to the middle of s1.  Pins can't be
+   connected to in their middle, but nets can be connected to the
+   middle of buses.  */
+
+static void connect_middle(segment *s0, segment *s1)
+{
+	int ends0 = s0->is_pin ? 1 : 2;
+
+	if (s1->is_pin || (s0->is_bus != s1->is_bus &&
+			   (s0->is_pin || s0->is_bus || !s1->is_bus)))
+		return;
+
+	for (int w0 = 0; w0 < ends0; w0++)
+		if (check_midpoint(s1, s0->x[w0], s0->y[w0]))
+			connect(s0, w0, s1, -1, s0->x[w0], s0->y[w0],
+				xorn_conntype_midpoint);
+}
+
+/* Find all connections of the ends of s0 to other segments.  */
+
+static void scan_segment(xorn_connectivity_t conn, segment *s0)
+{
+	int ends0 = s0->is_pin ? 1 : 2;
+
+	for (int end = 0; end < ends0; end++) {
+		segment_list const *l = lookup(
+			conn->by_endpoint,
+			std::make_pair(s0->x[end], s0->y[end]));
+		if (l == NULL)
+			continue;
+
+		for (segment_list::const_iterator i = l->begin();
+		     i != l->end(); ++i)
+			if ((*i)->ob != s0->ob && can_connect(s0, *i))
+				connect_ends(s0, *i);
+	}
+
+	for (int end = 0; end < ends0; end++) {
+		segment_list const *lists[2] = {
+			lookup(conn->vertical, s0->x[end]),
+			lookup(conn->horizontal, s0->y[end])
+		};
+
+		for (int j = 0; j < 2; j++) {
+			if (lists[j] == NULL)
+				continue;
+
+			for (segment_list::const_iterator i =
+				     lists[j]->begin();
+			     i != lists[j]->end(); ++i)
+				if ((*i)->ob != s0->ob && can_connect(s0, *i))
+					connect_middle(s0, *i);
+		}
+	}
+}
+
+/* Add the segments in l which aren't pending and end in the middle
+   of s to the list of segments to scan.  */
+
+static void add_neighbors(segment const *s, segment_list const *l,
+			  segment_list &scan)
+{
+	if (l == NULL)
+		return;
+
+	for (segment_list::const_iterator i = l->begin(); i != l->end(); ++i)
+		if (!(*i)->pending &&
+		    (check_midpoint(s, (*i)->x[0], (*i)->y[0]) ||
+		     check_midpoint(s, (*i)->x[1], (*i)->y[1]))) {
+			(*i)->pending = true;
+			scan.push_back(*i);
+		}
+}
+
+static void add_segment(xorn_connectivity_t conn, size_t group,
+			xorn_object_t ob, struct xornsch_net const *data)
+{
+	segment *s = new segment;
+	s->group = group;
+	s->ob = ob;
+	s->x[0] = data->pos.x;
+	s->y[0] = data->pos.y;
+	s->x[1] = data->pos.x + data->size.x;
+	s->y[1] = data->pos.y + data->size.y;
+	s->is_bus = data->is_bus;
+	s->is_pin = data->is_pin;
+	s->pending = true;
+
+	try {
+		conn->segments[segment_key(group, ob)] = s;
+		conn->pending.push_back(s);
+		index_segment(conn, s);
+	} catch (std::bad_alloc const &) {
+		unindex_segment(conn, s);
+		conn->pending.erase(std::remove(conn->pending.begin(),
+						conn->pending.end(), s),
+				    conn->pending.end());
+		conn->segments.erase(segment_key(group, ob));
+		delete s;
+		throw;
+	}
+}
+
+static void remove_segment(xorn_connectivity_t conn, segment *s)
+{
+	for (std::vector<xorn_connection>::const_iterator i =
+		     s->connections.begin(); i != s->connections.end(); ++i) {
+		std::map<segment_key, segment *>::const_iterator j =
+			conn->segments.find(segment_key(i->group1, i->ob1));
+		if (j == conn->segments.end())
+			continue;
+
+		xorn_connection c = *i;
+		c.whichend0 = i->whichend1;
+		c.group1 = s->group;
+		c.ob1 = s->ob;
+		c.whichend1 = i->whichend0;
+		remove_connection(j->second, c);
+	}
+
+	unindex_segment(conn, s);
+	if (s->pending)
+		conn->pending.erase(std::remove(conn->pending.begin(),
+						conn->pending.end(), s),
+				    conn->pending.end());
+	conn->segments.erase(segment_key(s->group, s->ob));
+	delete s;
+}
+
+
+/** \brief Create an empty connectivity object.
+ *
+ * You should free the object using \ref xorn_free_connectivity once
+ * it isn't used any more.
+ *
+ * \return Returns the new connectivity object, or \c NULL if there is
+ *         not enough memory.  */
+
+xorn_connectivity_t xorn_new_connectivity(void)
+{
+	try {
+		return new xorn_connectivity();
+	} catch (std::bad_alloc const &) {
+		return NULL;
+	}
+}
+
+/** \brief Free the memory associated with a connectivity object.  */
+
+void xorn_free_connectivity(xorn_connectivity_t conn)
+{
+	delete conn;
+}
+
+namespace {
+
+/* Collects the net objects which have changed between two revisions,
+   see pmap::diff.  */
+
+struct net_collector {
+	std::vector<xorn_object_t> removed_nets;
+	std::vector<obstate_map::value_type> added_nets;
+
+	void added(obstate_map::value_type const &entry) {
+		if (entry.second->type == xornsch_obtype_net)
+			added_nets.push_back(entry);
+	}
+	void removed(obstate_map::value_type const &entry) {
+		if (entry.second->type == xornsch_obtype_net)
+			removed_nets.push_back(entry.first);
+	}
+	void common(obstate_map::value_type const &old_entry,
+		    obstate_map::value_type const &new_entry) {
+		if (old_entry.second == new_entry.second)
+			return;
+		removed(old_entry);
+		added(new_entry);
+	}
+};
+
+}
+
+/** \brief Update the net segments of group 0 to a revision.
+ *
+ * Removes the net objects which have been changed or deleted since
+ * the last call and adds those which have been changed or added.
+ * Only the changes between the two revisions are examined, so if \a
+ * rev has been derived from the previous revision, the cost depends
+ * on the number of changes rather than on the size of the revision.
+ *
+ * The connections of the added segments aren't searched for until
+ * \ref xorn_connectivity_update is called.
+ *
+ * \return Returns \c 0 on success.  If \a rev is transient or there
+ * is not enough memory, returns \c -1 and writes \ref
+ * xorn_error_invalid_argument or \ref xorn_error_out_of_memory to \a
+ * *err.  In the latter case, the connectivity object should be freed
+ * since it may be in an inconsistent state.  */
+
+int xorn_connectivity_goto(xorn_connectivity_t conn, xorn_revision_t rev,
+			   xorn_error_t *err)
+{
+	if (rev->is_transient) {
+		if (err != NULL)
+			*err = xorn_error_invalid_argument;
+		return -1;
+	}
+
+	try {
+		net_collector collector;
+		conn->obstates.diff(rev->obstates, collector);
+
+		for (std::vector<xorn_object_t>::const_iterator i =
+			     collector.removed_nets.begin();
+		     i != collector.removed_nets.end(); ++i) {
+			std::map<segment_key, segment *>::const_iterator j =
+				conn->segments.find(segment_key(0, *i));
+			if (j != conn->segments.end())
+				remove_segment(conn, j->second);
+		}
+
+		for (std::vector<obstate_map::value_type>::const_iterator i =
+			     collector.added_nets.begin();
+		     i != collector.added_nets.end(); ++i)
+			add_segment(conn, 0, i->first,
+				    (struct xornsch_net const *)
+					    i->second->data);
+
+		conn->obstates = rev->obstates;
+	} catch (std::bad_alloc const &) {
+		if (err != NULL)
+			*err = xorn_error_out_of_memory;
+		return -1;
+	}
+	return 0;
+}
+
+/** \brief Add a net segment which isn't part of the revision.
+ *
+ * This is used for net objects inside symbols.  \a data must contain
+ * the absolute coordinates of the segment.  Segments in the same
+ * group \a group (which must not be \c 0) are considered to be inside
+ * the same symbol; only pins can connect to segments in other groups.
+ *
+ * The connections of the segment aren't searched for until \ref
+ * xorn_connectivity_update is called.
+ *
+ * \return Returns \c 0 on success.  If \a group is \c 0 or there
+ * already is a segment for \a ob in \a group, returns \c -1 and
+ * writes \ref xorn_error_invalid_argument to \a *err.  If there is
+ * not enough memory, returns \c -1 and writes \ref
+ * xorn_error_out_of_memory to \a *err.  */
+
+int xorn_connectivity_add_segment(xorn_connectivity_t conn,
+				  size_t group, xorn_object_t ob,
+				  struct xornsch_net const *data,
+				  xorn_error_t *err)
+{
+	if (group == 0 || conn->segments.count(segment_key(group, ob)) != 0) {
+		if (err != NULL)
+			*err = xorn_error_invalid_argument;
+		return -1;
+	}
+
+	try {
+		add_segment(conn, group, ob, data);
+	} catch (std::bad_alloc const &) {
+		if (err != NULL)
+			*err = xorn_error_out_of_memory;
+		return -1;
+	}
+	return 0;
+}
+
+/** \brief Remove a net segment and all its connections.
+ *
+ * This takes time in proportion to the number of connections of the
+ * segment and the number of segments ending at the same coordinates.
+ *
+ * \return Returns \c 0 on success.  If there is no such segment,
+ * returns \c -1 and writes \ref xorn_error_object_doesnt_exist to \a
+ * *err.  */
+
+int xorn_connectivity_remove_segment(xorn_connectivity_t conn,
+				     size_t group, xorn_object_t ob,
+				     xorn_error_t *err)
+{
+	std::map<segment_key, segment *>::const_iterator i =
+		conn->segments.find(segment_key(group, ob));
+	if (i == conn->segments.end()) {
+		if (err != NULL)
+			*err = xorn_error_object_doesnt_exist;
+		return -1;
+	}
+
+	remove_segment(conn, i->second);
+	return 0;
+}
+
+/** \brief Find the connections of the segments added since the last
+ *         update.
+ *
+ * A segment which hasn't been changed may end in the middle of an
+ * added segment.  This connection can only be found by looking at the
+ * unchanged segment, so these segments are examined again, too.
+ *
+ * \return Returns \c 0 on success.  If there is not enough memory,
+ * returns \c -1 and writes \ref xorn_error_out_of_memory to \a *err.
+ * In this case, the connectivity object should be freed since it may
+ * be in an inconsistent state.  */
+
+int xorn_connectivity_update(xorn_connectivity_t conn, xorn_error_t *err)
+{
+	try {
+		segment_list scan = conn->pending;
+
+		for (segment_list::const_iterator i = conn->pending.begin();
+		     i != conn->pending.end(); ++i) {
+			segment const *s = *i;
+			if (s->x[0] == s->x[1])
+				add_neighbors(s, lookup(conn->by_endpoint_x,
+							s->x[0]), scan);
+			if (s->y[0] == s->y[1])
+				add_neighbors(s, lookup(conn->by_endpoint_y,
+							s->y[0]), scan);
+		}
+
+		for (segment_list::const_iterator i = scan.begin();
+		     i != scan.end(); ++i)
+			scan_segment(conn, *i);
+		for (segment_list::const_iterator i = scan.begin();
+		     i != scan.end(); ++i)
+			(*i)->pending = false;
+		conn->pending.clear();
+	} catch (std::bad_alloc const &) {
+		if (err != NULL)
+			*err = xorn_error_out_of_memory;
+		return -1;
+	}
+	return 0;
+}
+
+/** \brief Return the connections of a net segment.
+ *
+ * A list of \ref xorn_connection structures is allocated and written
+ * to, and its location is written to the variable pointed to by \a
+ * connections_return.  The number of connections is written to the
+ * variable pointed to by \a count_return.  If the list is empty,
+ * \a *connections_return may be set to \c NULL.
+ *
+ * Each connection is listed in the order in which it was found.  The
+ * segment itself is referred to as "0", the segment it is connected
+ * to as "1"; \c whichend0 and \c whichend1 are the indexes of the
+ * connected ends, or \c -1 for a connection to the middle of a
+ * segment.
+ *
+ * \return Returns \c 0 on success and \c -1 if there is no such
+ *         segment or not enough memory.
+ *
+ * \note You should free the returned list using \c free(3).  */
+
+int xorn_get_connections(
+	xorn_connectivity_t conn, size_t group, xorn_object_t ob,
+	struct xorn_connection **connections_return, size_t *count_return)
+{
+	std::map<segment_key, segment *>::const_iterator i =
+		conn->segments.find(segment_key(group, ob));
+	if (i == conn->segments.end())
+		return -1;
+
+	std::vector<xorn_connection> const &connections =
+		i->second->connections;
+	*connections_return = (struct xorn_connection *) malloc(
+		connections.size() * sizeof(struct xorn_connection));
+	*count_return = 0;
+	if (*connections_return == NULL && !connections.empty())
+		return -1;
+
+	std::copy(connections.begin(), connections.end(),
+		  *connections_return);
+	*count_return = connections.size();
+	return 0;
+}
@@ -18,9 +18,9 @@
 #define INTERNAL_H
 
 #include <xornstorage.h>
-#include <map>
-#include <vector>
+#include <stdint.h>
 #include <set>
+#include "pmap.h"
 
 bool data_is_valid(xorn_obtype_t type, void const *data);
 
@@ -37,14 +37,36 @@ public:
 	void *const data;
 };
 
+template<> struct pmap_value_traits<obstate *> {
+	static void retain(obstate *p) {
+		p->inc_refcnt();
+	}
+	static void release(obstate *p) {
+		p->dec_refcnt();
+	}
+};
+
+/* The children of an object are ordered by a sort key which is
+   assigned when the child is added and stored with its location.  */
+
+typedef pmap<uint64_t, xorn_object_t> child_list;
+
+struct location {
+	xorn_object_t parent;
+	uint64_t key;
+};
+
+typedef pmap<xorn_object_t, obstate *> obstate_map;
+typedef pmap<xorn_object_t, child_list> children_map;
+typedef pmap<xorn_object_t, location> location_map;
+
 struct xorn_revision {
 	xorn_revision();
 	xorn_revision(xorn_revision_t rev);
-	~xorn_revision();
 	bool is_transient;
-	std::map<xorn_object_t, obstate *> obstates;
-	std::map<xorn_object_t, std::vector<xorn_object_t> > children;
-	std::map<xorn_object_t, xorn_object_t> parent;
+	obstate_map obstates;
+	children_map children;
+	location_map location;
 };
 
 /* There is no struct xorn_object. */
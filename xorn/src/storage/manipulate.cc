@@ -15,25 +15,154 @@
    Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
 
 #include "internal.h"
-#include <assert.h>
-#include <algorithm>
+#include <vector>
 
 static const char *next_object_id = NULL;
 
+/* Distance between the sort keys of children appended to the end of
+   the list.  Leaves room for inserting objects between them 32 times
+   before any of them have to be relabelled.  */
+
+static const uint64_t key_spacing = (uint64_t) 1 << 32;
+
+/* When there is no room left for a new sort key, the smallest aligned
+   range of 2^i keys around the insertion point with at most
+   (2/relabel_density)^i children is relabelled evenly.  This keeps
+   the number of relabelled children per insertion at O(log n),
+   amortized, even if objects are inserted at the same place over and
+   over again (M. A. Bender et al., "Two Simplified Algorithms for
+   Maintaining Order in a List", 2002).  */
+
+static const double relabel_density = 1.5;
+
+/* The functions below change a revision step by step and throw
+   std::bad_alloc if there is not enough memory.  Callers keep a copy
+   of the revision from before the change (which is cheap) and pass it
+   to restore() if the operation fails halfway.  */
+
+static void restore(xorn_revision_t rev, xorn_revision const &backup)
+{
+	rev->obstates = backup.obstates;
+	rev->children = backup.children;
+	rev->location = backup.location;
+}
 
 static void set_object_data(xorn_revision_t rev, xorn_object_t ob,
 			    xorn_obtype_t type, void const *data)
 {
 	obstate *tmp = new obstate(type, data);
 	try {
-		obstate *&p = rev->obstates[ob];
-		if (p != NULL)
-			p->dec_refcnt();
-		p = tmp;
+		rev->obstates.set(ob, tmp);
 	} catch (std::bad_alloc const &) {
 		tmp->dec_refcnt();
 		throw;
 	}
+	tmp->dec_refcnt();
+}
+
+/* Return the number of keys in \a children which are less than or
+   equal to \a key.  */
+
+static size_t rank_after(child_list const &children, uint64_t key)
+{
+	return key == UINT64_MAX ? children.size() : children.rank(key + 1);
+}
+
+/* Spread out the sort keys of the children of \a parent around \a key
+   so there is room for a new key next to each of them.  */
+
+static void relabel_children(xorn_revision_t rev, xorn_object_t parent,
+			     uint64_t key)
+{
+	child_list children = *rev->children.lookup(parent);
+	double capacity = 4. / (relabel_density * relabel_density);
+	uint64_t span, lo;
+	size_t first, count;
+
+	for (int bits = 2; ; bits++) {
+		span = bits == 64 ? UINT64_MAX
+				  : ((uint64_t) 1 << bits) - 1;
+		lo = key & ~span;
+		first = children.rank(lo);
+		count = rank_after(children, lo + span) - first;
+		if (bits == 64 || count + 1 <= capacity)
+			break;
+		capacity *= 2. / relabel_density;
+	}
+
+	uint64_t gap = span / (count + 1);
+	std::vector<xorn_object_t> obs;
+	obs.reserve(count);
+	for (size_t i = 0; i < count; i++)
+		obs.push_back(children.at(first + i).second);
+	for (size_t i = 0; i < count; i++)
+		children.erase(children.at(first).first);
+
+	for (size_t i = 0; i < count; i++) {
+		uint64_t new_key = lo + (i + 1) * gap;
+		children.set(new_key, obs[i]);
+		location loc = { parent, new_key };
+		rev->location.set(obs[i], loc);
+	}
+	rev->children.set(parent, children);
+}
+
+/* Return a sort key for a new child of \a parent which places it
+   before \a insert_before, or at the end if that is \c NULL.  */
+
+static uint64_t new_child_key(xorn_revision_t rev, xorn_object_t parent,
+			      xorn_object_t insert_before)
+{
+	for (;;) {
+		child_list const *children = rev->children.lookup(parent);
+		if (children == NULL || children->empty())
+			return key_spacing;
+
+		uint64_t key;
+		if (insert_before == NULL) {
+			key = children->at(children->size() - 1).first;
+			if (key <= UINT64_MAX - key_spacing)
+				return key + key_spacing;
+			if (UINT64_MAX - key >= 2)
+				return key + (UINT64_MAX - key) / 2;
+		} else {
+			key = rev->location.lookup(insert_before)->key;
+			size_t pos = children->rank(key);
+			uint64_t prev = pos == 0 ? 0
+						 : children->at(pos - 1).first;
+			if (key - prev >= 2)
+				return prev + (key - prev) / 2;
+		}
+
+		relabel_children(rev, parent, key);
+	}
+}
+
+static void insert_child(xorn_revision_t rev, xorn_object_t ob,
+			 xorn_object_t parent, xorn_object_t insert_before)
+{
+	uint64_t key = new_child_key(rev, parent, insert_before);
+	child_list const *p = rev->children.lookup(parent);
+	child_list children;
+	if (p != NULL)
+		children = *p;
+	children.set(key, ob);
+	rev->children.set(parent, children);
+
+	location loc = { parent, key };
+	rev->location.set(ob, loc);
+}
+
+static void remove_child(xorn_revision_t rev, xorn_object_t ob)
+{
+	location loc = *rev->location.lookup(ob);
+	child_list children = *rev->children.lookup(loc.parent);
+	children.erase(loc.key);
+	if (children.empty())
+		rev->children.erase(loc.parent);
+	else
+		rev->children.set(loc.parent, children);
+	rev->location.erase(ob);
 }
 
 /** \brief Add a new object to a transient revision.
@@ -102,26 +231,12 @@ xorn_object_t xorn_add_object(xorn_revision_t rev,
 	}
 
 	xorn_object_t ob = (xorn_object_t)++next_object_id;
+	xorn_revision backup(rev);
 	try {
-		rev->children[NULL].push_back(ob);
-	} catch (std::bad_alloc const &) {
-		if (err != NULL)
-			*err = xorn_error_out_of_memory;
-		return NULL;
-	}
-	try {
-		rev->parent[ob] = NULL;
-	} catch (std::bad_alloc const &) {
-		rev->children[NULL].pop_back();
-		if (err != NULL)
-			*err = xorn_error_out_of_memory;
-		return NULL;
-	}
-	try {
+		insert_child(rev, ob, NULL, NULL);
 		set_object_data(rev, ob, type, data);
 	} catch (std::bad_alloc const &) {
-		rev->parent.erase(rev->parent.find(ob));
-		rev->children[NULL].pop_back();
+		restore(rev, backup);
 		if (err != NULL)
 			*err = xorn_error_out_of_memory;
 		return NULL;
@@ -221,51 +336,29 @@ int xorn_set_object_data(xorn_revision_t rev, xorn_object_t ob,
 
 	if (type != xornsch_obtype_net &&
 	    type != xornsch_obtype_component) {
-		std::map<xorn_object_t,
-			 std::vector<xorn_object_t> >::const_iterator i
-			= rev->children.find(ob);
-		if (i != rev->children.end() && !i->second.empty()) {
+		child_list const *children = rev->children.lookup(ob);
+		if (children != NULL && !children->empty()) {
 			if (err != NULL)
 				*err = xorn_error_invalid_existing_child;
 			return -1;
 		}
 	}
 
-	std::map<xorn_object_t, xorn_object_t>::const_iterator i
-		= rev->parent.find(ob);
+	location const *loc = rev->location.lookup(ob);
 	if (type != xornsch_obtype_text &&
-	    i != rev->parent.end() && i->second != NULL) {
+	    loc != NULL && loc->parent != NULL) {
 		if (err != NULL)
 			*err = xorn_error_invalid_parent;
 		return -1;
 	}
 
-	bool add = i == rev->parent.end();
-	if (add) {
-		try {
-			rev->children[NULL].push_back(ob);
-		} catch (std::bad_alloc const &) {
-			if (err != NULL)
-				*err = xorn_error_out_of_memory;
-			return -1;
-		}
-		try {
-			rev->parent[ob] = NULL;
-		} catch (std::bad_alloc const &) {
-			rev->children[NULL].pop_back();
-			if (err != NULL)
-				*err = xorn_error_out_of_memory;
-			return -1;
-		}
-	}
-
+	xorn_revision backup(rev);
 	try {
+		if (loc == NULL)
+			insert_child(rev, ob, NULL, NULL);
 		set_object_data(rev, ob, type, data);
 	} catch (std::bad_alloc const &) {
-		if (add) {
-			rev->parent.erase(rev->parent.find(ob));
-			rev->children[NULL].pop_back();
-		}
+		restore(rev, backup);
 		if (err != NULL)
 			*err = xorn_error_out_of_memory;
 		return -1;
@@ -365,70 +458,51 @@ int xorn_relocate_object(xorn_revision_t rev, xorn_object_t ob,
 		return -1;
 	}
 
-	xorn_object_t &parent = rev->parent[ob];
-	std::vector<xorn_object_t> &old_children = rev->children[parent];
-	std::vector<xorn_object_t> &new_children = rev->children[attach_to];
-
-	std::vector<xorn_object_t>::iterator i = find(old_children.begin(),
-						      old_children.end(), ob);
-	assert(i != old_children.end());
-	std::vector<xorn_object_t>::size_type pos = i - old_children.begin();
-
-	/* Try adding the new entry first, removing the old one won't fail. */
+	if (insert_before != NULL) {
+		location const *loc = rev->location.lookup(insert_before);
+		if (loc == NULL) {
+			if (err != NULL)
+				*err = xorn_error_successor_doesnt_exist;
+			return -1;
+		}
+		if (loc->parent != attach_to) {
+			if (err != NULL)
+				*err = xorn_error_successor_not_sibling;
+			return -1;
+		}
+		if (insert_before == ob)
+			return 0;
+	}
 
+	xorn_revision backup(rev);
 	try {
-		if (insert_before == NULL)
-			new_children.push_back(ob);
-		else {
-			std::vector<xorn_object_t>::iterator j =
-				find(new_children.begin(),
-				     new_children.end(), insert_before);
-			if (j == new_children.end()) {
-			    if (err != NULL) {
-				if (xorn_object_exists_in_revision(
-					    rev, insert_before))
-				    *err = xorn_error_successor_not_sibling;
-				else
-				    *err = xorn_error_successor_doesnt_exist;
-			    }
-			    return -1;
-			}
-			if (&new_children == &old_children && j <= i)
-				++pos;
-			new_children.insert(j, ob);
-		}
+		remove_child(rev, ob);
+		insert_child(rev, ob, attach_to, insert_before);
 	} catch (std::bad_alloc const &) {
+		restore(rev, backup);
 		if (err != NULL)
 			*err = xorn_error_out_of_memory;
 		return -1;
 	}
-
-	old_children.erase(old_children.begin() + pos);
-	parent = attach_to;
 	return 0;
 }
 
 static void delete_object_but_leave_entry(
 	xorn_revision_t rev, xorn_object_t ob)
 {
-	std::map<xorn_object_t, obstate *>::iterator i
-		= rev->obstates.find(ob);
-	i->second->dec_refcnt();
-	rev->obstates.erase(i);
+	rev->obstates.erase(ob);
+	rev->location.erase(ob);
 
-	rev->parent.erase(rev->parent.find(ob));
-
-	std::map<xorn_object_t, std::vector<xorn_object_t> >::iterator j
-		= rev->children.find(ob);
-
-	if (j == rev->children.end())
+	child_list const *p = rev->children.lookup(ob);
+	if (p == NULL)
 		return;
 
-	for (std::vector<xorn_object_t>::const_iterator k = j->second.begin();
-	     k != j->second.end(); ++k)
-		delete_object_but_leave_entry(rev, *k);
+	child_list children = *p;
+	rev->children.erase(ob);
 
-	rev->children.erase(j);
+	for (child_list::const_iterator i = children.begin();
+	     i != children.end(); ++i)
+		delete_object_but_leave_entry(rev, i->second);
 }
 
 /** \brief Delete an object from a transient revision.
@@ -441,9 +515,10 @@ static void delete_object_but_leave_entry(
  * \return Returns \c 0 if the object has been deleted.  Returns \c -1
  * and sets the error code
  * - to \ref xorn_error_revision_not_transient if the revision isn't
- *   transient or
+ *   transient,
  * - to \ref xorn_error_object_doesnt_exist if the object doesn't
- *   exist in the revision.  */
+ *   exist in the revision, or
+ * - to \ref xorn_error_out_of_memory if there is not enough memory.  */
 
 int xorn_delete_object(xorn_revision_t rev, xorn_object_t ob,
 		       xorn_error_t *err)
@@ -454,19 +529,22 @@ int xorn_delete_object(xorn_revision_t rev, xorn_object_t ob,
 		return -1;
 	}
 
-	std::map<xorn_object_t, xorn_object_t>::const_iterator i
-		= rev->parent.find(ob);
-	if (i == rev->parent.end()) {
+	if (!rev->location.contains(ob)) {
 		if (err != NULL)
 			*err = xorn_error_object_doesnt_exist;
 		return -1;
 	}
-	xorn_object_t parent = i->second;
-
-	delete_object_but_leave_entry(rev, ob);
 
-	std::vector<xorn_object_t> &children = rev->children[parent];
-	children.erase(find(children.begin(), children.end(), ob));
+	xorn_revision backup(rev);
+	try {
+		remove_child(rev, ob);
+		delete_object_but_leave_entry(rev, ob);
+	} catch (std::bad_alloc const &) {
+		restore(rev, backup);
+		if (err != NULL)
+			*err = xorn_error_out_of_memory;
+		return -1;
+	}
 	return 0;
 }
 
@@ -481,8 +559,11 @@ int xorn_delete_object(xorn_revision_t rev, xorn_object_t ob,
  *
  * \return Returns \c 0 if the revision is transient (this doesn't
  * necessarily mean that any objects have been deleted).  Otherwise,
- * returns \c -1 and sets the error code to \ref
- * xorn_error_revision_not_transient.  */
+ * returns \c -1 and sets the error code
+ * - to \ref xorn_error_revision_not_transient if the revision isn't
+ *   transient or
+ * - to \ref xorn_error_out_of_memory if there is not enough memory,
+ *   in which case no objects are deleted.  */
 
 int xorn_delete_selected_objects(xorn_revision_t rev, xorn_selection_t sel,
 				 xorn_error_t *err)
@@ -493,49 +574,39 @@ int xorn_delete_selected_objects(xorn_revision_t rev, xorn_selection_t sel,
 		return -1;
 	}
 
+	xorn_revision backup(rev);
 	for (std::set<xorn_object_t>::const_iterator i = sel->begin();
-	     i != sel->end(); ++i)
-		(void) xorn_delete_object(rev, *i, NULL);
+	     i != sel->end(); ++i) {
+		xorn_error_t e;
+		if (xorn_delete_object(rev, *i, &e) == -1 &&
+		    e == xorn_error_out_of_memory) {
+			restore(rev, backup);
+			if (err != NULL)
+				*err = xorn_error_out_of_memory;
+			return -1;
+		}
+	}
 
 	return 0;
 }
 
+/* \a src is a copy of the source revision, so this works even if
+   objects are copied within the same revision.  */
+
 static xorn_object_t copy_object(
-	xorn_revision_t dest, xorn_revision_t src, xorn_object_t src_ob,
-	obstate *obstate, xorn_object_t attach_to,
-	std::vector<xorn_object_t> &copied)
+	xorn_revision_t dest, xorn_revision const &src, xorn_object_t src_ob,
+	obstate *obstate, xorn_object_t attach_to)
 {
 	xorn_object_t dest_ob = (xorn_object_t)++next_object_id;
-	dest->children[attach_to].push_back(dest_ob);
-	try {
-		dest->parent[dest_ob] = attach_to;
-	} catch (std::bad_alloc const &) {
-		dest->children[attach_to].pop_back();
-		throw;
-	}
-	try {
-		dest->obstates[dest_ob] = obstate;
-		obstate->inc_refcnt();
-	} catch (std::bad_alloc const &) {
-		dest->parent.erase(dest->parent.find(dest_ob));
-		dest->children[attach_to].pop_back();
-		throw;
-	}
-	try {
-		copied.push_back(dest_ob);
-	} catch (std::bad_alloc const &) {
-		(void) xorn_delete_object(dest, dest_ob, NULL);
-		throw;
-	}
+	insert_child(dest, dest_ob, attach_to, NULL);
+	dest->obstates.set(dest_ob, obstate);
 
-	std::map<xorn_object_t, std::vector<xorn_object_t> >::const_iterator i
-		= src->children.find(src_ob);
-
-	if (i != src->children.end())
-		for (std::vector<xorn_object_t>::const_iterator j
-			     = i->second.begin(); j != i->second.end(); ++j)
-			copy_object(dest, src, *j, src->obstates[*j],
-				    dest_ob, copied);
+	child_list const *children = src.children.lookup(src_ob);
+	if (children != NULL)
+		for (child_list::const_iterator i = children->begin();
+		     i != children->end(); ++i)
+			copy_object(dest, src, i->second,
+				    *src.obstates.lookup(i->second), dest_ob);
 
 	return dest_ob;
 }
@@ -572,23 +643,18 @@ xorn_object_t xorn_copy_object(xorn_revision_t dest,
 		return NULL;
 	}
 
-	std::map<xorn_object_t, obstate *>::const_iterator i
-		= src->obstates.find(ob);
-
-	if (i == src->obstates.end()) {
+	obstate *const *p = src->obstates.lookup(ob);
+	if (p == NULL) {
 		if (err != NULL)
 			*err = xorn_error_object_doesnt_exist;
 		return NULL;
 	}
 
-	std::vector<xorn_object_t> copied;
-
+	xorn_revision source(src), backup(dest);
 	try {
-		return copy_object(dest, src, ob, i->second, NULL, copied);
+		return copy_object(dest, source, ob, *p, NULL);
 	} catch (std::bad_alloc const &) {
-		for (std::vector<xorn_object_t>::const_iterator i
-			     = copied.begin(); i != copied.end(); ++i)
-			(void) xorn_delete_object(dest, *i, NULL);
+		restore(dest, backup);
 		if (err != NULL)
 			*err = xorn_error_out_of_memory;
 		return NULL;
@@ -638,12 +704,11 @@ xorn_selection_t xorn_copy_objects(xorn_revision_t dest,
 		return NULL;
 	}
 
-	std::map<xorn_object_t, obstate *>::const_iterator i
-		= src->obstates.begin();
+	xorn_revision source(src), backup(dest);
+	obstate_map::const_iterator i = source.obstates.begin();
 	std::set<xorn_object_t>::const_iterator j = sel->begin();
-	std::vector<xorn_object_t> copied;
 
-	while (i != src->obstates.end() && j != sel->end())
+	while (i != source.obstates.end() && j != sel->end())
 	    if (i->first < *j)
 		++i;
 	    else if (i->first > *j)
@@ -651,12 +716,10 @@ xorn_selection_t xorn_copy_objects(xorn_revision_t dest,
 	    else {
 		try {
 			xorn_object_t ob = copy_object(
-			    dest, src, i->first, i->second, NULL, copied);
+			    dest, source, i->first, i->second, NULL);
 			rsel->insert(ob);
 		} catch (std::bad_alloc const &) {
-			for (std::vector<xorn_object_t>::const_iterator i
-				     = copied.begin(); i != copied.end(); ++i)
-				(void) xorn_delete_object(dest, *i, NULL);
+			restore(dest, backup);
 			delete rsel;
 			if (err != NULL)
 				*err = xorn_error_out_of_memory;
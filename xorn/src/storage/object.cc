@@ -17,6 +17,7 @@
 #include "internal.h"
 #include <stdlib.h>
 #include <algorithm>
+#include <vector>
 #include "key_iterator.h"
 
 
@@ -24,7 +25,7 @@
 
 bool xorn_object_exists_in_revision(xorn_revision_t rev, xorn_object_t ob)
 {
-	return rev->obstates.find(ob) != rev->obstates.end();
+	return rev->obstates.contains(ob);
 }
 
 /** \brief Get the type of an object in a given revision.
@@ -34,13 +35,12 @@ bool xorn_object_exists_in_revision(xorn_revision_t rev, xorn_object_t ob)
 
 xorn_obtype_t xorn_get_object_type(xorn_revision_t rev, xorn_object_t ob)
 {
-	std::map<xorn_object_t, obstate *>::const_iterator i
-		= rev->obstates.find(ob);
+	obstate *const *p = rev->obstates.lookup(ob);
 
-	if (i == rev->obstates.end())
+	if (p == NULL)
 		return xorn_obtype_none;
 
-	return i->second->type;
+	return (*p)->type;
 }
 
 /** \brief Get a pointer to an object's data in a given revision.
@@ -64,13 +64,12 @@ xorn_obtype_t xorn_get_object_type(xorn_revision_t rev, xorn_object_t ob)
 void const *xorn_get_object_data(xorn_revision_t rev, xorn_object_t ob,
 				 xorn_obtype_t type)
 {
-	std::map<xorn_object_t, obstate *>::const_iterator i
-		= rev->obstates.find(ob);
+	obstate *const *p = rev->obstates.lookup(ob);
 
-	if (i == rev->obstates.end() || i->second->type != type)
+	if (p == NULL || (*p)->type != type)
 		return NULL;
 
-	return i->second->data;
+	return (*p)->data;
 }
 
 /** \brief Get the location of an object in the object structure.
@@ -94,36 +93,31 @@ int xorn_get_object_location(xorn_revision_t rev, xorn_object_t ob,
 			     xorn_object_t *attached_to_return,
 			     unsigned int *position_return)
 {
-	std::map<xorn_object_t, xorn_object_t>::const_iterator i
-		= rev->parent.find(ob);
-	if (i == rev->parent.end())
+	location const *loc = rev->location.lookup(ob);
+	if (loc == NULL)
 		return -1;
 
 	if (attached_to_return != NULL)
-		*attached_to_return = i->second;
+		*attached_to_return = loc->parent;
 
-	if (position_return != NULL) {
-		std::vector<xorn_object_t> const &children
-			= rev->children[i->second];
-		*position_return = find(children.begin(),
-					children.end(), ob) - children.begin();
-	}
+	if (position_return != NULL)
+		*position_return =
+			rev->children.lookup(loc->parent)->rank(loc->key);
 	return 0;
 }
 
 static void dump_children(xorn_revision_t rev, xorn_object_t attached_to,
 			  xorn_object_t **objects_return, size_t *count_return)
 {
-	std::map<xorn_object_t, std::vector<xorn_object_t> >::const_iterator i
-		= rev->children.find(attached_to);
+	child_list const *children = rev->children.lookup(attached_to);
 
-	if (i == rev->children.end())
+	if (children == NULL)
 		return;
 
-	for (std::vector<xorn_object_t>::const_iterator j
-		     = i->second.begin(); j != i->second.end(); ++j) {
-		(*objects_return)[(*count_return)++] = *j;
-		dump_children(rev, *j, objects_return, count_return);
+	for (child_list::const_iterator i = children->begin();
+	     i != children->end(); ++i) {
+		(*objects_return)[(*count_return)++] = i->second;
+		dump_children(rev, i->second, objects_return, count_return);
 	}
 }
 
@@ -177,30 +171,28 @@ int xorn_get_objects_attached_to(
 	xorn_revision_t rev, xorn_object_t ob,
 	xorn_object_t **objects_return, size_t *count_return)
 {
-	if (ob != NULL && rev->obstates.find(ob) == rev->obstates.end())
+	if (ob != NULL && !rev->obstates.contains(ob))
 		return -1;
-	std::map<xorn_object_t, std::vector<xorn_object_t> >::const_iterator i
-		= rev->children.find(ob);
+	child_list const *children = rev->children.lookup(ob);
 	if (objects_return == NULL) {
-		*count_return =
-			i == rev->children.end() ? 0 : i->second.size();
+		*count_return = children == NULL ? 0 : children->size();
 		return 0;
 	}
-	if (i == rev->children.end()) {
+	if (children == NULL) {
 		*objects_return = NULL;
 		*count_return = 0;
 		return 0;
 	}
 
 	*objects_return = (xorn_object_t *) malloc(
-		i->second.size() * sizeof(xorn_object_t));
+		children->size() * sizeof(xorn_object_t));
 	*count_return = 0;
-	if (*objects_return == NULL && !i->second.empty())
+	if (*objects_return == NULL && !children->empty())
 		return -1;
 
-	for (std::vector<xorn_object_t>::const_iterator j
-		     = i->second.begin(); j != i->second.end(); ++j)
-		(*objects_return)[(*count_return)++] = *j;
+	for (child_list::const_iterator i = children->begin();
+	     i != children->end(); ++i)
+		(*objects_return)[(*count_return)++] = i->second;
 	return 0;
 }
 
@@ -223,7 +215,7 @@ int xorn_get_selected_objects(
 	if (*objects_return == NULL && !rev->obstates.empty() && !sel->empty())
 		return -1;
 
-	xorn_object_t *ptr = set_intersection(
+	xorn_object_t *ptr = std::set_intersection(
 		iterate_keys(rev->obstates.begin()),
 		iterate_keys(rev->obstates.end()),
 		sel->begin(), sel->end(), *objects_return);
@@ -234,6 +226,48 @@ int xorn_get_selected_objects(
 	return 0;
 }
 
+namespace {
+
+/* Collects the differences between the object states of two
+   revisions, see pmap::diff.  */
+
+struct change_collector {
+	std::vector<xorn_object_t> *added_objects;
+	std::vector<xorn_object_t> *removed_objects;
+	std::vector<xorn_object_t> *modified_objects;
+
+	void added(obstate_map::value_type const &entry) {
+		if (added_objects != NULL)
+			added_objects->push_back(entry.first);
+	}
+	void removed(obstate_map::value_type const &entry) {
+		if (removed_objects != NULL)
+			removed_objects->push_back(entry.first);
+	}
+	void common(obstate_map::value_type const &old_entry,
+		    obstate_map::value_type const &new_entry) {
+		if (modified_objects != NULL &&
+		    old_entry.second != new_entry.second)
+			modified_objects->push_back(old_entry.first);
+	}
+};
+
+}
+
+static int to_array(std::vector<xorn_object_t> const &objects,
+		    xorn_object_t **objects_return, size_t *count_return)
+{
+	*objects_return = (xorn_object_t *) malloc(
+		objects.size() * sizeof(xorn_object_t));
+	*count_return = 0;
+	if (*objects_return == NULL && !objects.empty())
+		return -1;
+
+	std::copy(objects.begin(), objects.end(), *objects_return);
+	*count_return = objects.size();
+	return 0;
+}
+
 /** \brief Return a list of objects which are in a revision but not in
  *         another.
  *
@@ -247,22 +281,9 @@ int xorn_get_added_objects(
 	xorn_revision_t from_rev, xorn_revision_t to_rev,
 	xorn_object_t **objects_return, size_t *count_return)
 {
-	*objects_return = (xorn_object_t *) malloc(
-		to_rev->obstates.size() * sizeof(xorn_object_t));
-	*count_return = 0;
-	if (*objects_return == NULL && !to_rev->obstates.empty())
-		return -1;
-
-	xorn_object_t *ptr = set_difference(
-		iterate_keys(to_rev->obstates.begin()),
-		iterate_keys(to_rev->obstates.end()),
-		iterate_keys(from_rev->obstates.begin()),
-		iterate_keys(from_rev->obstates.end()), *objects_return);
-
-	*count_return = ptr - *objects_return;
-	*objects_return = (xorn_object_t *) realloc(
-		*objects_return, *count_return * sizeof(xorn_object_t));
-	return 0;
+	return xorn_get_changes(from_rev, to_rev,
+				objects_return, count_return,
+				NULL, NULL, NULL, NULL);
 }
 
 /** \brief Return a list of objects which are in a revision but not in
@@ -278,22 +299,10 @@ int xorn_get_removed_objects(
 	xorn_revision_t from_rev, xorn_revision_t to_rev,
 	xorn_object_t **objects_return, size_t *count_return)
 {
-	*objects_return = (xorn_object_t *) malloc(
-		from_rev->obstates.size() * sizeof(xorn_object_t));
-	*count_return = 0;
-	if (*objects_return == NULL && !from_rev->obstates.empty())
-		return -1;
-
-	xorn_object_t *ptr = set_difference(
-		iterate_keys(from_rev->obstates.begin()),
-		iterate_keys(from_rev->obstates.end()),
-		iterate_keys(to_rev->obstates.begin()),
-		iterate_keys(to_rev->obstates.end()), *objects_return);
-
-	*count_return = ptr - *objects_return;
-	*objects_return = (xorn_object_t *) realloc(
-		*objects_return, *count_return * sizeof(xorn_object_t));
-	return 0;
+	return xorn_get_changes(from_rev, to_rev,
+				NULL, NULL,
+				objects_return, count_return,
+				NULL, NULL);
 }
 
 /** \brief Return a list of objects which exist in two revisions but
@@ -308,33 +317,77 @@ int xorn_get_modified_objects(
 	xorn_revision_t from_rev, xorn_revision_t to_rev,
 	xorn_object_t **objects_return, size_t *count_return)
 {
-	*objects_return = (xorn_object_t *) malloc(
-		std::min(from_rev->obstates.size(),
-			 to_rev->obstates.size()) * sizeof(xorn_object_t));
-	*count_return = 0;
-	if (*objects_return == NULL && !from_rev->obstates.empty()
-				    && !to_rev->obstates.empty())
+	return xorn_get_changes(from_rev, to_rev,
+				NULL, NULL, NULL, NULL,
+				objects_return, count_return);
+}
+
+/** \brief Return the objects which have been added, removed, or
+ *         modified between two revisions.
+ *
+ * This is equivalent to calling \ref xorn_get_added_objects, \ref
+ * xorn_get_removed_objects, and \ref xorn_get_modified_objects, but
+ * only walks through the revisions once.  Parts of the revisions
+ * which are shared because one revision has been copied from the
+ * other are skipped, so the cost of this function depends on the
+ * number of changes rather than on the number of objects.
+ *
+ * Each pair of pointer arguments may be \c NULL to indicate that the
+ * caller isn't interested in that list.  Otherwise, the same
+ * semantics apply as in \ref xorn_get_objects.  See there for a more
+ * detailed description.
+ *
+ * \return Returns \c 0 on success and \c -1 if there is not enough
+ *         memory, in which case none of the lists is returned.  */
+
+int xorn_get_changes(
+	xorn_revision_t from_rev, xorn_revision_t to_rev,
+	xorn_object_t **added_return, size_t *added_count_return,
+	xorn_object_t **removed_return, size_t *removed_count_return,
+	xorn_object_t **modified_return, size_t *modified_count_return)
+{
+	std::vector<xorn_object_t> added, removed, modified;
+	change_collector collector;
+	collector.added_objects =
+		added_return == NULL ? NULL : &added;
+	collector.removed_objects =
+		removed_return == NULL ? NULL : &removed;
+	collector.modified_objects =
+		modified_return == NULL ? NULL : &modified;
+
+	try {
+		from_rev->obstates.diff(to_rev->obstates, collector);
+	} catch (std::bad_alloc const &) {
 		return -1;
+	}
 
-	std::map<xorn_object_t, obstate *>::const_iterator i
-		= from_rev->obstates.begin();
-	std::map<xorn_object_t, obstate *>::const_iterator j
-		= to_rev->obstates.begin();
-
-	while (i != from_rev->obstates.end() && j != to_rev->obstates.end())
-		if (i->first < j->first)
-			++i;
-		else if (i->first > j->first)
-			++j;
-		else {
-			if (i->second != j->second)
-				(*objects_return)[(*count_return)++] =
-					i->first;
-			++i;
-			++j;
-		}
+	xorn_object_t *added_objects = NULL, *removed_objects = NULL,
+		      *modified_objects = NULL;
+	size_t added_count = 0, removed_count = 0, modified_count = 0;
+
+	if ((added_return != NULL &&
+	     to_array(added, &added_objects, &added_count) == -1) ||
+	    (removed_return != NULL &&
+	     to_array(removed, &removed_objects, &removed_count) == -1) ||
+	    (modified_return != NULL &&
+	     to_array(modified, &modified_objects, &modified_count) == -1)) {
+		free(added_objects);
+		free(removed_objects);
+		free(modified_objects);
+		return -1;
+	}
 
-	*objects_return = (xorn_object_t *) realloc(
-		*objects_return, *count_return * sizeof(xorn_object_t));
+	if (added_return != NULL) {
+		*added_return = added_objects;
+		*added_count_return = added_count;
+	}
+	if (removed_return != NULL) {
+		*removed_return = removed_objects;
+		*removed_count_return = removed_count;
+	}
+	if (modified_return != NULL) {
+		*modified_return = modified_objects;
+		*modified_count_return = modified_count;
+	}
 	return 0;
 }
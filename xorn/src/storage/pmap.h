@@ -0,0 +1,486 @@
+/* Copyright (C) 2013-2020 Roland Lutz
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+#ifndef PMAP_H
+#define PMAP_H
+
+#include <stddef.h>
+#include <iterator>
+#include <new>
+#include <utility>
+
+/* Values stored in a pmap may be shared by several nodes.  Specialize
+   this template for value types which need to keep track of that.  */
+
+template<typename V> struct pmap_value_traits {
+	static void retain(V const &) {
+	}
+	static void release(V const &) {
+	}
+};
+
+/* Persistent ordered map.
+
+   The entries are kept in a weight-balanced binary search tree whose
+   nodes are reference-counted and never change once they have been
+   created.  Copying a map shares the root node and takes constant
+   time.  Changing a map replaces the O(log n) nodes on the path to the
+   affected entry; all other nodes stay shared with any copies.
+
+   Read-only access never allocates memory.  `set' and `erase' throw
+   std::bad_alloc if there is not enough memory, in which case the map
+   is left unchanged.  */
+
+template<typename K, typename V> class pmap {
+public:
+	typedef K key_type;
+	typedef V mapped_type;
+	typedef std::pair<K const, V> value_type;
+
+private:
+	struct node {
+		node(value_type const &value, node *left, node *right)
+			: refcnt(1), size(1 + count(left) + count(right)),
+			  left(left), right(right), value(value) {
+		}
+		unsigned int refcnt;
+		size_t size;
+		node *left;
+		node *right;
+		value_type value;
+	};
+
+	enum { delta = 3, ratio = 2 };
+
+	node *root;
+
+	static size_t count(node const *t) {
+		return t == NULL ? 0 : t->size;
+	}
+
+	static node *retain(node *t) {
+		if (t != NULL)
+			++t->refcnt;
+		return t;
+	}
+
+	static void release(node *t) {
+		while (t != NULL && --t->refcnt == 0) {
+			node *right = t->right;
+			release(t->left);
+			pmap_value_traits<V>::release(t->value.second);
+			delete t;
+			t = right;
+		}
+	}
+
+	/* Create a node.  Takes over the references to left and right,
+	   even if there is not enough memory.  */
+
+	static node *make(value_type const &value, node *left, node *right) {
+		node *t;
+		try {
+			t = new node(value, left, right);
+		} catch (std::bad_alloc const &) {
+			release(left);
+			release(right);
+			throw;
+		}
+		pmap_value_traits<V>::retain(t->value.second);
+		return t;
+	}
+
+	static node *rotate_left(value_type const &value,
+				 node *left, node *right) {
+		node *rl = right->left, *rr = right->right, *t;
+		try {
+			if (count(rl) < ratio * count(rr)) {
+				node *a = make(value, left, retain(rl));
+				t = make(right->value, a, retain(rr));
+			} else {
+				node *a = make(value, left, retain(rl->left));
+				node *b;
+				try {
+					b = make(right->value,
+						 retain(rl->right),
+						 retain(rr));
+				} catch (std::bad_alloc const &) {
+					release(a);
+					throw;
+				}
+				t = make(rl->value, a, b);
+			}
+		} catch (std::bad_alloc const &) {
+			release(right);
+			throw;
+		}
+		release(right);
+		return t;
+	}
+
+	static node *rotate_right(value_type const &value,
+				  node *left, node *right) {
+		node *ll = left->left, *lr = left->right, *t;
+		try {
+			if (count(lr) < ratio * count(ll)) {
+				node *a = make(value, retain(lr), right);
+				t = make(left->value, retain(ll), a);
+			} else {
+				node *a = make(value, retain(lr->right), right);
+				node *b;
+				try {
+					b = make(left->value,
+						 retain(ll),
+						 retain(lr->left));
+				} catch (std::bad_alloc const &) {
+					release(a);
+					throw;
+				}
+				t = make(lr->value, b, a);
+			}
+		} catch (std::bad_alloc const &) {
+			release(left);
+			throw;
+		}
+		release(left);
+		return t;
+	}
+
+	/* Create a node, rotating if one side has grown too heavy.
+	   Takes over the references to left and right.  */
+
+	static node *balance(value_type const &value,
+			     node *left, node *right) {
+		size_t l = count(left), r = count(right);
+		if (l + r >= 2) {
+			if (r > delta * l)
+				return rotate_left(value, left, right);
+			if (l > delta * r)
+				return rotate_right(value, left, right);
+		}
+		return make(value, left, right);
+	}
+
+	static node *insert_node(node *t, value_type const &value) {
+		if (t == NULL)
+			return make(value, NULL, NULL);
+		if (value.first < t->value.first) {
+			node *left = insert_node(t->left, value);
+			return balance(t->value, left, retain(t->right));
+		}
+		if (t->value.first < value.first) {
+			node *right = insert_node(t->right, value);
+			return balance(t->value, retain(t->left), right);
+		}
+		return make(value, retain(t->left), retain(t->right));
+	}
+
+	/* The key must exist in the tree.  */
+
+	static node *erase_node(node *t, K const &key) {
+		if (key < t->value.first) {
+			node *left = erase_node(t->left, key);
+			return balance(t->value, left, retain(t->right));
+		}
+		if (t->value.first < key) {
+			node *right = erase_node(t->right, key);
+			return balance(t->value, retain(t->left), right);
+		}
+		return glue(t->left, t->right);
+	}
+
+	static node *glue(node *left, node *right) {
+		if (left == NULL)
+			return retain(right);
+		if (right == NULL)
+			return retain(left);
+
+		if (left->size > right->size) {
+			node *m = left;
+			while (m->right != NULL)
+				m = m->right;
+			node *l = erase_node(left, m->value.first);
+			return balance(m->value, l, retain(right));
+		} else {
+			node *m = right;
+			while (m->left != NULL)
+				m = m->left;
+			node *r = erase_node(right, m->value.first);
+			return balance(m->value, retain(left), r);
+		}
+	}
+
+public:
+	class const_iterator {
+		enum { max_height = 128 };
+		node const *stack[max_height];
+		unsigned int depth;
+
+		void descend(node const *t) {
+			for (; t != NULL; t = t->left)
+				stack[depth++] = t;
+		}
+	public:
+		typedef typename pmap::value_type value_type;
+		typedef ptrdiff_t difference_type;
+		typedef value_type const *pointer;
+		typedef value_type const &reference;
+		typedef std::forward_iterator_tag iterator_category;
+
+		const_iterator() : depth(0) {
+		}
+		explicit const_iterator(node const *t) : depth(0) {
+			descend(t);
+		}
+		reference operator*() const {
+			return stack[depth - 1]->value;
+		}
+		pointer operator->() const {
+			return &stack[depth - 1]->value;
+		}
+		const_iterator &operator++() {
+			node const *t = stack[--depth];
+			descend(t->right);
+			return *this;
+		}
+		const_iterator operator++(int) {
+			const_iterator tmp = *this;
+			++*this;
+			return tmp;
+		}
+		bool operator==(const_iterator const &x) const {
+			if (depth == 0 || x.depth == 0)
+				return depth == x.depth;
+			return stack[depth - 1] == x.stack[x.depth - 1];
+		}
+		bool operator!=(const_iterator const &x) const {
+			return !(*this == x);
+		}
+	};
+
+private:
+	/* Walks through the entries of a tree in order, handing out
+	   whole subtrees until they are explicitly expanded.  */
+
+	class cursor {
+		enum { max_depth = 3 * 128 };
+		struct item {
+			node const *t;
+			bool whole;
+		} stack[max_depth];
+		unsigned int depth;
+
+		void push(node const *t, bool whole) {
+			stack[depth].t = t;
+			stack[depth].whole = whole;
+			depth++;
+		}
+	public:
+		explicit cursor(node const *t) : depth(0) {
+			if (t != NULL)
+				push(t, true);
+		}
+		bool done() const {
+			return depth == 0;
+		}
+		node const *top() const {
+			return stack[depth - 1].t;
+		}
+		bool top_is_whole() const {
+			return stack[depth - 1].whole;
+		}
+		size_t whole_size() const {
+			return depth != 0 && stack[depth - 1].whole
+				? stack[depth - 1].t->size : 0;
+		}
+		void pop() {
+			depth--;
+		}
+		void expand() {
+			node const *t = stack[--depth].t;
+			if (t->right != NULL)
+				push(t->right, true);
+			push(t, false);
+			if (t->left != NULL)
+				push(t->left, true);
+		}
+	};
+
+public:
+	pmap() : root(NULL) {
+	}
+	pmap(pmap const &x) : root(retain(x.root)) {
+	}
+	~pmap() {
+		release(root);
+	}
+	pmap &operator=(pmap const &x) {
+		node *t = retain(x.root);
+		release(root);
+		root = t;
+		return *this;
+	}
+
+	size_t size() const {
+		return count(root);
+	}
+	bool empty() const {
+		return root == NULL;
+	}
+
+	const_iterator begin() const {
+		return const_iterator(root);
+	}
+	const_iterator end() const {
+		return const_iterator();
+	}
+
+	/* Return a pointer to the value stored for a key, or NULL if
+	   there is no such entry.  The pointer stays valid until the
+	   map is changed or destroyed.  */
+
+	V const *lookup(K const &key) const {
+		node const *t = root;
+		while (t != NULL)
+			if (key < t->value.first)
+				t = t->left;
+			else if (t->value.first < key)
+				t = t->right;
+			else
+				return &t->value.second;
+		return NULL;
+	}
+
+	bool contains(K const &key) const {
+		return lookup(key) != NULL;
+	}
+
+	/* Return the number of keys which are less than \a key.  */
+
+	size_t rank(K const &key) const {
+		size_t result = 0;
+		node const *t = root;
+		while (t != NULL)
+			if (key < t->value.first)
+				t = t->left;
+			else if (t->value.first < key) {
+				result += count(t->left) + 1;
+				t = t->right;
+			} else
+				return result + count(t->left);
+		return result;
+	}
+
+	/* Return the entry with the given rank.  */
+
+	value_type const &at(size_t index) const {
+		node const *t = root;
+		for (;;) {
+			size_t l = count(t->left);
+			if (index < l)
+				t = t->left;
+			else if (index > l) {
+				index -= l + 1;
+				t = t->right;
+			} else
+				return t->value;
+		}
+	}
+
+	void set(K const &key, V const &value) {
+		node *t = insert_node(root, value_type(key, value));
+		release(root);
+		root = t;
+	}
+
+	void erase(K const &key) {
+		if (!contains(key))
+			return;
+		node *t = erase_node(root, key);
+		release(root);
+		root = t;
+	}
+
+	void clear() {
+		release(root);
+		root = NULL;
+	}
+
+	/* Compare this map with \a to and report the differences to \a f:
+
+	     f.removed(entry)      for entries only in this map,
+	     f.added(entry)        for entries only in \a to,
+	     f.common(old, new)    for keys present in both maps.
+
+	   Subtrees which the two maps share are skipped, so if \a to
+	   has been derived from this map (or vice versa), the cost
+	   depends on the number of changes rather than on the size of
+	   the maps.  Keys in shared subtrees are not passed to
+	   f.common.  All entries are reported in key order.  */
+
+	template<typename F> void diff(pmap const &to, F &f) const {
+		cursor a(root), b(to.root);
+
+		while (!a.done() && !b.done()) {
+			if (a.top_is_whole() && b.top_is_whole() &&
+			    a.top() == b.top()) {
+				a.pop();
+				b.pop();
+				continue;
+			}
+
+			size_t sa = a.whole_size(), sb = b.whole_size();
+			if (sa != 0 || sb != 0) {
+				if (sa >= sb)
+					a.expand();
+				if (sb >= sa)
+					b.expand();
+				continue;
+			}
+
+			value_type const &va = a.top()->value;
+			value_type const &vb = b.top()->value;
+			if (va.first < vb.first) {
+				f.removed(va);
+				a.pop();
+			} else if (vb.first < va.first) {
+				f.added(vb);
+				b.pop();
+			} else {
+				f.common(va, vb);
+				a.pop();
+				b.pop();
+			}
+		}
+
+		while (!a.done())
+			if (a.top_is_whole())
+				a.expand();
+			else {
+				f.removed(a.top()->value);
+				a.pop();
+			}
+		while (!b.done())
+			if (b.top_is_whole())
+				b.expand();
+			else {
+				f.added(b.top()->value);
+				b.pop();
+			}
+	}
+};
+
+#endif
@@ -23,18 +23,8 @@ xorn_revision::xorn_revision() : is_transient(true)
 
 xorn_revision::xorn_revision(xorn_revision_t rev)
 	: is_transient(true), obstates(rev->obstates),
-	  children(rev->children), parent(rev->parent)
+	  children(rev->children), location(rev->location)
 {
-	for (std::map<xorn_object_t, obstate *>::const_iterator i
-		     = obstates.begin(); i != obstates.end(); ++i)
-		i->second->inc_refcnt();
-}
-
-xorn_revision::~xorn_revision()
-{
-	for (std::map<xorn_object_t, obstate *>::const_iterator i
-		     = obstates.begin(); i != obstates.end(); ++i)
-		i->second->dec_refcnt();
 }
 
 
@@ -46,6 +36,11 @@ xorn_revision::~xorn_revision()
  *
  * \param rev Revision to copy, or \c NULL.
  *
+ * Copying a revision takes constant time.  The two revisions share
+ * their internal data until one of them is changed, and each change
+ * only allocates memory in proportion to the logarithm of the number
+ * of objects.
+ *
  * There is a slight difference between creating two empty revisions
  * and copying an empty one: only in the second case, objects of one
  * revision will be valid in the other.
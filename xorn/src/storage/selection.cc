@@ -60,7 +60,7 @@ xorn_selection_t xorn_select_object(xorn_object_t ob)
 
 xorn_selection_t xorn_select_attached_to(xorn_revision_t rev, xorn_object_t ob)
 {
-	if (ob != NULL && rev->obstates.find(ob) == rev->obstates.end())
+	if (ob != NULL && !rev->obstates.contains(ob))
 		return NULL;
 
 	xorn_selection_t rsel;
@@ -70,14 +70,14 @@ xorn_selection_t xorn_select_attached_to(xorn_revision_t rev, xorn_object_t ob)
 		return NULL;
 	}
 
-	std::map<xorn_object_t, std::vector<xorn_object_t> >::const_iterator i
-		= rev->children.find(ob);
-	if (i == rev->children.end())
+	child_list const *children = rev->children.lookup(ob);
+	if (children == NULL)
 		return rsel;
 
 	try {
-		copy(i->second.begin(), i->second.end(),
-		     inserter(*rsel, rsel->begin()));
+		for (child_list::const_iterator i = children->begin();
+		     i != children->end(); ++i)
+			rsel->insert(i->second);
 	} catch (std::bad_alloc const &) {
 		delete rsel;
 		return NULL;
@@ -96,9 +96,9 @@ xorn_selection_t xorn_select_all(xorn_revision_t rev)
 		return NULL;
 	}
 	try {
-		copy(iterate_keys(rev->obstates.begin()),
-		     iterate_keys(rev->obstates.end()),
-		     inserter(*rsel, rsel->begin()));
+		std::copy(iterate_keys(rev->obstates.begin()),
+			  iterate_keys(rev->obstates.end()),
+			  inserter(*rsel, rsel->begin()));
 	} catch (std::bad_alloc const &) {
 		delete rsel;
 		return NULL;
@@ -119,10 +119,10 @@ xorn_selection_t xorn_select_all_except(
 		return NULL;
 	}
 	try {
-		set_difference(iterate_keys(rev->obstates.begin()),
-			       iterate_keys(rev->obstates.end()),
-			       sel->begin(), sel->end(),
-			       inserter(*rsel, rsel->begin()));
+		std::set_difference(iterate_keys(rev->obstates.begin()),
+				    iterate_keys(rev->obstates.end()),
+				    sel->begin(), sel->end(),
+				    inserter(*rsel, rsel->begin()));
 	} catch (std::bad_alloc const &) {
 		delete rsel;
 		return NULL;
@@ -245,8 +245,7 @@ xorn_selection_t xorn_select_difference(
 
 bool xorn_selection_is_empty(xorn_revision_t rev, xorn_selection_t sel)
 {
-	std::map<xorn_object_t, obstate *>::const_iterator i
-		= rev->obstates.begin();
+	obstate_map::const_iterator i = rev->obstates.begin();
 	std::set<xorn_object_t>::const_iterator j = sel->begin();
 
 	while (i != rev->obstates.end() && j != sel->end())
@@ -266,7 +265,7 @@ bool xorn_selection_is_empty(xorn_revision_t rev, xorn_selection_t sel)
 bool xorn_object_is_selected(
 	xorn_revision_t rev, xorn_selection_t sel, xorn_object_t ob)
 {
-	return rev->obstates.find(ob) != rev->obstates.end() &&
+	return rev->obstates.contains(ob) &&
 	       sel->find(ob) != sel->end();
 }
 
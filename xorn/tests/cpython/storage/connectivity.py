@@ -0,0 +1,119 @@
+# Copyright (C) 2013-2020 Roland Lutz
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+import xorn.storage
+
+def net(x, y, width, height, is_pin = False):
+    return xorn.storage.Net(x = x, y = y, width = width, height = height,
+                            color = 4, is_bus = False, is_pin = is_pin)
+
+## Return the connections of a segment as a list of tuples
+## (x, y, type, whichend0, group1, ob1, whichend1).
+
+def connections(conn, ob, group = 0):
+    return conn.get_connections(group, ob)
+
+rev0 = xorn.storage.Revision()
+ob0 = rev0.add_object(net(0, 0, 100, 0))
+ob1 = rev0.add_object(net(100, 0, 0, 100))
+
+conn = xorn.storage.Connectivity()
+
+try:
+    conn.goto(rev0)
+except ValueError:
+    pass
+else:
+    raise AssertionError
+
+rev0.finalize()
+conn.goto(rev0)
+conn.update()
+
+assert connections(conn, ob0) == [(100., 0., 0, 1, 0, ob1, 0)]
+assert connections(conn, ob1) == [(100., 0., 0, 0, 0, ob0, 1)]
+
+# add a segment ending on the middle of ob0
+
+rev1 = xorn.storage.Revision(rev0)
+ob2 = rev1.add_object(net(50, 0, 0, -100))
+rev1.finalize()
+
+try:
+    conn.get_connections(0, ob2)
+except KeyError:
+    pass
+else:
+    raise AssertionError
+
+conn.goto(rev1)
+conn.update()
+
+assert connections(conn, ob0) == [(100., 0., 0, 1, 0, ob1, 0),
+                                  (50., 0., 1, -1, 0, ob2, 0)]
+assert connections(conn, ob2) == [(50., 0., 1, 0, 0, ob0, -1)]
+
+# move ob1 away from ob0
+
+rev2 = xorn.storage.Revision(rev1)
+rev2.set_object_data(ob1, net(200, 0, 0, 100))
+rev2.finalize()
+
+conn.goto(rev2)
+conn.update()
+
+assert connections(conn, ob0) == [(50., 0., 1, -1, 0, ob2, 0)]
+assert connections(conn, ob1) == []
+
+# delete ob2
+
+rev3 = xorn.storage.Revision(rev2)
+rev3.delete_object(ob2)
+rev3.finalize()
+
+conn.goto(rev3)
+conn.update()
+
+assert connections(conn, ob0) == []
+try:
+    conn.get_connections(0, ob2)
+except KeyError:
+    pass
+else:
+    raise AssertionError
+
+# segments which aren't part of the revision
+
+conn.add_segment(1, ob1, net(100, 0, 0, 100, is_pin = True))
+try:
+    conn.add_segment(1, ob1, net(100, 0, 0, 100, is_pin = True))
+except ValueError:
+    pass
+else:
+    raise AssertionError
+conn.update()
+
+assert connections(conn, ob1, 1) == [(100., 0., 0, 0, 0, ob0, 1)]
+assert connections(conn, ob0) == [(100., 0., 0, 1, 1, ob1, 0)]
+
+conn.remove_segment(1, ob1)
+assert connections(conn, ob0) == []
+try:
+    conn.remove_segment(1, ob1)
+except KeyError:
+    pass
+else:
+    raise AssertionError
@@ -23,6 +23,7 @@ mod_attrs = {
     'Revision': type,
     'Object': type,
     'Selection': type,
+    'Connectivity': type,
 
     'Arc': type,
     'Box': type,
@@ -41,6 +42,7 @@ mod_attrs = {
     'get_added_objects': types.BuiltinMethodType,
     'get_removed_objects': types.BuiltinMethodType,
     'get_modified_objects': types.BuiltinMethodType,
+    'get_changes': types.BuiltinMethodType,
 
     'select_none': types.BuiltinMethodType,
     'select_object': types.BuiltinMethodType,
@@ -30,3 +30,9 @@ assert xorn.storage.get_modified_objects(rev1, rev2) == []
 assert xorn.storage.get_added_objects(rev2, rev3) == []
 assert xorn.storage.get_removed_objects(rev2, rev3) == [ob1a]
 assert xorn.storage.get_modified_objects(rev2, rev3) == [ob0]
+
+assert xorn.storage.get_changes(rev0, rev1) == ([ob0], [], [])
+assert xorn.storage.get_changes(rev2, rev3) == ([], [ob1a], [ob0])
+assert xorn.storage.get_changes(rev3, rev2) == ([ob1a], [], [ob0])
+assert xorn.storage.get_changes(rev0, rev3) == (
+    xorn.storage.get_added_objects(rev0, rev3), [], [])
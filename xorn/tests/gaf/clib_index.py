@@ -0,0 +1,73 @@
+# Copyright (C) 2013-2020 Roland Lutz
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+import os, shutil, struct, tempfile
+import gaf.clib
+
+def write_index(directory, mtime, records):
+    data = struct.pack('<8sIIq', 'GAFCLIB\n', 1, len(records), mtime)
+    for name, pin_count, attribs in records:
+        strings = ''.join(s + '\0' for s in [name] + attribs)
+        record = struct.pack('<qqiI', 0, 0, pin_count, len(attribs)) + strings
+        data += struct.pack('<I', len(record)) + record
+
+    filename = gaf.clib.index_filename(directory)
+    if not os.path.isdir(os.path.dirname(filename)):
+        os.makedirs(os.path.dirname(filename))
+    f = open(filename, 'wb')
+    f.write(data)
+    f.close()
+
+tmpdir = tempfile.mkdtemp()
+try:
+    os.environ['XDG_CACHE_HOME'] = os.path.join(tmpdir, 'cache')
+    libdir = os.path.join(tmpdir, 'lib')
+    os.mkdir(libdir)
+    open(os.path.join(libdir, 'a.sym'), 'w').close()
+    open(os.path.join(libdir, 'README'), 'w').close()
+    os.utime(libdir, (1000000000, 1000000000))
+
+    source = gaf.clib.DirectorySource(libdir, False)
+
+    # no index: read the directory
+    assert gaf.clib.read_index(libdir) is None
+    assert list(source.list()) == ['a.sym']
+
+    # up-to-date index: don't read the directory
+    write_index(libdir, 1000000000, [
+        ('b.sym', 4, ['device=NAND', 'footprint=DIP14']),
+        ('c.sym.xml', -1, [])])
+    index = gaf.clib.read_index(libdir)
+    assert [name for name, summary in index] == ['b.sym', 'c.sym.xml']
+    assert index[0][1].pin_count == 4
+    assert index[0][1].attribs == ['device=NAND', 'footprint=DIP14']
+    assert index[1][1].pin_count == -1
+    assert index[1][1].attribs == []
+    assert list(source.list()) == ['b.sym', 'c.sym.xml']
+
+    # outdated index: read the directory again
+    os.utime(libdir, (1000000001, 1000000001))
+    assert gaf.clib.read_index(libdir) is None
+    assert list(source.list()) == ['a.sym']
+
+    # corrupt index
+    write_index(libdir, 1000000001, [('b.sym', 4, ['device=NAND'])])
+    filename = gaf.clib.index_filename(libdir)
+    data = open(filename, 'rb').read()
+    open(filename, 'wb').write(data[:-4])
+    assert gaf.clib.read_index(libdir) is None
+finally:
+    shutil.rmtree(tmpdir)
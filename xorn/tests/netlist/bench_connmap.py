@@ -0,0 +1,93 @@
+# Copyright (C) 2013-2020 Roland Lutz
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+# Measure how long it takes gaf.netlist.conn.ConnectionMap to follow
+# a sequence of small changes to a large sheet.
+#
+# The sheet is a grid of net segments.  Each revision stretches,
+# restores, deletes, or re-adds a random segment, and the connection
+# map is moved to it.  Afterwards, the connections found incrementally
+# are compared with those of a connection map created from scratch.
+#
+# This is not run as part of the test suite; run it with
+#
+#   PYTHONPATH=$(top_builddir)/built-packages \
+#     python bench_connmap.py [GRID-SIZE [REVISIONS]]
+
+import random, sys, time
+import xorn.proxy
+import xorn.storage
+import gaf.netlist.conn
+
+def grid_revision(size):
+    rev = xorn.storage.Revision()
+    obs = []
+    for i in xrange(size):
+        for j in xrange(size):
+            for width, height in [(100, 0), (0, 100)]:
+                obs.append(rev.add_object(xorn.storage.Net(
+                    x = i * 100, y = j * 100, width = width, height = height,
+                    color = 4, is_bus = False, is_pin = False)))
+    rev.finalize()
+    return rev, obs
+
+def connections(cmap, rev):
+    return dict(
+        (ob, sorted(ob1.ob for path1, ob1 in cmap.connected_to(
+            ((), xorn.proxy.ObjectProxy(rev, ob)))))
+        for ob in rev.get_objects())
+
+def main():
+    size = int(sys.argv[1]) if len(sys.argv) > 1 else 50
+    count = int(sys.argv[2]) if len(sys.argv) > 2 else 1000
+
+    random.seed(0)
+    rev, obs = grid_revision(size)
+
+    start = time.time()
+    cmap = gaf.netlist.conn.ConnectionMap(xorn.proxy.RevisionProxy(rev))
+    sys.stdout.write('%d net segments: %.3f s to create connection map\n'
+                     % (len(obs), time.time() - start))
+
+    deleted = {}
+    start = time.time()
+    for step in xrange(count):
+        rev = xorn.storage.Revision(rev)
+        ob = random.choice(obs)
+        if ob in deleted:
+            rev.add_object(deleted.pop(ob))
+            obs.remove(ob)
+            obs.append(rev.get_objects()[-1])
+        elif step % 4 == 3:
+            deleted[ob] = rev.get_object_data(ob)
+            rev.delete_object(ob)
+        else:
+            data = rev.get_object_data(ob)
+            if data.width:
+                data.width = 300 - data.width
+            else:
+                data.height = 300 - data.height
+            rev.set_object_data(ob, data)
+        rev.finalize()
+        cmap.goto(xorn.proxy.RevisionProxy(rev))
+    elapsed = time.time() - start
+    sys.stdout.write('%d revisions: %.3f s, %.3f ms per revision\n'
+                     % (count, elapsed, elapsed / count * 1e3))
+
+    fresh = gaf.netlist.conn.ConnectionMap(xorn.proxy.RevisionProxy(rev))
+    assert connections(cmap, rev) == connections(fresh, rev)
+
+main()
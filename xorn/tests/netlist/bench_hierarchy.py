@@ -0,0 +1,109 @@
+# Copyright (C) 2013-2020 Roland Lutz
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software Foundation,
+# Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+
+# Measure how the time needed to create a netlist grows with the size
+# of a hierarchical design.
+#
+# The toplevel schematic of the `hierarchy' test is copied side by
+# side the given number of times (by default 1, 10, and 100).  Each
+# copy gets its own refdes and net names, except for the net
+# `same_for_all', which connects all copies.  The time per component
+# pin should stay roughly constant as the design grows.
+#
+# This is not run as part of the test suite; run it with
+#
+#   PYTHONPATH=$(top_builddir)/built-packages \
+#     python bench_hierarchy.py [COPIES]...
+#
+# in the tests/netlist directory.
+
+import os, shutil, sys, tempfile, time
+import gaf.clib
+import gaf.netlist.netlist
+import gaf.netlist.slib
+
+srcdir = os.path.dirname(os.path.abspath(sys.argv[0]))
+
+def mangle(basename, hierarchy_tag):
+    if not hierarchy_tag or basename is None:
+        return basename
+    return '/'.join(hierarchy_tag) + '/' + basename
+
+## Return the contents of the toplevel schematic with \a count copies
+## of the `hierarchy' test schematic.
+
+def scaled_schematic(count):
+    f = open(os.path.join(srcdir, 'hierarchy.sch'))
+    lines = f.read().splitlines()
+    f.close()
+
+    out = [lines[0]]
+    for i in xrange(count):
+        dx = (i % 10) * 20000
+        dy = (i / 10) * 10000
+        for line in lines[1:]:
+            fields = line.split(' ')
+            if fields[0] == 'C':
+                fields[1] = str(int(fields[1]) + dx)
+                fields[2] = str(int(fields[2]) + dy)
+            elif fields[0] == 'N':
+                for j in (1, 3):
+                    fields[j] = str(int(fields[j]) + dx)
+                    fields[j + 1] = str(int(fields[j + 1]) + dy)
+            elif line.startswith('refdes=') or (
+                    line.startswith('netname=')
+                    and line != 'netname=same_for_all'):
+                fields[0] = '%s_%d' % (line, i)
+            out.append(' '.join(fields))
+    return '\n'.join(out) + '\n'
+
+def run(count, tmpdir):
+    filename = os.path.join(tmpdir, 'hierarchy%d.sch' % count)
+    f = open(filename, 'w')
+    f.write(scaled_schematic(count))
+    f.close()
+
+    start = time.time()
+    netlist = gaf.netlist.netlist.Netlist(
+        toplevel_filenames = [filename],
+        traverse_hierarchy = True,
+        refdes_mangle_func = mangle,
+        netname_mangle_func = mangle)
+    elapsed = time.time() - start
+
+    assert not netlist.failed
+    cpins = sum(len(component.cpins) for component in netlist.components)
+    sys.stdout.write('%6d copies: %7d pins, %5d nets, %8.3f s, %6.2f us/pin\n'
+                     % (count, cpins, len(netlist.nets), elapsed,
+                        elapsed / cpins * 1e6))
+
+def main():
+    counts = [int(arg) for arg in sys.argv[1:]] or [1, 10, 100]
+
+    for name in ['std-symbols', 'hierarchy-symbols']:
+        path = os.path.join(srcdir, name)
+        gaf.clib.add_source(gaf.clib.DirectorySource(path, True),
+                            gaf.clib.uniquify_source_name(name))
+    gaf.netlist.slib.slib.append(os.path.join(srcdir, 'hierarchy-sources'))
+
+    tmpdir = tempfile.mkdtemp()
+    try:
+        for count in counts:
+            run(count, tmpdir)
+    finally:
+        shutil.rmtree(tmpdir)
+
+main()
@@ -0,0 +1,105 @@
+/* Copyright (C) 2013-2020 Roland Lutz
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+/* Measure the cost of copying a revision and changing one object in
+   the copy, and of asking for the changes between the two revisions,
+   depending on the number of objects in the revision.
+
+   This is not run as part of the test suite; build it with
+   `make storage/bench_revision' in the tests directory.  */
+
+#include <xornstorage.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define STEPS 10000
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run(unsigned int size)
+{
+	xorn_revision_t rev, next;
+	struct xornsch_net net_data;
+	xorn_object_t *obs;
+	xorn_object_t *added, *removed, *modified;
+	size_t added_count, removed_count, modified_count;
+	unsigned int i;
+	double start, copy_time = 0., diff_time = 0.;
+
+	obs = malloc(size * sizeof *obs);
+	assert(obs != NULL);
+	memset(&net_data, 0, sizeof net_data);
+
+	rev = xorn_new_revision(NULL);
+	assert(rev != NULL);
+	for (i = 0; i < size; i++) {
+		net_data.size.x = i;
+		obs[i] = xornsch_add_net(rev, &net_data, NULL);
+		assert(obs[i] != NULL);
+	}
+	xorn_finalize_revision(rev);
+
+	for (i = 0; i < STEPS; i++) {
+		start = now();
+		next = xorn_new_revision(rev);
+		assert(next != NULL);
+		net_data.size.y = i;
+		assert(xornsch_set_net_data(
+			       next, obs[rand() % size], &net_data, NULL) == 0);
+		assert(xornsch_add_net(next, &net_data, NULL) != NULL);
+		xorn_finalize_revision(next);
+		copy_time += now() - start;
+
+		start = now();
+		assert(xorn_get_changes(rev, next,
+					&added, &added_count,
+					&removed, &removed_count,
+					&modified, &modified_count) == 0);
+		diff_time += now() - start;
+		assert(added_count == 1);
+		assert(removed_count == 0);
+		assert(modified_count == 1);
+		free(added);
+		free(removed);
+		free(modified);
+
+		xorn_free_revision(rev);
+		rev = next;
+	}
+	printf("%8u objects: %8.2f us per copy+modify, "
+	       "%8.2f us per xorn_get_changes\n", size,
+	       copy_time * 1e6 / STEPS, diff_time * 1e6 / STEPS);
+
+	xorn_free_revision(rev);
+	free(obs);
+}
+
+int main(void)
+{
+	unsigned int size;
+
+	for (size = 1000; size <= 1000000; size *= 10)
+		run(size);
+	return 0;
+}
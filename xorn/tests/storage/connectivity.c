@@ -0,0 +1,150 @@
+/* Copyright (C) 2013-2020 Roland Lutz
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+#include <xornstorage.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NO_ERROR ((xorn_error_t) -1)
+
+
+static xorn_object_t add_net(xorn_revision_t rev, double x, double y,
+			     double width, double height)
+{
+	struct xornsch_net data;
+	xorn_object_t ob;
+
+	memset(&data, 0, sizeof data);
+	data.pos.x = x;
+	data.pos.y = y;
+	data.size.x = width;
+	data.size.y = height;
+	data.color = 4;
+
+	ob = xornsch_add_net(rev, &data, NULL);
+	assert(ob != NULL);
+	return ob;
+}
+
+static void check_connection(
+	xorn_connectivity_t conn, xorn_object_t ob0, int whichend0,
+	xorn_object_t ob1, int whichend1, xorn_conntype_t type)
+{
+	struct xorn_connection *connections;
+	size_t count;
+
+	assert(xorn_get_connections(conn, 0, ob0,
+				    &connections, &count) == 0);
+	assert(count == 1);
+	assert(connections[0].type == type);
+	assert(connections[0].whichend0 == whichend0);
+	assert(connections[0].group1 == 0);
+	assert(connections[0].ob1 == ob1);
+	assert(connections[0].whichend1 == whichend1);
+	free(connections);
+}
+
+int main(void)
+{
+	xorn_revision_t rev0, rev1, rev2;
+	xorn_object_t ob0, ob1, ob2;
+	xorn_connectivity_t conn;
+	struct xornsch_net pin_data;
+	struct xorn_connection *connections;
+	size_t count;
+	xorn_error_t err;
+
+	rev0 = xorn_new_revision(NULL);
+	assert(rev0 != NULL);
+	ob0 = add_net(rev0, 0., 0., 100., 0.);
+	ob1 = add_net(rev0, 100., 0., 0., 100.);
+	xorn_finalize_revision(rev0);
+
+	rev1 = xorn_new_revision(rev0);
+	assert(rev1 != NULL);
+	ob2 = add_net(rev1, 50., 0., 0., -100.);
+
+	conn = xorn_new_connectivity();
+	assert(conn != NULL);
+
+	/* transient revisions can't be used */
+	err = NO_ERROR;
+	assert(xorn_connectivity_goto(conn, rev1, &err) == -1);
+	assert(err == xorn_error_invalid_argument);
+	xorn_finalize_revision(rev1);
+
+	assert(xorn_connectivity_goto(conn, rev0, NULL) == 0);
+	assert(xorn_connectivity_update(conn, NULL) == 0);
+	check_connection(conn, ob0, 1, ob1, 0, xorn_conntype_endpoint);
+	check_connection(conn, ob1, 0, ob0, 1, xorn_conntype_endpoint);
+	assert(xorn_get_connections(conn, 0, ob2,
+				    &connections, &count) == -1);
+
+	/* the new segment ends on the middle of ob0 */
+	assert(xorn_connectivity_goto(conn, rev1, NULL) == 0);
+	assert(xorn_connectivity_update(conn, NULL) == 0);
+	check_connection(conn, ob2, 0, ob0, -1, xorn_conntype_midpoint);
+
+	assert(xorn_get_connections(conn, 0, ob0,
+				    &connections, &count) == 0);
+	assert(count == 2);
+	assert(connections[1].ob1 == ob2);
+	assert(connections[1].whichend0 == -1);
+	assert(connections[1].whichend1 == 0);
+	assert(connections[1].pos.x == 50.);
+	assert(connections[1].pos.y == 0.);
+	free(connections);
+
+	/* deleting a segment removes its connections */
+	rev2 = xorn_new_revision(rev1);
+	assert(rev2 != NULL);
+	assert(xorn_delete_object(rev2, ob1, NULL) == 0);
+	xorn_finalize_revision(rev2);
+
+	assert(xorn_connectivity_goto(conn, rev2, NULL) == 0);
+	assert(xorn_connectivity_update(conn, NULL) == 0);
+	assert(xorn_get_connections(conn, 0, ob1,
+				    &connections, &count) == -1);
+	check_connection(conn, ob0, -1, ob2, 0, xorn_conntype_midpoint);
+
+	/* segments which aren't part of the revision */
+	memcpy(&pin_data, xornsch_get_net_data(rev1, ob1), sizeof pin_data);
+	pin_data.is_pin = true;
+	assert(xorn_connectivity_add_segment(
+		       conn, 1, ob1, &pin_data, NULL) == 0);
+	err = NO_ERROR;
+	assert(xorn_connectivity_add_segment(
+		       conn, 1, ob1, &pin_data, &err) == -1);
+	assert(err == xorn_error_invalid_argument);
+	assert(xorn_connectivity_update(conn, NULL) == 0);
+	assert(xorn_get_connections(conn, 1, ob1,
+				    &connections, &count) == 0);
+	assert(count == 1);
+	assert(connections[0].group1 == 0);
+	assert(connections[0].ob1 == ob0);
+	free(connections);
+
+	assert(xorn_connectivity_remove_segment(conn, 1, ob1, NULL) == 0);
+	assert(xorn_connectivity_remove_segment(conn, 1, ob1, NULL) == -1);
+	check_connection(conn, ob0, -1, ob2, 0, xorn_conntype_midpoint);
+
+	xorn_free_connectivity(conn);
+	xorn_free_revision(rev2);
+	xorn_free_revision(rev1);
+	xorn_free_revision(rev0);
+	return 0;
+}
@@ -0,0 +1,122 @@
+/* Copyright (C) 2013-2020 Roland Lutz
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.  */
+
+#include <xornstorage.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define COUNT 1000
+
+/* Insert many objects at the same place so the sort keys of the
+   children have to be relabelled many times.  */
+
+int main(void)
+{
+	xorn_revision_t rev0, rev1, rev2;
+	struct xornsch_line line_data;
+	xorn_object_t first, last, obs[COUNT];
+	xorn_object_t *objects;
+	size_t count;
+	xorn_object_t attached_to;
+	unsigned int position;
+	unsigned int i;
+
+	memset(&line_data, 0, sizeof line_data);
+	line_data.color = 3;
+
+	rev0 = xorn_new_revision(NULL);
+	assert(rev0 != NULL);
+	first = xornsch_add_line(rev0, &line_data, NULL);
+	assert(first != NULL);
+	last = xornsch_add_line(rev0, &line_data, NULL);
+	assert(last != NULL);
+	xorn_finalize_revision(rev0);
+
+	rev1 = xorn_new_revision(rev0);
+	assert(rev1 != NULL);
+
+	for (i = 0; i < COUNT; i++) {
+		obs[i] = xornsch_add_line(rev1, &line_data, NULL);
+		assert(obs[i] != NULL);
+		assert(xorn_relocate_object(rev1, obs[i], NULL,
+					    last, NULL) == 0);
+	}
+
+	assert(xorn_get_objects(rev1, &objects, &count) == 0);
+	assert(objects != NULL);
+	assert(count == COUNT + 2);
+	assert(objects[0] == first);
+	for (i = 0; i < COUNT; i++)
+		assert(objects[i + 1] == obs[i]);
+	assert(objects[COUNT + 1] == last);
+	free(objects);
+
+	for (i = 0; i < COUNT; i++) {
+		assert(xorn_get_object_location(
+			       rev1, obs[i], &attached_to, &position) == 0);
+		assert(attached_to == NULL);
+		assert(position == i + 1);
+	}
+	assert(xorn_get_object_location(rev1, last, NULL, &position) == 0);
+	assert(position == COUNT + 1);
+
+	/* insert each object right after the first one, i.e., before
+	   the object inserted previously */
+
+	rev2 = xorn_new_revision(rev0);
+	assert(rev2 != NULL);
+
+	for (i = 0; i < COUNT; i++) {
+		obs[i] = xornsch_add_line(rev2, &line_data, NULL);
+		assert(obs[i] != NULL);
+		assert(xorn_relocate_object(rev2, obs[i], NULL,
+					    i == 0 ? last : obs[i - 1],
+					    NULL) == 0);
+	}
+
+	assert(xorn_get_objects(rev2, &objects, &count) == 0);
+	assert(objects != NULL);
+	assert(count == COUNT + 2);
+	assert(objects[0] == first);
+	for (i = 0; i < COUNT; i++)
+		assert(objects[i + 1] == obs[COUNT - 1 - i]);
+	assert(objects[COUNT + 1] == last);
+	free(objects);
+
+	for (i = 0; i < COUNT; i++) {
+		assert(xorn_get_object_location(
+			       rev2, obs[i], &attached_to, &position) == 0);
+		assert(attached_to == NULL);
+		assert(position == COUNT - i);
+	}
+
+	/* the original revision is unaffected */
+
+	assert(xorn_get_objects(rev0, &objects, &count) == 0);
+	assert(objects != NULL);
+	assert(count == 2);
+	assert(objects[0] == first);
+	assert(objects[1] == last);
+	free(objects);
+	assert(xorn_get_object_location(rev0, last, NULL, &position) == 0);
+	assert(position == 1);
+
+	xorn_free_revision(rev2);
+	xorn_free_revision(rev1);
+	xorn_free_revision(rev0);
+	return 0;
+}
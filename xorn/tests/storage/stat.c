@@ -25,6 +25,8 @@ int main(void)
 
 	xorn_object_t *objects;
 	size_t count;
+	xorn_object_t *added, *removed, *modified;
+	size_t added_count, removed_count, modified_count;
 
 	setup(&rev0, &rev1, &rev2, &rev3, &ob0, &ob1a, &ob1b);
 
@@ -67,6 +69,39 @@ int main(void)
 	assert(objects[0] == ob0);
 	free(objects);
 
+	assert(xorn_get_changes(rev2, rev3, &added, &added_count,
+				&removed, &removed_count,
+				&modified, &modified_count) == 0);
+	assert(added_count == 0);
+	assert(removed_count == 1);
+	assert(removed[0] == ob1a);
+	assert(modified_count == 1);
+	assert(modified[0] == ob0);
+	free(added);
+	free(removed);
+	free(modified);
+
+	assert(xorn_get_changes(rev3, rev2, &added, &added_count,
+				NULL, NULL, &modified, &modified_count) == 0);
+	assert(added_count == 1);
+	assert(added[0] == ob1a);
+	assert(modified_count == 1);
+	assert(modified[0] == ob0);
+	free(added);
+	free(modified);
+
+	assert(xorn_get_changes(rev0, rev3, &added, &added_count,
+				&removed, &removed_count,
+				&modified, &modified_count) == 0);
+	assert(added_count == 2);
+	assert((added[0] == ob0 && added[1] == ob1b) ||
+	       (added[0] == ob1b && added[1] == ob0));
+	assert(removed_count == 0);
+	assert(modified_count == 0);
+	free(added);
+	free(removed);
+	free(modified);
+
 	xorn_free_revision(rev3);
 	xorn_free_revision(rev2);
 	xorn_free_revision(rev1);